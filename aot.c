@@ -0,0 +1,849 @@
+/*
+ *  aot.c
+ *  Ahead-of-time compiler. Started with -aot <file>, the VM loads the main class and all classes it references (transitively), but doesn't run it. Instead
+ *  every method is translated into a C function, which is written into the given file together with the class files. Compiled with -DAOT_IMAGE and the
+ *  sources of the VM, the file becomes a standalone executable of the program: the classes are loaded from the embedded class files, and the methods run
+ *  their C functions instead of being interpreted.
+ *  The C functions work like the machine code of the baseline JIT compiler (see jit.c), but keep the locals and the operand stack in C variables, so the C
+ *  compiler can put them into registers. A function is entered at the start of the method, at the return addresses of invokes and at loop headers, where it
+ *  loads the variables from the frame. It leaves to the interpreter at all instructions it doesn't support, and at the instructions which haven't been
+ *  quickened by the interpreter yet (i.e. which still need resolution or class initialization), where it stores the variables into the frame again. So all
+ *  invokes, returns, exceptions, monitors and less common instructions are executed by the interpreter which is embedded into the executable, as well as the
+ *  methods which can't be translated at all (the ones using subroutines).
+ *
+ *  Copyright (c) 2006, 2007 Daniel Klein. All rights reserved.
+ *
+ *  Licensed under GPL version 2.
+ *  See here for the full license: http://www.gnu.org/licenses/gpl.html
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "puraGlobals.h"
+#include "memoryManager.h"
+#include "methodArea.h"
+#include "referenceMap.h"
+#include "fileClassLoader.h"
+#include "aot.h"
+
+const char* aotOutputFileName= NULL;
+
+#ifndef AOT_IMAGE
+/* The VM itself doesn't contain any compiled code. */
+AotMethod aotMethods[]= { { NULL, NULL, NULL, NULL } };
+uint32 aotMethodCount= 0;
+AotClassFile aotClassFiles[]= { { NULL, NULL, 0 } };
+uint32 aotClassFileCount= 0;
+const char* aotMainClass= NULL;
+#endif
+
+/* classes which are used by the VM by their name only, so they aren't found by their references */
+const char* vmClassNames[]= { "java/lang/StackTraceElement", NULL };
+
+/* State of the translation of one method. */
+typedef struct sTranslation
+{
+	FILE* out;
+	Class* cls;
+	method_info* method;
+	int32* stackHeights; /* before every instruction, -1 for instructions which are never reached */
+} Translation;
+
+/* Returns the compiled code of the given method, or NULL if it is interpreted. */
+AotCode aot_findCode( const char* className, const char* name, const char* descriptor )
+{
+	uint32 i;
+	for( i= 0; i < aotMethodCount; i++ )
+		if( strcmp(aotMethods[i].name, name) == 0 && strcmp(aotMethods[i].descriptor, descriptor) == 0 && strcmp(aotMethods[i].className, className) == 0 )
+			return aotMethods[i].code;
+	
+	return NULL;
+}
+
+/* Returns the embedded class file of the class with the given name (using slashes), or NULL if there is none. */
+AotClassFile* aot_findClassFile( const char* className )
+{
+	uint32 i;
+	for( i= 0; i < aotClassFileCount; i++ )
+		if( strcmp(aotClassFiles[i].className, className) == 0 )
+			return &aotClassFiles[i];
+	
+	return NULL;
+}
+
+/* loading the program */
+
+/* Loads the class with the given name (or the component class of the given array class), if it hasn't been loaded yet. Classes which don't exist are
+   ignored, the program may never use them. Returns true if the class has been loaded now. */
+boolean loadReferencedClass( const char* className )
+{
+	char name[256];
+	
+	if( *className == '[' )
+	{
+		while( *className == '[' )
+			className++;
+		
+		/* arrays of primitive types */
+		if( *className != 'L' || strlen(className) > 255 )
+			return false;
+		
+		strcpy( name, className+1 );
+		name[strlen(name)-1]= '\0'; /* strip ';' */
+		className= name;
+	}
+	
+	if( ma_containsClass(className) != NULL || !cl_isClassAvailable(className) )
+		return false;
+	
+	ma_getClass( className );
+	return true;
+}
+
+/* Loads the next class which is referenced by the constant pool of a loaded class, but isn't loaded yet. Loading a class may change the class table, so
+   this is repeated from the beginning until all classes are loaded. Returns false if there is no class left. */
+boolean loadNextReferencedClass()
+{
+	uint32 i;
+	for( i= 0; i < classTableSize; i++ )
+	{
+		Class* cls= classTable[i];
+		
+		if( cls == NULL || cls->className[0] == '[' )
+			continue;
+		
+		uint32 index;
+		for( index= 1; index < cls->constant_pool_count; index++ )
+			if( cls->constant_pool[index] != NULL && cls->constant_pool[index]->tag == CONSTANT_Class &&
+				loadReferencedClass(cls_resolveConstantPoolIndexToClassName(cls, index)) )
+				return true;
+	}
+	
+	return false;
+}
+
+/* writing C code */
+
+/* Returns the type of the field referenced by the given Fieldref constant pool entry, i.e. the first character of its descriptor. */
+char getFieldType( Class* cls, u2 index )
+{
+	CONSTANT_Fieldref_info* ref= (CONSTANT_Fieldref_info*)cls->constant_pool[index];
+	return cls_resolveConstantPoolIndexToNameAndType( cls, ref->name_and_type_index )->descriptor[0];
+}
+
+boolean isWideType( char type )
+{
+	return type == BASE_TYPE_LONG || type == BASE_TYPE_DOUBLE;
+}
+
+/* Writes the stores of all locals and of the given number of operand stack slots into the frame. */
+void writeFrameStores( Translation* t, int32 stackHeight )
+{
+	int32 i;
+	for( i= 0; i < t->method->code->max_locals; i++ )
+		fprintf( t->out, "\tframe[%i]= l%i;\n", i, i );
+	
+	for( i= 0; i < stackHeight; i++ )
+		fprintf( t->out, "\tframe[%i]= s%i;\n", t->method->code->max_locals + i, i );
+}
+
+/* Writes the storing of the frame state before a call which may run the garbage collector. The pc must have a reference map (see findSafePoints() in
+   referenceMap.c). */
+void writeGcPoint( Translation* t, uint32 pc, int32 stackHeight )
+{
+	writeFrameStores( t, stackHeight );
+	fprintf( t->out, "\tsf->pc= code + %i;\n", pc );
+	fprintf( t->out, "\tstack->stackPointer= frame + %i;\n", t->method->code->max_locals + stackHeight );
+	fprintf( t->out, "\tgc_collectIfNecessary();\n" );
+}
+
+/* Writes a conditional branch, or a goto if the condition is NULL. Backward branches are safe points. */
+void writeBranch( Translation* t, uint32 pc, const char* condition, uint32 target )
+{
+	if( condition != NULL )
+		fprintf( t->out, "\tif( %s )\n\t", condition );
+	
+	if( target < pc )
+		fprintf( t->out, "\tAOT_BACKWARD_BRANCH( %i, %i );\n", target, t->stackHeights[target] );
+	else
+		fprintf( t->out, "\tgoto pc%i;\n", target );
+}
+
+/* Writes a check if the instruction at the given pc has been quickened to one of the given opcodes, which leaves to the interpreter otherwise. */
+void writeQuickCheck( Translation* t, uint32 pc, uint8 quickOpcode, const char* additionalExitCondition )
+{
+	fprintf( t->out, "\tif( code[%i] != %s", pc, opcodeNames[quickOpcode] );
+	
+	if( additionalExitCondition != NULL )
+		fprintf( t->out, " || %s", additionalExitCondition );
+	
+	fprintf( t->out, " )\n\t\tAOT_LEAVE( %i, %i );\n", pc, t->stackHeights[pc] );
+}
+
+/* Writes the check of an array access, which leaves to the interpreter if the reference is null or the index is out of bounds. */
+void writeArrayCheck( Translation* t, uint32 pc, int32 array, int32 index )
+{
+	fprintf( t->out, "\tif( s%i == NULL_REFERENCE || aot_isOutOfBounds(s%i, s%i) )\n\t\tAOT_LEAVE( %i, %i );\n", array, array, index, pc,
+		t->stackHeights[pc] );
+}
+
+/* Writes the C code of the instruction at the given pc. Returns false if the instruction isn't supported. */
+boolean writeInstruction( Translation* t, uint32 pc )
+{
+	FILE* out= t->out;
+	Class* cls= t->cls;
+	byte* code= t->method->code->code;
+	uint8 opcode= code[pc];
+	uint16 index= pc + 2 < t->method->code->code_length ? opcode_readU2( code+pc+1 ) : 0; /* the operand of most instructions with operands */
+	int32 height= t->stackHeights[pc];
+	int32 top= height - 1; /* index of the topmost operand stack slot */
+	char condition[64];
+	
+	switch( opcode )
+	{
+		/* constants */
+		case NOP:
+			return true;
+		
+		case ACONST_NULL:
+			fprintf( out, "\ts%i= NULL_REFERENCE;\n", height );
+			return true;
+		
+		case ICONST_M1: case ICONST_0: case ICONST_1: case ICONST_2: case ICONST_3: case ICONST_4: case ICONST_5:
+			fprintf( out, "\ts%i= %i;\n", height, opcode - ICONST_0 );
+			return true;
+		
+		case LCONST_0: case LCONST_1:
+			fprintf( out, "\ts%i= 0;\n\ts%i= %i;\n", height, height+1, opcode - LCONST_0 );
+			return true;
+		
+		case FCONST_0: case FCONST_1: case FCONST_2:
+		{
+			float value= opcode - FCONST_0;
+			int32 bits;
+			memcpy( &bits, &value, 4 );
+			fprintf( out, "\ts%i= %i;\n", height, bits );
+			return true;
+		}
+		
+		case DCONST_0: case DCONST_1:
+		{
+			double value= opcode - DCONST_0;
+			uint64 bits;
+			memcpy( &bits, &value, 8 );
+			fprintf( out, "\ts%i= %i;\n\ts%i= %i;\n", height, aot_high(bits), height+1, aot_low(bits) );
+			return true;
+		}
+		
+		case BIPUSH:
+			fprintf( out, "\ts%i= %i;\n", height, (int8)code[pc+1] );
+			return true;
+		
+		case SIPUSH:
+			fprintf( out, "\ts%i= %i;\n", height, (int16)index );
+			return true;
+		
+		case LDC:
+		case LDC_W:
+		{
+			if( opcode == LDC )
+				index= code[pc+1];
+			
+			uint8 tag= cls->constant_pool[index]->tag;
+			
+			if( tag == CONSTANT_Integer || tag == CONSTANT_Float )
+			{
+				fprintf( out, "\ts%i= %i;\n", height, cls_getItemFromConstantPool(cls, index) );
+				return true;
+			}
+			
+			/* Strings are created by the interpreter, when the instruction is executed the first time. */
+			if( tag != CONSTANT_String )
+				return false;
+			
+			writeQuickCheck( t, pc, opcode == LDC ? LDC_QUICK : LDC_W_QUICK, NULL );
+			fprintf( out, "\ts%i= ((CONSTANT_String_info*)cp[%i])->stringRef;\n", height, index );
+			return true;
+		}
+		
+		case LDC2_W:
+		{
+			uint64 value= cls_getWideItemFromConstantPool( cls, index );
+			fprintf( out, "\ts%i= %i;\n\ts%i= %i;\n", height, aot_high(value), height+1, aot_low(value) );
+			return true;
+		}
+		
+		/* local variables */
+		case ILOAD: case FLOAD: case ALOAD:
+			fprintf( out, "\ts%i= l%i;\n", height, code[pc+1] );
+			return true;
+		
+		case LLOAD: case DLOAD:
+			fprintf( out, "\ts%i= l%i;\n\ts%i= l%i;\n", height, code[pc+1], height+1, code[pc+1]+1 );
+			return true;
+		
+		case ILOAD_0: case ILOAD_1: case ILOAD_2: case ILOAD_3:
+		case FLOAD_0: case FLOAD_1: case FLOAD_2: case FLOAD_3:
+		case ALOAD_0: case ALOAD_1: case ALOAD_2: case ALOAD_3:
+			fprintf( out, "\ts%i= l%i;\n", height, (opcode - ILOAD_0) % 4 );
+			return true;
+		
+		case LLOAD_0: case LLOAD_1: case LLOAD_2: case LLOAD_3:
+		case DLOAD_0: case DLOAD_1: case DLOAD_2: case DLOAD_3:
+			fprintf( out, "\ts%i= l%i;\n\ts%i= l%i;\n", height, (opcode - ILOAD_0) % 4, height+1, (opcode - ILOAD_0) % 4 + 1 );
+			return true;
+		
+		case ISTORE: case FSTORE: case ASTORE:
+			fprintf( out, "\tl%i= s%i;\n", code[pc+1], top );
+			return true;
+		
+		case LSTORE: case DSTORE:
+			fprintf( out, "\tl%i= s%i;\n\tl%i= s%i;\n", code[pc+1], top-1, code[pc+1]+1, top );
+			return true;
+		
+		case ISTORE_0: case ISTORE_1: case ISTORE_2: case ISTORE_3:
+		case FSTORE_0: case FSTORE_1: case FSTORE_2: case FSTORE_3:
+		case ASTORE_0: case ASTORE_1: case ASTORE_2: case ASTORE_3:
+			fprintf( out, "\tl%i= s%i;\n", (opcode - ISTORE_0) % 4, top );
+			return true;
+		
+		case LSTORE_0: case LSTORE_1: case LSTORE_2: case LSTORE_3:
+		case DSTORE_0: case DSTORE_1: case DSTORE_2: case DSTORE_3:
+			fprintf( out, "\tl%i= s%i;\n\tl%i= s%i;\n", (opcode - ISTORE_0) % 4, top-1, (opcode - ISTORE_0) % 4 + 1, top );
+			return true;
+		
+		case IINC:
+			fprintf( out, "\tl%i= (int32)((uint32)l%i + %i);\n", code[pc+1], code[pc+1], (int8)code[pc+2] );
+			return true;
+		
+		/* arrays */
+		case IALOAD: case FALOAD: case AALOAD:
+			writeArrayCheck( t, pc, top-1, top );
+			fprintf( out, "\ts%i= aot_getArrayElements( s%i, int32 )[s%i];\n", top-1, top-1, top );
+			return true;
+		
+		case BALOAD:
+			writeArrayCheck( t, pc, top-1, top );
+			fprintf( out, "\ts%i= aot_getArrayElements( s%i, int8 )[s%i];\n", top-1, top-1, top );
+			return true;
+		
+		case CALOAD:
+			writeArrayCheck( t, pc, top-1, top );
+			fprintf( out, "\ts%i= aot_getArrayElements( s%i, uint16 )[s%i];\n", top-1, top-1, top );
+			return true;
+		
+		case IASTORE: case FASTORE: case AASTORE:
+			writeArrayCheck( t, pc, top-2, top-1 );
+			fprintf( out, "\taot_getArrayElements( s%i, int32 )[s%i]= s%i;\n", top-2, top-1, top );
+			if( opcode == AASTORE )
+				fprintf( out, "\theap_writeBarrier( s%i, s%i );\n", top-2, top );
+			return true;
+		
+		case BASTORE:
+			writeArrayCheck( t, pc, top-2, top-1 );
+			fprintf( out, "\taot_getArrayElements( s%i, int8 )[s%i]= s%i;\n", top-2, top-1, top );
+			return true;
+		
+		case CASTORE:
+			writeArrayCheck( t, pc, top-2, top-1 );
+			fprintf( out, "\taot_getArrayElements( s%i, uint16 )[s%i]= s%i;\n", top-2, top-1, top );
+			return true;
+		
+		case ARRAYLENGTH:
+			fprintf( out, "\tif( s%i == NULL_REFERENCE )\n\t\tAOT_LEAVE( %i, %i );\n", top, pc, height );
+			fprintf( out, "\ts%i= aot_getArrayLength( s%i );\n", top, top );
+			return true;
+		
+		/* operand stack */
+		case POP:
+		case POP2:
+			return true;
+		
+		case DUP:
+			fprintf( out, "\ts%i= s%i;\n", top+1, top );
+			return true;
+		
+		case DUP_X1:
+			fprintf( out, "\ts%i= s%i;\n\ts%i= s%i;\n\ts%i= s%i;\n", top+1, top, top, top-1, top-1, top+1 );
+			return true;
+		
+		case DUP_X2:
+			fprintf( out, "\ts%i= s%i;\n\ts%i= s%i;\n\ts%i= s%i;\n\ts%i= s%i;\n", top+1, top, top, top-1, top-1, top-2, top-2, top+1 );
+			return true;
+		
+		case DUP2:
+			fprintf( out, "\ts%i= s%i;\n\ts%i= s%i;\n", top+1, top-1, top+2, top );
+			return true;
+		
+		case DUP2_X1:
+			fprintf( out, "\ts%i= s%i;\n\ts%i= s%i;\n\ts%i= s%i;\n\ts%i= s%i;\n\ts%i= s%i;\n", top+2, top, top+1, top-1, top, top-2, top-2, top+1,
+				top-1, top+2 );
+			return true;
+		
+		case SWAP:
+			fprintf( out, "\t{\n\t\tint32 value= s%i;\n\t\ts%i= s%i;\n\t\ts%i= value;\n\t}\n", top, top, top-1, top-1 );
+			return true;
+		
+		/* integer arithmetic, using unsigned ints where Java defines the overflow */
+		case IADD:
+			fprintf( out, "\ts%i= (int32)((uint32)s%i + (uint32)s%i);\n", top-1, top-1, top );
+			return true;
+		
+		case ISUB:
+			fprintf( out, "\ts%i= (int32)((uint32)s%i - (uint32)s%i);\n", top-1, top-1, top );
+			return true;
+		
+		case IMUL:
+			fprintf( out, "\ts%i= (int32)((uint32)s%i * (uint32)s%i);\n", top-1, top-1, top );
+			return true;
+		
+		case IDIV:
+		case IREM:
+			/* Division by 0 is handled by the interpreter. Dividing the smallest int by -1 overflows, so the interpreter does this, too. */
+			fprintf( out, "\tif( s%i == 0 || s%i == -1 )\n\t\tAOT_LEAVE( %i, %i );\n", top, top, pc, height );
+			fprintf( out, "\ts%i= s%i %s s%i;\n", top-1, top-1, opcode == IDIV ? "/" : "%", top );
+			return true;
+		
+		case INEG:
+			fprintf( out, "\ts%i= (int32)(0 - (uint32)s%i);\n", top, top );
+			return true;
+		
+		case IAND:
+		case IOR:
+		case IXOR:
+			fprintf( out, "\ts%i= s%i %s s%i;\n", top-1, top-1, opcode == IAND ? "&" : opcode == IOR ? "|" : "^", top );
+			return true;
+		
+		case ISHL:
+			fprintf( out, "\ts%i= (int32)((uint32)s%i << (s%i & 0x1F));\n", top-1, top-1, top );
+			return true;
+		
+		case ISHR:
+			fprintf( out, "\ts%i= s%i >> (s%i & 0x1F);\n", top-1, top-1, top );
+			return true;
+		
+		case IUSHR:
+			fprintf( out, "\ts%i= (int32)((uint32)s%i >> (s%i & 0x1F));\n", top-1, top-1, top );
+			return true;
+		
+		case I2B:
+			fprintf( out, "\ts%i= (int8)s%i;\n", top, top );
+			return true;
+		
+		case I2C:
+			fprintf( out, "\ts%i= (uint16)s%i;\n", top, top );
+			return true;
+		
+		case I2S:
+			fprintf( out, "\ts%i= (int16)s%i;\n", top, top );
+			return true;
+		
+		/* long arithmetic */
+		case LADD:
+		case LSUB:
+		case LMUL:
+		case LAND:
+		case LOR:
+		case LXOR:
+		{
+			const char* operation= opcode == LADD ? "+" : opcode == LSUB ? "-" : opcode == LMUL ? "*" : opcode == LAND ? "&" : opcode == LOR ? "|" : "^";
+			fprintf( out, "\t{\n\t\tuint64 value= (uint64)aot_long( s%i, s%i ) %s (uint64)aot_long( s%i, s%i );\n", top-3, top-2, operation, top-1, top );
+			fprintf( out, "\t\ts%i= aot_high( value );\n\t\ts%i= aot_low( value );\n\t}\n", top-3, top-2 );
+			return true;
+		}
+		
+		case LDIV:
+		case LREM:
+			fprintf( out, "\tif( aot_long(s%i, s%i) == 0 || aot_long(s%i, s%i) == -1 )\n\t\tAOT_LEAVE( %i, %i );\n", top-1, top, top-1, top, pc, height );
+			fprintf( out, "\t{\n\t\tint64 value= aot_long( s%i, s%i ) %s aot_long( s%i, s%i );\n", top-3, top-2, opcode == LDIV ? "/" : "%", top-1, top );
+			fprintf( out, "\t\ts%i= aot_high( value );\n\t\ts%i= aot_low( value );\n\t}\n", top-3, top-2 );
+			return true;
+		
+		case LNEG:
+			fprintf( out, "\t{\n\t\tuint64 value= 0 - (uint64)aot_long( s%i, s%i );\n", top-1, top );
+			fprintf( out, "\t\ts%i= aot_high( value );\n\t\ts%i= aot_low( value );\n\t}\n", top-1, top );
+			return true;
+		
+		case LCMP:
+			fprintf( out, "\ts%i= aot_long( s%i, s%i ) > aot_long( s%i, s%i ) ? 1 : aot_long( s%i, s%i ) < aot_long( s%i, s%i ) ? -1 : 0;\n", top-3,
+				top-3, top-2, top-1, top, top-3, top-2, top-1, top );
+			return true;
+		
+		case I2L:
+			fprintf( out, "\ts%i= s%i;\n\ts%i= s%i >> 31;\n", top+1, top, top, top );
+			return true;
+		
+		case L2I:
+			fprintf( out, "\ts%i= s%i;\n", top-1, top );
+			return true;
+		
+		/* branches */
+		case IFEQ: case IFNE: case IFLT: case IFGE: case IFGT: case IFLE:
+		{
+			const char* operators[]= { "==", "!=", "<", ">=", ">", "<=" };
+			sprintf( condition, "s%i %s 0", top, operators[opcode - IFEQ] );
+			writeBranch( t, pc, condition, index );
+			return true;
+		}
+		
+		case IFNULL: case IFNONNULL:
+			sprintf( condition, "s%i %s NULL_REFERENCE", top, opcode == IFNULL ? "==" : "!=" );
+			writeBranch( t, pc, condition, index );
+			return true;
+		
+		case IF_ICMPEQ: case IF_ICMPNE: case IF_ICMPLT: case IF_ICMPGE: case IF_ICMPGT: case IF_ICMPLE:
+		case IF_ACMPEQ: case IF_ACMPNE:
+		{
+			const char* operators[]= { "==", "!=", "<", ">=", ">", "<=", "==", "!=" };
+			sprintf( condition, "s%i %s s%i", top-1, operators[opcode - IF_ICMPEQ], top );
+			writeBranch( t, pc, condition, index );
+			return true;
+		}
+		
+		case GOTO:
+			writeBranch( t, pc, NULL, index );
+			return true;
+		
+		case GOTO_W:
+			writeBranch( t, pc, NULL, opcode_readS4(code+pc+1) );
+			return true;
+		
+		/* fields, as soon as the interpreter has resolved them */
+		case GETSTATIC:
+		{
+			boolean isWide= isWideType( getFieldType(cls, index) );
+			writeQuickCheck( t, pc, isWide ? GETSTATIC2_QUICK : GETSTATIC_QUICK, NULL );
+			fprintf( out, "\ts%i= aot_getStaticSlots( cp, %i )[0];\n", height, index );
+			if( isWide )
+				fprintf( out, "\ts%i= aot_getStaticSlots( cp, %i )[1];\n", height+1, index );
+			return true;
+		}
+		
+		case PUTSTATIC:
+		{
+			boolean isWide= isWideType( getFieldType(cls, index) );
+			writeQuickCheck( t, pc, isWide ? PUTSTATIC2_QUICK : PUTSTATIC_QUICK, NULL );
+			if( isWide )
+				fprintf( out, "\taot_getStaticSlots( cp, %i )[0]= s%i;\n\taot_getStaticSlots( cp, %i )[1]= s%i;\n", index, top-1, index, top );
+			else
+				fprintf( out, "\taot_getStaticSlots( cp, %i )[0]= s%i;\n", index, top );
+			return true;
+		}
+		
+		/* The quick forms have the slot index of the field as operand. */
+		case GETFIELD:
+		{
+			sprintf( condition, "s%i == NULL_REFERENCE", top );
+			
+			if( isWideType(getFieldType(cls, index)) )
+			{
+				writeQuickCheck( t, pc, GETFIELD2_QUICK, condition );
+				fprintf( out, "\t{\n\t\tslot* slots= heap_getInstanceSlots( s%i ) + aot_getOperand16( code, %i );\n", top, pc );
+				fprintf( out, "\t\ts%i= slots[0];\n\t\ts%i= slots[1];\n\t}\n", top, top+1 );
+			}
+			else
+			{
+				writeQuickCheck( t, pc, GETFIELD_QUICK, condition );
+				fprintf( out, "\ts%i= heap_getInstanceSlots( s%i )[aot_getOperand16( code, %i )];\n", top, top, pc );
+			}
+			return true;
+		}
+		
+		case PUTFIELD:
+		{
+			char type= getFieldType( cls, index );
+			
+			if( isWideType(type) )
+			{
+				sprintf( condition, "s%i == NULL_REFERENCE", top-2 );
+				writeQuickCheck( t, pc, PUTFIELD2_QUICK, condition );
+				fprintf( out, "\t{\n\t\tslot* slots= heap_getInstanceSlots( s%i ) + aot_getOperand16( code, %i );\n", top-2, pc );
+				fprintf( out, "\t\tslots[0]= s%i;\n\t\tslots[1]= s%i;\n\t}\n", top-1, top );
+			}
+			else
+			{
+				/* The interpreter quickens stores into reference fields to APUTFIELD_QUICK, and only those need the write barrier. */
+				boolean isReference= type == BASE_TYPE_REFERENCE || type == BASE_TYPE_ONE_ARRAY_DIMENSION;
+				sprintf( condition, "s%i == NULL_REFERENCE", top-1 );
+				writeQuickCheck( t, pc, isReference ? APUTFIELD_QUICK : PUTFIELD_QUICK, condition );
+				fprintf( out, "\theap_getInstanceSlots( s%i )[aot_getOperand16( code, %i )]= s%i;\n", top-1, pc, top );
+				
+				if( isReference )
+					fprintf( out, "\theap_writeBarrier( s%i, s%i );\n", top-1, top );
+			}
+			return true;
+		}
+		
+		/* allocation, as soon as the interpreter has resolved the class */
+		case NEW:
+			writeQuickCheck( t, pc, NEW_QUICK, NULL );
+			writeGcPoint( t, pc, height );
+			fprintf( out, "\ts%i= heap_newInstance( ((CONSTANT_Class_info*)cp[%i])->class );\n", height, index );
+			return true;
+		
+		case ANEWARRAY:
+			sprintf( condition, "s%i < 0", top );
+			writeQuickCheck( t, pc, ANEWARRAY_QUICK, condition );
+			writeGcPoint( t, pc, height );
+			fprintf( out, "\ts%i= heap_newOneSlotArrayInstance( s%i, ((CONSTANT_Class_info*)cp[%i])->arrayClass );\n", top, top, index );
+			return true;
+		
+		case NEWARRAY:
+			fprintf( out, "\tif( s%i < 0 )\n\t\tAOT_LEAVE( %i, %i );\n", top, pc, height );
+			writeGcPoint( t, pc, height );
+			fprintf( out, "\ts%i= interpreter_newArray( %i, s%i );\n", top, code[pc+1], top );
+			return true;
+	}
+	
+	return false;
+}
+
+/* Writes the C function of the method of the given translation, named by the given number. */
+void writeMethod( Translation* t, uint32 number )
+{
+	FILE* out= t->out;
+	Code_attribute* code= t->method->code;
+	
+	/* The function is entered at the start of the method, at the return addresses of invokes and at the targets of backward branches (i.e. where the
+	   interpreter continues in compiled code, see interpreter.c), as long as these are reachable. */
+	boolean* isEntry= mm_staticMalloc( code->code_length * sizeof(boolean) );
+	memset( isEntry, 0, code->code_length * sizeof(boolean) );
+	isEntry[0]= true;
+	
+	uint32 pc;
+	for( pc= 0; pc < code->code_length; pc+= opcode_getInstructionLength(code->code, pc) )
+	{
+		uint8 opcode= code->code[pc];
+		uint32 nextPc= pc + opcode_getInstructionLength( code->code, pc );
+		
+		if( (opcode == INVOKEVIRTUAL || opcode == INVOKESPECIAL || opcode == INVOKESTATIC || opcode == INVOKEINTERFACE) && nextPc < code->code_length )
+			isEntry[nextPc]= true;
+		
+		if( (opcode >= IFEQ && opcode <= GOTO) || opcode == IFNULL || opcode == IFNONNULL )
+		{
+			uint16 target= opcode_readU2( code->code+pc+1 );
+			if( target < pc )
+				isEntry[target]= true;
+		}
+		
+		if( opcode == GOTO_W )
+		{
+			int32 target= opcode_readS4( code->code+pc+1 );
+			if( target < (int32)pc )
+				isEntry[target]= true;
+		}
+	}
+	
+	fprintf( out, "/* %s.%s%s */\n", t->cls->className, t->method->name, t->method->descriptor );
+	fprintf( out, "boolean aotMethod%i( Stack* stack, StackFrame* sf, boolean isSwitchingAllowed )\n{\n", number );
+	fprintf( out, "\tslot* frame= (slot*)(sf+1);\n" );
+	fprintf( out, "\tbyte* code= sf->methodInfo->code->code;\n" );
+	fprintf( out, "\tcp_info** cp= sf->currentClass->constant_pool;\n" );
+	fprintf( out, "\tuint32 exitPc;\n\tint32 exitStackHeight;\n" );
+	
+	int32 i;
+	for( i= 0; i < code->max_locals; i++ )
+		fprintf( out, "\tint32 l%i;\n", i );
+	
+	for( i= 0; i < code->max_stack; i++ )
+		fprintf( out, "\tint32 s%i;\n", i );
+	
+	/* entry */
+	fprintf( out, "\nenter:\n" );
+	
+	for( i= 0; i < code->max_locals; i++ )
+		fprintf( out, "\tl%i= frame[%i];\n", i, i );
+	
+	for( i= 0; i < code->max_stack; i++ )
+		fprintf( out, "\ts%i= frame[%i];\n", i, code->max_locals + i );
+	
+	fprintf( out, "\tswitch( sf->pc - code )\n\t{\n" );
+	
+	for( pc= 0; pc < code->code_length; pc++ )
+		if( isEntry[pc] && t->stackHeights[pc] >= 0 )
+			fprintf( out, "\t\tcase %i: goto pc%i;\n", pc, pc );
+	
+	fprintf( out, "\t}\n\treturn false;\n\n" );
+	
+	/* instructions */
+	for( pc= 0; pc < code->code_length; pc+= opcode_getInstructionLength(code->code, pc) )
+	{
+		if( t->stackHeights[pc] < 0 )
+			continue;
+		
+		fprintf( out, "pc%i: /* %s */\n", pc, opcodeNames[code->code[pc]] );
+		
+		if( !writeInstruction(t, pc) )
+			fprintf( out, "\tAOT_LEAVE( %i, %i );\n", pc, t->stackHeights[pc] );
+	}
+	
+	/* exits */
+	fprintf( out, "\nleave:\n" );
+	writeFrameStores( t, code->max_stack );
+	fprintf( out, "\tsf->pc= code + exitPc;\n\tstack->stackPointer= frame + %i + exitStackHeight;\n\treturn false;\n", code->max_locals );
+	
+	fprintf( out, "\nsafePoint:\n" );
+	writeFrameStores( t, code->max_stack );
+	fprintf( out, "\tsf->pc= code + exitPc;\n\tstack->stackPointer= frame + %i + exitStackHeight;\n", code->max_locals );
+	fprintf( out, "\tif( !isStopTheWorldRequested )\n\t\treturn true;\n" );
+	fprintf( out, "\tthread_enterSafePoint();\n\tgoto enter;\n}\n\n" );
+	
+	mm_staticFree( isEntry );
+}
+
+/* Returns the name by which the class file of the given class is found (see cl_init()). That's the class name, except for the main class, which may have
+   been loaded by the name given on the command line (i.e. without its package, or using dots). */
+const char* getEmbeddedClassName( Class* cls, Class* mainCls, const char* mainClass, char* name )
+{
+	if( cls != mainCls )
+		return cls->className;
+	
+	strcpy( name, mainClass );
+	
+	char* c;
+	for( c= name; *c != '\0'; c++ )
+		if( *c == '.' )
+			*c= '/';
+	
+	return name;
+}
+
+/* Writes the class file with the given name as a byte array, named by the given number. */
+void writeClassFile( FILE* out, const char* className, uint32 number )
+{
+	ClassLoaderState state;
+	cl_init( &state, className );
+	
+	fprintf( out, "/* %s */\nconst byte aotClassFile%i[]=\n{", className, number );
+	
+	uint32 i;
+	for( i= 0; i < state.size; i++ )
+		fprintf( out, "%s0x%02X,", i % 16 == 0 ? "\n\t" : " ", state.data[i] );
+	
+	fprintf( out, "\n};\n\n" );
+	cl_free( &state );
+}
+
+/* Translates the given main class and all classes it uses into C code, which is written into the given file. */
+void aot_translate( const char* mainClass, const char* outputFileName )
+{
+	FILE* out= fopen( outputFileName, "w" );
+	
+	if( out == NULL )
+		errorNo( "Could not create the output file of the ahead-of-time compiler." );
+	
+	/* load the program */
+	ma_loadSystemClasses();
+	Class* mainCls= ma_getClass( mainClass );
+	char mainClassName[256];
+	
+	const char** className;
+	for( className= vmClassNames; *className != NULL; className++ )
+		loadReferencedClass( *className );
+	
+	while( loadNextReferencedClass() )
+		;
+	
+	fprintf( out, "/* Generated by the ahead-of-time compiler of Pura from %s. Compile with -DAOT_IMAGE and the sources of the VM. */\n\n", mainClass );
+	fprintf( out, "#include \"aot.h\"\n\n" );
+	fprintf( out, "#ifndef AOT_IMAGE\n#error \"Compile with -DAOT_IMAGE.\"\n#endif\n\n" );
+	
+	/* methods */
+	uint32 classCount= 0;
+	uint32 methodCount= 0;
+	uint32 translatedMethodCount= 0;
+	uint32 i;
+	for( i= 0; i < classTableSize; i++ )
+	{
+		Class* cls= classTable[i];
+		
+		if( cls == NULL || cls->className[0] == '[' )
+			continue;
+		
+		classCount++;
+		
+		uint32 n;
+		for( n= 0; n < cls->methods_count; n++ )
+		{
+			method_info* method= cls->methods[n];
+			
+			if( method->code == NULL )
+				continue;
+			
+			methodCount++;
+			
+			Translation translation;
+			translation.out= out;
+			translation.cls= cls;
+			translation.method= method;
+			translation.stackHeights= mm_staticMalloc( method->code->code_length * sizeof(int32) );
+			
+			if( rm_computeStackHeights(cls, method, translation.stackHeights) )
+			{
+				writeMethod( &translation, translatedMethodCount );
+				translatedMethodCount++;
+			}
+			else
+			{
+				logVerbose( "--> Method %s.%s%s uses subroutines, it is interpreted.\n", cls->className, method->name, method->descriptor );
+			}
+			
+			mm_staticFree( translation.stackHeights );
+		}
+	}
+	
+	/* class files */
+	uint32 number= 0;
+	for( i= 0; i < classTableSize; i++ )
+		if( classTable[i] != NULL && classTable[i]->className[0] != '[' )
+			writeClassFile( out, getEmbeddedClassName(classTable[i], mainCls, mainClass, mainClassName), number++ );
+	
+	/* tables, in the same order as above */
+	fprintf( out, "AotMethod aotMethods[]=\n{\n" );
+	
+	number= 0;
+	for( i= 0; i < classTableSize; i++ )
+	{
+		Class* cls= classTable[i];
+		
+		if( cls == NULL || cls->className[0] == '[' )
+			continue;
+		
+		uint32 n;
+		for( n= 0; n < cls->methods_count; n++ )
+		{
+			method_info* method= cls->methods[n];
+			
+			if( method->code == NULL )
+				continue;
+			
+			/* The analysis is cheap, so it is run again instead of remembering its result. */
+			int32* stackHeights= mm_staticMalloc( method->code->code_length * sizeof(int32) );
+			
+			if( rm_computeStackHeights(cls, method, stackHeights) )
+				fprintf( out, "\t{ \"%s\", \"%s\", \"%s\", aotMethod%i },\n", cls->className, method->name, method->descriptor, number++ );
+			
+			mm_staticFree( stackHeights );
+		}
+	}
+	
+	fprintf( out, "\t{ NULL, NULL, NULL, NULL }\n};\n\nuint32 aotMethodCount= %i;\n\n", translatedMethodCount );
+	fprintf( out, "AotClassFile aotClassFiles[]=\n{\n" );
+	
+	number= 0;
+	for( i= 0; i < classTableSize; i++ )
+		if( classTable[i] != NULL && classTable[i]->className[0] != '[' )
+		{
+			fprintf( out, "\t{ \"%s\", aotClassFile%i, sizeof(aotClassFile%i) },\n", getEmbeddedClassName(classTable[i], mainCls, mainClass, mainClassName),
+				number, number );
+			number++;
+		}
+	
+	fprintf( out, "\t{ NULL, NULL, 0 }\n};\n\nuint32 aotClassFileCount= %i;\n\n", classCount );
+	fprintf( out, "const char* aotMainClass= \"%s\";\n", mainClass );
+	
+	if( fclose(out) != 0 )
+		errorNo( "Could not write the output file of the ahead-of-time compiler." );
+	
+	logInfo( "Translated %i of %i methods of %i classes into %s.\n", translatedMethodCount, methodCount, classCount, outputFileName );
+}
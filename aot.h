@@ -0,0 +1,94 @@
+/*
+ *  aot.h
+ *  Ahead-of-time compiler, which translates the methods of a program into C code. Compiled together with the VM, the C code is a standalone executable of
+ *  the program.
+ *
+ *  Copyright (c) 2006, 2007 Daniel Klein. All rights reserved.
+ *
+ *  Licensed under GPL version 2.
+ *  See here for the full license: http://www.gnu.org/licenses/gpl.html
+ */
+
+#ifndef _aot_h_
+#define _aot_h_
+
+#include "puraGlobals.h"
+#include "types.h"
+#include "class.h"
+#include "stack.h"
+#include "heap.h"
+#include "opcodes.h"
+#include "garbageCollector.h"
+#include "interpreter.h"
+#include "thread.h"
+#include "scheduler.h"
+
+/* Compiled code of a method. It is called like the machine code of the JIT compiler (see CompiledCode), but finds its entry by the stored pc of the frame. It
+   returns to the interpreter with the pc of the frame and the stack pointer stored, true if the current green thread should give up its worker and false if
+   the interpreter should continue at the stored pc. */
+typedef boolean (*AotCode)( Stack* stack, StackFrame* sf, boolean isSwitchingAllowed );
+
+typedef struct sAotMethod
+{
+	const char* className;
+	const char* name;
+	const char* descriptor;
+	AotCode code;
+} AotMethod;
+
+typedef struct sAotClassFile
+{
+	const char* className;
+	const byte* data;
+	uint32 size;
+} AotClassFile;
+
+/* Tables of the executable, defined by the emitted C code. Without AOT_IMAGE, they are empty. */
+extern AotMethod aotMethods[];
+extern uint32 aotMethodCount;
+extern AotClassFile aotClassFiles[];
+extern uint32 aotClassFileCount;
+extern const char* aotMainClass;
+
+/* set by the command line parameter -aot */
+extern const char* aotOutputFileName;
+
+void aot_translate( const char* mainClass, const char* outputFileName );
+AotCode aot_findCode( const char* className, const char* name, const char* descriptor );
+AotClassFile* aot_findClassFile( const char* className );
+
+/* used by the emitted C code */
+
+#define aot_getOperand16( code, pc ) opcode_readU2( (code)+(pc)+1 )
+#define aot_getArrayLength( ref ) (*(int32*)(objectPointerList[(ref)]+1))
+#define aot_getArrayElements( ref, type ) ((type*)(((slot*)(objectPointerList[(ref)]+1))+1))
+#define aot_getStaticSlots( cp, index ) \
+	(((CONSTANT_Fieldref_info*)(cp)[(index)])->class->class_inctance_variable_slots + ((CONSTANT_Fieldref_info*)(cp)[(index)])->variableInfo->slot_index)
+#define aot_isOutOfBounds( ref, index ) ((uint32)(index) >= (uint32)aot_getArrayLength( ref ))
+
+/* Longs and doubles are kept in two int32 variables, the high word first like on the operand stack. */
+#define aot_long( high, low ) ((int64)(((uint64)(uint32)(high) << 32) | (uint32)(low)))
+#define aot_high( value ) ((int32)((uint64)(value) >> 32))
+#define aot_low( value ) ((int32)(value))
+
+/* Leaves to the interpreter, which executes the instruction at the given pc. */
+#define AOT_LEAVE( pc, stackHeight ) \
+	do { \
+		exitPc= (pc); \
+		exitStackHeight= (stackHeight); \
+		goto leave; \
+	} while( false )
+
+/* Backward branch: a safe point and switch point like in the interpreter (see SAFE_POINT() in interpreter.c). */
+#define AOT_BACKWARD_BRANCH( target, stackHeight ) \
+	do { \
+		if( isStopTheWorldRequested || (isSwitchingAllowed && sched_isSwitchDue()) ) \
+		{ \
+			exitPc= (target); \
+			exitStackHeight= (stackHeight); \
+			goto safePoint; \
+		} \
+		goto pc##target; \
+	} while( false )
+
+#endif /*_aot_h_*/
@@ -0,0 +1,63 @@
+#!/bin/sh
+#
+#  aot_test.sh
+#  Compiles test programs ahead of time into standalone executables (see readme.md), runs them and compares their output with the
+#  output of the interpreter. Takes the programs to test as <directory in testclasses>/<main class>, or tests a default selection.
+#  Compiler flags can be passed in CFLAGS, e.g. CFLAGS="-Dmalloc_size=malloc_usable_size -include malloc.h" on Linux.
+#
+#  Copyright (c) 2006, 2007 Daniel Klein. All rights reserved.
+#
+#  Licensed under GPL version 2.
+#  See here for the full license: http://www.gnu.org/licenses/gpl.html
+#
+
+PURA=$(cd "$(dirname "$0")" && pwd)
+CC=${CC:-gcc}
+CFLAGS=${CFLAGS:-"-O2"}
+OUT=${TMPDIR:-/tmp}/pura_aot_test.$$
+
+PROGRAMS="$*"
+if [ -z "$PROGRAMS" ]
+then
+	PROGRAMS="hello/HelloWorld automobiles/AutoTest exceptions/CatchExceptionTest gc/GCTest jit/JitTest threads/ThreadCounter synchronization/SyncCounter"
+fi
+
+mkdir -p "$OUT/obj" || exit 1
+
+# The interpreter, which translates the programs and produces the expected output.
+echo "Building pura..."
+$CC $CFLAGS -w -o "$OUT/pura" "$PURA"/*.c -lm -lpthread || exit 1
+
+# The sources of Pura are the same for every executable, so they are only compiled once.
+echo "Building the runtime of the executables..."
+for source in "$PURA"/*.c
+do
+	$CC $CFLAGS -w -DAOT_IMAGE -c "$source" -o "$OUT/obj/$(basename "$source" .c).o" || exit 1
+done
+
+failures=0
+for program in $PROGRAMS
+do
+	directory=$PURA/testclasses/$(dirname "$program")
+	mainClass=$(basename "$program")
+	image=$OUT/$mainClass
+
+	"$OUT/pura" -silent -cp "$PURA/lib:$directory" "$mainClass" > "$OUT/expected.txt" 2>&1
+
+	# The executable contains all classes, so it's run outside of the classpath.
+	if "$OUT/pura" -silent -cp "$PURA/lib:$directory" -aot "$image.c" "$mainClass" > "$OUT/translation.txt" 2>&1 &&
+		$CC $CFLAGS -w -DAOT_IMAGE -I"$PURA" -o "$image" "$OUT"/obj/*.o "$image.c" -lm -lpthread &&
+		(cd "$OUT" && "$image" -silent > "$OUT/actual.txt" 2>&1) &&
+		cmp -s "$OUT/expected.txt" "$OUT/actual.txt"
+	then
+		echo "$program: ok"
+	else
+		echo "$program: FAILED"
+		failures=$((failures+1))
+	fi
+done
+
+rm -rf "$OUT"
+
+echo "$failures failed."
+[ $failures -eq 0 ]
@@ -14,8 +14,16 @@
 #include "methodArea.h"
 #include "interpreter.h"
 #include "memoryManager.h"
+#include "symbolTable.h"
 #include "heap.h"
+#include "stack.h"
 #include "class.h"
+#include "native.h"
+#include "referenceMap.h"
+#include "inlineCache.h"
+#include "opcodes.h"
+#include "aot.h"
+#include "registerInterpreter.h"
 
 /**********************************************************************************************
  * Constant Pool handling
@@ -36,6 +44,7 @@ void readMethodRefInfo( Class* cls, ClassLoaderState* cl, int constantPoolPos )
 	ref->name_and_type_index= cl_readU2( cl );
 	ref->class= NULL; /* rt pointers, will be initialized later */
 	ref->methodInfo= NULL;
+	ref->vtableIndex= NO_VTABLE_INDEX;
 
 	logVerbose( "<#%i, #%i>\n", ref->class_index, ref->name_and_type_index );
 
@@ -87,7 +96,8 @@ void readClassInfo( Class* cls, ClassLoaderState* cl, int constantPoolPos )
 	CONSTANT_Class_info* ref= mm_staticMalloc( sizeof(CONSTANT_Class_info) );
 	ref->tag= cl_readU1( cl );
 	ref->name_index= cl_readU2( cl );
-	ref->class= NULL; /* rt pointer */
+	ref->class= NULL; /* rt pointers */
+	ref->arrayClass= NULL;
 	
 	logVerbose( "<#%i>\n", ref->name_index );
 
@@ -100,13 +110,15 @@ void readConstantUtf8Info( Class* cls, ClassLoaderState* cl, int constantPoolPos
 	ref->tag= cl_readU1( cl );
 	ref->length= cl_readU2( cl );
 	
-	ref->bytes= mm_staticMalloc( ref->length+1 );
-	cl_readBytes( cl, ref->length, ref->bytes );
+	byte* data= mm_staticMalloc( ref->length+1 );
+	cl_readBytes( cl, ref->length, data );
 	
 	/* add terminating null-byte */
-	byte* data= ref->bytes;
-	data+= ref->length;
-	*data= '\0';
+	data[ref->length]= '\0';
+	
+	/* Only keep the interned version of the string, so that names and descriptors can be compared by their pointers. */
+	ref->bytes= (byte*)sym_intern( (char*)data );
+	mm_staticFree( data );
 	
 	logVerbose( "\"%s\"\n", (char*)ref->bytes );
 	
@@ -204,14 +216,16 @@ void readConstantPoolEntries( Class* cls, ClassLoaderState* cl )
 		case CONSTANT_Long:
 			logVerbose( "%i: CONSTANT_Long ", i );
 			readConstantLongInfo( cls, cl, i );
-			/* use two slots! -> skip one */
+			/* use two slots! -> skip one, and leave it empty */
 			i++;
+			cls->constant_pool[i]= NULL;
 			break;
 		case CONSTANT_Double:
 			logVerbose( "%i: CONSTANT_Double ", i );
 			readConstantDoubleInfo( cls, cl, i );
-			/* use two slots! -> skip one */
+			/* use two slots! -> skip one, and leave it empty */
 			i++;
+			cls->constant_pool[i]= NULL;
 			break;
 		case CONSTANT_Class:
 			logVerbose( "%i: CONSTANT_Class ", i );
@@ -426,7 +440,10 @@ void readFields( Class* cls, ClassLoaderState* cl )
 	int currentClassInstanceTableIndex= 0;
 	int currentInstanceTableIndex= 0;
 	cls->class_instance_variable_slot_count= 0;
-	cls->instance_variable_slot_count= 0;
+	
+	/* Instances are laid out as one block: the slots of all super classes come first, followed by the slots of this class. So the instance variables of this class
+		start right behind the last slot of the super class, and instance_variable_slot_count is the slot count of the whole instance. */
+	cls->instance_variable_slot_count= (cls->superClass != NULL) ? cls->superClass->instance_variable_slot_count : 0;
 	
 	cls->class_instance_variable_table= mm_staticMalloc( sizeof(variable*) * cls->class_instance_variable_count );
 	cls->instance_variable_table= mm_staticMalloc( sizeof(variable*) * cls->instance_variable_count );
@@ -470,8 +487,25 @@ void readFields( Class* cls, ClassLoaderState* cl )
 		}
 	}
 	
-	/* allocate memory for the static instance variable slots */
+	/* allocate memory for the static instance variable slots, which start with their default values */
 	cls->class_inctance_variable_slots= mm_staticMalloc( sizeof(int32) * cls->class_instance_variable_slot_count );
+	memset( cls->class_inctance_variable_slots, 0, sizeof(int32) * cls->class_instance_variable_slot_count );
+	
+	/* Collect the slots of all reference type instance variables, starting with the ones of the super classes. */
+	u2 superReferenceSlotCount= (cls->superClass != NULL) ? cls->superClass->reference_slot_count : 0;
+	cls->reference_slots= mm_staticMalloc( sizeof(u2) * (superReferenceSlotCount + cls->instance_variable_count) );
+	cls->reference_slot_count= 0;
+	
+	for( k= 0; k < superReferenceSlotCount; k++ )
+		cls->reference_slots[cls->reference_slot_count++]= cls->superClass->reference_slots[k];
+	
+	for( k= 0; k < cls->instance_variable_count; k++ )
+	{
+		variable* var= cls->instance_variable_table[k];
+		
+		if( *var->descriptor == BASE_TYPE_REFERENCE || *var->descriptor == BASE_TYPE_ONE_ARRAY_DIMENSION )
+			cls->reference_slots[cls->reference_slot_count++]= var->slot_index;
+	}
 	
 	mm_staticFree( fields );
 }
@@ -491,6 +525,8 @@ Code_attribute* readCodeAttribute( Class* cls, ClassLoaderState* cl )
 	code->code_length= cl_readU4( cl );
 	code->code= mm_staticMalloc( code->code_length );
 	cl_readBytes( cl, code->code_length, code->code );
+	opcode_predecode( code->code, code->code_length );
+	ic_init( code );
 	
 	/* read exception table */
 	code->exception_table_length= cl_readU2( cl );
@@ -651,12 +687,190 @@ void readMethods( Class* cls, ClassLoaderState* cl )
 		method->parameterSlotCount= determineSlotCountFromDescriptor( method->descriptor );
 		method->parameterSlotCount+= isFlagSet(method->access_flags, ACC_STATIC) ? 0 : 1;
 		
+		method->declaringClass= cls;
+		method->vtableIndex= NO_VTABLE_INDEX;
+		method->itableIndex= i;
+		method->nativeFunction= NULL;
+		method->invocationCount= 0;
+		method->backwardBranchCount= 0;
+		method->compilationCount= 0;
+		method->compiledMethod= NULL;
+		method->optimizationCount= 0;
+		method->optimizedMethod= NULL;
+		method->loopOptimizationCount= 0;
+		method->loopOptimizedMethods= NULL;
+		method->aotCode= aot_findCode( cls->className, method->name, method->descriptor );
+		method->registerCode= NULL;
+		
+		/* Look up the implementation of native methods now, so that it can be called directly. */
+		if( isFlagSet(method->access_flags, ACC_NATIVE) )
+			native_bindMethod( cls, method );
+		
+		/* Compute where the stack frames of this method hold references, so that the garbage collector can scan them precisely. */
+		rm_computeReferenceMaps( cls, method );
+		
+		/* Translate the stack bytecode into the register code of the register interpreter. */
+		ri_translate( cls, method );
+		
 		/* Add to method list. */
 		cls->methods[i]= method;
 	}
 }
 
-/* Tries to recursively resolve the given method, starting at class cls and going up through the hierarchy of super classes. */
+/* Checks if a method is dispatched virtually, i.e. if it gets an entry in the vtable. */
+boolean isVirtualMethod( method_info* method )
+{
+	if( isFlagSet(method->access_flags, ACC_STATIC) || isFlagSet(method->access_flags, ACC_PRIVATE) )
+		return false;
+	
+	/* instance and class initializers */
+	if( *method->name == '<' )
+		return false;
+	
+	return true;
+}
+
+/* Builds the vtable of the given class from the vtable of its super class and its own methods. Must be called after readMethods(). */
+void buildVtable( Class* cls )
+{
+	u2 superLength= (cls->superClass != NULL) ? cls->superClass->vtable_length : 0;
+	
+	/* The vtable can't get longer than the super vtable plus all methods of this class. */
+	cls->vtable= mm_staticMalloc( (superLength + cls->methods_count) * sizeof(method_info*) );
+	cls->vtable_length= superLength;
+	
+	int i;
+	for( i= 0; i < superLength; i++ )
+		cls->vtable[i]= cls->superClass->vtable[i];
+	
+	for( i= 0; i < cls->methods_count; i++ )
+	{
+		method_info* method= cls->methods[i];
+		
+		if( !isVirtualMethod(method) )
+			continue;
+		
+		/* Does this method override one of the super class? Then it takes over its index. */
+		int j;
+		for( j= 0; j < superLength; j++ )
+		{
+			method_info* superMethod= cls->vtable[j];
+			if( superMethod->name == method->name && superMethod->descriptor == method->descriptor )
+			{
+				method->vtableIndex= j;
+				break;
+			}
+		}
+		
+		/* Otherwise, append a new entry. */
+		if( method->vtableIndex == NO_VTABLE_INDEX )
+			method->vtableIndex= cls->vtable_length++;
+		
+		cls->vtable[method->vtableIndex]= method;
+	}
+	
+	logVerbose( "Created vtable with %i entries (%i inherited).\n", cls->vtable_length, superLength );
+}
+
+/* All loaded interfaces, indexed by their interfaceId. Every interface gets the next free interfaceId when it is loaded. */
+Class** interfaceList= NULL;
+u2 interfaceCount= 0;
+u2 maxInterfaceListEntries= 0;
+
+void registerInterface( Class* interf )
+{
+	if( interfaceCount == maxInterfaceListEntries )
+	{
+		if( interfaceList == NULL )
+		{
+			maxInterfaceListEntries= INITIAL_NUMBER_OF_POSSIBLE_INTERFACES;
+			interfaceList= mm_staticMalloc( maxInterfaceListEntries * sizeof(Class*) );
+		}
+		else
+		{
+			maxInterfaceListEntries*= 2;
+			interfaceList= mm_staticReAlloc( interfaceList, maxInterfaceListEntries * sizeof(Class*) );
+			
+			if( interfaceList == NULL )
+				error( "Memory Reallocation Error!" );
+		}
+	}
+	
+	interf->interfaceId= interfaceCount++;
+	interfaceList[interf->interfaceId]= interf;
+}
+
+/* Creates the itable entry of the given class for the given interface and all of its super interfaces. The implementations are looked up once here, so that
+	INVOKEINTERFACE does not have to search for them by name. */
+void addInterfaceToItable( Class* cls, Class* interf )
+{
+	if( cls->itable[interf->interfaceId] != NULL )
+		return;
+	
+	/* Index the table by the method's position in the interface's method list. (Entries of static initializers stay unused.) Abstract classes may leave
+		interface methods unimplemented, these entries are NULL. */
+	method_info** table= mm_staticMalloc( (interf->methods_count + 1) * sizeof(method_info*) );
+	
+	int i;
+	for( i= 0; i < interf->methods_count; i++ )
+	{
+		Class* implementationClass= cls;
+		table[i]= cls_resolveMethod( &implementationClass, interf->methods[i]->name, interf->methods[i]->descriptor );
+	}
+	
+	cls->itable[interf->interfaceId]= table;
+	
+	/* super interfaces */
+	for( i= 0; i < interf->interfaces_count; i++ )
+		addInterfaceToItable( cls, cls_resolveConstantPoolIndexToClass(interf, interf->interfaces[i]) );
+}
+
+/* Assigns an interfaceId to interfaces, or builds the itable of normal classes from the interfaces of the class and of its super classes. This loads all 
+	implemented interfaces. Must be called after buildVtable(). */
+void buildItable( Class* cls )
+{
+	int i;
+	
+	cls->itable_length= 0;
+	cls->itable= NULL;
+	
+	/* make sure the interfaces are loaded, so that they have got their ids */
+	for( i= 0; i < cls->interfaces_count; i++ )
+		cls_resolveConstantPoolIndexToClass( cls, cls->interfaces[i] );
+	
+	if( isFlagSet(cls->access_flags, ACC_INTERFACE) )
+	{
+		registerInterface( cls );
+		return;
+	}
+
+	/* Nothing to do for classes without any interfaces. */
+	u2 superLength= (cls->superClass != NULL) ? cls->superClass->itable_length : 0;
+	if( superLength == 0 && cls->interfaces_count == 0 )
+		return;
+	
+	cls->itable_length= interfaceCount;
+	cls->itable= mm_staticMalloc( cls->itable_length * sizeof(method_info**) );
+	
+	for( i= 0; i < cls->itable_length; i++ )
+		cls->itable[i]= NULL;
+
+	/* own interfaces */
+	for( i= 0; i < cls->interfaces_count; i++ )
+		addInterfaceToItable( cls, cls_resolveConstantPoolIndexToClass(cls, cls->interfaces[i]) );
+	
+	/* Interfaces of the super classes. The implementations have to be looked up again, as this class may override some of them. */
+	for( i= 0; i < superLength; i++ )
+	{
+		if( cls->superClass->itable[i] != NULL )
+			addInterfaceToItable( cls, interfaceList[i] );
+	}
+	
+	logVerbose( "Created itable with %i entries.\n", cls->itable_length );
+}
+
+/* Tries to recursively resolve the given method, starting at class cls and going up through the hierarchy of super classes. Name and descriptor have to be 
+	interned (see symbolTable.h), as they are compared by their pointers. The same applies to all of the following lookup functions. */
 method_info* cls_resolveMethod( Class** cls, const char* name, const char* descriptor )
 {
 	int i;
@@ -664,7 +878,7 @@ method_info* cls_resolveMethod( Class** cls, const char* name, const char* descr
 	{
 		method_info* currentMethod= (*cls)->methods[i];
 		
-		if( strcmp(currentMethod->name, name) == 0 && strcmp(currentMethod->descriptor, descriptor) == 0 )
+		if( currentMethod->name == name && currentMethod->descriptor == descriptor )
 			return currentMethod;
 	}
 	
@@ -685,7 +899,7 @@ method_info* cls_getMethod( Class* cls, const char* name, const char* descriptor
 	{
 		method_info* currentMethod= cls->methods[i];
 	
-		if( strcmp(currentMethod->name, name) == 0 && strcmp(currentMethod->descriptor, descriptor) == 0 )
+		if( currentMethod->name == name && currentMethod->descriptor == descriptor )
 			return currentMethod;
 	}
 	
@@ -700,7 +914,7 @@ variable* cls_resolveStaticField( Class** cls, const char* name, const char* des
 	{
 		variable* currentVar= (*cls)->class_instance_variable_table[i];
 		
-		if( strcmp(currentVar->name, name) == 0 && strcmp(currentVar->descriptor, descriptor) == 0 )
+		if( currentVar->name == name && currentVar->descriptor == descriptor )
 			return currentVar;
 	}
 	
@@ -721,7 +935,7 @@ variable* cls_resolveField( Class** cls, const char* name, const char* descripto
 	{
 		variable* currentVar= (*cls)->instance_variable_table[i];
 		
-		if( strcmp(currentVar->name, name) == 0 && strcmp(currentVar->descriptor, descriptor) == 0 )
+		if( currentVar->name == name && currentVar->descriptor == descriptor )
 			return currentVar;
 	}
 	
@@ -780,6 +994,7 @@ void cls_resolveConstantPoolIndexToClassAndMethodInfo( Class* cls, uint16 index,
 			error( "Execution haltet." );
 		}
 		
+		constMethodInfo->vtableIndex= constMethodInfo->methodInfo->vtableIndex;
 		logVerbose( "\tMethod resolved.\n" );
 	}
 	
@@ -824,9 +1039,13 @@ void cls_resolveConstantPoolIndexToClassAndInterfaceMethodInfo( Class* cls, uint
 		logVerbose( "\tInterface resolved.\n" );
 	}
 	
-	/* Okay, we verified the existence of the interface and its method, look for an appropriate implementation now, starting with the class of objref,
-		method call (objRefClass), that has been passed by the caller. */
-	*methodInfo= cls_resolveMethod( objRefClass, constInterfaceMethodInfo->methodInfo->name, constInterfaceMethodInfo->methodInfo->descriptor );	
+	/* Okay, we verified the existence of the interface and its method, take the implementation from the itable of the class of objref (objRefClass), that
+		has been passed by the caller. */
+	*methodInfo= cls_getInterfaceMethodImplementation( *objRefClass, constInterfaceMethodInfo->methodInfo );
+	
+	if( *methodInfo != NULL )
+		*objRefClass= (*methodInfo)->declaringClass;
+	
 	return;
 }
 
@@ -882,30 +1101,25 @@ void cls_resolveConstantPoolIndexToClassAndVariableInfo( Class* cls, uint16 inde
 	return;
 }
 
-/* Recursively determines if the given class or its super classes implement the given interface. */
+/* Determines if the given class or its super classes implement the given interface, i.e. if the class has got an itable entry for it. */
 boolean cls_implementsInterface( Class* cls, Class* interf )
 {
-	uint16 index;
-	Class* possibleInterf;
-	int i;
-	for( i= 0; i < cls->interfaces_count; i++ )
-	{
-		index= cls->interfaces[i];
-		possibleInterf= cls_resolveConstantPoolIndexToClass( cls, index );
-		
-		if( possibleInterf == interf )
-			return true;
-		
-		boolean rekRes= cls_implementsInterface( possibleInterf, interf );
-		
-		if( rekRes )
-			return true;
-	}
+	return interf->interfaceId < cls->itable_length && cls->itable[interf->interfaceId] != NULL;
+}
+
+/* Returns the implementation of the given interface method in the given class, or NULL if the class does not implement it. */
+method_info* cls_getInterfaceMethodImplementation( Class* cls, method_info* interfaceMethod )
+{
+	Class* interf= interfaceMethod->declaringClass;
 	
-	if( cls->superClass == NULL )
-		return false;
+	/* Methods of java.lang.Object may be called via an interface, too. */
+	if( !isFlagSet(interf->access_flags, ACC_INTERFACE) )
+		return (interfaceMethod->vtableIndex != NO_VTABLE_INDEX) ? cls->vtable[interfaceMethod->vtableIndex] : interfaceMethod;
+	
+	if( !cls_implementsInterface(cls, interf) )
+		return NULL;
 	
-	return cls_implementsInterface( cls->superClass, interf );	
+	return cls->itable[interf->interfaceId][interfaceMethod->itableIndex];
 }
 
 /**********************************************************************************************
@@ -914,26 +1128,35 @@ boolean cls_implementsInterface( Class* cls, Class* interf )
 
 void cls_initArrayClass( Class* cls, const char* type )
 {
-	char* typeCopy= mm_staticMalloc( strlen(type)+1 );
-	strcpy( typeCopy, type );
-	
 	cls->access_flags= ACC_FINAL|ACC_PUBLIC;
 	cls->class_inctance_variable_slots= 0;
 	cls->class_instance_variable_count= 0;
 	cls->class_instance_variable_slot_count= 0;
 	cls->class_instance_variable_table= NULL;
-	cls->className= typeCopy;
+	cls->className= sym_intern( type );
 	cls->constant_pool= NULL;
 	cls->constant_pool_count= 0;
 	cls->instance_variable_count= 0;
 	cls->instance_variable_slot_count= 0;
 	cls->instance_variable_table= NULL;
+	cls->reference_slot_count= 0;
+	cls->reference_slots= NULL;
 	cls->interfaces= NULL;
 	cls->interfaces_count= 0;
 	cls->isInitialized= false;
+	cls->isBeingInitialized= false;
+	cls->initializingThread= NULL;
+	pthread_cond_init( &cls->initializationFinished, NULL );
+	cls->lockWord= 0;
 	cls->methods= NULL;
 	cls->methods_count= 0;
 	cls->superClass= ma_getClass( "java/lang/Object" );
+	
+	/* Arrays don't have any methods of their own, so they simply share the vtable of java.lang.Object. */
+	cls->vtable= cls->superClass->vtable;
+	cls->vtable_length= cls->superClass->vtable_length;
+	cls->itable= NULL;
+	cls->itable_length= 0;
 	cls->sourceFileName= NULL;
 }
 
@@ -991,6 +1214,8 @@ void cls_load( Class* cls, ClassLoaderState* cl )
 	
 	/* methods */
 	readMethods( cls, cl );
+	buildVtable( cls );
+	buildItable( cls );
 	
 	/* unrelated attributes */
 	cls->sourceFileName= NULL;
@@ -1019,5 +1244,9 @@ void cls_load( Class* cls, ClassLoaderState* cl )
 	
 	/* mark that initialization is still pending */
 	cls->isInitialized= false;
+	cls->isBeingInitialized= false;
+	cls->initializingThread= NULL;
+	pthread_cond_init( &cls->initializationFinished, NULL );
+	cls->lockWord= 0;
 	logVerbose( "Done parsing class data.\n" );
 }
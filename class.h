@@ -11,6 +11,7 @@
 #ifndef _class_h_
 #define _class_h_
 
+#include <pthread.h>
 #include "fileClassLoader.h"
 
 /* class constants */
@@ -36,6 +37,7 @@
 #define ACC_STATIC		0x0008
 #define ACC_FINAL			0x0010
 #define ACC_SUPER			0x0020
+#define ACC_SYNCHRONIZED	0x0020
 #define ACC_VOLATILE		0x0040
 #define ACC_TRANSIENT	0x0080
 #define ACC_NATIVE		0x0100
@@ -55,6 +57,11 @@
 #define BASE_TYPE_BOOLEAN   'Z'
 #define BASE_TYPE_ONE_ARRAY_DIMENSION '['
 
+/* vtable index of methods which are never dispatched virtually (static and private methods, initializers) */
+#define NO_VTABLE_INDEX 0xFFFF
+
+#define INITIAL_NUMBER_OF_POSSIBLE_INTERFACES 16
+
 /* umbrella struct for constant pool entries */
 typedef struct scp_info
 {
@@ -99,8 +106,17 @@ typedef struct sCode_attribute
 	exception_table** exception_table_tab;
 	u2 attributes_count;
 	attribute_info* attributes;
+	u2 inline_cache_count; /* rt info, see inlineCache.h */
+	struct sInlineCache* inlineCaches;
 } Code_attribute;
 
+struct sClass;
+struct sStack;
+struct sStack_frame;
+
+/* Implementation of a native method, see native.c. Returns the number of slots that have been pushed onto the stack as return value. */
+typedef int (*NativeFunction)( struct sClass* cls, int parameterSlotCount, slot* parameters, struct sStack* stack );
+
 typedef struct smethod_info
 {
 	u2 access_flags;
@@ -112,6 +128,23 @@ typedef struct smethod_info
 	uint8 parameterSlotCount; /* rt info */
 	char* name;
 	char* descriptor;
+	struct sClass* declaringClass; /* rt info */
+	u2 vtableIndex; /* rt info, NO_VTABLE_INDEX for non virtual methods */
+	u2 itableIndex; /* rt info, only for methods of interfaces: index into the itable entry of the interface */
+	NativeFunction nativeFunction; /* rt info, only for native methods: bound when the class is loaded, NULL if there is no implementation */
+	boolean hasReferenceMaps; /* rt info, false if the stack frames of this method have to be scanned conservatively */
+	u2 reference_map_count; /* rt info, see referenceMap.h */
+	struct sReferenceMap* referenceMaps;
+	uint32 invocationCount; /* rt info, counters of the mixed mode, see jit.c */
+	uint32 backwardBranchCount; /* rt info */
+	uint8 compilationCount; /* rt info */
+	struct sCompiledMethod* compiledMethod; /* rt info, NULL as long as the method is interpreted */
+	uint8 optimizationCount; /* rt info, see optimizingCompiler.c */
+	struct sOptimizedMethod* optimizedMethod; /* rt info, NULL as long as the method isn't optimized */
+	uint8 loopOptimizationCount; /* rt info, see optimizingCompiler.c */
+	struct sOptimizedMethod* loopOptimizedMethods; /* rt info, optimized machine code entered at loop headers (on-stack replacement) */
+	boolean (*aotCode)( struct sStack* stack, struct sStack_frame* sf, boolean isSwitchingAllowed ); /* rt info, NULL unless compiled ahead of time (see aot.c) */
+	struct sRegisterCode* registerCode; /* rt info, NULL unless translated into register code (see registerInterpreter.c) */
 } method_info;
 
 typedef struct sclasses
@@ -144,6 +177,7 @@ typedef struct sCONSTANT_Class_info
 	u1 tag;
 	u2 name_index;
 	struct sClass* class; /* rt info */
+	struct sClass* arrayClass; /* rt info, array class with this component type (used by ANEWARRAY) */
 } CONSTANT_Class_info;
 
 typedef struct sCONSTANT_Fieldref_info
@@ -162,6 +196,7 @@ typedef struct sCONSTANT_Methodref_info
 	u2 name_and_type_index;
 	struct sClass* class; /* resolved symbolic references */
 	method_info* methodInfo;
+	u2 vtableIndex; /* vtable index of the resolved method */
 } CONSTANT_Methodref_info;
 
 typedef struct sCONSTANT_InterfaceMethodref_info
@@ -317,6 +352,16 @@ typedef struct sClass
 	u2 methods_count;
 	method_info** methods;
 	
+	/* virtual method table: inherited methods keep the index of the super class' vtable, overriding methods replace the according entry */
+	u2 vtable_length;
+	method_info** vtable;
+	
+	/* interface method table: for every interface (indexed by its interfaceId) that is implemented by this class, a table with the implementations of the 
+		interface's methods (indexed by their itableIndex); NULL for all other interfaces */
+	u2 itable_length;
+	method_info*** itable;
+	u2 interfaceId; /* only for interfaces */
+	
 	/* additional runtime data */
 	u2 class_instance_variable_count;
 	variable** class_instance_variable_table;
@@ -327,8 +372,17 @@ typedef struct sClass
 	u2 instance_variable_count;
 	variable** instance_variable_table;
 	u2 instance_variable_slot_count;
-
-	boolean isInitialized;
+	
+	/* indices of all instance slots (including the ones of the super classes) which hold references, used by the garbage collector */
+	u2 reference_slot_count;
+	u2* reference_slots;
+
+	/* initialization state, see thread_beginClassInitialization() */
+	volatile boolean isInitialized;
+	boolean isBeingInitialized; /* set while the class initializer runs */
+	struct sJavaThread* initializingThread; /* the thread which runs the class initializer */
+	pthread_cond_t initializationFinished;
+	volatile uint32 lockWord; /* lock word of the monitor of the class, which is used by static synchronized methods (see monitor.c) */
 	const char* className;
 	struct sClass* superClass;
 	const char* sourceFileName;
@@ -355,6 +409,7 @@ void cls_resolveConstantPoolIndexToClassAndVariableInfo( Class* cls, uint16 inde
 void cls_resolveConstantPoolIndexOfMethodRefToMethodNameAndDescriptor( Class* cls, uint16 index, char** className, char** methodName, char** methodDescriptor );
 
 boolean cls_implementsInterface( Class* cls, Class* interf );
+method_info* cls_getInterfaceMethodImplementation( Class* cls, method_info* interfaceMethod );
 
 boolean isFlagSet( u2 flags, u2 flag );
 
@@ -13,6 +13,7 @@
 #include "memoryManager.h"
 #include "puraGlobals.h"
 #include "fileClassLoader.h"
+#include "aot.h"
 
 #define STR_CLASSPATH_DELIMITERS ":;"
 
@@ -91,26 +92,66 @@ FILE* findClassInClasspath( const char* className )
 		logVerbose( "Not Found.\n" );
 	}
 	
-	error( "Could not find class!" );
-	return NULL; /* shut up compiler */
+	return NULL;
+}
+
+/* Converts the given class name into the name of its class file, without the ".class" file extension. */
+void getClassFileName( const char* className, char* classFileName )
+{
+	if( strlen(className) > 255-6 )
+		error( "Name of the main class is too long!\n" );
+		
+	strcpy( classFileName, className );
+	replaceDots( classFileName );
+}
+
+/* Checks if the class with the given name can be loaded, without loading it. */
+boolean cl_isClassAvailable( const char* className )
+{
+	char classNameWithExtension[256];
+	getClassFileName( className, classNameWithExtension );
+	
+	if( aot_findClassFile(classNameWithExtension) != NULL )
+		return true;
+	
+	strcat( classNameWithExtension, ".class" );
+	FILE* f= findClassInClasspath( classNameWithExtension );
+	
+	if( f == NULL )
+		return false;
+	
+	fclose( f );
+	return true;
 }
 
 void cl_init( ClassLoaderState* state, const char* className )
 {
 	logVerbose( "file class loader is loading class %s\n", className );
 
-	/* append ".class" file extension */
 	char classNameWithExtension[256];
+	getClassFileName( className, classNameWithExtension );
 	
-	if( strlen(className) > 255-6 )
-		error( "Name of the main class is too long!\n" );
-		
-	strcpy( classNameWithExtension, className );
-	replaceDots( classNameWithExtension );
+	/* An executable built by the ahead-of-time compiler contains the class files of its program (see aot.c). */
+	AotClassFile* classFile= aot_findClassFile( classNameWithExtension );
+	
+	if( classFile != NULL )
+	{
+		logVerbose( "Found embedded class file.\n" );
+		state->size= classFile->size;
+		state->data= (byte*)mm_staticMalloc( state->size );
+		state->currentPosition= state->data;
+		memcpy( state->data, classFile->data, state->size );
+		return;
+	}
+	
+	/* append ".class" file extension */
 	strcat( classNameWithExtension, ".class" );	
 
 	/* find the class file within the classpath and open it*/
 	FILE* f= findClassInClasspath( classNameWithExtension );
+	
+	if( f == NULL )
+		error( "Could not find class!" );
 		
 	/* get file size */
 	fseek( f, 0, SEEK_END );
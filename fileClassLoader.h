@@ -19,6 +19,7 @@ typedef struct sFileClassLoaderState
 } ClassLoaderState;
 
 void cl_init( ClassLoaderState* state, const char* className );
+boolean cl_isClassAvailable( const char* className );
 void cl_free( ClassLoaderState* state );
 
 void cl_readBytes( ClassLoaderState* state, int numBytes, byte* data );
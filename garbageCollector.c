@@ -0,0 +1,372 @@
+/*
+ *  garbageCollector.c
+ *  Stop-the-world generational garbage collector for the Java Heap. New instances are allocated in the nursery (see heap.c), which is emptied by a minor 
+ *  collection whenever it runs full: the live young instances are copied to the old generation. The old generation is collected by a full mark and compact
+ *  collection, which also empties the nursery.
+ *  The roots are the slots of all stack frames of all threads (locals and operand stacks), the java.lang.Thread instances of the running threads, the static
+ *  variables of all loaded classes and the String instances of resolved CONSTANT_String entries. Stack frames are scanned precisely, using the reference map
+ *  of the safe point where the frame is suspended (see referenceMap.c). Only the initial frame and the frames of methods without reference maps are scanned
+ *  conservatively, i.e. every slot that looks like a valid reference is treated as one. Instances and arrays are scanned precisely.
+ *  A minor collection only marks young instances. Old instances are considered to be alive, and the ones which may refer to young instances are taken from the
+ *  remembered set, which is maintained by the write barrier of the heap. Static variables are roots, so storing into them doesn't need a write barrier.
+ *  A collection may only be started when all live references are stored in one of the roots, i.e. not while native code holds references in C variables. That's 
+ *  why the interpreter checks for a necessary collection at the beginning of the allocating instructions only. Before, it has to store the pc of the instruction
+ *  in the current frame, so that the according reference map can be found. All other threads are stopped at such a point or in a blocking region (see thread.c)
+ *  while the collector runs.
+ *
+ *  Copyright (c) 2006, 2007 Daniel Klein. All rights reserved.
+ *  
+ *  Licensed under GPL version 2.
+ *  See here for the full license: http://www.gnu.org/licenses/gpl.html
+ */
+
+#include <stdio.h>
+#include <sys/time.h>
+#include "puraGlobals.h"
+#include "memoryManager.h"
+#include "methodArea.h"
+#include "class.h"
+#include "heap.h"
+#include "stack.h"
+#include "referenceMap.h"
+#include "thread.h"
+#include "garbageCollector.h"
+
+boolean gcStatsEnabled= false;
+
+/* A collection is started as soon as the heap memory usage exceeds this threshold. After each collection, it is set to twice the size of the live objects. */
+uint32 gcThreshold= INITIAL_GC_THRESHOLD;
+
+/* References of marked instances whose references haven't been marked yet. */
+reference* markStack= NULL;
+uint32 markStackSize= 0;
+uint32 markStackCount= 0;
+
+/* If set, only young instances are marked. */
+boolean isMinorCollection= false;
+
+/* statistics */
+uint32 numberOfMinorCollections= 0;
+uint64 totalBytesPromoted= 0;
+uint32 numberOfCollections= 0;
+uint32 totalObjectsFreed= 0;
+uint64 totalBytesReclaimed= 0;
+uint64 totalPauseTime= 0; /* in microseconds */
+uint32 maxPauseTime= 0;
+uint32 timeToSafePoint= 0; /* of the current collection */
+uint64 totalTimeToSafePoint= 0;
+uint32 maxTimeToSafePoint= 0;
+
+/* Marks the instance behind the given reference and remembers it for scanning its own references, if it hasn't been marked before. */
+void markReference( reference ref )
+{
+	Object* object= objectPointerList[ref];
+	
+	if( object->gcMarker || (isMinorCollection && !heap_isYoung(object)) )
+		return;
+	
+	object->gcMarker= true;
+	
+	if( markStackCount == markStackSize )
+	{
+		markStackSize*= 2;
+		markStack= mm_staticReAlloc( markStack, sizeof(reference) * markStackSize );
+		
+		if( markStack == NULL )
+			error( "Memory Reallocation Error!" );
+	}
+	
+	markStack[markStackCount]= ref;
+	markStackCount++;
+}
+
+/* Marks the given value, if it is a reference to a live instance. Used for all values whose type is unknown. */
+void markPossibleReference( slot value )
+{
+	if( value != NULL_REFERENCE && value < objectPointerListEntryCount && objectPointerList[value] != NULL )
+		markReference( value );
+}
+
+/* Marks all instances referenced by the given instance. */
+void scanInstance( reference ref )
+{
+	Object* object= objectPointerList[ref];
+	Class* cls= object->cls;
+	
+	if( *cls->className == BASE_TYPE_ONE_ARRAY_DIMENSION )
+	{
+		/* arrays of objects or arrays */
+		if( cls->className[1] == BASE_TYPE_REFERENCE || cls->className[1] == BASE_TYPE_ONE_ARRAY_DIMENSION )
+		{
+			slot* arrayCount= (slot*)(object+1);
+			slot* elements= arrayCount+1;
+			
+			uint32 i;
+			for( i= 0; i < *arrayCount; i++ )
+				if( elements[i] != NULL_REFERENCE )
+					markReference( elements[i] );
+		}
+		
+		return;
+	}
+	
+	slot* slots= (slot*)(object+1);
+	
+	int i;
+	for( i= 0; i < cls->reference_slot_count; i++ )
+	{
+		reference value= slots[cls->reference_slots[i]];
+		
+		if( value != NULL_REFERENCE )
+			markReference( value );
+	}
+}
+
+/* Marks all references in the locals and operand stack of the given frame, which end at the given slot. */
+void markFrameRoots( StackFrame* sf, slot* end )
+{
+	slot* slots= (slot*)(sf+1);
+	method_info* method= sf->methodInfo;
+	
+	/* The monitor of a synchronized method is exited on return, even if the instance isn't referenced by a local variable anymore. */
+	if( sf->lockedObject != NULL_REFERENCE )
+		markReference( sf->lockedObject );
+	
+	if( method == NULL || !method->hasReferenceMaps )
+	{
+		slot* current;
+		for( current= slots; current < end; current++ )
+			markPossibleReference( *current );
+		
+		return;
+	}
+	
+	ReferenceMap* map= rm_getReferenceMap( method, sf->pc - method->code->code );
+	
+	if( map == NULL )
+		error( "No reference map found for the current pc of a stack frame!" );
+	
+	/* The top slots of the operand stack of a frame that invoked a method (i.e. its parameters) belong to the frame of the invoked method already, and the 
+		return value hasn't been pushed yet. */
+	uint32 slotCount= method->code->max_locals + map->stackHeight;
+	
+	if( slots + slotCount > end )
+		slotCount= end - slots;
+	
+	uint32 i;
+	for( i= 0; i < slotCount; i++ )
+		if( rm_isReference(map, i) && slots[i] != NULL_REFERENCE )
+			markReference( slots[i] );
+}
+
+/* Marks all references of all stack frames, from the top of the stack down to the initial stack frame. */
+void markStackRoots( Stack* stack )
+{
+	slot* end= stack->stackPointer;
+	StackFrame* sf;
+	
+	for( sf= stack->currentFrame; sf != NULL; sf= sf->prevStackFrame )
+	{
+		markFrameRoots( sf, end );
+		
+		/* The operand stack of the previous frame ends where this frame starts. */
+		end= (slot*)sf;
+	}
+}
+
+/* Marks the static reference variables and the String constants of all loaded classes. */
+void markClassRoots()
+{
+	uint32 i;
+	for( i= 0; i < classTableSize; i++ )
+	{
+		Class* cls= classTable[i];
+		
+		if( cls == NULL )
+			continue;
+		
+		/* Static variables are scanned like stack slots, as they are not initialized before the class initialization. */
+		int j;
+		for( j= 0; j < cls->class_instance_variable_count; j++ )
+		{
+			variable* var= cls->class_instance_variable_table[j];
+			
+			if( *var->descriptor == BASE_TYPE_REFERENCE || *var->descriptor == BASE_TYPE_ONE_ARRAY_DIMENSION )
+				markPossibleReference( cls->class_inctance_variable_slots[var->slot_index] );
+		}
+		
+		for( j= 1; j < cls->constant_pool_count; j++ )
+		{
+			cp_info* cpEntry= cls->constant_pool[j];
+			
+			if( cpEntry != NULL && cpEntry->tag == CONSTANT_String && ((CONSTANT_String_info*)cpEntry)->stringRef != NULL_REFERENCE )
+				markReference( ((CONSTANT_String_info*)cpEntry)->stringRef );
+		}
+	}
+}
+
+/* Marks the stack roots and the java.lang.Thread instances of all threads. */
+void markThreadRoots()
+{
+	JavaThread* thread;
+	for( thread= threads; thread != NULL; thread= thread->next )
+	{
+		markStackRoots( thread->stack );
+		
+		if( thread->threadObject != NULL_REFERENCE )
+			markReference( thread->threadObject );
+	}
+}
+
+/* Marks all instances reachable from the roots (and from the remembered set for minor collections). */
+void mark()
+{
+	if( markStack == NULL )
+	{
+		markStackSize= INITIAL_MARK_STACK_SIZE;
+		markStack= mm_staticMalloc( sizeof(reference) * markStackSize );
+	}
+	
+	markThreadRoots();
+	markClassRoots();
+	
+	if( isMinorCollection )
+	{
+		uint32 i;
+		for( i= 0; i < rememberedSetCount; i++ )
+			scanInstance( rememberedSet[i] );
+	}
+	
+	while( markStackCount > 0 )
+	{
+		markStackCount--;
+		scanInstance( markStack[markStackCount] );
+	}
+}
+
+/* Returns the time in microseconds that has passed since the given start time. */
+uint32 getElapsedTime( struct timeval* startTime )
+{
+	struct timeval endTime;
+	gettimeofday( &endTime, NULL );
+	return (endTime.tv_sec - startTime->tv_sec)*1000000 + (endTime.tv_usec - startTime->tv_usec);
+}
+
+/* Adds the pause time and the time to safe point of the current collection to the statistics. */
+void addPauseTime( uint32 pauseTime )
+{
+	totalPauseTime+= pauseTime;
+	totalTimeToSafePoint+= timeToSafePoint;
+	
+	if( pauseTime > maxPauseTime )
+		maxPauseTime= pauseTime;
+	
+	if( timeToSafePoint > maxTimeToSafePoint )
+		maxTimeToSafePoint= timeToSafePoint;
+}
+
+/* A full collection empties the nursery, too. The old generation must always be able to take all instances of the nursery. */
+boolean isFullCollectionNecessary()
+{
+	return heap_getOldGenerationUsage() > gcThreshold || heap_getFreeOldGenerationSize() < NURSERY_SIZE;
+}
+
+boolean isMinorCollectionNecessary()
+{
+	return heap_getFreeNurserySize() < MAX_YOUNG_INSTANCE_SIZE;
+}
+
+/* Starts a full collection if the memory usage of the old generation has exceeded the threshold, or a minor collection if the nursery is (almost) full. Must
+	be called at a safe point, as other threads may have stopped the world. */
+void gc_collectIfNecessary()
+{
+	if( !isFullCollectionNecessary() && !isMinorCollectionNecessary() )
+	{
+		thread_pollSafePoint();
+		return;
+	}
+	
+	timeToSafePoint= thread_stopTheWorld();
+	
+	/* Another thread may have collected while this one was waiting. */
+	if( isFullCollectionNecessary() )
+		gc_collect();
+	else if( isMinorCollectionNecessary() )
+		gc_collectYoung();
+	
+	thread_resumeTheWorld();
+}
+
+/* Minor collection: copies all live young instances to the old generation and empties the nursery. */
+void gc_collectYoung()
+{
+	struct timeval startTime;
+	gettimeofday( &startTime, NULL );
+	
+	uint32 nurseryUsage= NURSERY_SIZE - heap_getFreeNurserySize();
+	logVerbose( "Starting minor garbage collection, nursery usage is %i bytes, %i remembered instances.\n", nurseryUsage, rememberedSetCount );
+	
+	isMinorCollection= true;
+	mark();
+	isMinorCollection= false;
+	
+	uint32 promoted= heap_evacuateNursery();
+	uint32 pauseTime= getElapsedTime( &startTime );
+	
+	numberOfMinorCollections++;
+	totalBytesPromoted+= promoted;
+	addPauseTime( pauseTime );
+	
+	logVerbose( "Minor garbage collection finished, %i bytes promoted.\n", promoted );
+	
+	if( gcStatsEnabled )
+		printf( "[GC (minor) #%i: %i bytes reclaimed, %i bytes promoted, pause %.3f ms, time to safe point %.3f ms]\n", numberOfMinorCollections, nurseryUsage - promoted, promoted,
+			pauseTime/1000.0, timeToSafePoint/1000.0 );
+}
+
+/* Full collection: mark and compact of the old generation, the live young instances are copied to the old generation afterwards. */
+void gc_collect()
+{
+	struct timeval startTime;
+	gettimeofday( &startTime, NULL );
+	
+	uint32 usageBefore= heap_getOldGenerationUsage();
+	logVerbose( "Starting garbage collection, heap memory usage is %i bytes.\n", usageBefore );
+	
+	mark();
+	
+	/* compaction phase */
+	uint32 freed= heap_compactOldGeneration();
+	uint32 usageAfter= heap_getOldGenerationUsage();
+	uint32 promoted= heap_evacuateNursery();
+	gcThreshold= usageAfter*2 > INITIAL_GC_THRESHOLD ? usageAfter*2 : INITIAL_GC_THRESHOLD;
+	
+	uint32 pauseTime= getElapsedTime( &startTime );
+	
+	numberOfCollections++;
+	totalBytesPromoted+= promoted;
+	totalObjectsFreed+= freed;
+	totalBytesReclaimed+= usageBefore - usageAfter;
+	addPauseTime( pauseTime );
+	
+	logVerbose( "Garbage collection finished, %i instances freed, heap memory usage is %i bytes.\n", freed, usageAfter );
+	
+	if( gcStatsEnabled )
+		printf( "[GC #%i: %i instances freed, %i bytes reclaimed, %i bytes live, pause %.3f ms, time to safe point %.3f ms]\n", numberOfCollections, freed, usageBefore - usageAfter,
+			usageAfter, pauseTime/1000.0, timeToSafePoint/1000.0 );
+}
+
+void gc_printStatistics()
+{
+	if( !gcStatsEnabled )
+		return;
+	
+	printf( "\nGarbage Collector Statistics:\n" );
+	printf( "Minor collections: %i\n", numberOfMinorCollections );
+	printf( "Full collections: %i\n", numberOfCollections );
+	printf( "Bytes promoted: %lli\n", totalBytesPromoted );
+	printf( "Old instances freed: %i\n", totalObjectsFreed );
+	printf( "Old bytes reclaimed: %lli\n", totalBytesReclaimed );
+	printf( "Total pause time: %.3f ms (max. %.3f ms)\n", totalPauseTime/1000.0, maxPauseTime/1000.0 );
+	printf( "Total time to safe point: %.3f ms (max. %.3f ms)\n", totalTimeToSafePoint/1000.0, maxTimeToSafePoint/1000.0 );
+}
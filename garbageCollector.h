@@ -0,0 +1,30 @@
+/*
+ *  garbageCollector.h
+ *  Stop-the-world generational garbage collector for the Java Heap.
+ *
+ *  Copyright (c) 2006, 2007 Daniel Klein. All rights reserved.
+ *  
+ *  Licensed under GPL version 2.
+ *  See here for the full license: http://www.gnu.org/licenses/gpl.html
+ */
+
+#ifndef _garbageCollector_h_
+#define _garbageCollector_h_
+
+#include "types.h"
+#include "stack.h"
+
+/* amount of heap memory (in bytes) that may be in use before the first collection is started */
+#define INITIAL_GC_THRESHOLD (1024*1024)
+
+/* initial size of the mark stack, it is doubled whenever it is full */
+#define INITIAL_MARK_STACK_SIZE 1024
+
+extern boolean gcStatsEnabled;
+
+void gc_collectIfNecessary();
+void gc_collectYoung();
+void gc_collect();
+void gc_printStatistics();
+
+#endif /*_garbageCollector_h_*/
@@ -14,230 +14,505 @@
 #include "class.h"
 #include "memoryManager.h"
 #include "interpreter.h"
+#include "symbolTable.h"
 #include "heap.h"
+#include "monitor.h"
 
 /* Stores the pointers to instances (object or array). References are realized as indices into this list.
-   The size of the list is doubled if a new instance is created and no free entry is left.
-   Note, that due to the (yet) missing garbage collector entries will never be freed up. */
+   The list is reserved in one piece of virtual memory with room for MAX_NUMBER_OF_REFERENCES entries, and it grows by handing out segments of 
+   REFERENCE_BUFFER_SIZE entries to the allocation buffers of the threads (the pages are only used as soon as they are touched). So entries never move and other 
+   threads may read the list while it grows.
+   Entries of instances that have been freed by the garbage collector are NULL and are kept in the free reference list for reuse. */
 Object** objectPointerList;
-uint32 maxObjectPointerListEntries= INITIAL_NUMBER_OF_POSSIBLE_REFERENCES;
 uint32 objectPointerListEntryCount= 1; /* never use 0, it's used as NULL_REFERENCE */
 
-/* Double the size of the pointer list. */
-void increasePointerList()
-{
-	logVerbose( "Starting reallocation...\n" );
+/* Free entries of the object pointer list, used as a stack. It has the same size as the object pointer list, so it can never overflow. References are only
+	pushed by the garbage collector, while all other threads are stopped. */
+reference* freeReferenceList;
+uint32 freeReferenceCount= 0;
+
+/* allocation buffer of the current thread and list of the buffers of all threads */
+THREAD_LOCAL AllocationBuffer* currentAllocationBuffer;
+AllocationBuffer* allocationBuffers= NULL;
+
+/* Protects the rarely used paths of the heap, i.e. allocation in the old generation, the remembered set and the list of allocation buffers. */
+volatile int heapLock= 0;
+#define lockHeap() while( __sync_lock_test_and_set(&heapLock, 1) ) while( heapLock )
+#define unlockHeap() __sync_lock_release( &heapLock )
+
+/* The nursery (young generation) is one contiguous block of memory, where new instances are allocated by simply increasing nurseryTop. The instances that survive
+	a minor collection are copied to the old generation and the nursery is emptied again. As instances are only accessed via the object pointer list, no 
+	references have to be adjusted when an instance is moved. */
+byte* nurseryStart;
+byte* nurseryTop;
+byte* nurseryEnd;
+
+/* References of all instances in the nursery, indexed by their address (in units of INSTANCE_ALIGNMENT bytes), 0 for addresses where no instance starts. Each
+	thread only writes the entries of its own allocation buffer. */
+reference* youngReferenceTable;
+
+/* The old generation is one contiguous block of memory as well, where promoted instances and instances that are too large for the nursery are allocated by 
+	increasing oldGenerationTop. Dead instances leave holes, which are closed by sliding all live instances down after every full collection. */
+byte* oldGenerationStart;
+byte* oldGenerationTop;
+byte* oldGenerationEnd;
+
+/* References of all old instances, ordered by their addresses. Compaction keeps the order. */
+reference* oldReferenceList;
+uint32 oldReferenceCount= 0;
+uint32 maxOldReferenceEntries= INITIAL_NUMBER_OF_POSSIBLE_REFERENCES;
+
+/* Old instances that may contain references to young instances, see heap_writeBarrier(). */
+reference* rememberedSet;
+uint32 rememberedSetCount= 0;
+uint32 maxRememberedSetEntries= INITIAL_NUMBER_OF_POSSIBLE_REFERENCES;
+
+/* Refills the references of the given allocation buffer. Freed references are reused first, otherwise a new segment of the object pointer list is taken. */
+void refillReferences( AllocationBuffer* buffer )
+{
+	/* Take up to REFERENCE_BUFFER_SIZE references from the top of the free reference list. */
+	uint32 count;
+	uint32 taken;
+	do
+	{
+		count= freeReferenceCount;
+		taken= count < REFERENCE_BUFFER_SIZE ? count : REFERENCE_BUFFER_SIZE;
+	} while( taken > 0 && !__sync_bool_compare_and_swap(&freeReferenceCount, count, count - taken) );
+	
+	if( taken > 0 )
+	{
+		memcpy( buffer->references, freeReferenceList + count - taken, taken*sizeof(reference) );
+		buffer->referenceCount= taken;
+		return;
+	}
 	
-	uint32 before= maxObjectPointerListEntries;
-	maxObjectPointerListEntries*= 2;
+	reference first= __sync_fetch_and_add( &objectPointerListEntryCount, REFERENCE_BUFFER_SIZE );
 	
-	void* newPtr= mm_staticReAlloc( objectPointerList, sizeof(Object*) * maxObjectPointerListEntries );
+	if( first + REFERENCE_BUFFER_SIZE > MAX_NUMBER_OF_REFERENCES )
+		error( "OutOfMemoryError: The object pointer list is full." );
 	
-	if( newPtr == NULL )
-		error( "Memory Reallocation Error!" );
+	/* The references are used from the end of the buffer, so reverse them to hand them out in ascending order. */
+	uint32 i;
+	for( i= 0; i < REFERENCE_BUFFER_SIZE; i++ )
+		buffer->references[i]= first + REFERENCE_BUFFER_SIZE - 1 - i;
 	
-	objectPointerList= (Object**)newPtr;
-	logVerbose( "Increasing object pointer list size. Size was %i and is %i now.\n", before, maxObjectPointerListEntries );
+	buffer->referenceCount= REFERENCE_BUFFER_SIZE;
 }
 
-/* Returns an unused entry of the object pointer list.
-	Note, that this method currently is NOT thread safe!
-	TODO: Implement a better version, that is also able to find empty spots in the list, if the end is reached.
-   But this won't be necessary until we've got a garbage collector. */
+/* Returns an unused entry of the object pointer list, taken from the allocation buffer of the current thread. */
 reference getFreeObjectPointerListEntry()
 {
-	if( objectPointerListEntryCount == maxObjectPointerListEntries )
-		increasePointerList();
+	AllocationBuffer* buffer= currentAllocationBuffer;
 	
-	return objectPointerListEntryCount++;
+	if( buffer->referenceCount == 0 )
+		refillReferences( buffer );
+	
+	buffer->referenceCount--;
+	return buffer->references[buffer->referenceCount];
 }
 
+/* Refills the nursery part of the given allocation buffer, so that it has room for at least the given number of bytes. Returns false if the nursery is full. */
+boolean refillAllocationBuffer( AllocationBuffer* buffer, uint32 size )
+{
+	byte* top;
+	uint32 bufferSize;
+	do
+	{
+		top= nurseryTop;
+		bufferSize= nurseryEnd - top < ALLOCATION_BUFFER_SIZE ? nurseryEnd - top : ALLOCATION_BUFFER_SIZE;
+		
+		if( bufferSize < size )
+			return false;
+	} while( !__sync_bool_compare_and_swap(&nurseryTop, top, top + bufferSize) );
+	
+	buffer->top= top;
+	buffer->end= top + bufferSize;
+	return true;
+}
 
+/* Returns the given instance size rounded up to the instance alignment. */
+uint32 getAlignedSize( uint32 size )
+{
+	return (size + INSTANCE_ALIGNMENT - 1) & ~(INSTANCE_ALIGNMENT - 1);
+}
+
+/* Allocates the memory for an instance with the given reference in the old generation. */
+Object* allocateOldInstanceMemory( reference ref, uint32 size )
+{
+	uint32 alignedSize= getAlignedSize( size );
+	
+	lockHeap();
+	
+	if( oldGenerationTop + alignedSize > oldGenerationEnd )
+		error( "OutOfMemoryError: The old generation is full." );
+	
+	if( oldReferenceCount == maxOldReferenceEntries )
+	{
+		maxOldReferenceEntries*= 2;
+		oldReferenceList= mm_staticReAlloc( oldReferenceList, sizeof(reference) * maxOldReferenceEntries );
+		
+		if( oldReferenceList == NULL )
+			error( "Memory Reallocation Error!" );
+	}
+	
+	Object* object= (Object*)oldGenerationTop;
+	oldGenerationTop+= alignedSize;
+	
+	oldReferenceList[oldReferenceCount]= ref;
+	oldReferenceCount++;
+	
+	unlockHeap();
+	return object;
+}
+
+/* Allocates the memory for a new instance with the given reference. Small instances are allocated in the allocation buffer of the current thread, as long as 
+	there is enough space left in the nursery. All others are allocated directly in the old generation. */
+Object* allocateInstanceMemory( reference ref, uint32 size )
+{
+	AllocationBuffer* buffer= currentAllocationBuffer;
+	uint32 alignedSize= getAlignedSize( size );
+	
+	if( alignedSize > MAX_YOUNG_INSTANCE_SIZE )
+		return allocateOldInstanceMemory( ref, size );
+	
+	if( (uint32)(buffer->end - buffer->top) < alignedSize && !refillAllocationBuffer(buffer, alignedSize) )
+		return allocateOldInstanceMemory( ref, size );
+	
+	Object* object= (Object*)buffer->top;
+	buffer->top+= alignedSize;
+	
+	youngReferenceTable[((byte*)object - nurseryStart) / INSTANCE_ALIGNMENT]= ref;
+	
+	return object;
+}
 
 /* Initializes the heap. */
 void heap_init()
 {
-	logVerbose( "Initializing heap, using an initial object pointer list size of %i.\n", INITIAL_NUMBER_OF_POSSIBLE_REFERENCES );
+	logVerbose( "Initializing heap, using an object pointer list with a maximum size of %i.\n", MAX_NUMBER_OF_REFERENCES );
 	
-	/* allocate and initialize reference list with NULL pointers */
-	objectPointerList= (Object**)mm_staticMalloc( sizeof(Object*) * INITIAL_NUMBER_OF_POSSIBLE_REFERENCES );
+	/* reserve the reference list, mapped memory is initialized with NULL pointers */
+	objectPointerList= (Object**)mm_mapMemory( sizeof(Object*) * MAX_NUMBER_OF_REFERENCES );
+	freeReferenceList= (reference*)mm_mapMemory( sizeof(reference) * MAX_NUMBER_OF_REFERENCES );
 	
-	int i;
-	for( i= 0; i < maxObjectPointerListEntries; i++ )
-		objectPointerList[i]= NULL;
+	/* create the nursery */
+	logVerbose( "Creating nursery with a size of %i bytes.\n", NURSERY_SIZE );
+	nurseryStart= mm_mapMemory( NURSERY_SIZE );
+	nurseryTop= nurseryStart;
+	nurseryEnd= nurseryStart + NURSERY_SIZE;
+	
+	youngReferenceTable= (reference*)mm_mapMemory( sizeof(reference) * (NURSERY_SIZE / INSTANCE_ALIGNMENT) );
+	rememberedSet= (reference*)mm_staticMalloc( sizeof(reference) * maxRememberedSetEntries );
+	
+	/* create the old generation, its pages are only used as soon as instances are allocated there */
+	logVerbose( "Creating old generation with a maximum size of %i bytes.\n", OLD_GENERATION_SIZE );
+	oldGenerationStart= mm_mapMemory( OLD_GENERATION_SIZE );
+	oldGenerationTop= oldGenerationStart;
+	oldGenerationEnd= oldGenerationStart + OLD_GENERATION_SIZE;
+	
+	oldReferenceList= (reference*)mm_staticMalloc( sizeof(reference) * maxOldReferenceEntries );
+	
+	/* the main thread */
+	heap_attachThread();
 }
 
-/* Creates a new instance of the given class and returns the reference to it. */ 
-reference heap_newInstance( Class* cls )
+/* Assigns an allocation buffer to the current thread. Must be called by every thread before it creates any instances. The buffers of finished threads are 
+	reused, together with their unused references. */
+void heap_attachThread()
 {
-	/* if this class has superclasses, instanciate them first (via recursion) */
-	reference superInstance= NULL_REFERENCE;
-	if( cls->superClass != NULL )
-		superInstance= heap_newInstance( cls->superClass );
-	
-	/* first, find a free entry in the object pointer list */
-	reference newRef= getFreeObjectPointerListEntry();
+	lockHeap();
 	
-	/* allocate object instance */
-	Object* object= mm_dynamicMalloc( sizeof(Object) + cls->instance_variable_slot_count*sizeof(slot) );
+	AllocationBuffer* buffer;
+	for( buffer= allocationBuffers; buffer != NULL && buffer->isInUse; buffer= buffer->next )
+		;
 	
-	/* initialize instance */
-	object->cls= cls;
-	/* object->gcMarker= false; */
-	object->superInstance= superInstance;
+	if( buffer == NULL )
+	{
+		buffer= mm_staticMalloc( sizeof(AllocationBuffer) );
+		buffer->top= NULL;
+		buffer->end= NULL;
+		buffer->referenceCount= 0;
+		buffer->next= allocationBuffers;
+		allocationBuffers= buffer;
+	}
 	
-	/* initialize slots with zeros */
-	slot* instanceData= (slot*)(object+1);
-	int i;
-	for( i= 0; i < cls->instance_variable_slot_count; i++)
-		instanceData[i]= 0;
+	buffer->isInUse= true;
+	unlockHeap();
 	
-	/* save the pointer to this instance into the object pointer list */
-	objectPointerList[newRef]= object;
+	currentAllocationBuffer= buffer;
+}
+
+/* Releases the allocation buffer of the current thread, which must not create any instances afterwards. */
+void heap_detachThread()
+{
+	lockHeap();
+	currentAllocationBuffer->isInUse= false;
+	unlockHeap();
 	
-	return newRef;
+	currentAllocationBuffer= NULL;
 }
 
-/* Returns the contents of the given slot (i.e. instance variable). */
-uint32 heap_getSlotFromInstance( reference ref, Class* fieldClass, uint32 slotIndex )
+/* Returns the number of bytes that are still available in the nursery. */
+uint32 heap_getFreeNurserySize()
 {
-	/* resolve first reference */
-	Object* obj= objectPointerList[ref];
+	return nurseryEnd - nurseryTop;
+}
+
+/* Returns the number of bytes used by the old generation, including the ones of dead instances which haven't been reclaimed yet. */
+uint32 heap_getOldGenerationUsage()
+{
+	return oldGenerationTop - oldGenerationStart;
+}
+
+/* Returns the number of bytes that are still available in the old generation. */
+uint32 heap_getFreeOldGenerationSize()
+{
+	return oldGenerationEnd - oldGenerationTop;
+}
+
+/* Returns the size of the given instance in bytes. */
+uint32 heap_getInstanceSize( Object* object )
+{
+	Class* cls= object->cls;
+	
+	if( *cls->className != BASE_TYPE_ONE_ARRAY_DIMENSION )
+		return sizeof(Object) + cls->instance_variable_slot_count*sizeof(slot);
 	
-	/* see if this instance matches with the class that we're looking for, otherwise recursively go to superclass */
-	if( obj->cls != fieldClass )
+	slot count= *(slot*)(object+1);
+	
+	switch( cls->className[1] )
 	{
-		if( obj->cls->superClass == NULL )
-			error( "An instance of the given class of the field could not be found in this class hierarchy." );
-		
-		return heap_getSlotFromInstance( obj->superInstance, fieldClass, slotIndex );
+		case BASE_TYPE_BOOLEAN:
+		case BASE_TYPE_BYTE:
+			return sizeof(Object) + sizeof(slot) + count*sizeof(int8);
+		case BASE_TYPE_CHAR:
+		case BASE_TYPE_SHORT:
+			return sizeof(Object) + sizeof(slot) + count*sizeof(uint16);
+		case BASE_TYPE_LONG:
+		case BASE_TYPE_DOUBLE:
+			return sizeof(Object) + sizeof(slot) + count*sizeof(slot)*2;
+		default:
+			return sizeof(Object) + sizeof(slot) + count*sizeof(slot);
 	}
-			
-	return ((slot*)(obj+1))[slotIndex];	
 }
 
-/* Set the content of the given slot (i.e. instance variable).  */
-void heap_setSlotOfInstance( reference ref, Class* fieldClass, uint32 slotIndex, uint32 value )
+/* Puts the given old instance into the remembered set, if the given value is a reference to a young instance. */
+void heap_rememberIfYoung( reference ref, slot value )
 {
-	/* resolve first reference */
-	Object* obj= objectPointerList[ref];
+	if( value >= objectPointerListEntryCount || objectPointerList[value] == NULL || !heap_isYoung(objectPointerList[value]) || objectPointerList[ref]->isRemembered )
+		return;
+	
+	lockHeap();
 	
-	/* see if this instance matches with the class that we're looking for, otherwise recursively go to superclass */
-	if( obj->cls != fieldClass )
+	/* Another thread may have remembered the instance in the meantime. */
+	if( objectPointerList[ref]->isRemembered )
 	{
-		if( obj->cls->superClass == NULL )
-			error( "An instance of the given class of the field could not be found in this class hierarchy." );
-		
-		heap_setSlotOfInstance( obj->superInstance, fieldClass, slotIndex, value );
+		unlockHeap();
 		return;
 	}
 	
-	((slot*)(obj+1))[slotIndex]= value;	
+	if( rememberedSetCount == maxRememberedSetEntries )
+	{
+		maxRememberedSetEntries*= 2;
+		rememberedSet= mm_staticReAlloc( rememberedSet, sizeof(reference) * maxRememberedSetEntries );
+		
+		if( rememberedSet == NULL )
+			error( "Memory Reallocation Error!" );
+	}
+	
+	objectPointerList[ref]->isRemembered= true;
+	rememberedSet[rememberedSetCount]= ref;
+	rememberedSetCount++;
+	
+	unlockHeap();
 }
 
-/* Get two slots in a row -> long or double instance variables */
-uint64 heap_getTwoSlotsFromInstance( reference ref, Class* fieldClass, uint32 slotIndex )
+/* Empties the nursery after the garbage collector has marked all live young instances. Marked instances are copied to the old generation, the references of all
+	others are freed. Afterwards there are no young instances anymore, so the remembered set is cleared, too. Returns the number of bytes that have been copied. */
+uint32 heap_evacuateNursery()
 {
-	/* resolve first reference */
-	Object* obj= objectPointerList[ref];
+	uint32 promotedBytes= 0;
+	uint32 tableSize= (nurseryTop - nurseryStart) / INSTANCE_ALIGNMENT;
 	
-	/* see if this instance matches with the class that we're looking for, otherwise recursively go to superclass */
-	if( obj->cls != fieldClass )
+	uint32 i;
+	for( i= 0; i < tableSize; i++ )
 	{
-		if( obj->cls->superClass == NULL )
-			error( "An instance of the given class of the field could not be found in this class hierarchy." );
+		reference ref= youngReferenceTable[i];
+		
+		if( ref == NULL_REFERENCE )
+			continue;
+		
+		youngReferenceTable[i]= NULL_REFERENCE;
+		Object* object= objectPointerList[ref];
 		
-		return heap_getTwoSlotsFromInstance( obj->superInstance, fieldClass, slotIndex );
+		if( !object->gcMarker )
+		{
+			if( object->lockWord != 0 )
+				monitor_release( object->lockWord );
+			
+			objectPointerList[ref]= NULL;
+			freeReferenceList[freeReferenceCount]= ref;
+			freeReferenceCount++;
+			continue;
+		}
+		
+		uint32 size= heap_getInstanceSize( object );
+		Object* oldObject= allocateOldInstanceMemory( ref, size );
+		memcpy( oldObject, object, size );
+		oldObject->gcMarker= false;
+		objectPointerList[ref]= oldObject;
+		promotedBytes+= getAlignedSize( size );
 	}
 	
-	slot* instanceData= (slot*)(obj+1);
-	uint32 value1= instanceData[slotIndex];
-	uint32 value2= instanceData[slotIndex+1];
-	return ((uint64)value1 << 32) | value2;
+	/* The allocation buffers of all threads point into the old nursery. */
+	nurseryTop= nurseryStart;
+	
+	AllocationBuffer* buffer;
+	for( buffer= allocationBuffers; buffer != NULL; buffer= buffer->next )
+	{
+		buffer->top= NULL;
+		buffer->end= NULL;
+	}
+	
+	for( i= 0; i < rememberedSetCount; i++ )
+		if( objectPointerList[rememberedSet[i]] != NULL )
+			objectPointerList[rememberedSet[i]]->isRemembered= false;
+	
+	rememberedSetCount= 0;
+	return promotedBytes;
 }
 
-/* Set two slots in a row -> long or double instance variables */
-void heap_setTwoSlotsOfInstance( reference ref, Class* fieldClass, uint32 slotIndex, uint64 value )
+/* Compacts the old generation after the garbage collector has marked all live instances: the references of unmarked instances are freed and all marked ones are 
+	slid down to the start of the old generation, in the order of their addresses, so they end up in one contiguous block. Only the object pointer list entry of a 
+	moved instance has to be updated. The pages behind the live instances are handed back to the operating system. Returns the number of freed instances. */
+uint32 heap_compactOldGeneration()
 {
-	/* resolve first reference */
-	Object* obj= objectPointerList[ref];
+	byte* newTop= oldGenerationStart;
+	uint32 liveCount= 0;
+	uint32 freed= 0;
 	
-	/* see if this instance matches with the class that we're looking for, otherwise recursively go to superclass */
-	if( obj->cls != fieldClass )
+	uint32 i;
+	for( i= 0; i < oldReferenceCount; i++ )
 	{
-		if( obj->cls->superClass == NULL )
-			error( "An instance of the given class of the field could not be found in this class hierarchy." );
+		reference ref= oldReferenceList[i];
+		Object* object= objectPointerList[ref];
+		uint32 size= getAlignedSize( heap_getInstanceSize(object) );
+		
+		if( !object->gcMarker )
+		{
+			if( object->lockWord != 0 )
+				monitor_release( object->lockWord );
+			
+			objectPointerList[ref]= NULL;
+			freeReferenceList[freeReferenceCount]= ref;
+			freeReferenceCount++;
+			freed++;
+			continue;
+		}
+		
+		object->gcMarker= false;
 		
-		heap_setTwoSlotsOfInstance( obj->superInstance, fieldClass, slotIndex, value );
+		/* The destination may overlap the instance itself. */
+		if( (byte*)object != newTop )
+		{
+			memmove( newTop, object, size );
+			objectPointerList[ref]= (Object*)newTop;
+		}
+		
+		oldReferenceList[liveCount]= ref;
+		liveCount++;
+		newTop+= size;
 	}
 	
-	uint32 value1= (uint32)((value >> 32) & 0xFFFFFFFF);
-	uint32 value2= (uint32)(value & 0xFFFFFFFF);
-
-	slot* instanceData= (slot*)(obj+1);
-	instanceData[slotIndex]= value1;	
-	instanceData[slotIndex+1]= value2;	
+	uint32 released= mm_releaseMemory( newTop, oldGenerationTop - newTop );
+	logVerbose( "Compacted old generation from %i to %i bytes, %i bytes released.\n", oldGenerationTop - oldGenerationStart, newTop - oldGenerationStart, released );
+	(void)released; /* only logged, which may be compiled out */
+	
+	oldGenerationTop= newTop;
+	oldReferenceCount= liveCount;
+	return freed;
 }
 
-/* Creates a new instance of an array with a maximum data type size of one slot. */ 
-reference heap_newOneSlotArrayInstance( int32 count, Class* cls )
+/* Creates a new instance of the given class and returns the reference to it. The instance is a single block, holding the slots of all classes of the
+	hierarchy (see readFields()). */ 
+reference heap_newInstance( Class* cls )
 {
-	/* all arrays have Object as their superclasses, so create an Object instance as superclass manually here */
-	Class* objectClass= ma_getClass( "java/lang/Object" );
-	reference superInstance= heap_newInstance( objectClass );
-	
 	/* first, find a free entry in the object pointer list */
 	reference newRef= getFreeObjectPointerListEntry();
 	
 	/* allocate object instance */
-	Object* object= mm_dynamicMalloc( sizeof(Object) + sizeof(slot) + count*sizeof(slot) );
+	Object* object= allocateInstanceMemory( newRef, sizeof(Object) + cls->instance_variable_slot_count*sizeof(slot) );
 	
 	/* initialize instance */
 	object->cls= cls;
-	/* object->gcMarker= false; */
-	object->superInstance= superInstance;
+	object->lockWord= 0;
+	object->gcMarker= false;
+	object->isRemembered= false;
 	
-	/* initialize */
-	slot* arrayCount= (slot*)(object+1);
-	*arrayCount= count;
-	
-	slot* instanceData= arrayCount+1;
-	int i;
-	for( i= 0; i < count; i++)
-		instanceData[i]= 0;
+	/* initialize slots with zeros */
+	memset( object+1, 0, cls->instance_variable_slot_count*sizeof(slot) );
 	
-	/* save the pointer to this instance into the according object pointer list */
+	/* save the pointer to this instance into the object pointer list */
 	objectPointerList[newRef]= object;
 	
 	return newRef;
 }
 
-/* Creates a new instance of an array with a maximum data type size of two slots. */ 
-reference heap_newTwoSlotsArrayInstance( int32 count, Class* cls )
+/* Returns the contents of the given slot (i.e. instance variable). */
+uint32 heap_getSlotFromInstance( reference ref, uint32 slotIndex )
+{
+	return heap_getInstanceSlots( ref )[slotIndex];
+}
+
+/* Set the content of the given slot (i.e. instance variable).  */
+void heap_setSlotOfInstance( reference ref, uint32 slotIndex, uint32 value )
+{
+	heap_getInstanceSlots( ref )[slotIndex]= value;
+	heap_writeBarrier( ref, value );
+}
+
+/* Get two slots in a row -> long or double instance variables */
+uint64 heap_getTwoSlotsFromInstance( reference ref, uint32 slotIndex )
+{
+	slot* instanceData= heap_getInstanceSlots( ref );
+	uint32 value1= instanceData[slotIndex];
+	uint32 value2= instanceData[slotIndex+1];
+	return ((uint64)value1 << 32) | value2;
+}
+
+/* Set two slots in a row -> long or double instance variables */
+void heap_setTwoSlotsOfInstance( reference ref, uint32 slotIndex, uint64 value )
+{
+	uint32 value1= (uint32)((value >> 32) & 0xFFFFFFFF);
+	uint32 value2= (uint32)(value & 0xFFFFFFFF);
+
+	slot* instanceData= heap_getInstanceSlots( ref );
+	instanceData[slotIndex]= value1;	
+	instanceData[slotIndex+1]= value2;	
+}
+
+/* Creates a new array of the given class. An array is a plain object (without any instance variables), followed by the number of elements and the elements 
+	themselves. As java.lang.Object has no instance variables, the methods of Object work on arrays directly (see cls_initArrayClass()). */
+reference newArrayInstance( Class* cls, int32 count, uint32 elementSize )
 {
-	/* all arrays have Object as their superclasses, so create an Object instance as superclass manually here */
-	Class* objectClass= ma_getClass( "java/lang/Object" );
-	reference superInstance= heap_newInstance( objectClass );
-	
 	/* first, find a free entry in the object pointer list */
 	reference newRef= getFreeObjectPointerListEntry();
 	
 	/* allocate object instance */
-	Object* object= mm_dynamicMalloc( sizeof(Object) + sizeof(slot) + count*sizeof(slot)*2 );
+	uint32 dataSize= count*elementSize;
+	Object* object= allocateInstanceMemory( newRef, sizeof(Object) + sizeof(slot) + dataSize );
 	
 	/* initialize instance */
 	object->cls= cls;
-	/* object->gcMarker= false; */
-	object->superInstance= superInstance;
+	object->lockWord= 0;
+	object->gcMarker= false;
+	object->isRemembered= false;
 	
-	/* initialize */
 	slot* arrayCount= (slot*)(object+1);
 	*arrayCount= count;
 	
-	slot* instanceData= arrayCount+1;
-	int i;
-	for( i= 0; i < count; i++)
-		instanceData[i]= 0;
+	/* initialize elements with zeros */
+	memset( arrayCount+1, 0, dataSize );
 	
 	/* save the pointer to this instance into the according object pointer list */
 	objectPointerList[newRef]= object;
@@ -245,129 +520,54 @@ reference heap_newTwoSlotsArrayInstance( int32 count, Class* cls )
 	return newRef;
 }
 
+/* Creates a new instance of an array with a maximum data type size of one slot. */ 
+reference heap_newOneSlotArrayInstance( int32 count, Class* cls )
+{
+	return newArrayInstance( cls, count, sizeof(slot) );
+}
+
+/* Creates a new instance of an array with a maximum data type size of two slots. */ 
+reference heap_newTwoSlotsArrayInstance( int32 count, Class* cls )
+{
+	return newArrayInstance( cls, count, sizeof(slot)*2 );
+}
+
 reference heap_newIntArrayInstance( int32 count )
 {
-	return heap_newOneSlotArrayInstance( count, ma_getClass("[I") );
+	return heap_newOneSlotArrayInstance( count, intArrayClass );
 }
 
 reference heap_newFloatArrayInstance( int32 count )
 {
-	return heap_newOneSlotArrayInstance( count, ma_getClass("[F") );
+	return heap_newOneSlotArrayInstance( count, floatArrayClass );
 }
 
 reference heap_newLongArrayInstance( int32 count )
 {
-	return heap_newTwoSlotsArrayInstance( count, ma_getClass("[J") );
+	return heap_newTwoSlotsArrayInstance( count, longArrayClass );
 }
 
 reference heap_newDoubleArrayInstance( int32 count )
 {
-	return heap_newTwoSlotsArrayInstance( count, ma_getClass("[D") );
+	return heap_newTwoSlotsArrayInstance( count, doubleArrayClass );
 }
 
 /* Creates a new instance of a byte array. */ 
 reference heap_newByteArrayInstance( int32 count )
 {
-	Class* cls= ma_getClass( "[B" );
-	
-	/* all arrays have Object as their superclasses, so create an Object instance as superclass manually here */
-	Class* objectClass= ma_getClass( "java/lang/Object" );
-	reference superInstance= heap_newInstance( objectClass );
-	
-	/* first, find a free entry in the object pointer list */
-	reference newRef= getFreeObjectPointerListEntry();
-	
-	/* allocate object instance */
-	Object* object= mm_dynamicMalloc( sizeof(Object) + sizeof(slot) + count*sizeof(int8) );
-	
-	/* initialize instance */
-	object->cls= cls;
-	/* object->gcMarker= false; */
-	object->superInstance= superInstance;
-	
-	/* initialize */
-	slot* arrayCount= (slot*)(object+1);
-	*arrayCount= count;
-	
-	int8* instanceData= (int8*)(arrayCount+1);
-	int i;
-	for( i= 0; i < count; i++)
-		instanceData[i]= 0;
-	
-	/* save the pointer to this instance into the according object pointer list */
-	objectPointerList[newRef]= object;
-	
-	return newRef;
+	return newArrayInstance( byteArrayClass, count, sizeof(int8) );
 }
 
 /* Creates a new instance short array. */ 
 reference heap_newShortArrayInstance( int32 count )
 {
-	Class* cls= ma_getClass( "[S" );
-	
-	/* all arrays have Object as their superclasses, so create an Object instance as superclass manually here */
-	Class* objectClass= ma_getClass( "java/lang/Object" );
-	reference superInstance= heap_newInstance( objectClass );
-	
-	/* first, find a free entry in the object pointer list */
-	reference newRef= getFreeObjectPointerListEntry();
-	
-	/* allocate object instance */
-	Object* object= mm_dynamicMalloc( sizeof(Object) + sizeof(slot) + count*sizeof(uint16) );
-	
-	/* initialize instance */
-	object->cls= cls;
-	/* object->gcMarker= false; */
-	object->superInstance= superInstance;
-	
-	/* initialize */
-	slot* arrayCount= (slot*)(object+1);
-	*arrayCount= count;
-	
-	uint16* instanceData= (uint16*)(arrayCount+1);
-	int i;
-	for( i= 0; i < count; i++)
-		instanceData[i]= 0;
-	
-	/* save the pointer to this instance into the according object pointer list */
-	objectPointerList[newRef]= object;
-	
-	return newRef;
+	return newArrayInstance( shortArrayClass, count, sizeof(uint16) );
 }
 
 /* Creates a new instance char array. */ 
 reference heap_newCharArrayInstance( int32 count )
 {
-	Class* cls= ma_getClass( "[C" );
-	
-	/* all arrays have Object as their superclasses, so create an Object instance as superclass manually here */
-	Class* objectClass= ma_getClass( "java/lang/Object" );
-	reference superInstance= heap_newInstance( objectClass );
-	
-	/* first, find a free entry in the object pointer list */
-	reference newRef= getFreeObjectPointerListEntry();
-	
-	/* allocate object instance */
-	Object* object= mm_dynamicMalloc( sizeof(Object) + sizeof(slot) + count*sizeof(uint16) );
-	
-	/* initialize instance */
-	object->cls= cls;
-	/* object->gcMarker= false; */
-	object->superInstance= superInstance;
-	
-	/* initialize */
-	slot* arrayCount= (slot*)(object+1);
-	*arrayCount= count;
-	
-	uint16* instanceData= (uint16*)(arrayCount+1);
-	int i;
-	for( i= 0; i < count; i++)
-		instanceData[i]= 0;
-	
-	/* save the pointer to this instance into the according object pointer list */
-	objectPointerList[newRef]= object;
-	
-	return newRef;
+	return newArrayInstance( charArrayClass, count, sizeof(uint16) );
 }
 
 slot heap_getSlotFromArray( reference arRef, int32 position )
@@ -459,6 +659,10 @@ void heap_setSlotInArray( reference arRef, int32 position, slot value )
 
 	slot* instanceData= ((slot*)(obj+1))+1;
 	instanceData[position]= value;
+	
+	/* arrays of objects or arrays */
+	if( obj->cls->className[1] == BASE_TYPE_REFERENCE || obj->cls->className[1] == BASE_TYPE_ONE_ARRAY_DIMENSION )
+		heap_writeBarrier( arRef, value );
 }
 
 void heap_setByteInArray( reference arRef, int32 position, slot value )
@@ -564,7 +768,7 @@ boolean heap_isArray( reference ref )
 reference heap_newStringInstance( const char* string )
 {
 	/* create instance of java.lang.String */
-	Class* stringClass= ma_getClass( "java/lang/String" );
+	Class* stringClass= javaLangStringClass;
 	reference newStr= heap_newInstance( stringClass );
 	
 	/* Get length of the given utf8 string. */
@@ -580,8 +784,7 @@ reference heap_newStringInstance( const char* string )
 		heap_setCharInArray( charArray, i, string[i] );
 	
 	/* Put the reference to the char array into the according String instance variable. */
-	variable* varInfo= cls_resolveField( &stringClass, "value", "[C" );
-	heap_setSlotOfInstance( newStr, stringClass, varInfo->slot_index, charArray );
+	heap_setSlotOfInstance( newStr, stringValueSlotIndex, charArray );
 	
 	/* done */
 	return newStr;
@@ -603,19 +806,30 @@ slot heap_getAddressOfInstance( reference objectRef )
 	return (slot)objectPointerList[objectRef];
 }
 
-/* Recursively checks the given object if it or its super instances are an instance of the given class. */
+/* Returns the lock word of the given instance (see monitor.c). The pointer is only valid until the instance is moved by the next garbage collection. */
+volatile uint32* heap_getLockWord( reference objectRef )
+{
+	if( objectRef == NULL_REFERENCE )
+		error( "NullPointerException" );
+	
+	return &objectPointerList[objectRef]->lockWord;
+}
+
+/* Checks if the class of the given object or one of its super classes is the given class. */
 boolean heap_isObjectInstanceOf( reference objectRef, Class* cls )
 {
 	if( objectRef == 0 || objectRef > objectPointerListEntryCount )
 		error( "Invalid reference exception." );
 
-	Object* obj= objectPointerList[objectRef];
-	
-	if( obj->cls == cls )
-		return true;
+	Class* objectClass= objectPointerList[objectRef]->cls;
 	
-	if( obj->superInstance == NULL_REFERENCE )
-		return false;
+	while( objectClass != NULL )
+	{
+		if( objectClass == cls )
+			return true;
+		
+		objectClass= objectClass->superClass;
+	}
 	
-	return heap_isObjectInstanceOf( obj->superInstance, cls );
+	return false;
 }
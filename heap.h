@@ -13,6 +13,21 @@
 
 #define NULL_REFERENCE 0
 #define INITIAL_NUMBER_OF_POSSIBLE_REFERENCES 1024
+/* maximum number of entries of the object pointer list, see heap.c */
+#define MAX_NUMBER_OF_REFERENCES (16*1024*1024)
+/* number of references a thread takes from the object pointer list at once */
+#define REFERENCE_BUFFER_SIZE 256
+/* number of bytes a thread takes from the nursery at once */
+#define ALLOCATION_BUFFER_SIZE (16*1024)
+
+/* size of the nursery (young generation), see heap.c */
+#define NURSERY_SIZE (4*1024*1024)
+/* larger instances are allocated in the old generation directly */
+#define MAX_YOUNG_INSTANCE_SIZE (NURSERY_SIZE/16)
+/* maximum size of the old generation, see heap.c */
+#define OLD_GENERATION_SIZE (256*1024*1024)
+/* must be a power of two and at least sizeof(Object) */
+#define INSTANCE_ALIGNMENT 16
 
 #define NO_ARRAY -1
 #define NO_TYPE 0
@@ -21,19 +36,59 @@
 typedef struct sObject
 {
 	Class* cls;
-	/* boolean gcMarker; */
-	reference superInstance;
+	volatile uint32 lockWord; /* see monitor.c */
+	uint8 gcMarker;
+	uint8 isRemembered; /* only used by old instances which are in the remembered set */
 } Object;
 
+/* Thread-local allocation buffer: every thread allocates instances in its own part of the nursery and takes the references for them from its own buffer, so the 
+	common allocation path doesn't need any synchronization. Empty buffers are refilled from the shared nursery and object pointer list by atomic operations. */
+typedef struct sAllocationBuffer
+{
+	byte* top;
+	byte* end;
+	reference references[REFERENCE_BUFFER_SIZE]; /* unused references, used as a stack */
+	uint32 referenceCount;
+	boolean isInUse; /* false, if the thread of the buffer has finished */
+	struct sAllocationBuffer* next; /* list of the buffers of all threads */
+} AllocationBuffer;
+
+/* object pointer list, nursery and remembered set, see heap.c */
+extern Object** objectPointerList;
+extern uint32 objectPointerListEntryCount;
+extern byte* nurseryStart;
+extern byte* nurseryEnd;
+extern reference* rememberedSet;
+extern uint32 rememberedSetCount;
+
+#define heap_isYoung( object ) ((byte*)(object) >= nurseryStart && (byte*)(object) < nurseryEnd)
+
+/* The write barrier has to be used whenever a reference might be stored into an instance (except when the instance has just been created by the heap itself). It 
+	keeps track of all old instances which refer to young instances, so that the garbage collector doesn't have to scan the whole old generation for a minor 
+	collection. */
+#define heap_writeBarrier( ref, value ) do { if( (value) != NULL_REFERENCE && !heap_isYoung(objectPointerList[(ref)]) ) heap_rememberIfYoung( (ref), (value) ); } while( false )
+
+/* Returns a pointer to the first instance variable slot of the given (non array) instance. Instance variables are accessed by their slot index. */
+#define heap_getInstanceSlots( ref ) ((slot*)(objectPointerList[(ref)]+1))
+
 void heap_init();
+void heap_attachThread();
+void heap_detachThread();
+uint32 heap_getFreeNurserySize();
+uint32 heap_getOldGenerationUsage();
+uint32 heap_getFreeOldGenerationSize();
+uint32 heap_getInstanceSize( Object* object );
+void heap_rememberIfYoung( reference ref, slot value );
+uint32 heap_evacuateNursery();
+uint32 heap_compactOldGeneration();
 
 reference heap_newInstance( Class* cls );
 
-uint32 heap_getSlotFromInstance( reference ref, Class* fieldClass, uint32 slotIndex );
-uint64 heap_getTwoSlotsFromInstance( reference ref, Class* fieldClass, uint32 slotIndex );
+uint32 heap_getSlotFromInstance( reference ref, uint32 slotIndex );
+uint64 heap_getTwoSlotsFromInstance( reference ref, uint32 slotIndex );
 
-void heap_setSlotOfInstance( reference ref, Class* fieldClass, uint32 slotIndex, uint32 value );
-void heap_setTwoSlotsOfInstance( reference ref, Class* fieldClass, uint32 slotIndex, uint64 value );
+void heap_setSlotOfInstance( reference ref, uint32 slotIndex, uint32 value );
+void heap_setTwoSlotsOfInstance( reference ref, uint32 slotIndex, uint64 value );
 
 reference heap_newOneSlotArrayInstance( int32 count, Class* cls );
 reference heap_newByteArrayInstance( int32 count );
@@ -67,6 +122,7 @@ reference heap_newStringInstance( const char* string );
 
 Class* heap_getClassOfInstance( reference objectRef );
 slot heap_getAddressOfInstance( reference objectRef );
+volatile uint32* heap_getLockWord( reference objectRef );
 
 boolean heap_isObjectInstanceOf( reference objectRef, Class* cls );
 #endif /*_heap_h_*/
\ No newline at end of file
@@ -0,0 +1,170 @@
+/*
+ *  inlineCache.c
+ *  Inline caches for virtual and interface method call sites. When a call site is quickened, it gets its own inline cache, which is stored with the code of 
+ *  the calling method. The quick instruction then refers to the cache instead of the constant pool.
+ *  The caches of a method are allocated when it is loaded, one for each call site, so they never move while other threads use them. Changes are made while
+ *  holding the method area lock.
+ *
+ *  Copyright (c) 2006, 2007 Daniel Klein. All rights reserved.
+ *  
+ *  Licensed under GPL version 2.
+ *  See here for the full license: http://www.gnu.org/licenses/gpl.html
+ */
+
+#include <stdio.h>
+#include "puraGlobals.h"
+#include "class.h"
+#include "memoryManager.h"
+#include "opcodes.h"
+#include "thread.h"
+#include "interpreter.h"
+#include "inlineCache.h"
+
+/* statistics, the hits and misses are counted per thread like the opcodes (see interpreter_addThreadStatistics()) */
+THREAD_LOCAL uint32 inlineCacheHits= 0;
+THREAD_LOCAL uint32 inlineCacheMisses= 0;
+uint32 totalInlineCacheHits= 0;
+uint32 totalInlineCacheMisses= 0;
+
+/* Number of call sites by the number of cached receiver classes (index 0 is unused, as every call site starts with one class), and the number of
+	megamorphic call sites. */
+uint32 callSiteCount[INLINE_CACHE_SIZE+1];
+uint32 megamorphicCallSiteCount= 0;
+
+/* Looks up the implementation to call for the given receiver class, i.e. without asking the cache. */
+method_info* lookupTarget( InlineCache* cache, Class* receiverClass )
+{
+	if( isFlagSet(cache->methodInfo->declaringClass->access_flags, ACC_INTERFACE) )
+		return cls_getInterfaceMethodImplementation( receiverClass, cache->methodInfo );
+	
+	/* native methods without a vtable entry are called directly */
+	if( cache->methodInfo->vtableIndex == NO_VTABLE_INDEX )
+		return cache->methodInfo;
+	
+	return receiverClass->vtable[cache->methodInfo->vtableIndex];
+}
+
+/* Allocates the inline caches for all virtual and interface call sites of the given (just loaded) code. They are used as the call sites are quickened. */
+void ic_init( Code_attribute* code )
+{
+	uint32 callSiteCount= 0;
+	
+	uint32 pc;
+	for( pc= 0; pc < code->code_length; pc+= opcode_getInstructionLength(code->code, pc) )
+		if( code->code[pc] == INVOKEVIRTUAL || code->code[pc] == INVOKEINTERFACE )
+			callSiteCount++;
+	
+	if( callSiteCount > 0xFFFF )
+		error( "Too many call sites in one method." );
+	
+	code->inline_cache_count= 0;
+	code->inlineCaches= callSiteCount > 0 ? mm_staticMalloc( callSiteCount * sizeof(InlineCache) ) : NULL;
+}
+
+/* Rewrites the given invoke instruction into its quick form, whose operand is the index of a new, empty inline cache for the call site of the given method. 
+	Several threads may quicken the same instruction at the same time, so only the first one creates a cache. */
+void ic_quickenCallSite( Code_attribute* code, method_info* methodInfo, byte* instruction, uint8 quickOpcode )
+{
+	thread_lockMethodArea();
+	
+	if( *instruction != quickOpcode )
+	{
+		u2 cacheIndex= code->inline_cache_count;
+		InlineCache* cache= &code->inlineCaches[cacheIndex];
+		cache->methodInfo= methodInfo;
+		cache->entryCount= 0;
+		cache->isMegamorphic= false;
+		code->inline_cache_count++;
+		
+		interpreter_beginOperandRewrite();
+		opcode_writeU2( instruction+1, cacheIndex );
+		
+		/* Other threads must not see the new opcode before its operand and the cache. */
+		__sync_synchronize();
+		*instruction= quickOpcode;
+		interpreter_endOperandRewrite();
+	}
+	
+	thread_unlockMethodArea();
+}
+
+/* Returns the implementation to call for the given receiver class. If the receiver class is not cached yet, the implementation is looked up and added to the
+	cache, unless the cache is full already. In this case the call site is megamorphic and will be looked up every time. */
+method_info* ic_getTarget( InlineCache* cache, Class* receiverClass )
+{
+	int i;
+	for( i= 0; i < cache->entryCount; i++ )
+	{
+		if( cache->receiverClasses[i] == receiverClass )
+		{
+			if( opcodeStatsEnabled )
+				inlineCacheHits++;
+			return cache->targets[i];
+		}
+	}
+	
+	if( opcodeStatsEnabled )
+		inlineCacheMisses++;
+	
+	method_info* target= lookupTarget( cache, receiverClass );
+	
+	/* Don't cache failed lookups, the caller will report them. */
+	if( target == NULL || cache->isMegamorphic )
+		return target;
+	
+	thread_lockMethodArea();
+	
+	/* The cache may have been changed by another thread in the meantime. */
+	if( cache->isMegamorphic )
+	{
+		thread_unlockMethodArea();
+		return target;
+	}
+	
+	if( cache->entryCount == INLINE_CACHE_SIZE )
+	{
+		logVerbose( "\tCall site of %s%s became megamorphic.\n", cache->methodInfo->name, cache->methodInfo->descriptor );
+		cache->isMegamorphic= true;
+		callSiteCount[cache->entryCount]--;
+		megamorphicCallSiteCount++;
+		thread_unlockMethodArea();
+		return target;
+	}
+	
+	if( cache->entryCount > 0 )
+		callSiteCount[cache->entryCount]--;
+	
+	/* Threads that search the cache without the lock must not see the new entry count before the entry. */
+	cache->receiverClasses[cache->entryCount]= receiverClass;
+	cache->targets[cache->entryCount]= target;
+	__sync_synchronize();
+	cache->entryCount++;
+	callSiteCount[cache->entryCount]++;
+	
+	thread_unlockMethodArea();
+	return target;
+}
+
+/* Adds the hits and misses of the current native thread to the totals and resets them. */
+void ic_addThreadStatistics()
+{
+	__sync_fetch_and_add( &totalInlineCacheHits, inlineCacheHits );
+	__sync_fetch_and_add( &totalInlineCacheMisses, inlineCacheMisses );
+	inlineCacheHits= 0;
+	inlineCacheMisses= 0;
+}
+
+void ic_printStatistics()
+{
+	uint32 total= totalInlineCacheHits + totalInlineCacheMisses;
+	
+	printf( "\nInline Cache Statistics:\n" );
+	printf( "Hits: %i (%4.1f%%), misses: %i\n", totalInlineCacheHits, total > 0 ? (totalInlineCacheHits*100)/(float)total : 0.0f,
+		totalInlineCacheMisses );
+	
+	int i;
+	for( i= 1; i <= INLINE_CACHE_SIZE; i++ )
+		printf( "Call sites with %i receiver class%s: %i\n", i, i == 1 ? "" : "es", callSiteCount[i] );
+	
+	printf( "Megamorphic call sites: %i\n", megamorphicCallSiteCount );
+}
@@ -0,0 +1,35 @@
+/*
+ *  inlineCache.h
+ *  Inline caches for virtual and interface method call sites.
+ *
+ *  Copyright (c) 2006, 2007 Daniel Klein. All rights reserved.
+ *  
+ *  Licensed under GPL version 2.
+ *  See here for the full license: http://www.gnu.org/licenses/gpl.html
+ */
+
+#ifndef _inlineCache_h_
+#define _inlineCache_h_
+
+#include "class.h"
+
+/* maximum number of receiver classes per call site, call sites with more receiver classes are megamorphic */
+#define INLINE_CACHE_SIZE 4
+
+/* One inline cache per call site. It remembers the last receiver classes and the implementations that have been called for them. */
+typedef struct sInlineCache
+{
+	method_info* methodInfo; /* the resolved (virtual or interface) method of the call site */
+	uint8 entryCount;
+	boolean isMegamorphic;
+	Class* receiverClasses[INLINE_CACHE_SIZE];
+	method_info* targets[INLINE_CACHE_SIZE];
+} InlineCache;
+
+void ic_init( Code_attribute* code );
+void ic_quickenCallSite( Code_attribute* code, method_info* methodInfo, byte* instruction, uint8 quickOpcode );
+method_info* ic_getTarget( InlineCache* cache, Class* receiverClass );
+void ic_addThreadStatistics();
+void ic_printStatistics();
+
+#endif /*_inlineCache_h_*/
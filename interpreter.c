@@ -19,6 +19,16 @@
 #include "heap.h"
 #include "opcodes.h"
 #include "native.h"
+#include "inlineCache.h"
+#include "symbolTable.h"
+#include "garbageCollector.h"
+#include "thread.h"
+#include "monitor.h"
+#include "scheduler.h"
+#include "jit.h"
+#include "optimizingCompiler.h"
+#include "aot.h"
+#include "registerInterpreter.h"
 #include "interpreter.h"
 
 #define MAIN_METHOD_NAME "main"
@@ -27,11 +37,207 @@
 #define STR_STATIC_INITIALIZER_METHOD_NAME "<clinit>"
 #define STR_STATIC_INITIALIZER_METHOD_DESCRIPTOR "()V"
 
+/* Opcode handler entry and exit. Using the switch loop, every handler is a plain case label and leaves the switch via break. Using threaded dispatch, every
+   handler additionally gets its own label and jumps directly to the handler of the next opcode, so that the loop head and the switch's range check are only
+   passed once per call of interpreter_interpret(). Either way, logging and counting the instructions costs a load and a branch per instruction unless enabled by
+   the verbose log level or -opcodestats (see traceInstruction()). */
+#ifdef THREADED_DISPATCH_ENABLED
+#define OPCODE(op) case op: op_##op
+#define NEXT_OPCODE \
+	do { \
+		if( isInstructionTracingEnabled ) \
+			traceInstruction( pc ); \
+		goto *dispatchTable[*pc]; \
+	} while( false )
+#else
+#define OPCODE(op) case op
+#define NEXT_OPCODE break
+#endif
+
+/* Safe point poll at backward branches, method entries and returns, so that a thread running a loop without allocations doesn't keep another thread from
+   stopping the world (see thread.c). The fast path is a single load of isStopTheWorldRequested and a branch which is practically never taken. The pc must point
+   to the start of an instruction which has a reference map (i.e. the target of a backward branch, the start of a method or the return address of an invoke). */
+#define POLL_SAFE_POINT() \
+	do { \
+		if( isStopTheWorldRequested ) \
+		{ \
+			sf->pc= pc; \
+			thread_enterSafePoint(); \
+		} \
+	} while( false )
+
+/* Safe point at backward branches and method entries, which is a switch point of the green thread scheduler, too (see scheduler.c). Leaves the interpreter loop
+   with the pc stored, if the current thread should give up its worker. */
+#define SAFE_POINT() \
+	do { \
+		POLL_SAFE_POINT(); \
+		if( isSwitchingAllowed && sched_isSwitchDue() ) \
+		{ \
+			sf->pc= pc; \
+			return; \
+		} \
+	} while( false )
+
+/* Runs the compiled code of the current method in an executable built by the ahead-of-time compiler (see aot.c), starting at the current pc. Like the
+   machine code of the JIT compiler, it returns with the pc stored. It never leaves the current frame. */
+#define RUN_AOT_CODE() \
+	do { \
+		sf->pc= pc; \
+		if( sf->methodInfo->aotCode(stack, sf, isSwitchingAllowed) ) \
+			return; \
+		pc= sf->pc; \
+	} while( false )
+
+/* Runs the register code of the current method (see registerInterpreter.c), if it can be entered at the current pc. Like the compiled code, it returns with
+   the pc stored and never leaves the current frame. */
+#define RUN_REGISTER_CODE() \
+	do { \
+		sf->pc= pc; \
+		if( ri_run(stack, sf, isSwitchingAllowed) ) \
+			return; \
+		pc= sf->pc; \
+	} while( false )
+
+/* Continues at the given branch target, which is an absolute pc of the current method (see opcode_predecode()). The pc must point behind the opcode of the
+   branch instruction. Backward branches are safe points. */
+#define BRANCH( target ) \
+	do { \
+		byte* branchPc= pc - 1; \
+		pc= code + (target); \
+		if( pc < branchPc ) \
+			BACKWARD_BRANCH(); \
+	} while( false )
+
+#ifdef JIT_ENABLED
+/* Runs the machine code of the current method (see jit.c), starting at the current pc. The machine code returns with the pc stored, either because the
+   interpreter has to continue at that pc, or because the current green thread should leave its worker. The optimized machine code may leave in the frame
+   of an inlined method, so the current frame is reloaded. */
+#define RUN_COMPILED_CODE() \
+	do { \
+		sf->pc= pc; \
+		if( jit_run(stack, isSwitchingAllowed) ) \
+			return; \
+		sf= stack->currentFrame; \
+		code= sf->methodInfo->code->code; \
+		pc= sf->pc; \
+	} while( false )
+
+/* Method entry: counts the invocations of the mixed mode, compiles the method with the baseline compiler and later with the optimizing compiler (see
+   optimizingCompiler.c), and continues in its machine code. Methods which have been compiled ahead of time aren't compiled again. */
+#define JIT_METHOD_ENTRY() \
+	do { \
+		if( sf->methodInfo->aotCode != NULL ) \
+		{ \
+			RUN_AOT_CODE(); \
+			break; \
+		} \
+		if( sf->methodInfo->optimizedMethod == NULL && isJitEnabled ) \
+		{ \
+			uint32 invocationCount= ++sf->methodInfo->invocationCount; \
+			if( invocationCount == jitInvocationThreshold ) \
+				jit_compile( sf->methodInfo ); \
+			if( invocationCount == optimizationThreshold ) \
+				opt_compile( sf->methodInfo ); \
+		} \
+		if( sf->methodInfo->compiledMethod != NULL || sf->methodInfo->optimizedMethod != NULL ) \
+			RUN_COMPILED_CODE(); \
+		else if( sf->methodInfo->registerCode != NULL ) \
+			RUN_REGISTER_CODE(); \
+	} while( false )
+
+/* Continues in the machine code of the current method at the current pc, if the method has been compiled, or else in its register code. Used at the return
+   addresses of invokes and when the interpreter loop is entered. */
+#define JIT_CONTINUE() \
+	do { \
+		if( sf->methodInfo->aotCode != NULL ) \
+			RUN_AOT_CODE(); \
+		else if( sf->methodInfo->compiledMethod != NULL ) \
+			RUN_COMPILED_CODE(); \
+		else if( sf->methodInfo->registerCode != NULL ) \
+			RUN_REGISTER_CODE(); \
+	} while( false )
+
+/* Backward branch: a safe point, which counts the loop iterations of the mixed mode, too. A hot loop is compiled, and continues in the machine code at the
+   loop header, even if the method is never invoked again (on-stack replacement). */
+#define BACKWARD_BRANCH() \
+	do { \
+		SAFE_POINT(); \
+		if( sf->methodInfo->aotCode != NULL ) \
+		{ \
+			RUN_AOT_CODE(); \
+			break; \
+		} \
+		if( isJitEnabled ) \
+		{ \
+			uint32 backwardBranchCount= ++sf->methodInfo->backwardBranchCount; \
+			if( backwardBranchCount == jitBackwardBranchThreshold && sf->methodInfo->compiledMethod == NULL ) \
+				jit_compile( sf->methodInfo ); \
+			if( backwardBranchCount == optimizationBackwardBranchThreshold ) \
+				opt_compileLoop( sf->methodInfo, pc - sf->methodInfo->code->code ); \
+		} \
+		if( sf->methodInfo->compiledMethod != NULL || sf->methodInfo->loopOptimizedMethods != NULL ) \
+			RUN_COMPILED_CODE(); \
+		else if( sf->methodInfo->registerCode != NULL ) \
+			RUN_REGISTER_CODE(); \
+	} while( false )
+#else
+/* Without the JIT compiler, only the compiled code of the ahead-of-time compiler and the register code are run. */
+#define JIT_METHOD_ENTRY() \
+	do { \
+		if( sf->methodInfo->aotCode != NULL ) \
+			RUN_AOT_CODE(); \
+		else if( sf->methodInfo->registerCode != NULL ) \
+			RUN_REGISTER_CODE(); \
+	} while( false )
+#define JIT_CONTINUE() JIT_METHOD_ENTRY()
+#define BACKWARD_BRANCH() \
+	do { \
+		SAFE_POINT(); \
+		JIT_METHOD_ENTRY(); \
+	} while( false )
+#endif
+
 void interpreter_interpret( Stack* stack ); 
+void interpret( Stack* stack, StackFrame* exitFrame, boolean isSwitchingAllowed );
 
-uint32 numberOfBytecodesExecuted= 0;
+/* The statistics are counted per thread, and added to the totals when the thread finishes. */
+THREAD_LOCAL uint32 numberOfBytecodesExecuted= 0;
+THREAD_LOCAL uint32 opcodeCount[256];
+uint32 totalNumberOfBytecodesExecuted= 0;
+uint32 totalOpcodeCount[256];
 boolean opcodeStatsEnabled= false;
-uint32* opcodeCount= NULL;
+
+/* Set by interpreter_start() if the instructions are logged or counted, which the interpreter loop then does for every instruction it executes. */
+boolean isInstructionTracingEnabled= false;
+
+/* Adds the statistics of the current native thread to the totals. Worker threads of the scheduler run many Java threads, so the counters are reset. */
+void interpreter_addThreadStatistics()
+{
+	__sync_fetch_and_add( &totalNumberOfBytecodesExecuted, numberOfBytecodesExecuted );
+	numberOfBytecodesExecuted= 0;
+	
+	int i;
+	for( i= 0; i < 256; i++ )
+		if( opcodeCount[i] > 0 )
+		{
+			__sync_fetch_and_add( &totalOpcodeCount[i], opcodeCount[i] );
+			opcodeCount[i]= 0;
+		}
+	
+	ic_addThreadStatistics();
+	jit_addThreadStatistics();
+}
+
+/* Logs the instruction at the given pc at verbose log level and counts it for the opcode statistics. */
+void traceInstruction( const byte* pc )
+{
+	logVerbose( "Executing %s\n", opcodeNames[*pc] );
+	if( opcodeStatsEnabled )
+	{
+		numberOfBytecodesExecuted++;
+		opcodeCount[*pc]++;
+	}
+}
 
 void showOpcodeStats()
 {
@@ -42,24 +248,58 @@ void showOpcodeStats()
 	
 	int i;
 	for( i= 0; i < 256; i++ )
-		if( opcodeCount[i] > 0 )
-			printf( "Opcode %13s: %7i (%4.1f%%)\n", opcodeNames[i], opcodeCount[i], (opcodeCount[i]*100)/(float)numberOfBytecodesExecuted );
-		
+		if( totalOpcodeCount[i] > 0 )
+			printf( "Opcode %13s: %7i (%4.1f%%)\n", opcodeNames[i], totalOpcodeCount[i], (totalOpcodeCount[i]*100)/(float)totalNumberOfBytecodesExecuted );
+	
+	ic_printStatistics();
+	jit_printStatistics();
+	ri_printStatistics();
+}
+
+/* Creates an array of the given primitive type (see NEWARRAY). */
+reference interpreter_newArray( uint8 arrayType, int32 count )
+{
+	reference arRef= NULL_REFERENCE;
+	
+	switch( arrayType )
+	{
+		case ARRAY_TYPE_BOOLEAN:
+		case ARRAY_TYPE_BYTE:
+			arRef= heap_newByteArrayInstance( count );
+			break;
+		case ARRAY_TYPE_CHAR:
+			arRef= heap_newCharArrayInstance( count );
+			break;
+		case ARRAY_TYPE_SHORT:
+			arRef= heap_newShortArrayInstance( count );
+			break;
+		case ARRAY_TYPE_INT:
+			arRef= heap_newIntArrayInstance( count );
+			break;
+		case ARRAY_TYPE_FLOAT:
+			arRef= heap_newFloatArrayInstance( count );
+			break;
+		case ARRAY_TYPE_LONG:
+			arRef= heap_newLongArrayInstance( count );
+			break;
+		case ARRAY_TYPE_DOUBLE:
+			arRef= heap_newDoubleArrayInstance( count );
+			break;
+		default:
+			error( "Unknown array type!" );
+			break;
+	}
+	
+	return arRef;
 }
 
 /* Start another interpreter loop to execute a static method without parameters (usually "<clinit>") on the same stack. We do this in order to be able to initialize a class 
    without messing up the state (i.e. the native locals) of the current interpreter. */
 void directParameterlessStaticMethodCall( Stack* stack, Class* cls, method_info* method )
 {
-	/* simulate the case that this frame is the only one on the stack (same as the main method), so that interpreter_interpret() returns after executing the given method */
-	StackFrame* prevStackFrame= stack->currentFrame->prevStackFrame;
-	stack->currentFrame->prevStackFrame= NULL;
-	
+	/* interpreter_interpret() returns as soon as the given method returns to the current frame (same as the main method) */
 	stack_pushFrame( stack, cls, method );
 	interpreter_interpret( stack );
-	
-	/* restore previous stack frame pointer and continue as normal */
-	stack->currentFrame->prevStackFrame= prevStackFrame;
 }
 
 /* initialize the given class */
@@ -69,28 +309,32 @@ void handleClassInitialization( Stack* stack, Class* cls )
 	if( cls->isInitialized )
 		return;
 	
+	/* Initialized by another thread in the meantime (possibly after waiting for it), or already being initialized by this thread (i.e. we're called from the
+	initializer)? -> Nothing to do. Otherwise the class is marked as being initialized by this thread, so that we don't get stuck in a recursion loop while
+	executing the initializer. */
+	if( !thread_beginClassInitialization(cls) )
+		return;
+	
 	/* Check if the superclass has already been initialized. If not, do so recursively. 
 	If the super_class entry is 0, this is our terminating condition, because the current class is java.lang.Object. */
 	if( cls->superClass != NULL )
 		handleClassInitialization( stack, cls->superClass );
 	
-	/* Mark as initialized, so that we don't get stuck in a recursion loop while executing the initializer. */ 
-	cls->isInitialized= true;
-	
 	/* Check if there is a "<clinit>" method present in this class. If yes, execute it.*/
-	method_info* clInitMethod=	cls_getMethod( cls, STR_STATIC_INITIALIZER_METHOD_NAME, STR_STATIC_INITIALIZER_METHOD_DESCRIPTOR );
+	method_info* clInitMethod=	cls_getMethod( cls, sym_intern(STR_STATIC_INITIALIZER_METHOD_NAME), sym_intern(STR_STATIC_INITIALIZER_METHOD_DESCRIPTOR) );
 	
 	if( clInitMethod )
 		directParameterlessStaticMethodCall( stack, cls, clInitMethod );
+	
+	thread_endClassInitialization( cls );
 }
 
 void initSystemClasses( Stack* stack )
 {
-	Class* objectClass= ma_getClass( "java/lang/Object" );
-	handleClassInitialization( stack, objectClass );
+	ma_loadSystemClasses();
 	
-	Class* stringClass= ma_getClass( "java/lang/String" );
-	handleClassInitialization( stack, stringClass );
+	handleClassInitialization( stack, javaLangObjectClass );
+	handleClassInitialization( stack, javaLangStringClass );
 	
 	/* TODO: Add more here as required. */
 }
@@ -109,7 +353,7 @@ reference createArgumentArray()
 	logVerbose( "Passing %i arguments.\n", numArgs );
 	
 	/* Create the String[]. */
-	reference stringArray= heap_newOneSlotArrayInstance( numArgs, ma_getClass("[Ljava/lang/String;") );
+	reference stringArray= heap_newOneSlotArrayInstance( numArgs, stringArrayClass );
 	
 	/* And now create a String object for every argument and put its reference into the array. */
 	arg= mainClassArguments;
@@ -125,24 +369,24 @@ reference createArgumentArray()
 
 void interpreter_start( const char* mainClass )
 {
-	/* initialize opcode counter */
-	opcodeCount= mm_staticMalloc( 256*sizeof(uint32) );
-	
-	int i;
-	for( i= 0; i < 256; i++ )
-		opcodeCount[i]= 0;
+#ifdef VERBOSE_LOGGING_DISABLED
+	isInstructionTracingEnabled= opcodeStatsEnabled;
+#else
+	isInstructionTracingEnabled= opcodeStatsEnabled || currentLogLevel <= LOG_VERBOSE;
+#endif
 	
 	/* make sure the given class is loaded and get a pointer */
 	Class* cls= ma_getClass( mainClass );
 		
 	/* find main method */
-	method_info* mainMethod= cls_getMethod( cls, MAIN_METHOD_NAME, MAIN_METHOD_DESCRIPTOR );
+	method_info* mainMethod= cls_getMethod( cls, sym_intern(MAIN_METHOD_NAME), sym_intern(MAIN_METHOD_DESCRIPTOR) );
 	
 	/* create a new stack */
 	Stack* stack= stack_create( initialStackSize );
 	
 	/* setup initial stack frame (for parameter passing to the main method) */
 	stack_createInitialStackFrame( stack );
+	thread_attachMainThread( stack );
 	
 	/* Pre-Initialize basic system classes. */
 	initSystemClasses( stack );
@@ -154,27 +398,40 @@ void interpreter_start( const char* mainClass )
 	/* setup stack frame for method */
 	stack_pushFrame( stack, cls, mainMethod );
 	
-	/* execute main method */
-	interpreter_interpret( stack );
-	
-	/* free stack */
-	/* Note: This is not necessary, because we're not executing multithreaded (yet), but we may do so later. */
-	stack_free( stack );
+	/* execute main method, either directly or as the first green thread */
+	if( sched_isEnabled() )
+	{
+		stack->currentFrame->pc= stack->currentFrame->methodInfo->code->code;
+		sched_run( stack );
+	}
+	else
+	{
+		interpreter_interpret( stack );
+		interpreter_addThreadStatistics();
+		
+		/* The VM exits as soon as all threads have finished. */
+		thread_waitForAllThreads();
+		
+		/* free stack */
+		stack_free( stack );
+	}
 	
 	/* Done executing the main-method. Tell statistics. */
-	logVerbose( "\nExecution finished. %i Bytecodes executed.\n", numberOfBytecodesExecuted );
+	if( opcodeStatsEnabled )
+		logVerbose( "\nExecution finished. %i Bytecodes executed.\n", totalNumberOfBytecodesExecuted );
+	else
+		logVerbose( "\nExecution finished.\n" );
 	
 	/* Show opcode statistics, if enabled. */
 	showOpcodeStats();
+	gc_printStatistics();
 }
 
-u2 getNextU2( byte* pc )
+/* Continues the given thread at the stored pc of its current frame, until it returns to its initial stack frame. Green threads return earlier at switch points or
+   to be parked, see scheduler.c. */
+void interpreter_runThread( Stack* stack )
 {
-	u2 data= *pc << 8;
-	pc++;
-	data|= *pc;
-	pc++;
-	return data;
+	interpret( stack, (StackFrame*)stack->basePointer, sched_isEnabled() );
 }
 
 void unsupportedError( byte* pc )
@@ -183,6 +440,82 @@ void unsupportedError( byte* pc )
 	error( "Execution haltet.\n" );
 }
 
+/* Incremented before and after the operand of an instruction is rewritten by quickening, so it is odd while a rewrite is in progress. Only changed with the
+   method area lock held (see interpreter_beginOperandRewrite()). */
+volatile uint32 operandRewriteSequence= 0;
+
+/* Reads the constant pool index of the given instruction. Quickening replaces the index by a slot or inline cache index before it stores the quick opcode, so a
+   thread may see the new operand with the old opcode. The index is therefore only trusted if no operand has been rewritten while it was read, otherwise it is
+   read again under the method area lock. Returns false if another thread has quickened the instruction in the meantime, which then has to be dispatched
+   again. */
+boolean readUnquickenedIndex( byte* instruction, uint8 opcode, uint16* index )
+{
+	uint32 sequence= operandRewriteSequence;
+	__sync_synchronize();
+	
+	if( instruction[0] != opcode )
+		return false;
+	
+	*index= opcode_readU2( instruction+1 );
+	__sync_synchronize();
+	
+	if( (sequence & 1) == 0 && operandRewriteSequence == sequence )
+		return true;
+	
+	thread_lockMethodArea();
+	
+	boolean isUnquickened= instruction[0] == opcode;
+	if( isUnquickened )
+		*index= opcode_readU2( instruction+1 );
+	
+	thread_unlockMethodArea();
+	return isUnquickened;
+}
+
+/* Called with the method area lock held around rewriting the operand and opcode of an instruction, see readUnquickenedIndex(). */
+void interpreter_beginOperandRewrite()
+{
+	operandRewriteSequence++;
+	__sync_synchronize();
+}
+
+void interpreter_endOperandRewrite()
+{
+	__sync_synchronize();
+	operandRewriteSequence++;
+}
+
+/* Rewrites a GETFIELD or PUTFIELD instruction into the given quick form, which takes the slot index of the field as its operand. */
+void quickenFieldAccess( byte* instruction, uint8 quickOpcode, uint16 slotIndex )
+{
+	thread_lockMethodArea();
+	
+	if( instruction[0] != quickOpcode )
+	{
+		interpreter_beginOperandRewrite();
+		opcode_writeU2( instruction+1, slotIndex );
+		
+		/* Other threads may execute the instruction at the same time, they must not see the new opcode before its operand. */
+		__sync_synchronize();
+		instruction[0]= quickOpcode;
+		interpreter_endOperandRewrite();
+	}
+	
+	thread_unlockMethodArea();
+}
+
+/* Returns true for field descriptors of long and double values, which occupy two slots. */
+boolean isTwoSlotType( const char* descriptor )
+{
+	return *descriptor == BASE_TYPE_LONG || *descriptor == BASE_TYPE_DOUBLE;
+}
+
+/* Returns true for field descriptors of objects and arrays, whose stores need the write barrier. */
+boolean isReferenceType( const char* descriptor )
+{
+	return *descriptor == BASE_TYPE_REFERENCE || *descriptor == BASE_TYPE_ONE_ARRAY_DIMENSION;
+}
+
 char getTypeOfLastArrayOfMultidimensionalArray( Class* cls, uint16 index )
 {
 	const char* name= cls_resolveConstantPoolIndexToClassName( cls, index );
@@ -201,7 +534,7 @@ reference createMultiDimensionalArray( int32* values, int32 dimensions, char typ
 		switch( typeOfLast )
 		{
 			case BASE_TYPE_REFERENCE:
-				return heap_newOneSlotArrayInstance( *values, ma_getClass("[Ljava/lang/Object;") );
+				return heap_newOneSlotArrayInstance( *values, objectArrayClass );
 				break;
 			case BASE_TYPE_BOOLEAN:
 			case BASE_TYPE_BYTE:
@@ -269,173 +602,220 @@ int checkSurroundedByMatchingCatchClause( uint16 localPC, StackFrame* sf, Class*
 }
 
 
+/* Executes the method of the current frame of the given stack from its start. Returns when the method returns. */
 void interpreter_interpret( Stack* stack )
+{
+	StackFrame* sf= stack->currentFrame;
+	sf->pc= sf->methodInfo->code->code;
+	
+	/* Returning to the previous frame ends this interpreter loop. The stack frames below stay intact, so that the garbage collector can still find them. */
+	interpret( stack, sf->prevStackFrame, false );
+}
+
+/* The interpreter loop. Starts at the stored pc of the current frame and returns when the given exit frame is reached again, or at a switch point, if switching
+   green threads is allowed. */
+void interpret( Stack* stack, StackFrame* exitFrame, boolean isSwitchingAllowed )
 {
 	/*boolean isWideOpcode= false;*/
 	StackFrame* sf= stack->currentFrame;
 	
-	/* initialize program counter */
-	register byte* pc= sf->methodInfo->code->code;
+#ifdef THREADED_DISPATCH_ENABLED
+	/* handler addresses, indexed by opcode */
+	static const void* dispatchTable[256]= {
+		&&op_NOP, &&op_ACONST_NULL, &&op_ICONST_M1, &&op_ICONST_0, &&op_ICONST_1, &&op_ICONST_2, &&op_ICONST_3, &&op_ICONST_4, &&op_ICONST_5,
+		&&op_LCONST_0, &&op_LCONST_1, &&op_FCONST_0, &&op_FCONST_1, &&op_FCONST_2, &&op_DCONST_0, &&op_DCONST_1, &&op_BIPUSH, &&op_SIPUSH, &&op_LDC,
+		&&op_LDC_W, &&op_LDC2_W, &&op_ILOAD, &&op_LLOAD, &&op_FLOAD, &&op_DLOAD, &&op_ALOAD, &&op_ILOAD_0, &&op_ILOAD_1, &&op_ILOAD_2, &&op_ILOAD_3,
+		&&op_LLOAD_0, &&op_LLOAD_1, &&op_LLOAD_2, &&op_LLOAD_3, &&op_FLOAD_0, &&op_FLOAD_1, &&op_FLOAD_2, &&op_FLOAD_3, &&op_DLOAD_0, &&op_DLOAD_1,
+		&&op_DLOAD_2, &&op_DLOAD_3, &&op_ALOAD_0, &&op_ALOAD_1, &&op_ALOAD_2, &&op_ALOAD_3, &&op_IALOAD, &&op_LALOAD, &&op_FALOAD, &&op_DALOAD,
+		&&op_AALOAD, &&op_BALOAD, &&op_CALOAD, &&op_SALOAD, &&op_ISTORE, &&op_LSTORE, &&op_FSTORE, &&op_DSTORE, &&op_ASTORE, &&op_ISTORE_0, &&op_ISTORE_1,
+		&&op_ISTORE_2, &&op_ISTORE_3, &&op_LSTORE_0, &&op_LSTORE_1, &&op_LSTORE_2, &&op_LSTORE_3, &&op_FSTORE_0, &&op_FSTORE_1, &&op_FSTORE_2,
+		&&op_FSTORE_3, &&op_DSTORE_0, &&op_DSTORE_1, &&op_DSTORE_2, &&op_DSTORE_3, &&op_ASTORE_0, &&op_ASTORE_1, &&op_ASTORE_2, &&op_ASTORE_3,
+		&&op_IASTORE, &&op_LASTORE, &&op_FASTORE, &&op_DASTORE, &&op_AASTORE, &&op_BASTORE, &&op_CASTORE, &&op_SASTORE, &&op_POP, &&op_POP2, &&op_DUP,
+		&&op_DUP_X1, &&op_DUP_X2, &&op_DUP2, &&op_DUP2_X1, &&op_DUP2_X2, &&op_SWAP, &&op_IADD, &&op_LADD, &&op_FADD, &&op_DADD, &&op_ISUB, &&op_LSUB,
+		&&op_FSUB, &&op_DSUB, &&op_IMUL, &&op_LMUL, &&op_FMUL, &&op_DMUL, &&op_IDIV, &&op_LDIV, &&op_FDIV, &&op_DDIV, &&op_IREM, &&op_LREM, &&op_FREM,
+		&&op_DREM, &&op_INEG, &&op_LNEG, &&op_FNEG, &&op_DNEG, &&op_ISHL, &&op_LSHL, &&op_ISHR, &&op_LSHR, &&op_IUSHR, &&op_LUSHR, &&op_IAND, &&op_LAND,
+		&&op_IOR, &&op_LOR, &&op_IXOR, &&op_LXOR, &&op_IINC, &&op_I2L, &&op_I2F, &&op_I2D, &&op_L2I, &&op_L2F, &&op_L2D, &&op_F2I, &&op_F2L, &&op_F2D,
+		&&op_D2I, &&op_D2L, &&op_D2F, &&op_I2B, &&op_I2C, &&op_I2S, &&op_LCMP, &&op_FCMPL, &&op_FCMPG, &&op_DCMPL, &&op_DCMPG, &&op_IFEQ, &&op_IFNE,
+		&&op_IFLT, &&op_IFGE, &&op_IFGT, &&op_IFLE, &&op_IF_ICMPEQ, &&op_IF_ICMPNE, &&op_IF_ICMPLT, &&op_IF_ICMPGE, &&op_IF_ICMPGT, &&op_IF_ICMPLE,
+		&&op_IF_ACMPEQ, &&op_IF_ACMPNE, &&op_GOTO, &&op_JSR, &&op_RET, &&op_TABLESWITCH, &&op_LOOKUPSWITCH, &&op_IRETURN, &&op_LRETURN, &&op_FRETURN,
+		&&op_DRETURN, &&op_ARETURN, &&op_RETURN, &&op_GETSTATIC, &&op_PUTSTATIC, &&op_GETFIELD, &&op_PUTFIELD, &&op_INVOKEVIRTUAL, &&op_INVOKESPECIAL,
+		&&op_INVOKESTATIC, &&op_INVOKEINTERFACE, &&op_XXX_UNUSED_XXX, &&op_NEW, &&op_NEWARRAY, &&op_ANEWARRAY, &&op_ARRAYLENGTH, &&op_ATHROW,
+		&&op_CHECKCAST, &&op_INSTANCEOF, &&op_MONITORENTER, &&op_MONITOREXIT, &&op_WIDE, &&op_MULTIANEWARRAY, &&op_IFNULL, &&op_IFNONNULL, &&op_GOTO_W,
+		&&op_JSR_W, &&op_BREAKPOINT, &&op_LDC_QUICK, &&op_LDC_W_QUICK, &&op_LDC2_W_QUICK, &&op_GETFIELD_QUICK, &&op_PUTFIELD_QUICK, &&op_GETFIELD2_QUICK,
+		&&op_PUTFIELD2_QUICK, &&op_GETSTATIC_QUICK, &&op_PUTSTATIC_QUICK, &&op_GETSTATIC2_QUICK, &&op_PUTSTATIC2_QUICK, &&op_INVOKEVIRTUAL_QUICK,
+		&&op_INVOKENONVIRTUAL_QUICK, &&op_INVOKESUPER_QUICK, &&op_INVOKESTATIC_QUICK, &&op_INVOKEINTERFACE_QUICK, &&op_INVOKEVIRTUALOBJECT_QUICK,
+		&&op_UNKNOWN3, &&op_NEW_QUICK, &&op_ANEWARRAY_QUICK, &&op_MULTIANEWARRAY_QUICK, &&op_CHECKCAST_QUICK, &&op_INSTANCEOF_QUICK,
+		&&op_INVOKEVIRTUAL_QUICK_W, &&op_GETFIELD_QUICK_W, &&op_APUTFIELD_QUICK, &&op_UNUSED1, &&op_UNUSED2, &&op_UNUSED3, &&op_UNUSED4, &&op_UNUSED5,
+		&&op_UNUSED6, &&op_UNUSED7, &&op_UNUSED8, &&op_UNUSED9, &&op_UNUSED10, &&op_UNUSED11, &&op_UNUSED12, &&op_UNUSED13, &&op_UNUSED14, &&op_UNUSED15,
+		&&op_UNUSED16, &&op_UNUSED17, &&op_UNUSED18, &&op_UNUSED19, &&op_UNUSED20, &&op_UNUSED21, &&op_UNUSED22, &&op_UNUSED23, &&op_UNUSED24,
+		&&op_UNUSED25, &&op_IMPDEP1, &&op_IMPDEP2
+	};
+#endif
+	
+	/* initialize program counter and the start of the code of the current method, which is the base of branch targets */
+	register byte* pc= sf->pc;
+	byte* code= sf->methodInfo->code->code;
 	
 	/* print debug info */
 	logVerbose( "Executing method %s.%s%s...\n", sf->currentClass->className, 
 					sf->methodInfo->name, 
 					sf->methodInfo->descriptor );
 	
+	/* A green thread which has left its worker in the machine code continues there. */
+	JIT_CONTINUE();
+	
 	/* main interpreter loop */
 	while( true )
 	{
-		logVerbose( "Executing %s\n", opcodeNames[*pc] );
-		opcodeCount[*pc]++;
+		if( isInstructionTracingEnabled )
+			traceInstruction( pc );
 		
 		switch( *pc )
 		{
-		case NOP: /* no operation opcode */
+		OPCODE( NOP ): /* no operation opcode */
 			/* do nothing */
 			pc++;
-			break;
+			NEXT_OPCODE;
 				
 		/* push constants onto the stack */
-		case ACONST_NULL: /* u1; push null reference onto the stack */
+		OPCODE( ACONST_NULL ): /* u1; push null reference onto the stack */
 			pc++;
 			stack_pushSlot( stack, NULL_REFERENCE );
-			break;
+			NEXT_OPCODE;
 				
-		case ICONST_M1: /* push integer constant -1 onto the stack */
+		OPCODE( ICONST_M1 ): /* push integer constant -1 onto the stack */
 			pc++;
 			stack_pushSlot( stack, -1 );
-			break;
+			NEXT_OPCODE;
 			
-		case ICONST_0: /* push integer value 0 onto the stack */
+		OPCODE( ICONST_0 ): /* push integer value 0 onto the stack */
 			pc++;
 			stack_pushSlot( stack, 0 );
-			break;
+			NEXT_OPCODE;
 				
-		case ICONST_1: /* push integer value 1 onto the stack */
+		OPCODE( ICONST_1 ): /* push integer value 1 onto the stack */
 			pc++;
 			stack_pushSlot( stack, 1 );
-			break;
+			NEXT_OPCODE;
 					
-		case ICONST_2: /* push integer value 2 onto the stack */
+		OPCODE( ICONST_2 ): /* push integer value 2 onto the stack */
 			pc++;
 			stack_pushSlot( stack, 2 );
-			break;
+			NEXT_OPCODE;
 						
-		case ICONST_3: /* push integer value 3 onto the stack */
+		OPCODE( ICONST_3 ): /* push integer value 3 onto the stack */
 			pc++;
 			stack_pushSlot( stack, 3 );
-			break;
+			NEXT_OPCODE;
 							
-		case ICONST_4: /* push integer value 4 onto the stack */
+		OPCODE( ICONST_4 ): /* push integer value 4 onto the stack */
 			pc++;
 			stack_pushSlot( stack, 4 );
-			break;
+			NEXT_OPCODE;
 								
-		case ICONST_5: /* push integer value 5 onto the stack */
+		OPCODE( ICONST_5 ): /* push integer value 5 onto the stack */
 			pc++;
 			stack_pushSlot( stack, 5 );
-			break;
+			NEXT_OPCODE;
 																		
-		case LCONST_0: /* u1; push the long integer 0 onto the stack */
+		OPCODE( LCONST_0 ): /* u1; push the long integer 0 onto the stack */
 			pc++;
 			stack_pushLong( stack, 0 );
-			break;
+			NEXT_OPCODE;
 
-		case LCONST_1: /* u1; push the long integer 1 onto the stack */
+		OPCODE( LCONST_1 ): /* u1; push the long integer 1 onto the stack */
 			pc++;
 			stack_pushLong( stack, 1 );
-			break;
+			NEXT_OPCODE;
 			
-		case FCONST_0: /* u1; push the single float 0.0 onto the stack */
+		OPCODE( FCONST_0 ): /* u1; push the single float 0.0 onto the stack */
 			pc++;
 			stack_pushFloat( stack, 0.0f );
-			break;
+			NEXT_OPCODE;
 				
-		case FCONST_1: /* u1; push the single float 1.0 onto the stack */
+		OPCODE( FCONST_1 ): /* u1; push the single float 1.0 onto the stack */
 			pc++;
 			stack_pushFloat( stack, 1.0f );
-			break;
+			NEXT_OPCODE;
 					
-		case FCONST_2: /* u1; push the single float 2.0 onto the stack */
+		OPCODE( FCONST_2 ): /* u1; push the single float 2.0 onto the stack */
 			pc++;
 			stack_pushFloat( stack, 2.0f );
-			break;
+			NEXT_OPCODE;
 												
-		case DCONST_0: /* u1, u1; push the double 0.0 onto the stack */
+		OPCODE( DCONST_0 ): /* u1, u1; push the double 0.0 onto the stack */
 			pc++;
 			stack_pushDouble( stack, 0.0 );
-			break;
+			NEXT_OPCODE;
 							
-		case DCONST_1: /* u1, u1; push the double 1.0 onto the stack */
+		OPCODE( DCONST_1 ): /* u1, u1; push the double 1.0 onto the stack */
 			pc++;
 			stack_pushDouble( stack, 1.0 );
-			break;
+			NEXT_OPCODE;
 								
 		/* stack manipulation */
-		case BIPUSH: /* u1, s1; push one signed byte onto stack (expands to 32bit) */
+		OPCODE( BIPUSH ): /* u1, s1; push one signed byte onto stack (expands to 32bit) */
 		{
 			pc++;
 			int8 value= *pc;
 			pc++;
 			stack_pushByte( stack, value );
 			logVerbose( "\tPushing byte value %i onto the stack.\n", value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case SIPUSH: /* u1, s2; push signed short (2 byte) onto stack (expands to 32bit) */
+		OPCODE( SIPUSH ): /* u1, s2; push signed short (2 byte) onto stack (expands to 32bit) */
 		{
-			pc++;
-			uint8 value1= *pc;
-			pc++;
-			uint8 value2= *pc;
-			pc++;
-			int16 value= (value1 << 8) | value2;
+			int16 value= opcode_readS2( pc+1 );
+			pc+= 3;
 			stack_pushShort( stack, value );
 			logVerbose( "\tPushing short value %i onto the stack.\n", value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case LDC: /* u1, u1; push single-word constant onto stack */
+		OPCODE( LDC ): /* u1, u1; push single-word constant onto stack */
 		{
 			pc++;
 			u1 index= *pc;
 			pc++;
 			int32 value= cls_getItemFromConstantPool( sf->currentClass, index );
 			stack_pushSlot( stack, value );
+			
+			/* The String instance exists now, so the quick form can simply push the stored reference from now on. */
+			if( sf->currentClass->constant_pool[index]->tag == CONSTANT_String )
+				*(pc-2)= LDC_QUICK;
+			
 			logVerbose( "\tPushing value %i from constant pool index %i.\n", value, index );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case LDC_W: /* u1, u2; push single-word constant onto stack (wide index) */
+		OPCODE( LDC_W ): /* u1, u2; push single-word constant onto stack (wide index) */
 		{
-			pc++;
-			uint8 index1= *pc;
-			pc++;
-			uint8 index2= *pc;
-			pc++;
-			uint16 index= (index1 << 8) | index2;
+			uint16 index= opcode_readU2( pc+1 );
+			pc+= 3;
 			int32 value= cls_getItemFromConstantPool( sf->currentClass, index );
 			stack_pushSlot( stack, value );
+			
+			/* The String instance exists now, so the quick form can simply push the stored reference from now on. */
+			if( sf->currentClass->constant_pool[index]->tag == CONSTANT_String )
+				*(pc-3)= LDC_W_QUICK;
+			
 			logVerbose( "\tPushing value %i from constant pool index %i.\n", value, index );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case LDC2_W: /* u1, u2; push two-word constant onto stack (wide index) */
+		OPCODE( LDC2_W ): /* u1, u2; push two-word constant onto stack (wide index) */
 		{
-			pc++;
-			uint8 index1= *pc;
-			pc++;
-			uint8 index2= *pc;
-			pc++;
-			uint16 index= (index1 << 8) | index2;
+			uint16 index= opcode_readU2( pc+1 );
+			pc+= 3;
 			uint64 value= cls_getWideItemFromConstantPool( sf->currentClass, index );
 			stack_pushLong( stack, value );
 			logVerbose( "\tPushing value %i from constant pool index %i.\n", value, index );
-			break;
+			NEXT_OPCODE;
 		}
 				
 		/* working with local variables */
-		case ILOAD: /* u1, u1 (u1, u1, u2 using wide opcode); retrieve integer from local variable */
+		OPCODE( ILOAD ): /* u1, u1 (u1, u1, u2 using wide opcode); retrieve integer from local variable */
 		{
 			pc++;
 			u1 index= *pc;
@@ -443,10 +823,10 @@ void interpreter_interpret( Stack* stack )
 			int32 value= stack_getLocalVariable( stack, index );
 			stack_pushSlot( stack, value );
 			logVerbose( "\tPushing integer %i onto the stack, index is %i.\n", value, index );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case LLOAD: /* u1, u1 (u1, u1, u2 using wide opcode); retrieve long integer from local variable */
+		OPCODE( LLOAD ): /* u1, u1 (u1, u1, u2 using wide opcode); retrieve long integer from local variable */
 		{
 			pc++;
 			u1 index= *pc;
@@ -456,10 +836,10 @@ void interpreter_interpret( Stack* stack )
 			stack_pushSlot( stack, value1 );
 			stack_pushSlot( stack, value2 );
 			logVerbose( "\tPushing long %lli onto the stack, index is %i.\n", ((uint64)value1 << 32) | value2, index );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case FLOAD: /* u1, u1 (u1, u1, u2 using wide opcode); retrieve float from local variable */
+		OPCODE( FLOAD ): /* u1, u1 (u1, u1, u2 using wide opcode); retrieve float from local variable */
 		{
 			pc++;
 			u1 index= *pc;
@@ -467,10 +847,10 @@ void interpreter_interpret( Stack* stack )
 			uint32 value= stack_getLocalVariable( stack, index );
 			stack_pushSlot( stack, value );
 			logVerbose( "\tPushing float %d onto the stack, index is %i.\n", (float)value, index );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case DLOAD: /* u1, u1 (u1, u1, u2 using wide opcode); retrieve double from local variable */
+		OPCODE( DLOAD ): /* u1, u1 (u1, u1, u2 using wide opcode); retrieve double from local variable */
 		{
 			pc++;
 			u1 index= *pc;
@@ -480,10 +860,10 @@ void interpreter_interpret( Stack* stack )
 			stack_pushSlot( stack, value1 );
 			stack_pushSlot( stack, value2 );
 			logVerbose( "\tPushing double %d onto the stack, index is %i.\n", (double)(((uint64)value1 << 32) | value2), index );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case ALOAD: /* u1, u1 (u1, u1, u2 using wide opcode); retrieve object reference from local variable */
+		OPCODE( ALOAD ): /* u1, u1 (u1, u1, u2 using wide opcode); retrieve object reference from local variable */
 		{
 			pc++;
 			u1 index= *pc;
@@ -491,46 +871,46 @@ void interpreter_interpret( Stack* stack )
 			uint32 value= stack_getLocalVariable( stack, index );
 			stack_pushSlot( stack, value );
 			logVerbose( "\tPushing reference %i onto the stack, index is %i.\n", value, index );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case ILOAD_0: /* u1; retrieve integer from local variable 0 */
+		OPCODE( ILOAD_0 ): /* u1; retrieve integer from local variable 0 */
 		{
 			pc++;
 			int32 value= stack_getLocalVariable( stack, 0 );
 			stack_pushSlot( stack, value );
 			logVerbose( "\tLoading integer %i from slot 0.\n", value );
-			break;
+			NEXT_OPCODE;
 		}
 		
-		case ILOAD_1: /* u1; retrieve integer from local variable 1 */
+		OPCODE( ILOAD_1 ): /* u1; retrieve integer from local variable 1 */
 		{
 			pc++;
 			int32 value= stack_getLocalVariable( stack, 1 );
 			stack_pushSlot( stack, value );
 			logVerbose( "\tLoading integer %i from slot 1.\n", value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case ILOAD_2: /* u1; retrieve integer from local variable 2 */
+		OPCODE( ILOAD_2 ): /* u1; retrieve integer from local variable 2 */
 		{
 			pc++;
 			int32 value= stack_getLocalVariable( stack, 2 );
 			stack_pushSlot( stack, value );
 			logVerbose( "\tLoading integer %i from slot 2.\n", value );
-			break;
+			NEXT_OPCODE;
 		}
 				
-		case ILOAD_3: /* u1; retrieve integer from local variable 3 */
+		OPCODE( ILOAD_3 ): /* u1; retrieve integer from local variable 3 */
 		{
 			pc++;
 			int32 value= stack_getLocalVariable( stack, 3 );
 			stack_pushSlot( stack, value );
 			logVerbose( "\tLoading integer %i from slot 3.\n", value );
-			break;
+			NEXT_OPCODE;
 		}
 				
-		case LLOAD_0: /* u1; retrieve long integer from local variable 0 */
+		OPCODE( LLOAD_0 ): /* u1; retrieve long integer from local variable 0 */
 		{
 			pc++;
 			uint32 value1= stack_getLocalVariable( stack, 0 );
@@ -538,10 +918,10 @@ void interpreter_interpret( Stack* stack )
 			stack_pushSlot( stack, value1 );
 			stack_pushSlot( stack, value2 );
 			logVerbose( "\tPushing long %lli onto the stack.\n", ((uint64)value1 << 32) | value2 );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case LLOAD_1: /* u1; retrieve long integer from local variable 1 */
+		OPCODE( LLOAD_1 ): /* u1; retrieve long integer from local variable 1 */
 		{
 			pc++;
 			uint32 value1= stack_getLocalVariable( stack, 1 );
@@ -549,10 +929,10 @@ void interpreter_interpret( Stack* stack )
 			stack_pushSlot( stack, value1 );
 			stack_pushSlot( stack, value2 );
 			logVerbose( "\tPushing long %lli onto the stack.\n", ((uint64)value1 << 32) | value2 );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case LLOAD_2: /* u1; retrieve long integer from local variable 2 */
+		OPCODE( LLOAD_2 ): /* u1; retrieve long integer from local variable 2 */
 		{
 			pc++;
 			uint32 value1= stack_getLocalVariable( stack, 2 );
@@ -560,10 +940,10 @@ void interpreter_interpret( Stack* stack )
 			stack_pushSlot( stack, value1 );
 			stack_pushSlot( stack, value2 );
 			logVerbose( "\tPushing long %lli onto the stack.\n", ((uint64)value1 << 32) | value2 );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case LLOAD_3: /* u1; retrieve long integer from local variable 3 */
+		OPCODE( LLOAD_3 ): /* u1; retrieve long integer from local variable 3 */
 		{
 			pc++;
 			uint32 value1= stack_getLocalVariable( stack, 3 );
@@ -571,46 +951,46 @@ void interpreter_interpret( Stack* stack )
 			stack_pushSlot( stack, value1 );
 			stack_pushSlot( stack, value2 );
 			logVerbose( "\tPushing long %lli onto the stack.\n", ((uint64)value1 << 32) | value2 );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case FLOAD_0: /* u1; retrieve float from local variable 0 */
+		OPCODE( FLOAD_0 ): /* u1; retrieve float from local variable 0 */
 		{
 			pc++;
 			uint32 value= stack_getLocalVariable( stack, 0 );
 			stack_pushSlot( stack, value );
 			logVerbose( "\tPushing float %d onto the stack.\n", (float)value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case FLOAD_1: /* u1; retrieve float from local variable 1 */
+		OPCODE( FLOAD_1 ): /* u1; retrieve float from local variable 1 */
 		{
 			pc++;
 			uint32 value= stack_getLocalVariable( stack, 1 );
 			stack_pushSlot( stack, value );
 			logVerbose( "\tPushing float %d onto the stack.\n", (float)value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case FLOAD_2: /* u1; retrieve float from local variable 2 */
+		OPCODE( FLOAD_2 ): /* u1; retrieve float from local variable 2 */
 		{
 			pc++;
 			uint32 value= stack_getLocalVariable( stack, 2 );
 			stack_pushSlot( stack, value );
 			logVerbose( "\tPushing float %d onto the stack.\n", (float)value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case FLOAD_3: /* u1; retrieve float from local variable 3 */
+		OPCODE( FLOAD_3 ): /* u1; retrieve float from local variable 3 */
 		{
 			pc++;
 			uint32 value= stack_getLocalVariable( stack, 3 );
 			stack_pushSlot( stack, value );
 			logVerbose( "\tPushing float %d onto the stack.\n", (float)value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case DLOAD_0: /* u1; retrieve double from local variable 0 */
+		OPCODE( DLOAD_0 ): /* u1; retrieve double from local variable 0 */
 		{
 			pc++;
 			uint32 value1= stack_getLocalVariable( stack, 0 );
@@ -618,10 +998,10 @@ void interpreter_interpret( Stack* stack )
 			stack_pushSlot( stack, value1 );
 			stack_pushSlot( stack, value2 );
 			logVerbose( "\tPushing double %d onto the stack.\n", (double)(((uint64)value1 << 32) | value2) );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case DLOAD_1: /* u1; retrieve double from local variable 1 */
+		OPCODE( DLOAD_1 ): /* u1; retrieve double from local variable 1 */
 		{
 			pc++;
 			uint32 value1= stack_getLocalVariable( stack, 1 );
@@ -629,10 +1009,10 @@ void interpreter_interpret( Stack* stack )
 			stack_pushSlot( stack, value1 );
 			stack_pushSlot( stack, value2 );
 			logVerbose( "\tPushing double %d onto the stack.\n", (double)(((uint64)value1 << 32) | value2) );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case DLOAD_2: /* u1; retrieve double from local variable 2 */
+		OPCODE( DLOAD_2 ): /* u1; retrieve double from local variable 2 */
 		{
 			pc++;
 			uint32 value1= stack_getLocalVariable( stack, 2 );
@@ -640,10 +1020,10 @@ void interpreter_interpret( Stack* stack )
 			stack_pushSlot( stack, value1 );
 			stack_pushSlot( stack, value2 );
 			logVerbose( "\tPushing double %d onto the stack.\n", (double)(((uint64)value1 << 32) | value2) );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case DLOAD_3: /* u1; retrieve double from local variable 3 */
+		OPCODE( DLOAD_3 ): /* u1; retrieve double from local variable 3 */
 		{
 			pc++;
 			uint32 value1= stack_getLocalVariable( stack, 3 );
@@ -651,47 +1031,47 @@ void interpreter_interpret( Stack* stack )
 			stack_pushSlot( stack, value1 );
 			stack_pushSlot( stack, value2 );
 			logVerbose( "\tPushing double %d onto the stack.\n", (double)(((uint64)value1 << 32) | value2) );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case ALOAD_0: /* u1; retrieve object reference from local variable 0 */
+		OPCODE( ALOAD_0 ): /* u1; retrieve object reference from local variable 0 */
 		{
 			pc++;
 			uint32 value= stack_getLocalVariable( stack, 0 );
 			stack_pushSlot( stack, value );
 			logVerbose( "\tPushing reference %i onto the stack.\n", value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case ALOAD_1: /* u1; retrieve object reference from local variable 1 */
+		OPCODE( ALOAD_1 ): /* u1; retrieve object reference from local variable 1 */
 		{
 			pc++;
 			uint32 value= stack_getLocalVariable( stack, 1 );
 			stack_pushSlot( stack, value );
 			logVerbose( "\tPushing reference %i onto the stack.\n", value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case ALOAD_2: /* u1; retrieve object reference from local variable 2 */
+		OPCODE( ALOAD_2 ): /* u1; retrieve object reference from local variable 2 */
 		{
 			pc++;
 			uint32 value= stack_getLocalVariable( stack, 2 );
 			stack_pushSlot( stack, value );
 			logVerbose( "\tPushing reference %i onto the stack.\n", value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case ALOAD_3: /* u1; retrieve object reference from local variable 3 */
+		OPCODE( ALOAD_3 ): /* u1; retrieve object reference from local variable 3 */
 		{
 			pc++;
 			uint32 value= stack_getLocalVariable( stack, 3 );
 			stack_pushSlot( stack, value );
 			logVerbose( "\tPushing reference %i onto the stack.\n", value );
-			break;
+			NEXT_OPCODE;
 		}
 			
 		/* working with arrays */
-		case BALOAD: /* u1; retrieve byte/boolean from array */
+		OPCODE( BALOAD ): /* u1; retrieve byte/boolean from array */
 		{
 			pc++;
 			
@@ -708,10 +1088,10 @@ void interpreter_interpret( Stack* stack )
 			stack_pushSlot( stack, value );
 			
 			logVerbose( "\tLoading index %i of the array with reference %i. The value is %i.\n", index, arRef, value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case CALOAD: /* u1; retrieve character from array */
+		OPCODE( CALOAD ): /* u1; retrieve character from array */
 		{
 			pc++;
 			
@@ -728,10 +1108,10 @@ void interpreter_interpret( Stack* stack )
 			stack_pushSlot( stack, value );
 			
 			logVerbose( "\tLoading index %i of the array with reference %i. The value is %c.\n", index, arRef, (char)value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case SALOAD: /* u1; retrieve short from array */
+		OPCODE( SALOAD ): /* u1; retrieve short from array */
 		{
 			pc++;
 			
@@ -748,12 +1128,12 @@ void interpreter_interpret( Stack* stack )
 			stack_pushSlot( stack, value );
 			
 			logVerbose( "\tLoading index %i of the array with reference %i. The value is %i.\n", index, arRef, value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case FALOAD: /* u1; retrieve float from array */
-		case AALOAD: /* u1; retrieve object reference from array */
-		case IALOAD: /* u1; retrieve integer from array */
+		OPCODE( FALOAD ): /* u1; retrieve float from array */
+		OPCODE( AALOAD ): /* u1; retrieve object reference from array */
+		OPCODE( IALOAD ): /* u1; retrieve integer from array */
 		{
 			pc++;
 			
@@ -770,11 +1150,11 @@ void interpreter_interpret( Stack* stack )
 			stack_pushSlot( stack, value );
 			
 			logVerbose( "\tLoading index %i of the array with reference %i. The value is %i.\n", index, arRef, value );
-			break;
+			NEXT_OPCODE;
 		}
 
-		case LALOAD: /* u1; retrieve long integer from array */
-		case DALOAD: /* u1; retrieve double-precision float from array */
+		OPCODE( LALOAD ): /* u1; retrieve long integer from array */
+		OPCODE( DALOAD ): /* u1; retrieve double-precision float from array */
 		{
 			pc++;
 			
@@ -791,11 +1171,11 @@ void interpreter_interpret( Stack* stack )
 			stack_pushLong( stack, value );
 			
 			logVerbose( "\tLoading index %i of the array with reference %i. The value is %lli.\n", index, arRef, value );
-			break;
+			NEXT_OPCODE;
 		}
 			
 			/* working with local variables */
-		case ISTORE: /* u1, u1 (u1, u1, u2 using wide opcode); store integer in local variable */
+		OPCODE( ISTORE ): /* u1, u1 (u1, u1, u2 using wide opcode); store integer in local variable */
 		{	
 			pc++;
 			u1 index= *pc;
@@ -803,10 +1183,10 @@ void interpreter_interpret( Stack* stack )
 			int32 value= stack_popSlot( stack );
 			stack_setLocalVariable( stack, index, value );
 			logVerbose( "\tPopping integer %i from the stack, storing it to slot %i.\n", value, index );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case LSTORE: /* u1, u1 (u1, u1, u2 using wide opcode); store long integer in local variable */
+		OPCODE( LSTORE ): /* u1, u1 (u1, u1, u2 using wide opcode); store long integer in local variable */
 		{	
 			pc++;
 			u1 index= *pc;
@@ -816,10 +1196,10 @@ void interpreter_interpret( Stack* stack )
 			stack_setLocalVariable( stack, index, value1 );
 			stack_setLocalVariable( stack, index+1, value2 );
 			logVerbose( "\tPopping long %lli from the stack, storing it to slot %i.\n", (int64)(((uint64)value1 << 32) | value2), index );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case FSTORE: /* u1, u1 (u1, u1, u2 using wide opcode); store float in local variable */
+		OPCODE( FSTORE ): /* u1, u1 (u1, u1, u2 using wide opcode); store float in local variable */
 		{	
 			pc++;
 			u1 index= *pc;
@@ -827,10 +1207,10 @@ void interpreter_interpret( Stack* stack )
 			uint32 value= stack_popSlot( stack );
 			stack_setLocalVariable( stack, index, value );
 			logVerbose( "\tPopping float %d from the stack, storing it to slot %i.\n", (float)value, index );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case DSTORE: /* u1, u1 (u1, u1, u2 using wide opcode); store double in local variable */
+		OPCODE( DSTORE ): /* u1, u1 (u1, u1, u2 using wide opcode); store double in local variable */
 		{	
 			pc++;
 			u1 index= *pc;
@@ -840,10 +1220,10 @@ void interpreter_interpret( Stack* stack )
 			stack_setLocalVariable( stack, index, value1 );
 			stack_setLocalVariable( stack, index+1, value2 );
 			logVerbose( "\tPopping double %d from the stack, storing it to slot %i.\n", (double)(((uint64)value1 << 32) | value2), index );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case ASTORE: /* u1, u1 (u1, u1, u2 if using wide opcode); store object reference in local variable */
+		OPCODE( ASTORE ): /* u1, u1 (u1, u1, u2 if using wide opcode); store object reference in local variable */
 		{	
 			pc++;
 			u1 index= *pc;
@@ -851,46 +1231,46 @@ void interpreter_interpret( Stack* stack )
 			uint32 value= stack_popSlot( stack );
 			stack_setLocalVariable( stack, index, value );
 			logVerbose( "\tPopping reference %i from the stack, storing it to slot %i.\n", value, index );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case ISTORE_0: /* u1; store integer in local variable 0 */
+		OPCODE( ISTORE_0 ): /* u1; store integer in local variable 0 */
 		{
 			pc++;
 			int32 value= stack_popSlot( stack );
 			stack_setLocalVariable( stack, 0, value );
 			logVerbose( "\tStoring integer %i from the stack into slot 0.\n", value );
-			break;
+			NEXT_OPCODE;
 		}
 					
-		case ISTORE_1: /* u1; store integer in local variable 1 */
+		OPCODE( ISTORE_1 ): /* u1; store integer in local variable 1 */
 		{
 			pc++;
 			int32 value= stack_popSlot( stack );
 			stack_setLocalVariable( stack, 1, value );
 			logVerbose( "\tStoring integer %i from the stack into slot 1.\n", value );
-			break;
+			NEXT_OPCODE;
 		}
 						
-		case ISTORE_2: /* u1; store integer in local variable 2 */
+		OPCODE( ISTORE_2 ): /* u1; store integer in local variable 2 */
 		{
 			pc++;
 			int32 value= stack_popSlot( stack );
 			stack_setLocalVariable( stack, 2, value );
 			logVerbose( "\tStoring integer %i from the stack into slot 2.\n", value );
-			break;
+			NEXT_OPCODE;
 		}
 							
-		case ISTORE_3: /* u1; store integer in local variable 3 */
+		OPCODE( ISTORE_3 ): /* u1; store integer in local variable 3 */
 		{
 			pc++;
 			int32 value= stack_popSlot( stack );
 			stack_setLocalVariable( stack, 3, value );
 			logVerbose( "\tStoring integer %i from the stack into slot 3.\n", value );
-			break;
+			NEXT_OPCODE;
 		}
 								
-		case LSTORE_0: /* u1; store long integer in local variable 0 */
+		OPCODE( LSTORE_0 ): /* u1; store long integer in local variable 0 */
 		{	
 			pc++;
 			uint32 value2= stack_popSlot( stack );
@@ -898,10 +1278,10 @@ void interpreter_interpret( Stack* stack )
 			stack_setLocalVariable( stack, 0, value1 );
 			stack_setLocalVariable( stack, 1, value2 );
 			logVerbose( "\tPopping long %lli from the stack, storing it to slot 0.\n", (int64)(((uint64)value1 << 32) | value2) );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case LSTORE_1: /* u1; store long integer in local variable 1 */
+		OPCODE( LSTORE_1 ): /* u1; store long integer in local variable 1 */
 		{	
 			pc++;
 			uint32 value2= stack_popSlot( stack );
@@ -909,10 +1289,10 @@ void interpreter_interpret( Stack* stack )
 			stack_setLocalVariable( stack, 1, value1 );
 			stack_setLocalVariable( stack, 2, value2 );
 			logVerbose( "\tPopping long %lli from the stack, storing it to slot 1.\n", (int64)(((uint64)value1 << 32) | value2) );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case LSTORE_2: /* u1; store long integer in local variable 2 */
+		OPCODE( LSTORE_2 ): /* u1; store long integer in local variable 2 */
 		{	
 			pc++;
 			uint32 value2= stack_popSlot( stack );
@@ -920,10 +1300,10 @@ void interpreter_interpret( Stack* stack )
 			stack_setLocalVariable( stack, 2, value1 );
 			stack_setLocalVariable( stack, 3, value2 );
 			logVerbose( "\tPopping long %lli from the stack, storing it to slot 2.\n", (int64)(((uint64)value1 << 32) | value2) );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case LSTORE_3: /* u1; store long integer in local variable 3 */
+		OPCODE( LSTORE_3 ): /* u1; store long integer in local variable 3 */
 		{	
 			pc++;
 			uint32 value2= stack_popSlot( stack );
@@ -931,46 +1311,46 @@ void interpreter_interpret( Stack* stack )
 			stack_setLocalVariable( stack, 3, value1 );
 			stack_setLocalVariable( stack, 4, value2 );
 			logVerbose( "\tPopping long %lli from the stack, storing it to slot 4.\n", (int64)(((uint64)value1 << 32) | value2) );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case FSTORE_0: /* u1; store float in local variable 0 */
+		OPCODE( FSTORE_0 ): /* u1; store float in local variable 0 */
 		{	
 			pc++;
 			uint32 value= stack_popSlot( stack );
 			stack_setLocalVariable( stack, 0, value );
 			logVerbose( "\tPopping float %d from the stack, storing it to slot 0.\n", (float)value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case FSTORE_1: /* u1; store float in local variable 1 */
+		OPCODE( FSTORE_1 ): /* u1; store float in local variable 1 */
 		{	
 			pc++;
 			uint32 value= stack_popSlot( stack );
 			stack_setLocalVariable( stack, 1, value );
 			logVerbose( "\tPopping float %d from the stack, storing it to slot 1.\n", (float)value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case FSTORE_2: /* u1; store float in local variable 2 */
+		OPCODE( FSTORE_2 ): /* u1; store float in local variable 2 */
 		{	
 			pc++;
 			uint32 value= stack_popSlot( stack );
 			stack_setLocalVariable( stack, 2, value );
 			logVerbose( "\tPopping float %d from the stack, storing it to slot 2.\n", (float)value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case FSTORE_3: /* u1; store float in local variable 3 */
+		OPCODE( FSTORE_3 ): /* u1; store float in local variable 3 */
 		{	
 			pc++;
 			uint32 value= stack_popSlot( stack );
 			stack_setLocalVariable( stack, 3, value );
 			logVerbose( "\tPopping float %d from the stack, storing it to slot 3.\n", (float)value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case DSTORE_0: /* u1; store double in local variable 0 */
+		OPCODE( DSTORE_0 ): /* u1; store double in local variable 0 */
 		{	
 			pc++;
 			uint32 value2= stack_popSlot( stack );
@@ -978,10 +1358,10 @@ void interpreter_interpret( Stack* stack )
 			stack_setLocalVariable( stack, 0, value1 );
 			stack_setLocalVariable( stack, 1, value2 );
 			logVerbose( "\tPopping double %d from the stack, storing it to slot 0.\n", (double)(((uint64)value1 << 32) | value2) );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case DSTORE_1: /* u1; store double in local variable 1 */
+		OPCODE( DSTORE_1 ): /* u1; store double in local variable 1 */
 		{	
 			pc++;
 			uint32 value2= stack_popSlot( stack );
@@ -989,10 +1369,10 @@ void interpreter_interpret( Stack* stack )
 			stack_setLocalVariable( stack, 1, value1 );
 			stack_setLocalVariable( stack, 2, value2 );
 			logVerbose( "\tPopping double %d from the stack, storing it to slot 1.\n", (double)(((uint64)value1 << 32) | value2) );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case DSTORE_2: /* u1; store double in local variable 2 */
+		OPCODE( DSTORE_2 ): /* u1; store double in local variable 2 */
 		{	
 			pc++;
 			uint32 value2= stack_popSlot( stack );
@@ -1000,10 +1380,10 @@ void interpreter_interpret( Stack* stack )
 			stack_setLocalVariable( stack, 2, value1 );
 			stack_setLocalVariable( stack, 3, value2 );
 			logVerbose( "\tPopping double %d from the stack, storing it to slot 2.\n", (double)(((uint64)value1 << 32) | value2) );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case DSTORE_3: /* u1; store double in local variable 3 */
+		OPCODE( DSTORE_3 ): /* u1; store double in local variable 3 */
 		{	
 			pc++;
 			uint32 value2= stack_popSlot( stack );
@@ -1011,47 +1391,47 @@ void interpreter_interpret( Stack* stack )
 			stack_setLocalVariable( stack, 3, value1 );
 			stack_setLocalVariable( stack, 4, value2 );
 			logVerbose( "\tPopping double %d from the stack, storing it to slot 3.\n", (double)(((uint64)value1 << 32) | value2) );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case ASTORE_0: /* u1; store object reference in local variable 0 */
+		OPCODE( ASTORE_0 ): /* u1; store object reference in local variable 0 */
 		{	
 			pc++;
 			uint32 value= stack_popSlot( stack );
 			stack_setLocalVariable( stack, 0, value );
 			logVerbose( "\tPopping reference %i from the stack, storing it to slot 0.\n", value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case ASTORE_1: /* u1; store object reference in local variable 1 */
+		OPCODE( ASTORE_1 ): /* u1; store object reference in local variable 1 */
 		{	
 			pc++;
 			uint32 value= stack_popSlot( stack );
 			stack_setLocalVariable( stack, 1, value );
 			logVerbose( "\tPopping reference %i from the stack, storing it to slot 1.\n", value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case ASTORE_2: /* u1; store object reference in local variable 2 */
+		OPCODE( ASTORE_2 ): /* u1; store object reference in local variable 2 */
 		{	
 			pc++;
 			uint32 value= stack_popSlot( stack );
 			stack_setLocalVariable( stack, 2, value );
 			logVerbose( "\tPopping reference %i from the stack, storing it to slot 2.\n", value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case ASTORE_3: /* u1; store object reference in local variable 3 */
+		OPCODE( ASTORE_3 ): /* u1; store object reference in local variable 3 */
 		{	
 			pc++;
 			uint32 value= stack_popSlot( stack );
 			stack_setLocalVariable( stack, 3, value );
 			logVerbose( "\tPopping reference %i from the stack, storing it to slot 3.\n", value );
-			break;
+			NEXT_OPCODE;
 		}
 			
 		/* working with arrays */
-		case BASTORE: /* u1; store in byte/boolean */
+		OPCODE( BASTORE ): /* u1; store in byte/boolean */
 		{
 			pc++;
 			
@@ -1068,10 +1448,10 @@ void interpreter_interpret( Stack* stack )
 			heap_setByteInArray( arRef, index, value );
 			
 			logVerbose( "\tSetting int %i in index %i of the array with reference %i.\n", value, index, arRef );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case CASTORE: /* u1; store in character array */
+		OPCODE( CASTORE ): /* u1; store in character array */
 		{
 			pc++;
 			
@@ -1088,10 +1468,10 @@ void interpreter_interpret( Stack* stack )
 			heap_setShortInArray( arRef, index, value );
 			
 			logVerbose( "\tSetting char %c in index %i of the array with reference %i.\n", (char)value, index, arRef );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case SASTORE: /* u1; store in short array */
+		OPCODE( SASTORE ): /* u1; store in short array */
 		{
 			pc++;
 			
@@ -1108,12 +1488,12 @@ void interpreter_interpret( Stack* stack )
 			heap_setShortInArray( arRef, index, value );
 			
 			logVerbose( "\tSetting int %i in index %i of the array with reference %i.\n", value, index, arRef );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case FASTORE: /* u1; store in single-precision float array */
-		case AASTORE: /* u1; store object reference in array */
-		case IASTORE: /* u1; store in integer array */
+		OPCODE( FASTORE ): /* u1; store in single-precision float array */
+		OPCODE( AASTORE ): /* u1; store object reference in array */
+		OPCODE( IASTORE ): /* u1; store in integer array */
 		{
 			pc++;
 			
@@ -1130,11 +1510,11 @@ void interpreter_interpret( Stack* stack )
 			heap_setSlotInArray( arRef, index, value );
 			
 			logVerbose( "\tSetting int %i in index %i of the array with reference %i.\n", value, index, arRef );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case LASTORE: /* u1; store in long integer array */
-		case DASTORE: /* u1; store in double-precision float array */
+		OPCODE( LASTORE ): /* u1; store in long integer array */
+		OPCODE( DASTORE ): /* u1; store in double-precision float array */
 		{
 			pc++;
 			
@@ -1151,31 +1531,31 @@ void interpreter_interpret( Stack* stack )
 			heap_setTwoSlotsInArray( arRef, index, value );
 			
 			logVerbose( "\tSetting int %i in index %i of the array with reference %i.\n", value, index, arRef );
-			break;
+			NEXT_OPCODE;
 		}
 			
 		/* stack managment */
-		case POP: /* u1; discard top item on stack */
+		OPCODE( POP ): /* u1; discard top item on stack */
 			pc++;
 			stack_popSlot( stack );
-			break;
+			NEXT_OPCODE;
 			
-		case POP2: /* u1; discard top two items on stack */
+		OPCODE( POP2 ): /* u1; discard top two items on stack */
 			pc++;
 			stack_popSlot( stack );
 			stack_popSlot( stack );
-			break;
+			NEXT_OPCODE;
 			
-		case DUP: /* u1; duplicate top single item on the stack */
+		OPCODE( DUP ): /* u1; duplicate top single item on the stack */
 		{
 			pc++;
 			int32 value= stack_popSlot( stack );
 			stack_pushSlot( stack, value );
 			stack_pushSlot( stack, value );
-			break;
+			NEXT_OPCODE;
 		}
 					
-		case DUP_X1: /* u1; duplicate top stack item and insert beneath second item */
+		OPCODE( DUP_X1 ): /* u1; duplicate top stack item and insert beneath second item */
 		{
 			pc++;
 			int32 value1= stack_popSlot( stack );
@@ -1183,10 +1563,10 @@ void interpreter_interpret( Stack* stack )
 			stack_pushSlot( stack, value1 );
 			stack_pushSlot( stack, value2 );
 			stack_pushSlot( stack, value1 );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case DUP_X2: /* u1; duplicate top stack item and insert beneath third item */
+		OPCODE( DUP_X2 ): /* u1; duplicate top stack item and insert beneath third item */
 		{
 			pc++;
 			int32 value1= stack_popSlot( stack );
@@ -1196,10 +1576,10 @@ void interpreter_interpret( Stack* stack )
 			stack_pushSlot( stack, value3 );
 			stack_pushSlot( stack, value2 );
 			stack_pushSlot( stack, value1 );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case DUP2: /* u1; duplicate top two stack items */
+		OPCODE( DUP2 ): /* u1; duplicate top two stack items */
 		{
 			pc++;
 			int32 value1= stack_popSlot( stack );
@@ -1208,10 +1588,10 @@ void interpreter_interpret( Stack* stack )
 			stack_pushSlot( stack, value1 );
 			stack_pushSlot( stack, value2 );
 			stack_pushSlot( stack, value1 );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case DUP2_X1: /* u1; duplicate two items and insert beneath third item */
+		OPCODE( DUP2_X1 ): /* u1; duplicate two items and insert beneath third item */
 		{
 			pc++;
 			int32 value1= stack_popSlot( stack );
@@ -1222,10 +1602,10 @@ void interpreter_interpret( Stack* stack )
 			stack_pushSlot( stack, value3 );
 			stack_pushSlot( stack, value2 );
 			stack_pushSlot( stack, value1 );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case DUP2_X2: /* u1; duplicate two items and insert beneath fourth item */
+		OPCODE( DUP2_X2 ): /* u1; duplicate two items and insert beneath fourth item */
 		{
 			pc++;
 			int32 value1= stack_popSlot( stack );
@@ -1238,21 +1618,21 @@ void interpreter_interpret( Stack* stack )
 			stack_pushSlot( stack, value3 );
 			stack_pushSlot( stack, value2 );
 			stack_pushSlot( stack, value1 );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case SWAP: /* u1; swap top two stack items */
+		OPCODE( SWAP ): /* u1; swap top two stack items */
 		{
 			pc++;
 			int32 value1= stack_popSlot( stack );
 			int32 value2= stack_popSlot( stack );
 			stack_pushSlot( stack, value1 );
 			stack_pushSlot( stack, value2 );
-			break;
+			NEXT_OPCODE;
 		}
 			
 		/* arithmetic operators */
-		case IADD: /* u1; add two integers */
+		OPCODE( IADD ): /* u1; add two integers */
 		{
 			pc++;
 			int32 value2= stack_popSlot( stack );
@@ -1260,10 +1640,10 @@ void interpreter_interpret( Stack* stack )
 			int32 result= value1 + value2;
 			stack_pushSlot( stack, result );
 			logVerbose( "\tAdding %i and %i, result is %i.\n", value1, value2, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case LADD: /* u1; add two long integers */
+		OPCODE( LADD ): /* u1; add two long integers */
 		{
 			pc++;
 			int64 value2= stack_popLong( stack );
@@ -1271,10 +1651,10 @@ void interpreter_interpret( Stack* stack )
 			int64 result= value1 + value2;
 			stack_pushLong( stack, result );
 			logVerbose( "\tAdding %i and %i, result is %i.\n", value1, value2, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case FADD: /* u1; add two floats */
+		OPCODE( FADD ): /* u1; add two floats */
 		{
 			pc++;
 			float value2= stack_popSlot( stack );
@@ -1282,10 +1662,10 @@ void interpreter_interpret( Stack* stack )
 			float result= value1 + value2;
 			stack_pushSlot( stack, result );
 			logVerbose( "\tAdding %d and %d, result is %d.\n", value1, value2, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case DADD: /* u1; add two doubles */
+		OPCODE( DADD ): /* u1; add two doubles */
 		{
 			pc++;
 			double value2= stack_popLong( stack );
@@ -1293,10 +1673,10 @@ void interpreter_interpret( Stack* stack )
 			double result= value1 + value2;
 			stack_pushLong( stack, result );
 			logVerbose( "\tAdding %d and %d, result is %d.\n", value1, value2, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case ISUB: /* u1; substract two integers */
+		OPCODE( ISUB ): /* u1; substract two integers */
 		{
 			pc++;
 			int32 value2= stack_popSlot( stack );
@@ -1304,10 +1684,10 @@ void interpreter_interpret( Stack* stack )
 			int32 result= value1 - value2;
 			stack_pushSlot( stack, result );
 			logVerbose( "\tSubtracting %i from %i, result is %i.\n", value2, value1, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case LSUB: /* u1; substract two long integers */
+		OPCODE( LSUB ): /* u1; substract two long integers */
 		{
 			pc++;
 			int64 value2= stack_popLong( stack );
@@ -1315,10 +1695,10 @@ void interpreter_interpret( Stack* stack )
 			int64 result= value1 - value2;
 			stack_pushLong( stack, result );
 			logVerbose( "\tSubtracting %i from %i, result is %i.\n", value2, value1, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case FSUB: /* u1; substract two floats */
+		OPCODE( FSUB ): /* u1; substract two floats */
 		{
 			pc++;
 			float value2= stack_popSlot( stack );
@@ -1326,10 +1706,10 @@ void interpreter_interpret( Stack* stack )
 			float result= value1 - value2;
 			stack_pushSlot( stack, result );
 			logVerbose( "\tSubtracting %d from %d, result is %d.\n", value2, value1, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case DSUB: /* u1; substract two doubles */
+		OPCODE( DSUB ): /* u1; substract two doubles */
 		{
 			pc++;
 			double value2= stack_popLong( stack );
@@ -1337,10 +1717,10 @@ void interpreter_interpret( Stack* stack )
 			double result= value1 - value2;
 			stack_pushLong( stack, result );
 			logVerbose( "\tSubtracting %d from %d, result is %d.\n", value2, value1, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case IMUL: /* u1; multiply two integers */
+		OPCODE( IMUL ): /* u1; multiply two integers */
 		{
 			pc++;
 			int32 value2= stack_popSlot( stack );
@@ -1348,10 +1728,10 @@ void interpreter_interpret( Stack* stack )
 			int32 result= value1 * value2;
 			stack_pushSlot( stack, result );
 			logVerbose( "\tMultiplying %i and %i, result is %i.\n", value1, value2, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case LMUL: /* u1; multiply two long integers */
+		OPCODE( LMUL ): /* u1; multiply two long integers */
 		{
 			pc++;
 			int64 value2= stack_popLong( stack );
@@ -1359,10 +1739,10 @@ void interpreter_interpret( Stack* stack )
 			int64 result= value1 * value2;
 			stack_pushLong( stack, result );
 			logVerbose( "\tMultiplying %i and %i, result is %i.\n", value1, value2, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case FMUL: /* u1; multiply two floats */
+		OPCODE( FMUL ): /* u1; multiply two floats */
 		{
 			pc++;
 			float value2= stack_popSlot( stack );
@@ -1370,10 +1750,10 @@ void interpreter_interpret( Stack* stack )
 			float result= value1 * value2;
 			stack_pushSlot( stack, result );
 			logVerbose( "\tMultiplying %d and %d, result is %d.\n", value1, value2, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case DMUL: /* u1; multiply two doubles */
+		OPCODE( DMUL ): /* u1; multiply two doubles */
 		{
 			pc++;
 			double value2= stack_popLong( stack );
@@ -1381,10 +1761,10 @@ void interpreter_interpret( Stack* stack )
 			double result= value1 * value2;
 			stack_pushLong( stack, result );
 			logVerbose( "\tMultiplying %d and %d, result is %d.\n", value1, value2, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case IDIV: /* u1; divides two integers */
+		OPCODE( IDIV ): /* u1; divides two integers */
 		{
 			pc++;
 			int32 value2= stack_popSlot( stack );
@@ -1396,10 +1776,10 @@ void interpreter_interpret( Stack* stack )
 			int32 result= value1 / value2;
 			stack_pushSlot( stack, result );
 			logVerbose( "\tDividing %i by %i, result is %i.\n", value1, value2, result );
-			break;
+			NEXT_OPCODE;
 		}
 
-		case LDIV: /* u1; divides two long integers */
+		OPCODE( LDIV ): /* u1; divides two long integers */
 		{
 			pc++;
 			int64 value2= stack_popLong( stack );
@@ -1411,10 +1791,10 @@ void interpreter_interpret( Stack* stack )
 			int64 result= value1 / value2;
 			stack_pushLong( stack, result );
 			logVerbose( "\tDividing %i by %i, result is %i.\n", value1, value2, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case FDIV: /* u1; divides two floats */
+		OPCODE( FDIV ): /* u1; divides two floats */
 		{
 			pc++;
 			float value2= stack_popSlot( stack );
@@ -1426,10 +1806,10 @@ void interpreter_interpret( Stack* stack )
 			float result= value1 / value2;
 			stack_pushSlot( stack, result );
 			logVerbose( "\tDividing %d by %d, result is %d.\n", value1, value2, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case DDIV: /* u1; divides two doubles */
+		OPCODE( DDIV ): /* u1; divides two doubles */
 		{
 			pc++;
 			double value2= stack_popLong( stack );
@@ -1441,10 +1821,10 @@ void interpreter_interpret( Stack* stack )
 			double result= value1 / value2;
 			stack_pushLong( stack, result );
 			logVerbose( "\tDividing %d by %d, result is %d.\n", value1, value2, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case IREM: /* u1; remainder of two integers */
+		OPCODE( IREM ): /* u1; remainder of two integers */
 		{
 			pc++;
 			int32 value2= stack_popSlot( stack );
@@ -1456,10 +1836,10 @@ void interpreter_interpret( Stack* stack )
 			int32 result= value1 % value2;
 			stack_pushSlot( stack, result );
 			logVerbose( "\tRemainder of %i divided by %i is %i.\n", value1, value2, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case LREM: /* u1; remainder of two long integers */
+		OPCODE( LREM ): /* u1; remainder of two long integers */
 		{
 			pc++;
 			int64 value2= stack_popLong( stack );
@@ -1471,10 +1851,10 @@ void interpreter_interpret( Stack* stack )
 			int64 result= value1 % value2;
 			stack_pushLong( stack, result );
 			logVerbose( "\tRemainder of %i divided by %i is %i.\n", value1, value2, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case FREM: /* u1; remainder of two floats */
+		OPCODE( FREM ): /* u1; remainder of two floats */
 		{
 			pc++;
 			float value2= stack_popSlot( stack );
@@ -1486,10 +1866,10 @@ void interpreter_interpret( Stack* stack )
 			float result= fmod( value1, value2 );
 			stack_pushSlot( stack, result );
 			logVerbose( "\tRemainder of %d divided by %d is %d.\n", value1, value2, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case DREM: /* u1; remainder of two doubles */
+		OPCODE( DREM ): /* u1; remainder of two doubles */
 		{
 			pc++;
 			double value2= stack_popLong( stack );
@@ -1501,43 +1881,43 @@ void interpreter_interpret( Stack* stack )
 			double result= fmod( value1, value2 );
 			stack_pushLong( stack, result );
 			logVerbose( "\tRemainder of %d divided by %d is %d.\n", value1, value2, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
 		/* logical operators */
-		case INEG: /* u1; negate a integer */
+		OPCODE( INEG ): /* u1; negate a integer */
 		{
 			pc++;
 			int32 value= stack_popSlot( stack );
 			stack_pushSlot( stack, -value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case LNEG: /* u1; negate a long integer */
+		OPCODE( LNEG ): /* u1; negate a long integer */
 		{
 			pc++;
 			int64 value= stack_popLong( stack );
 			stack_pushLong( stack, -value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case FNEG: /* u1; negate a float */
+		OPCODE( FNEG ): /* u1; negate a float */
 		{
 			pc++;
 			float value= stack_popSlot( stack );
 			stack_pushSlot( stack, -value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case DNEG: /* u1; negate a double */
+		OPCODE( DNEG ): /* u1; negate a double */
 		{
 			pc++;
 			double value= stack_popLong( stack );
 			stack_pushLong( stack, -value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case ISHL: /* u1; integer shift left */
+		OPCODE( ISHL ): /* u1; integer shift left */
 		{
 			pc++;
 			int32 value2= stack_popSlot( stack );
@@ -1549,10 +1929,10 @@ void interpreter_interpret( Stack* stack )
 			int32 result= value1 << value2;
 			stack_pushSlot( stack, result );
 			logVerbose( "\tShifting %i %i bits to the left. Result is %i.\n", value1, value2, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case LSHL: /* u1; long integer shift left */
+		OPCODE( LSHL ): /* u1; long integer shift left */
 		{
 			pc++;
 			int64 value2= stack_popLong( stack );
@@ -1564,10 +1944,10 @@ void interpreter_interpret( Stack* stack )
 			int32 result= value1 << value2;
 			stack_pushLong( stack, result );
 			logVerbose( "\tShifting %i %i bits to the left. Result is %i.\n", value1, value2, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case ISHR: /* u1; integer arithmetic shift right */
+		OPCODE( ISHR ): /* u1; integer arithmetic shift right */
 		{
 			pc++;
 			int32 value2= stack_popSlot( stack );
@@ -1579,10 +1959,10 @@ void interpreter_interpret( Stack* stack )
 			int32 result= value1 >> value2;
 			stack_pushSlot( stack, result );
 			logVerbose( "\tShifting %i %i bits to the right. Result is %i.\n", value1, value2, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case LSHR: /* u1; long integer arithmetic shift right */
+		OPCODE( LSHR ): /* u1; long integer arithmetic shift right */
 		{
 			pc++;
 			int64 value2= stack_popLong( stack );
@@ -1594,10 +1974,10 @@ void interpreter_interpret( Stack* stack )
 			int64 result= value1 >> value2;
 			stack_pushLong( stack, result );
 			logVerbose( "\tShifting %i %i bits to the right. Result is %i.\n", value1, value2, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case IUSHR: /* u1; integer logical shift right */
+		OPCODE( IUSHR ): /* u1; integer logical shift right */
 		{
 			pc++;
 			uint32 value2= stack_popSlot( stack );
@@ -1609,10 +1989,10 @@ void interpreter_interpret( Stack* stack )
 			uint32 result= value1 >> value2;
 			stack_pushSlot( stack, result );
 			logVerbose( "\tShifting %i %i bits to the right without sign extension. Result is %i.\n", value1, value2, result );
-			break;
+			NEXT_OPCODE;
 		}
 
-		case LUSHR: /* u1; long integer logical shift right */
+		OPCODE( LUSHR ): /* u1; long integer logical shift right */
 		{
 			pc++;
 			uint64 value2= stack_popLong( stack );
@@ -1624,10 +2004,10 @@ void interpreter_interpret( Stack* stack )
 			uint64 result= value1 >> value2;
 			stack_pushLong( stack, result );
 			logVerbose( "\tShifting %i %i bits to the right without sign extension. Result is %i.\n", value1, value2, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case IAND: /* u1; integer bitwise and */
+		OPCODE( IAND ): /* u1; integer bitwise and */
 		{
 			pc++;
 			uint32 value2= stack_popSlot( stack );
@@ -1636,10 +2016,10 @@ void interpreter_interpret( Stack* stack )
 			uint32 result= value1 & value2;
 			stack_pushSlot( stack, result );
 			logVerbose( "\tPerforming bitwise AND with %i and %i. Result is %i.\n", value1, value2, result );
-			break;
+			NEXT_OPCODE;
 		}
 
-		case LAND: /* u1; long integer bitwise and */
+		OPCODE( LAND ): /* u1; long integer bitwise and */
 		{
 			pc++;
 			uint64 value2= stack_popLong( stack );
@@ -1648,10 +2028,10 @@ void interpreter_interpret( Stack* stack )
 			uint64 result= value1 & value2;
 			stack_pushLong( stack, result );
 			logVerbose( "\tPerforming bitwise AND with %i and %i. Result is %i.\n", value1, value2, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case IOR: /* u1; integer bitwise or */
+		OPCODE( IOR ): /* u1; integer bitwise or */
 		{
 			pc++;
 			uint32 value2= stack_popSlot( stack );
@@ -1660,10 +2040,10 @@ void interpreter_interpret( Stack* stack )
 			uint32 result= value1 | value2;
 			stack_pushSlot( stack, result );
 			logVerbose( "\tPerforming bitwise OR with %i and %i. Result is %i.\n", value1, value2, result );
-			break;
+			NEXT_OPCODE;
 		}
 
-		case LOR: /* u1; long integer bitwise or */
+		OPCODE( LOR ): /* u1; long integer bitwise or */
 		{
 			pc++;
 			uint64 value2= stack_popLong( stack );
@@ -1672,10 +2052,10 @@ void interpreter_interpret( Stack* stack )
 			uint64 result= value1 | value2;
 			stack_pushLong( stack, result );
 			logVerbose( "\tPerforming bitwise OR with %i and %i. Result is %i.\n", value1, value2, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case IXOR: /* u1; integer bitwise exclusive or */
+		OPCODE( IXOR ): /* u1; integer bitwise exclusive or */
 		{
 			pc++;
 			uint32 value2= stack_popSlot( stack );
@@ -1684,10 +2064,10 @@ void interpreter_interpret( Stack* stack )
 			uint32 result= value1 ^ value2;
 			stack_pushSlot( stack, result );
 			logVerbose( "\tPerforming bitwise XOR with %i and %i. Result is %i.\n", value1, value2, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case LXOR: /* u1; long integer bitwise exclusive or */
+		OPCODE( LXOR ): /* u1; long integer bitwise exclusive or */
 		{
 			pc++;
 			uint64 value2= stack_popLong( stack );
@@ -1696,11 +2076,11 @@ void interpreter_interpret( Stack* stack )
 			uint64 result= value1 ^ value2;
 			stack_pushLong( stack, result );
 			logVerbose( "\tPerforming bitwise XOR with %i and %i. Result is %i.\n", value1, value2, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
 		/* arithmetic again */
-		case IINC: /* u1, u1, s1 (u1, u1, u2, s2 using wide opcode); increment integer in local variable */
+		OPCODE( IINC ): /* u1, u1, s1 (u1, u1, u2, s2 using wide opcode); increment integer in local variable */
 		{
 			pc++;
 			uint8 index= *pc;
@@ -1710,132 +2090,132 @@ void interpreter_interpret( Stack* stack )
 			
 			stack_setLocalVariable( stack, index, stack_getLocalVariable(stack,index)+constValue );
 			logVerbose( "\tIncrementing local variable %i by %i. Value is %i now.\n", index, constValue, stack_getLocalVariable(stack,index) );
-			break;
+			NEXT_OPCODE;
 		}
 			
 		/* converting */
-		case I2L: /* u1; convert integer to long integer */
+		OPCODE( I2L ): /* u1; convert integer to long integer */
 		{
 			pc++;
 			int32 value= stack_popSlot( stack );
 			stack_pushLong( stack, (int64)value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case I2F: /* u1; convert integer to float */
+		OPCODE( I2F ): /* u1; convert integer to float */
 		{
 			pc++;
 			uint32 value= stack_popSlot( stack );
 			stack_pushFloat( stack, (float)value );
-			break;
+			NEXT_OPCODE;
 		}
 
-		case I2D: /* u1; convert integer to double */
+		OPCODE( I2D ): /* u1; convert integer to double */
 		{
 			pc++;
 			uint32 value= stack_popSlot( stack );
 			stack_pushDouble( stack, (double)value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case L2I: /* u1; convert long integer to integer */
+		OPCODE( L2I ): /* u1; convert long integer to integer */
 		{
 			pc++;
 			int64 value= stack_popLong( stack );
 			stack_pushSlot( stack, (int32)value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case L2F: /* u1; convert long integer to float */
+		OPCODE( L2F ): /* u1; convert long integer to float */
 		{
 			pc++;
 			int64 value= stack_popLong( stack );
 			stack_pushFloat( stack, (float)value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case L2D: /* u1; convert long integer to double */
+		OPCODE( L2D ): /* u1; convert long integer to double */
 		{
 			pc++;
 			int64 value= stack_popLong( stack );
 			stack_pushDouble( stack, (double)value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case F2I: /* u1; convert float to integer */
+		OPCODE( F2I ): /* u1; convert float to integer */
 		{
 			pc++;
 			float value= stack_popFloat( stack );
 			stack_pushSlot( stack, (int32)value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case F2L: /* u1; convert float to long integer */
+		OPCODE( F2L ): /* u1; convert float to long integer */
 		{
 			pc++;
 			float value= stack_popFloat( stack );
 			stack_pushLong( stack, (int64)value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case F2D: /* u1; convert float to double */
+		OPCODE( F2D ): /* u1; convert float to double */
 		{
 			pc++;
 			float value= stack_popFloat( stack );
 			stack_pushDouble( stack, (double)value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case D2I: /* u1; convert double to integer */
+		OPCODE( D2I ): /* u1; convert double to integer */
 		{
 			pc++;
 			double value= stack_popDouble( stack );
 			stack_pushSlot( stack, (int32)value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case D2L: /* u1; convert double to long integer */
+		OPCODE( D2L ): /* u1; convert double to long integer */
 		{
 			pc++;
 			double value= stack_popDouble( stack );
 			stack_pushLong( stack, (int64)value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case D2F: /* u1; convert double to float */
+		OPCODE( D2F ): /* u1; convert double to float */
 		{
 			pc++;
 			double value= stack_popDouble( stack );
 			stack_pushFloat( stack, (float)value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case I2B: /* u1; convert integer to byte */
+		OPCODE( I2B ): /* u1; convert integer to byte */
 		{
 			pc++;
 			int32 value= stack_popSlot( stack );
 			stack_pushByte( stack, (int8)value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case I2C: /* u1; convert integer to char */
+		OPCODE( I2C ): /* u1; convert integer to char */
 		{
 			pc++;
 			int32 value= stack_popSlot( stack );
 			stack_pushChar( stack, (uint16)value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case I2S: /* u1; convert integer to short */
+		OPCODE( I2S ): /* u1; convert integer to short */
 		{
 			pc++;
 			int32 value= stack_popSlot( stack );
 			stack_pushShort( stack, (int16)value );
-			break;
+			NEXT_OPCODE;
 		}
 			
 		/* comparison */
-		case LCMP: /* u1; long integer comparison */
+		OPCODE( LCMP ): /* u1; long integer comparison */
 		{
 			pc++;
 			int64 value2= stack_popLong( stack );
@@ -1844,10 +2224,10 @@ void interpreter_interpret( Stack* stack )
 			/* v1 > v2 = 1; v1 < v2 = -1; v1 == v2 = 0 */ 
 			int32 result= value1 > value2 ? 1 : value1 < value2 ? -1 : 0;
 			stack_pushSlot( stack, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case FCMPL: /* u1; single precision float comparison (-1 on NaN) */
+		OPCODE( FCMPL ): /* u1; single precision float comparison (-1 on NaN) */
 		{
 			pc++;
 			float value2= stack_popFloat( stack );
@@ -1857,10 +2237,10 @@ void interpreter_interpret( Stack* stack )
 			/* TODO: Do we correctly recognize NaN this way? */
 			int32 result= value1 > value2 ? 1 : value1 < value2 ? -1 : value1 == value2 ? 0 : -1;
 			stack_pushSlot( stack, result );
-			break;
+			NEXT_OPCODE;
 		}
 
-		case FCMPG: /* u1; single precision float comparison (1 on NaN) */
+		OPCODE( FCMPG ): /* u1; single precision float comparison (1 on NaN) */
 		{
 			pc++;
 			float value2= stack_popFloat( stack );
@@ -1870,10 +2250,10 @@ void interpreter_interpret( Stack* stack )
 			/* TODO: Do we correctly recognize NaN this way? */
 			int32 result= value1 > value2 ? 1 : value1 < value2 ? -1 : value1 == value2 ? 0 : 1;
 			stack_pushSlot( stack, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case DCMPL: /* u1; comapre two doubles (-1 on NaN) */
+		OPCODE( DCMPL ): /* u1; comapre two doubles (-1 on NaN) */
 		{
 			pc++;
 			double value2= stack_popDouble( stack );
@@ -1883,10 +2263,10 @@ void interpreter_interpret( Stack* stack )
 			/* TODO: Do we correctly recognize NaN this way? */
 			int32 result= value1 > value2 ? 1 : value1 < value2 ? -1 : value1 == value2 ? 0 : -1;
 			stack_pushSlot( stack, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case DCMPG: /* u1; compare two doubles (1 on NaN) */
+		OPCODE( DCMPG ): /* u1; compare two doubles (1 on NaN) */
 		{
 			pc++;
 			double value2= stack_popDouble( stack );
@@ -1896,11 +2276,11 @@ void interpreter_interpret( Stack* stack )
 			/* TODO: Do we correctly recognize NaN this way? */
 			int32 result= value1 > value2 ? 1 : value1 < value2 ? -1 : value1 == value2 ? 0 : 1;
 			stack_pushSlot( stack, result );
-			break;
+			NEXT_OPCODE;
 		}
 			
 		/* conditional branching (jumps) */
-		case IFEQ: /* u1, s2; jump if zero */
+		OPCODE( IFEQ ): /* u1, s2; jump if zero */
 		{
 			pc++;
 			int32 value= stack_popSlot( stack ); 
@@ -1910,24 +2290,18 @@ void interpreter_interpret( Stack* stack )
 			{
 				pc+= 2;
 				logVerbose( "Value is %i, do NOT branch.\n", value );
-				break;
+				NEXT_OPCODE;
 			}
 			
 			/* value equals 0, branch to target address */
-			uint8 branchByte1= *pc;
-			pc++;
-			uint8 branchByte2= *pc;
-			pc++;
+			uint16 branchTarget= opcode_readU2( pc );
+			BRANCH( branchTarget );
 			
-			int16 branchOffset= (branchByte1 << 8) | branchByte2;
-			pc-= 3; /* rewind pc to the original opcode address */
-			pc+= branchOffset;
-			
-			logVerbose( "Value is 0, branch to offset %i.\n", branchOffset );
-			break;
+			logVerbose( "Value is 0, branch to pc %i.\n", branchTarget );
+			NEXT_OPCODE;
 		}
 			
-		case IFNE: /* u1, s2; jump if non zero */
+		OPCODE( IFNE ): /* u1, s2; jump if non zero */
 		{
 			pc++;
 			int32 value= stack_popSlot( stack ); 
@@ -1937,24 +2311,18 @@ void interpreter_interpret( Stack* stack )
 			{
 				pc+= 2;
 				logVerbose( "\tValue is %i, do NOT branch.\n", value );
-				break;
+				NEXT_OPCODE;
 			}
 			
 			/* value does not equal 0, branch to target address */
-			uint8 branchByte1= *pc;
-			pc++;
-			uint8 branchByte2= *pc;
-			pc++;
+			uint16 branchTarget= opcode_readU2( pc );
+			BRANCH( branchTarget );
 			
-			int16 branchOffset= (branchByte1 << 8) | branchByte2;
-			pc-= 3; /* rewind pc to the original opcode address */
-			pc+= branchOffset;
-			
-			logVerbose( "\tValue is %i, branch to offset %i.\n", value, branchOffset );
-			break;
+			logVerbose( "\tValue is %i, branch to pc %i.\n", value, branchTarget );
+			NEXT_OPCODE;
 		}
 			
-		case IFLT: /* u1, s2; jump if less than zero */
+		OPCODE( IFLT ): /* u1, s2; jump if less than zero */
 		{
 			pc++;
 			int32 value= stack_popSlot( stack ); 
@@ -1964,24 +2332,18 @@ void interpreter_interpret( Stack* stack )
 			{
 				pc+= 2;
 				logVerbose( "Value is %i, do NOT branch.\n", value );
-				break;
+				NEXT_OPCODE;
 			}
 			
 			/* value is less than 0, branch to target address */
-			uint8 branchByte1= *pc;
-			pc++;
-			uint8 branchByte2= *pc;
-			pc++;
-			
-			int16 branchOffset= (branchByte1 << 8) | branchByte2;
-			pc-= 3; /* rewind pc to the original opcode address */
-			pc+= branchOffset;
+			uint16 branchTarget= opcode_readU2( pc );
+			BRANCH( branchTarget );
 			
-			logVerbose( "Value is %i, branch to offset %i.\n", value, branchOffset );
-			break;
+			logVerbose( "Value is %i, branch to pc %i.\n", value, branchTarget );
+			NEXT_OPCODE;
 		}
 			
-		case IFGE: /* u1, s2; jump if greater than or equal to zero */
+		OPCODE( IFGE ): /* u1, s2; jump if greater than or equal to zero */
 		{
 			pc++;
 			int32 value= stack_popSlot( stack ); 
@@ -1991,24 +2353,18 @@ void interpreter_interpret( Stack* stack )
 			{
 				pc+= 2;
 				logVerbose( "Value is %i, do NOT branch.\n", value );
-				break;
+				NEXT_OPCODE;
 			}
 			
 			/* value is greater than or equal to 0, branch to target address */
-			uint8 branchByte1= *pc;
-			pc++;
-			uint8 branchByte2= *pc;
-			pc++;
-			
-			int16 branchOffset= (branchByte1 << 8) | branchByte2;
-			pc-= 3; /* rewind pc to the original opcode address */
-			pc+= branchOffset;
+			uint16 branchTarget= opcode_readU2( pc );
+			BRANCH( branchTarget );
 			
-			logVerbose( "Value is %i, branch to offset %i.\n", value, branchOffset );
-			break;
+			logVerbose( "Value is %i, branch to pc %i.\n", value, branchTarget );
+			NEXT_OPCODE;
 		}
 			
-		case IFGT: /* u1, s2; jump if greater than zero */
+		OPCODE( IFGT ): /* u1, s2; jump if greater than zero */
 		{
 			pc++;
 			int32 value= stack_popSlot( stack ); 
@@ -2018,24 +2374,18 @@ void interpreter_interpret( Stack* stack )
 			{
 				pc+= 2;
 				logVerbose( "Value is %i, do NOT branch.\n", value );
-				break;
+				NEXT_OPCODE;
 			}
 			
 			/* value is greater than 0, branch to target address */
-			uint8 branchByte1= *pc;
-			pc++;
-			uint8 branchByte2= *pc;
-			pc++;
-			
-			int16 branchOffset= (branchByte1 << 8) | branchByte2;
-			pc-= 3; /* rewind pc to the original opcode address */
-			pc+= branchOffset;
+			uint16 branchTarget= opcode_readU2( pc );
+			BRANCH( branchTarget );
 			
-			logVerbose( "Value is %i, branch to offset %i.\n", value, branchOffset );
-			break;
+			logVerbose( "Value is %i, branch to pc %i.\n", value, branchTarget );
+			NEXT_OPCODE;
 		}
 			
-		case IFLE: /* u1, s2; jump if less than or equal to zero */
+		OPCODE( IFLE ): /* u1, s2; jump if less than or equal to zero */
 		{
 			pc++;
 			int32 value= stack_popSlot( stack ); 
@@ -2045,24 +2395,18 @@ void interpreter_interpret( Stack* stack )
 			{
 				pc+= 2;
 				logVerbose( "Value is %i, do NOT branch.\n", value );
-				break;
+				NEXT_OPCODE;
 			}
 			
 			/* value is less than or equal to 0, branch to target address */
-			uint8 branchByte1= *pc;
-			pc++;
-			uint8 branchByte2= *pc;
-			pc++;
-			
-			int16 branchOffset= (branchByte1 << 8) | branchByte2;
-			pc-= 3; /* rewind pc to the original opcode address */
-			pc+= branchOffset;
+			uint16 branchTarget= opcode_readU2( pc );
+			BRANCH( branchTarget );
 			
-			logVerbose( "Value is %i, branch to offset %i.\n", value, branchOffset );
-			break;
+			logVerbose( "Value is %i, branch to pc %i.\n", value, branchTarget );
+			NEXT_OPCODE;
 		}
 			
-		case IF_ICMPEQ: /* u1, s2; jump if two integers are equal */
+		OPCODE( IF_ICMPEQ ): /* u1, s2; jump if two integers are equal */
 		{
 			pc++;
 			
@@ -2072,26 +2416,20 @@ void interpreter_interpret( Stack* stack )
 			/* if v1 equals v2, branch and continue execution there */
 			if( value1 == value2 )
 			{
-				uint8 branchByte1= *pc;
-				pc++;
-				uint8 branchByte2= *pc;
-				pc++;
-				
-				int16 branchOffset= (branchByte1 << 8) | branchByte2;
-				pc-= 3; /* rewind pc to the original opcode address */
-				pc+= branchOffset;
+				uint16 branchTarget= opcode_readU2( pc );
+				BRANCH( branchTarget );
 				
-				logVerbose( "\tValue1 %i and value2 %i are equal, branch to offset %i.\n", value1, value2, branchOffset );
-				break;
+				logVerbose( "\tValue1 %i and value2 %i are equal, branch to pc %i.\n", value1, value2, branchTarget );
+				NEXT_OPCODE;
 			}
 			
 			/* do not branch and simply continue */
 			pc+= 2;
 			logVerbose( "\tValue1 %i and value2 %i are not equal, do NOT branch.\n", value1, value2 );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case IF_ICMPNE: /* u1, s2; jump if two integers are not equal */
+		OPCODE( IF_ICMPNE ): /* u1, s2; jump if two integers are not equal */
 		{
 			pc++;
 			
@@ -2101,26 +2439,20 @@ void interpreter_interpret( Stack* stack )
 			/* if v1 does not equal v2, branch and continue execution there */
 			if( value1 != value2 )
 			{
-				uint8 branchByte1= *pc;
-				pc++;
-				uint8 branchByte2= *pc;
-				pc++;
+				uint16 branchTarget= opcode_readU2( pc );
+				BRANCH( branchTarget );
 				
-				int16 branchOffset= (branchByte1 << 8) | branchByte2;
-				pc-= 3; /* rewind pc to the original opcode address */
-				pc+= branchOffset;
-				
-				logVerbose( "\tValue1 %i and value2 %i are not equal, branch to offset %i.\n", value1, value2, branchOffset );
-				break;
+				logVerbose( "\tValue1 %i and value2 %i are not equal, branch to pc %i.\n", value1, value2, branchTarget );
+				NEXT_OPCODE;
 			}
 			
 			/* do not branch and simply continue */
 			pc+= 2;
 			logVerbose( "\tValue1 %i and value2 %i are equal, do NOT branch.\n", value1, value2 );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case IF_ICMPLT: /* u1, s2; jump if one integer is less than another */
+		OPCODE( IF_ICMPLT ): /* u1, s2; jump if one integer is less than another */
 		{
 			pc++;
 			
@@ -2130,26 +2462,20 @@ void interpreter_interpret( Stack* stack )
 			/* if v1 is less than v2, branch and continue execution there */
 			if( value1 < value2 )
 			{
-				uint8 branchByte1= *pc;
-				pc++;
-				uint8 branchByte2= *pc;
-				pc++;
+				uint16 branchTarget= opcode_readU2( pc );
+				BRANCH( branchTarget );
 				
-				int16 branchOffset= (branchByte1 << 8) | branchByte2;
-				pc-= 3; /* rewind pc to the original opcode address */
-				pc+= branchOffset;
-				
-				logVerbose( "\tValue1 %i is less than value2 %i, branch to offset %i.\n", value1, value2, branchOffset );
-				break;
+				logVerbose( "\tValue1 %i is less than value2 %i, branch to pc %i.\n", value1, value2, branchTarget );
+				NEXT_OPCODE;
 			}
 			
 			/* do not branch and simply continue */
 			pc+= 2;
 			logVerbose( "\tValue1 %i is not less than value2 %i, do NOT branch.\n", value1, value2 );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case IF_ICMPGE: /* u1, s2; jump if one integer is greater than or equal to another */
+		OPCODE( IF_ICMPGE ): /* u1, s2; jump if one integer is greater than or equal to another */
 		{
 			pc++;
 			
@@ -2159,26 +2485,20 @@ void interpreter_interpret( Stack* stack )
 			/* if v1 is greater than or equal v2, branch and continue execution there */
 			if( value1 >= value2 )
 			{
-				uint8 branchByte1= *pc;
-				pc++;
-				uint8 branchByte2= *pc;
-				pc++;
-				
-				int16 branchOffset= (branchByte1 << 8) | branchByte2;
-				pc-= 3; /* rewind pc to the original opcode address */
-				pc+= branchOffset;
+				uint16 branchTarget= opcode_readU2( pc );
+				BRANCH( branchTarget );
 				
-				logVerbose( "\tValue1 %i is greater than or equal value2 %i, branch to offset %i.\n", value1, value2, branchOffset );
-				break;
+				logVerbose( "\tValue1 %i is greater than or equal value2 %i, branch to pc %i.\n", value1, value2, branchTarget );
+				NEXT_OPCODE;
 			}
 			
 			/* do not branch and simply continue */
 			pc+= 2;
 			logVerbose( "\tValue1 %i is not greater than or equal value2 %i, do NOT branch.\n", value1, value2 );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case IF_ICMPGT: /* u1, s2; jump if one integer is greater than another */
+		OPCODE( IF_ICMPGT ): /* u1, s2; jump if one integer is greater than another */
 		{
 			pc++;
 			
@@ -2188,26 +2508,20 @@ void interpreter_interpret( Stack* stack )
 			/* if v1 is greater than v2, branch and continue execution there */
 			if( value1 > value2 )
 			{
-				uint8 branchByte1= *pc;
-				pc++;
-				uint8 branchByte2= *pc;
-				pc++;
-				
-				int16 branchOffset= (branchByte1 << 8) | branchByte2;
-				pc-= 3; /* rewind pc to the original opcode address */
-				pc+= branchOffset;
+				uint16 branchTarget= opcode_readU2( pc );
+				BRANCH( branchTarget );
 				
-				logVerbose( "\tValue1 %i is greater than value2 %i, branch to offset %i.\n", value1, value2, branchOffset );
-				break;
+				logVerbose( "\tValue1 %i is greater than value2 %i, branch to pc %i.\n", value1, value2, branchTarget );
+				NEXT_OPCODE;
 			}
 			
 			/* do not branch and simply continue */
 			pc+= 2;
 			logVerbose( "\tValue1 %i is not greater than value2 %i, do NOT branch.\n", value1, value2 );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case IF_ICMPLE: /* u1, s2; jump if one integer is less than or equal to another */
+		OPCODE( IF_ICMPLE ): /* u1, s2; jump if one integer is less than or equal to another */
 		{
 			pc++;
 			
@@ -2217,26 +2531,20 @@ void interpreter_interpret( Stack* stack )
 			/* if v1 is less than or equal v2, branch and continue execution there */
 			if( value1 <= value2 )
 			{
-				uint8 branchByte1= *pc;
-				pc++;
-				uint8 branchByte2= *pc;
-				pc++;
-				
-				int16 branchOffset= (branchByte1 << 8) | branchByte2;
-				pc-= 3; /* rewind pc to the original opcode address */
-				pc+= branchOffset;
+				uint16 branchTarget= opcode_readU2( pc );
+				BRANCH( branchTarget );
 				
-				logVerbose( "\tValue1 %i is less than or equal value2 %i, branch to offset %i.\n", value1, value2, branchOffset );
-				break;
+				logVerbose( "\tValue1 %i is less than or equal value2 %i, branch to pc %i.\n", value1, value2, branchTarget );
+				NEXT_OPCODE;
 			}
 			
 			/* do not branch and simply continue */
 			pc+= 2;
 			logVerbose( "\tValue1 %i is not less than or equal value2 %i, do NOT branch.\n", value1, value2 );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case IF_ACMPEQ: /* u1, s2; jump if two object references are equal */
+		OPCODE( IF_ACMPEQ ): /* u1, s2; jump if two object references are equal */
 		{
 			pc++;
 			
@@ -2246,26 +2554,20 @@ void interpreter_interpret( Stack* stack )
 			/* if v1 equals v2, branch and continue execution there */
 			if( value1 == value2 )
 			{
-				uint8 branchByte1= *pc;
-				pc++;
-				uint8 branchByte2= *pc;
-				pc++;
-				
-				int16 branchOffset= (branchByte1 << 8) | branchByte2;
-				pc-= 3; /* rewind pc to the original opcode address */
-				pc+= branchOffset;
+				uint16 branchTarget= opcode_readU2( pc );
+				BRANCH( branchTarget );
 				
-				logVerbose( "\tReference 1 (%i) and reference 2 (%i) are equal, branch to offset %i.\n", value1, value2, branchOffset );
-				break;
+				logVerbose( "\tReference 1 (%i) and reference 2 (%i) are equal, branch to pc %i.\n", value1, value2, branchTarget );
+				NEXT_OPCODE;
 			}
 			
 			/* do not branch and simply continue */
 			pc+= 2;
 			logVerbose( "\tReference 1 (%i) and reference 2 (%i) are not equal, do NOT branch.\n", value1, value2 );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case IF_ACMPNE: /* u1, s2; jump if two object references are not equal */
+		OPCODE( IF_ACMPNE ): /* u1, s2; jump if two object references are not equal */
 		{
 			pc++;
 			
@@ -2275,227 +2577,117 @@ void interpreter_interpret( Stack* stack )
 			/* if v1 does not equal v2, branch and continue execution there */
 			if( value1 != value2 )
 			{
-				uint8 branchByte1= *pc;
-				pc++;
-				uint8 branchByte2= *pc;
-				pc++;
+				uint16 branchTarget= opcode_readU2( pc );
+				BRANCH( branchTarget );
 				
-				int16 branchOffset= (branchByte1 << 8) | branchByte2;
-				pc-= 3; /* rewind pc to the original opcode address */
-				pc+= branchOffset;
-				
-				logVerbose( "\tReference 1 (%i) and reference 2 (%i) are not equal, branch to offset %i.\n", value1, value2, branchOffset );
-				break;
+				logVerbose( "\tReference 1 (%i) and reference 2 (%i) are not equal, branch to pc %i.\n", value1, value2, branchTarget );
+				NEXT_OPCODE;
 			}
 			
 			/* do not branch and simply continue */
 			pc+= 2;
 			logVerbose( "\tReference 1 (%i) and reference 2 (%i) are equal, do NOT branch.\n", value1, value2 );
-			break;
+			NEXT_OPCODE;
 		}
 			
 		/* non-conditional branching (simple jumps) */
-		case GOTO: /* u1, s2; branch to address */
+		OPCODE( GOTO ): /* u1, s2; branch to address */
 		{
 			pc++;
-			uint8 branchByte1= *pc;
-			pc++;
-			uint8 branchByte2= *pc;
-			pc++;
+			uint16 branchTarget= opcode_readU2( pc );
+			BRANCH( branchTarget );
 			
-			int16 branchOffset= (branchByte1 << 8) | branchByte2;
-			pc-= 3; /* rewind pc to the original opcode address */
-			pc+= branchOffset;
-			
-			logVerbose( "\tBranching to offset %i.\n", branchOffset );
-			break;
+			logVerbose( "\tBranching to pc %i.\n", branchTarget );
+			NEXT_OPCODE;
 		}
 			
-		case JSR: /* u1, s2; jump subroutine */
+		OPCODE( JSR ): /* u1, s2; jump subroutine */
 		{
-			pc++;
-			uint8 branchByte1= *pc;
-			pc++;
-			uint8 branchByte2= *pc;
-			pc++;
-
+			uint16 branchTarget= opcode_readU2( pc+1 );
+			pc+= 3;
+			
 			/* push the current pc, which points to the following opcode now, onto the stack */
 			/* Note: We're pushing a full address with the size of a pointer of the host system onto the stack. So make sure the slot size is greater than or equal the size
 				of a native pointer. */
 			stack_pushSlot( stack, (uint32)pc );
 			
-			int16 branchOffset= (branchByte1 << 8) | branchByte2;
-			pc-= 3; /* rewind pc to the original opcode address */
-			pc+= branchOffset;
-			break;
+			pc= code + branchTarget;
+			NEXT_OPCODE;
 		}
 			
-		case RET: /* u1, u1 (u1, u1, u2 using wide opcode); return from subroutine */
+		OPCODE( RET ): /* u1, u1 (u1, u1, u2 using wide opcode); return from subroutine */
 		{
 			pc++;
 			uint8 index= *pc;
 			pc= (byte*)stack_getLocalVariable(stack, index); /* Restore stored pc. Note that this is a native pointer! */			
-			break;
+			NEXT_OPCODE;
 		}
 			
 		/* switch statements */
-		case TABLESWITCH: /* u1, ...; jump according to a table */
+		OPCODE( TABLESWITCH ): /* u1, ...; jump according to a table */
 		{
-			/* remember opcode start and calculate 4 byte boundary padding */
-			byte* opcodeStart= pc;
-			pc++;
-			int padding= (pc - sf->methodInfo->code->code) % 4;
-			pc+= padding;
+			/* The operands are 4 byte aligned relative to the start of the code. They're native-endian and the branch targets are absolute (see
+				opcode_predecode()), so the table is indexed directly: default target, low, high and the targets from low to high. */
+			const int32* operands= (const int32*)(code + ((pc - code + 4) & ~3));
 			
 			/* get index from stack */
 			int32 index= stack_popSlot( stack );
-			
-			/* read default, low and high */
-			uint8 defaultByte1= *pc;
-			pc++;
-			uint8 defaultByte2= *pc;
-			pc++;
-			uint8 defaultByte3= *pc;
-			pc++;
-			uint8 defaultByte4= *pc;
-			pc++;
-			int32 defaultOffset= (defaultByte1 << 24) | (defaultByte2 << 16) | (defaultByte3 << 8) | defaultByte4;
-				
-			uint8 lowByte1= *pc;
-			pc++;
-			uint8 lowByte2= *pc;
-			pc++;
-			uint8 lowByte3= *pc;
-			pc++;
-			uint8 lowByte4= *pc;
-			pc++;
-			int32 low= (lowByte1 << 24) | (lowByte2 << 16) | (lowByte3 << 8) | lowByte4;
-				
-			uint8 highByte1= *pc;
-			pc++;
-			uint8 highByte2= *pc;
-			pc++;
-			uint8 highByte3= *pc;
-			pc++;
-			uint8 highByte4= *pc;
-			pc++;
-			int32 high= (highByte1 << 24) | (highByte2 << 16) | (highByte3 << 8) | highByte4;
+			int32 low= operands[1];
+			int32 high= operands[2];
 			
 			/* If the given index is not within the bounds of the table of this opcode, jump to the default address. */
 			if( index < low || index > high )
 			{
-				pc= opcodeStart + defaultOffset;
-				logVerbose( "\tDefault case, index is %i, low is %i and high is %i. Branching to offset %i.\n", index, low, high, defaultOffset );
-				break;
+				pc= code + operands[0];
+				logVerbose( "\tDefault case, index is %i, low is %i and high is %i. Branching to pc %i.\n", index, low, high, operands[0] );
+				NEXT_OPCODE;
 			}
 			
-			/* The index is within the table, so calculate according table address, fetch the branch offset (table entry) from there and branch accordingly. */
-			uint32 tableIndex= (index - low) * 4; /* index entries are 4 bytes in size */ 
-			pc+= tableIndex;
-			
-			uint8 tableEntryByte1= *pc;
-			pc++;
-			uint8 tableEntryByte2= *pc;
-			pc++;
-			uint8 tableEntryByte3= *pc;
-			pc++;
-			uint8 tableEntryByte4= *pc;
-			pc++;
-			int32 tableEntry= (tableEntryByte1 << 24) | (tableEntryByte2 << 16) | (tableEntryByte3 << 8) | tableEntryByte4;
+			int32 target= operands[3 + (uint32)(index - low)];
+			pc= code + target;
 			
-			pc= opcodeStart + tableEntry;
-			
-			logVerbose( "\tIndex is %i, low is %i and high is %i.\n\tThe according table entry position %i has a branch offset of %i.\n", index, low, high, tableIndex/4, tableEntry );
-			break;
+			logVerbose( "\tIndex is %i, low is %i and high is %i. Branching to pc %i.\n", index, low, high, target );
+			NEXT_OPCODE;
 		}
 			
-		case LOOKUPSWITCH: /* u1, s4, s4, ...; match key in table and jump */
+		OPCODE( LOOKUPSWITCH ): /* u1, s4, s4, ...; match key in table and jump */
 		{
-			/* remember opcode start and calculate 4 byte boundary padding */
-			byte* opcodeStart= pc;
-			pc++;
-			int padding= (pc - sf->methodInfo->code->code) % 4;
-			pc+= padding;
+			/* Like TABLESWITCH: the default target, the number of pairs and the match/target pairs, sorted by the match values. */
+			const int32* operands= (const int32*)(code + ((pc - code + 4) & ~3));
+			const int32* pairs= operands + 2;
 			
-			/* get index from stack */
-			int32 index= stack_popSlot( stack );
-			
-			/* read default and pairs */
-			uint8 defaultByte1= *pc;
-			pc++;
-			uint8 defaultByte2= *pc;
-			pc++;
-			uint8 defaultByte3= *pc;
-			pc++;
-			uint8 defaultByte4= *pc;
-			pc++;
-			int32 defaultOffset= (defaultByte1 << 24) | (defaultByte2 << 16) | (defaultByte3 << 8) | defaultByte4;
+			/* get key from stack */
+			int32 key= stack_popSlot( stack );
 			
-			uint8 pairsByte1= *pc;
-			pc++;
-			uint8 pairsByte2= *pc;
-			pc++;
-			uint8 pairsByte3= *pc;
-			pc++;
-			uint8 pairsByte4= *pc;
-			pc++;
-			int32 pairs= (pairsByte1 << 24) | (pairsByte2 << 16) | (pairsByte3 << 8) | pairsByte4;
-			
-			/* Linaearly go through the following table of match/offset entries and check if match matches with the given index. */
-			/* TODO: Optimize this by using bin search (divide and conquer). This is possible because the entries are sorted by the match values. */
-			boolean isMatchFound= false;
-			int i;
-			for( i= 0; i < pairs; i++ )
+			/* binary search of the key, the default target is taken if there is no match */
+			int32 target= operands[0];
+			int32 lowIndex= 0;
+			int32 highIndex= operands[1] - 1;
+			while( lowIndex <= highIndex )
 			{
-				uint8 matchByte1= *pc;
-				pc++;
-				uint8 matchByte2= *pc;
-				pc++;
-				uint8 matchByte3= *pc;
-				pc++;
-				uint8 matchByte4= *pc;
-				pc++;
-				int32 match= (matchByte1 << 24) | (matchByte2 << 16) | (matchByte3 << 8) | matchByte4;
+				int32 middleIndex= lowIndex + (highIndex - lowIndex) / 2;
+				int32 match= pairs[middleIndex * 2];
 				
-				/* Check if the match of this table entry matches the given index. If yes, read and set the according offset and branch, 
-					otherwise add 4 bytes to the pc and continue. */
-				if( index == match )
+				if( key == match )
 				{
-					uint8 offsetByte1= *pc;
-					pc++;
-					uint8 offsetByte2= *pc;
-					pc++;
-					uint8 offsetByte3= *pc;
-					pc++;
-					uint8 offsetByte4= *pc;
-					pc++;
-					int32 offset= (offsetByte1 << 24) | (offsetByte2 << 16) | (offsetByte3 << 8) | offsetByte4;
-					
-					pc= opcodeStart + offset;
-					
-					logVerbose( "\tIndex is %i, entry %i was a match, offset is %i.\n", index, i, offset );
-					isMatchFound= true;
+					target= pairs[middleIndex * 2 + 1];
 					break;
 				}
+				
+				if( key < match )
+					highIndex= middleIndex - 1;
 				else
-				{
-					pc+= 4;
-				}
+					lowIndex= middleIndex + 1;
 			}
 			
-			/* if a match was found we're done */
-			if( isMatchFound )
-				break;
+			pc= code + target;
 			
-			/* if there was no match, branch to the default offset */
-			pc= opcodeStart + defaultOffset;
-
-			logVerbose( "\tDefault case, index is %i. Branching to offset %i.\n", index, defaultOffset );
-			break;
+			logVerbose( "\tKey is %i, branching to pc %i.\n", key, target );
+			NEXT_OPCODE;
 		}
 			
 		/* return from a method */
-		case IRETURN: /* u1; return from method with integer result */
+		OPCODE( IRETURN ): /* u1; return from method with integer result */
 		{
 			pc++;
 			
@@ -2507,14 +2699,17 @@ void interpreter_interpret( Stack* stack )
 			
 			/* restore old stack frame and pc */
 			sf= stack->currentFrame;
+			code= sf->methodInfo->code->code;
 			pc= sf->pc;
 			
 			/* push return value back onto the operand stack */
 			stack_pushSlot( stack, retVal );
-			break;
+			POLL_SAFE_POINT();
+			JIT_CONTINUE();
+			NEXT_OPCODE;
 		}
 			
-		case LRETURN: /* u1; return from method with long integer result */
+		OPCODE( LRETURN ): /* u1; return from method with long integer result */
 		{
 			pc++;
 			
@@ -2526,14 +2721,17 @@ void interpreter_interpret( Stack* stack )
 			
 			/* restore old stack frame and pc */
 			sf= stack->currentFrame;
+			code= sf->methodInfo->code->code;
 			pc= sf->pc;
 			
 			/* push return value back onto the operand stack */
 			stack_pushLong( stack, retVal );
-			break;
+			POLL_SAFE_POINT();
+			JIT_CONTINUE();
+			NEXT_OPCODE;
 		}
 			
-		case FRETURN: /* u1; return from method with float result */
+		OPCODE( FRETURN ): /* u1; return from method with float result */
 		{
 			pc++;
 			
@@ -2545,14 +2743,17 @@ void interpreter_interpret( Stack* stack )
 			
 			/* restore old stack frame and pc */
 			sf= stack->currentFrame;
+			code= sf->methodInfo->code->code;
 			pc= sf->pc;
 			
 			/* push return value back onto the operand stack */
 			stack_pushFloat( stack, retVal );
-			break;
+			POLL_SAFE_POINT();
+			JIT_CONTINUE();
+			NEXT_OPCODE;
 		}
 			
-		case DRETURN: /* u1; return from method with double result */
+		OPCODE( DRETURN ): /* u1; return from method with double result */
 		{
 			pc++;
 			
@@ -2564,14 +2765,17 @@ void interpreter_interpret( Stack* stack )
 			
 			/* restore old stack frame and pc */
 			sf= stack->currentFrame;
+			code= sf->methodInfo->code->code;
 			pc= sf->pc;
 			
 			/* push return value back onto the operand stack */
 			stack_pushDouble( stack, retVal );
-			break;
+			POLL_SAFE_POINT();
+			JIT_CONTINUE();
+			NEXT_OPCODE;
 		}
 			
-		case ARETURN: /* u1; return from method with object reference result */
+		OPCODE( ARETURN ): /* u1; return from method with object reference result */
 		{
 			pc++;
 			
@@ -2583,14 +2787,17 @@ void interpreter_interpret( Stack* stack )
 			
 			/* restore old stack frame and pc */
 			sf= stack->currentFrame;
+			code= sf->methodInfo->code->code;
 			pc= sf->pc;
 			
 			/* push return value back onto the operand stack */
 			stack_pushSlot( stack, retVal );
-			break;
+			POLL_SAFE_POINT();
+			JIT_CONTINUE();
+			NEXT_OPCODE;
 		}
 			
-		case RETURN: /* u1; return from a method */
+		OPCODE( RETURN ): /* u1; return from a method */
 		{
 			/* removed finished stack frame */
 			stack_popFrame( stack );
@@ -2599,23 +2806,23 @@ void interpreter_interpret( Stack* stack )
 			sf= stack->currentFrame;
 			pc= sf->pc;
 			
-			/* Do we leave the main-method? -> simply return, and we're done! */
-			if( sf->prevStackFrame == NULL )
+			/* Do we leave the main-method (or the method of a nested interpreter loop)? -> simply return, and we're done! */
+			if( sf == exitFrame )
 				return;				
-
-			break;
+			
+			code= sf->methodInfo->code->code;
+	
+			POLL_SAFE_POINT();
+			JIT_CONTINUE();
+			NEXT_OPCODE;
 		}
 			
 		/* get/set static field */
-		case GETSTATIC: /* u1, u2; get value of static field */
+		OPCODE( GETSTATIC ): /* u1, u2; get value of static field */
 		{
-			pc++;
-			
-			uint8 index1= *pc;
-			pc++;
-			uint8 index2= *pc;
-			pc++;
-			uint16 index= (index1 << 8) | index2;
+			sf->pc= pc; /* The class initialization may run Java code and the garbage collector. */
+			uint16 index= opcode_readU2( pc+1 );
+			pc+= 3;
 			
 			/* get field and its class */
 			Class* newClass;
@@ -2629,6 +2836,11 @@ void interpreter_interpret( Stack* stack )
 			if( !isFlagSet(fieldInfo->access_flags, ACC_STATIC) )
 				error( "IncompatibleClassChangeError: The expected field was not static." );
 			
+			/* The field is resolved and its class initialized, so use the quick form of this instruction from now on. Not so while the initializer is still
+				running, the quick form would let other threads skip waiting for it. */
+			if( newClass->isInitialized )
+				*(pc-3)= isTwoSlotType( fieldInfo->descriptor ) ? GETSTATIC2_QUICK : GETSTATIC_QUICK;
+			
 			/* handle possible different field types here and push the according value onto the stack */
 			switch( *fieldInfo->descriptor )
 			{
@@ -2667,18 +2879,14 @@ void interpreter_interpret( Stack* stack )
 			logVerbose( "\tGetting static field %s.%s (type is %s).\n", newClass->className, 
 							fieldInfo->name, 
 							fieldInfo->descriptor );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case PUTSTATIC: /* u1, u2; set value of static field */
+		OPCODE( PUTSTATIC ): /* u1, u2; set value of static field */
 		{
-			pc++;
-				
-			uint8 index1= *pc;
-			pc++;
-			uint8 index2= *pc;
-			pc++;
-			uint16 index= (index1 << 8) | index2;
+			sf->pc= pc; /* The class initialization may run Java code and the garbage collector. */
+			uint16 index= opcode_readU2( pc+1 );
+			pc+= 3;
 			
 			/* get field and its class */
 			Class* newClass;
@@ -2691,6 +2899,10 @@ void interpreter_interpret( Stack* stack )
 			/* make sure we have a static field here */
 			if( !isFlagSet(fieldInfo->access_flags, ACC_STATIC) )
 				error( "IncompatibleClassChangeError: The expected field was not static." );
+			
+			/* The field is resolved and its class initialized, so use the quick form of this instruction from now on (see GETSTATIC). */
+			if( newClass->isInitialized )
+				*(pc-3)= isTwoSlotType( fieldInfo->descriptor ) ? PUTSTATIC2_QUICK : PUTSTATIC_QUICK;
 					
 				/* handle possible different field types now */
 				switch( *fieldInfo->descriptor )
@@ -2733,20 +2945,19 @@ void interpreter_interpret( Stack* stack )
 				}
 						
 				logVerbose( "\tPutting into static field %s.%s (type is %s).\n", newClass->className, fieldInfo->name, fieldInfo->descriptor );
-				break;
+				NEXT_OPCODE;
 		}
 				
 		/* get/set object field */
 		/* TODO: Implement correct handling for protected fields! (Check access rights.) */
-		case GETFIELD: /* u1, u2; get value of object field */
+		OPCODE( GETFIELD ): /* u1, u2; get value of object field */
 		{
-			pc++;
-			uint8 index1= *pc;
-			pc++;
-			uint8 index2= *pc;
-			pc++;
-			uint16 index= (index1 << 8) | index2;
-
+			sf->pc= pc; /* The class initialization may run Java code and the garbage collector. */
+			uint16 index;
+			if( !readUnquickenedIndex(pc, GETFIELD, &index) )
+				NEXT_OPCODE;
+			pc+= 3;
+			
 			/* reference to the instance where we're going to get the field data from */
 			reference ref= stack_popSlot( stack );
 			
@@ -2762,6 +2973,10 @@ void interpreter_interpret( Stack* stack )
 			if( isFlagSet(fieldInfo->access_flags, ACC_STATIC) )
 				error( "IncompatibleClassChangeError: The requested field was static." );
 			
+			/* The field is resolved, so use the quick form of this instruction from now on. Its operand is the slot index of the field instead of the constant
+				pool index. */
+			quickenFieldAccess( pc-3, isTwoSlotType(fieldInfo->descriptor) ? GETFIELD2_QUICK : GETFIELD_QUICK, fieldInfo->slot_index );
+			
 			/* handle possible different field types now */
 			switch( *fieldInfo->descriptor )
 			{
@@ -2776,7 +2991,7 @@ void interpreter_interpret( Stack* stack )
 				{
 					/* 32 bit, one slot variable */
 					/* get value from field */
-					uint32 value= heap_getSlotFromInstance( ref, fieldClass, fieldInfo->slot_index );
+					uint32 value= heap_getSlotFromInstance( ref, fieldInfo->slot_index );
 					
 					/* push value onto the stack */
 					stack_pushSlot( stack, value );
@@ -2790,7 +3005,7 @@ void interpreter_interpret( Stack* stack )
 				{
 					/* 64 bit, two slots variable */
 					/* get value from field */
-					uint64 value= heap_getTwoSlotsFromInstance( ref, fieldClass, fieldInfo->slot_index );
+					uint64 value= heap_getTwoSlotsFromInstance( ref, fieldInfo->slot_index );
 					
 					/* push value onto the stack */
 					stack_pushLong( stack, value );
@@ -2805,17 +3020,16 @@ void interpreter_interpret( Stack* stack )
 			}
 			
 			logVerbose( "\tGetting field %s.%s (type is %s) of object with reference %i.\n", fieldClass->className, fieldInfo->name, fieldInfo->descriptor, ref );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case PUTFIELD: /* u1, u2; set value of object field */
+		OPCODE( PUTFIELD ): /* u1, u2; set value of object field */
 		{
-			pc++;
-			uint8 index1= *pc;
-			pc++;
-			uint8 index2= *pc;
-			pc++;
-			uint16 index= (index1 << 8) | index2;
+			sf->pc= pc; /* The class initialization may run Java code and the garbage collector. */
+			uint16 index;
+			if( !readUnquickenedIndex(pc, PUTFIELD, &index) )
+				NEXT_OPCODE;
+			pc+= 3;
 			
 			/* get info about the class of the instance, and about the variable itself (including its storage position) */
 			Class* fieldClass;
@@ -2829,6 +3043,11 @@ void interpreter_interpret( Stack* stack )
 			if( isFlagSet(fieldInfo->access_flags, ACC_STATIC) )
 				error( "IncompatibleClassChangeError: The requested field was static." );
 			
+			/* The field is resolved, so use the quick form of this instruction from now on. Its operand is the slot index of the field instead of the constant
+				pool index. */
+			quickenFieldAccess( pc-3, isTwoSlotType(fieldInfo->descriptor) ? PUTFIELD2_QUICK : isReferenceType(fieldInfo->descriptor) ? APUTFIELD_QUICK :
+				PUTFIELD_QUICK, fieldInfo->slot_index );
+			
 			/* handle possible different field types now */
 			switch( *fieldInfo->descriptor )
 			{
@@ -2848,7 +3067,7 @@ void interpreter_interpret( Stack* stack )
 					reference ref= stack_popSlot( stack );
 					
 					/* set value to field */
-					heap_setSlotOfInstance( ref, fieldClass, fieldInfo->slot_index, value );
+					heap_setSlotOfInstance( ref, fieldInfo->slot_index, value );
 					
 					logVerbose( "\tThe value is %i, the slot number %i the reference is %i.\n", value, fieldInfo->slot_index, ref );
 					break;
@@ -2864,7 +3083,7 @@ void interpreter_interpret( Stack* stack )
 					reference ref= stack_popSlot( stack );
 					
 					/* set value to field */
-					heap_setTwoSlotsOfInstance( ref, fieldClass, fieldInfo->slot_index, value );
+					heap_setTwoSlotsOfInstance( ref, fieldInfo->slot_index, value );
 					
 					logVerbose( "\tThe value is %i, the slot number %i the reference is %i.\n", value, fieldInfo->slot_index, ref );
 					break;
@@ -2876,34 +3095,44 @@ void interpreter_interpret( Stack* stack )
 			}
 			
 			logVerbose( "\tPutting into field %s.%s (type is %s).\n", fieldClass->className, fieldInfo->name, fieldInfo->descriptor );
-			break;
+			NEXT_OPCODE;
 		}
 			
 		/* method calls */
 		/* TODO: Check correct handling for protected methods! */
-		case INVOKEVIRTUAL: /* u1, u2; call an instance method */
+		OPCODE( INVOKEVIRTUAL ): /* u1, u2; call an instance method */
 		{
-			pc++;
-			uint8 index1= *pc;
-			pc++;
-			uint8 index2= *pc;
-			pc++;
-			uint16 index= (index1 << 8) | index2;
+			sf->pc= pc; /* Resolving the method may fail or load classes, which must see the frame at this instruction. */
+			uint16 index;
+			if( !readUnquickenedIndex(pc, INVOKEVIRTUAL, &index) )
+				NEXT_OPCODE;
+			pc+= 3;
 			
 			/* get the method and its class where it is defined */
 			Class* newClass;
 			method_info* methodInfo;
 			cls_resolveConstantPoolIndexToClassAndMethodInfo( sf->currentClass, index, &newClass, &methodInfo );
 			
+			/* The constant pool entry is resolved, so use the quick form of this instruction from now on. Methods without a vtable entry (i.e. private
+				methods) don't need to be dispatched at all. All others get an inline cache for this call site, whose index replaces the constant pool index. */
+			if( methodInfo->vtableIndex == NO_VTABLE_INDEX && !isFlagSet(methodInfo->access_flags, ACC_NATIVE) )
+			{
+				*(pc-3)= INVOKENONVIRTUAL_QUICK;
+			}
+			else
+			{
+				ic_quickenCallSite( sf->methodInfo->code, methodInfo, pc-3, INVOKEVIRTUAL_QUICK );
+			}
+			
 			/* Fetch objectref from the stack, which is the first parameter for this method call on the stack. */
 			uint32 objectRef= *(stack->stackPointer - methodInfo->parameterSlotCount);
 			
-			/* If the class we resolved from the constant pool above doesn't match the class of the object (i.e. the class of the object behind objectRef),
-				then we do have the same effect as with interfaces here, as we can not cache the resolved method in the constant pool entry above. */
-			Class* virtualCallClass= heap_getClassOfInstance( objectRef );
+			/* The implementation to call is found at the same vtable index in the vtable of the class of the object (i.e. the class of the object behind
+				objectRef). */
+			if( methodInfo->vtableIndex != NO_VTABLE_INDEX )
+				methodInfo= heap_getClassOfInstance( objectRef )->vtable[methodInfo->vtableIndex];
 			
-			if( newClass != virtualCallClass )
-				methodInfo= cls_resolveMethod( &virtualCallClass, methodInfo->name, methodInfo->descriptor );
+			Class* virtualCallClass= methodInfo->declaringClass;
 			
 			/* Make sure the requested method has been found. */
 			if( methodInfo == NULL )
@@ -2920,28 +3149,29 @@ void interpreter_interpret( Stack* stack )
 			if( isFlagSet(methodInfo->access_flags, ACC_NATIVE) )
 			{
 				logVerbose( "\t===> Executing native method %s.%s%s...\n", virtualCallClass->className, methodInfo->name, methodInfo->descriptor );
+				sf->pc= pc; /* Natives may wait in a blocking region, see thread_enterBlockingRegion(). */
 				native_handleNativeMethodCall( virtualCallClass, methodInfo, stack );
-				break;
+				NEXT_OPCODE;
 			}
 			
 			/* prepare pc, push new stack frame and invoke method by continuing execution */
 			sf->pc= pc;
 			sf= stack_pushFrame( stack, virtualCallClass, methodInfo );  /* overwrites sf! */
-			pc= sf->methodInfo->code->code;
+			code= sf->methodInfo->code->code;
+			pc= code;
+			SAFE_POINT();
 			
 			logVerbose( "\t===> Executing method %s.%s%s...\n", virtualCallClass->className, sf->methodInfo->name, sf->methodInfo->descriptor );
-			break;
+			JIT_METHOD_ENTRY();
+			NEXT_OPCODE;
 		}
 			
 		/* TODO: Make sure access rights are properly handled. */
-		case INVOKESPECIAL: /* u1, u2; invoke method belonging to a specific class */
+		OPCODE( INVOKESPECIAL ): /* u1, u2; invoke method belonging to a specific class */
 		{
-			pc++;
-			uint8 index1= *pc;
-			pc++;
-			uint8 index2= *pc;
-			pc++;
-			uint16 index= (index1 << 8) | index2;
+			sf->pc= pc; /* Resolving the method may fail or load classes, which must see the frame at this instruction. */
+			uint16 index= opcode_readU2( pc+1 );
+			pc+= 3;
 			
 			/* get the method and its class */
 			Class* newClass;
@@ -2952,29 +3182,33 @@ void interpreter_interpret( Stack* stack )
 			if( isFlagSet(methodInfo->access_flags, ACC_NATIVE) )
 			{
 				logVerbose( "===> Executing native method %s.%s%s...\n", newClass->className, methodInfo->name, methodInfo->descriptor );
+				sf->pc= pc;
 				native_handleNativeMethodCall( newClass, methodInfo, stack  );
-				break;
+				NEXT_OPCODE;
 			}
 			
+			/* The method is resolved, so use the quick form of this instruction from now on. */
+			*(pc-3)= INVOKENONVIRTUAL_QUICK;
+			
 			/* prepare pc, push new stack frame and invoke method by continuing execution */
 			sf->pc= pc;
 			sf= stack_pushFrame( stack, newClass, methodInfo );  /* overwrites sf! */
-			pc= sf->methodInfo->code->code;
+			code= sf->methodInfo->code->code;
+			pc= code;
+			SAFE_POINT();
 			
 			logVerbose( "\t===> Executing method %s.%s%s...\n", sf->currentClass->className, sf->methodInfo->name, sf->methodInfo->descriptor );
-			break;
+			JIT_METHOD_ENTRY();
+			NEXT_OPCODE;
 		}
 
 		/* TODO: Make sure access rights are properly handled. */
-		case INVOKESTATIC: /* u1, u2; invoke a static method */
+		OPCODE( INVOKESTATIC ): /* u1, u2; invoke a static method */
 		{
-			pc++;
-			uint8 index1= *pc;
-			pc++;
-			uint8 index2= *pc;
-			pc++;
-			uint16 index= (index1 << 8) | index2;
-
+			sf->pc= pc; /* The class initialization may run Java code and the garbage collector. */
+			uint16 index= opcode_readU2( pc+1 );
+			pc+= 3;
+			
 			/* get method and its class */
 			Class* newClass;
 			method_info* methodInfo;
@@ -2984,30 +3218,37 @@ void interpreter_interpret( Stack* stack )
 			if( isFlagSet(methodInfo->access_flags, ACC_NATIVE) )
 			{
 				logVerbose( "===> Executing native method %s.%s%s...\n", newClass->className, methodInfo->name, methodInfo->descriptor );
+				sf->pc= pc;
 				native_handleNativeMethodCall( newClass, methodInfo, stack  );
-				break;
+				NEXT_OPCODE;
 			}
 			
 			/* Check if the given class is initialized. If not, initialize it now. */
 			handleClassInitialization( stack, newClass );
+			
+			/* The method is resolved and its class initialized, so use the quick form of this instruction from now on (see GETSTATIC). */
+			if( newClass->isInitialized )
+				*(pc-3)= INVOKESTATIC_QUICK;
 
 			/* prepare pc, push new stack frame and invoke method by continuing execution */
 			sf->pc= pc;
 			sf= stack_pushFrame( stack, newClass, methodInfo );  /* overwrites sf! */
-			pc= sf->methodInfo->code->code;
+			code= sf->methodInfo->code->code;
+			pc= code;
+			SAFE_POINT();
 
 			logVerbose( "===> Executing method %s.%s%s...\n", sf->currentClass->className, sf->methodInfo->name, sf->methodInfo->descriptor );
-			break;
+			JIT_METHOD_ENTRY();
+			NEXT_OPCODE;
 		}
 
-		case INVOKEINTERFACE: /* u1, u2, u1, u1; invoke an interface method */
+		OPCODE( INVOKEINTERFACE ): /* u1, u2, u1, u1; invoke an interface method */
 		{
-			pc++;
-			uint8 index1= *pc;
-			pc++;
-			uint8 index2= *pc;
-			pc++;
-			uint16 index= (index1 << 8) | index2;
+			sf->pc= pc; /* Resolving the method may fail or load classes, which must see the frame at this instruction. */
+			uint16 index;
+			if( !readUnquickenedIndex(pc, INVOKEINTERFACE, &index) )
+				NEXT_OPCODE;
+			pc+= 3;
 			
 			uint8 parameterSlotCount= *pc;
 			pc++;
@@ -3021,6 +3262,10 @@ void interpreter_interpret( Stack* stack )
 			method_info* methodInfo; /* sf->currentClass -> instead of objectClass correct? */
 			cls_resolveConstantPoolIndexToClassAndInterfaceMethodInfo( sf->currentClass, index, &objectClass, &methodInfo );
 			
+			/* The interface method is resolved, so use the quick form of this instruction from now on. The constant pool index is replaced by the index of
+				the inline cache for this call site. */
+			ic_quickenCallSite( sf->methodInfo->code, ((CONSTANT_InterfaceMethodref_info*)sf->currentClass->constant_pool[index])->methodInfo, pc-5, INVOKEINTERFACE_QUICK );
+			
 			/* Make sure the requested method has been found. */
 			if( methodInfo == NULL )
 			{
@@ -3036,33 +3281,36 @@ void interpreter_interpret( Stack* stack )
 			if( isFlagSet(methodInfo->access_flags, ACC_NATIVE) )
 			{
 				logVerbose( "===> Executing native method %s.%s%s...\n", objectClass->className, methodInfo->name, methodInfo->descriptor );
+				sf->pc= pc;
 				native_handleNativeMethodCall( objectClass, methodInfo, stack  );
-				break;
+				NEXT_OPCODE;
 			}
 			 
 			/* prepare pc, push new stack frame and invoke method by continuing execution */
 			sf->pc= pc;
 			sf= stack_pushFrame( stack, objectClass, methodInfo );  /* overwrites sf! */
-			pc= sf->methodInfo->code->code;
+			code= sf->methodInfo->code->code;
+			pc= code;
+			SAFE_POINT();
 			
 			logVerbose( "\t===> Executing method %s.%s%s...\n", sf->currentClass->className, sf->methodInfo->name, sf->methodInfo->descriptor );
-			break;
+			JIT_METHOD_ENTRY();
+			NEXT_OPCODE;
 		}
 			
-		case XXX_UNUSED_XXX: /* unused */
+		OPCODE( XXX_UNUSED_XXX ): /* unused */
 			unsupportedError( pc );
-					break;
+					NEXT_OPCODE;
 					
 		/* object/array creation and length */
-		case NEW: /* u1, u2; create an object */
+		OPCODE( NEW ): /* u1, u2; create an object */
 		{
-			pc++;
+			/* The garbage collector finds the reference map of the current frame by its pc. */
+			sf->pc= pc;
+			gc_collectIfNecessary();
 			
-			uint8 index1= *pc;
-			pc++;
-			uint8 index2= *pc;
-			pc++;
-			uint16 index= (index1 << 8) | index2;
+			uint16 index= opcode_readU2( pc+1 );
+			pc+= 3;
 			
 			/* resolve requested class */
 			Class* newCls= cls_resolveConstantPoolIndexToClass( sf->currentClass, index );
@@ -3070,15 +3318,22 @@ void interpreter_interpret( Stack* stack )
 			/* Check if the given class is initialized. If not, initialize it now. */
 			handleClassInitialization( stack, newCls );
 			
+			/* The class is resolved and initialized, so use the quick form of this instruction from now on (see GETSTATIC). */
+			if( newCls->isInitialized )
+				*(pc-3)= NEW_QUICK;
+			
 			/* allocate new instance */
 			reference newRef= heap_newInstance( newCls );
 			stack_pushSlot( stack, newRef );
 			logVerbose( "\tCreating new instance of class %s. Reference number is %i.\n", newCls->className, newRef );
-			break;
+			NEXT_OPCODE;
 		}
 				
-		case NEWARRAY: /* u1, u1; allocate new array for numbers or booleans */
+		OPCODE( NEWARRAY ): /* u1, u1; allocate new array for numbers or booleans */
 		{
+			sf->pc= pc;
+			gc_collectIfNecessary();
+			
 			pc++;
 			uint8 atype= *pc;
 			pc++;
@@ -3090,53 +3345,23 @@ void interpreter_interpret( Stack* stack )
 			if( count < 0 )
 				error( "NegativeArraySizeException: A negative number of array entries is not allowed." );
 				
-			reference arRef= NULL_REFERENCE;
-			
-			switch( atype )
-			{
-				case ARRAY_TYPE_BOOLEAN:
-				case ARRAY_TYPE_BYTE:
-					arRef= heap_newByteArrayInstance( count );
-					break;
-				case ARRAY_TYPE_CHAR:
-					arRef= heap_newCharArrayInstance( count );
-					break;
-				case ARRAY_TYPE_SHORT:
-					arRef= heap_newShortArrayInstance( count );
-					break;
-				case ARRAY_TYPE_INT:
-					arRef= heap_newIntArrayInstance( count );
-					break;
-				case ARRAY_TYPE_FLOAT:
-					arRef= heap_newFloatArrayInstance( count );
-					break;
-				case ARRAY_TYPE_LONG:
-					arRef= heap_newLongArrayInstance( count );
-					break;
-				case ARRAY_TYPE_DOUBLE:
-					arRef= heap_newDoubleArrayInstance( count );
-					break;
-				default:
-					error( "Unknown array type!" );
-					break;
-			}
+			reference arRef= interpreter_newArray( atype, count );
 			
 			/* finally, push the reference of the newly created array onto the stack */
 			stack_pushSlot( stack, arRef );
 			
 			logVerbose( "\tCreating new array with type %i. Reference is %i, size is %i.\n", atype, arRef, count );
-			break;
+			NEXT_OPCODE;
 		}
 			
 		/* NOTE: We do not handle type information here (yet). So these are no more than references/slots to us. */
-		case ANEWARRAY: /* u1, u2; allocate new array for objects */
+		OPCODE( ANEWARRAY ): /* u1, u2; allocate new array for objects */
 		{
-			pc++;
-			uint8 index1= *pc;
-			pc++;
-			uint8 index2= *pc;
-			pc++;
-			uint16 index= (index1 << 8) | index2;
+			sf->pc= pc;
+			gc_collectIfNecessary();
+			
+			uint16 index= opcode_readU2( pc+1 );
+			pc+= 3;
 			
 			Class* type= cls_resolveConstantPoolIndexToClass( sf->currentClass, index );
 			
@@ -3145,6 +3370,10 @@ void interpreter_interpret( Stack* stack )
 			sprintf( tmpArrayType, "[L%s;", type->className );
 			Class* arrayType= ma_getClass( tmpArrayType );
 			
+			/* Remember the array class and use the quick form of this instruction from now on. */
+			((CONSTANT_Class_info*)sf->currentClass->constant_pool[index])->arrayClass= arrayType;
+			*(pc-3)= ANEWARRAY_QUICK;
+			
 			int32 count= stack_popSlot( stack );
 				
 			/* make sure count is not negative */
@@ -3158,10 +3387,10 @@ void interpreter_interpret( Stack* stack )
 			stack_pushSlot( stack, arRef );
 				
 			logVerbose( "Creating new array of reference type. Reference is %i, size is %i.\n", arRef, count );
-			break;
+			NEXT_OPCODE;
 		}
 		
-		case ARRAYLENGTH: /* u1; get length of array */
+		OPCODE( ARRAYLENGTH ): /* u1; get length of array */
 		{
 			pc++;
 			reference arRef= stack_popSlot( stack );
@@ -3173,11 +3402,11 @@ void interpreter_interpret( Stack* stack )
 			stack_pushSlot( stack, length );
 			
 			logVerbose( "\tThe length of the array with reference %i is %i.\n", arRef, length );
-			break;
+			NEXT_OPCODE;
 		}
 			
 		/* exception mechanisnm */
-		case ATHROW: /* u1; throw an exception error */
+		OPCODE( ATHROW ): /* u1; throw an exception error */
 		{
 			pc++;
 			reference objectRef= stack_popSlot( stack );
@@ -3198,7 +3427,8 @@ void interpreter_interpret( Stack* stack )
 					localPC= sf->methodInfo->code->exception_table_tab[isCaughtFrom]->handler_pc;
 					logVerbose( "Execption caught! Execution continues at method %s.%s%s at bytecode %i.\n", sf->currentClass->className, sf->methodInfo->name, sf->methodInfo->descriptor, localPC );
 					stack_pushSlot( stack, objectRef );
-					pc= sf->methodInfo->code->code + localPC;
+					code= sf->methodInfo->code->code;
+					pc= code + localPC;
 					continue;
 				}
 				
@@ -3209,37 +3439,37 @@ void interpreter_interpret( Stack* stack )
 			}
 			
 			if( isCaughtFrom != -1 )
-				break;
+				NEXT_OPCODE;
 			
 			/* No exception handler found, print stack trace and exit. For the stack trace we call the Java method Throwable.printStackTrace(),
 				the exit happens automatically, because we're at the lowest stack frame now. */			
 			stack_pushSlot( stack, objectRef );
 			Class* methodClass= classOfObject;
-			stack_pushFrame( stack, methodClass, cls_resolveMethod(&methodClass, "printStackTrace", "()V") );
+			stack_pushFrame( stack, methodClass, cls_resolveMethod(&methodClass, sym_intern("printStackTrace"), sym_intern("()V")) );
 			interpreter_interpret( stack );
 			return;
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case CHECKCAST: /* u1, u2; ensure object or array belongs to type */
+		OPCODE( CHECKCAST ): /* u1, u2; ensure object or array belongs to type */
 		{
-			pc++;
-			uint8 index1= *pc;
-			pc++;
-			uint8 index2= *pc;
-			pc++;
-			uint16 index= (index1 << 8) | index2;
+			uint16 index= opcode_readU2( pc+1 );
+			pc+= 3;
 			
 			reference objectRef= stack_popSlot( stack );
 			stack_pushSlot( stack, objectRef );
 
 			/* A null reference is fine in this case. */ 
 			if( objectRef == NULL_REFERENCE )
-				break;
+				NEXT_OPCODE;
 			
 			Class* poolClass= cls_resolveConstantPoolIndexToClass( sf->currentClass, index );
 			boolean result;
 			
+			/* The class is resolved, so use the quick form of this instruction from now on. */
+			*(pc-3)= CHECKCAST_QUICK;
+			
+			
 			/* interface */
 			if( isFlagSet(poolClass->access_flags, ACC_INTERFACE) )
 			{
@@ -3256,17 +3486,13 @@ void interpreter_interpret( Stack* stack )
 			if( result == false )
 				error( "ClassCastException" );
 			
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case INSTANCEOF: /* u1, u2; negate an integer */
+		OPCODE( INSTANCEOF ): /* u1, u2; negate an integer */
 		{
-			pc++;
-			uint8 index1= *pc;
-			pc++;
-			uint8 index2= *pc;
-			pc++;
-			uint16 index= (index1 << 8) | index2;
+			uint16 index= opcode_readU2( pc+1 );
+			pc+= 3;
 			
 			reference objectRef= stack_popSlot( stack );
 			
@@ -3274,12 +3500,15 @@ void interpreter_interpret( Stack* stack )
 			{
 				stack_pushSlot( stack, 0 );
 				logVerbose( "\tIs instance of: no\n" );
-				break;
+				NEXT_OPCODE;
 			}
 				
 			
 			Class* poolClass= cls_resolveConstantPoolIndexToClass( sf->currentClass, index );
 			boolean result;
+			
+			/* The class is resolved, so use the quick form of this instruction from now on. */
+			*(pc-3)= INSTANCEOF_QUICK;
 		
 			/* interface */
 			if( isFlagSet(poolClass->access_flags, ACC_INTERFACE) )
@@ -3288,41 +3517,58 @@ void interpreter_interpret( Stack* stack )
 				result= cls_implementsInterface(refClass, poolClass);
 				stack_pushSlot( stack, result ? 1 : 0 );
 				logVerbose( "\tIs instance of: %s\n", result ? "yes" : "no" );
-				break;
+				NEXT_OPCODE;
 			}
 
 			/* class */
 			result= heap_isObjectInstanceOf(objectRef, poolClass);
 			stack_pushSlot( stack, result ? 1 : 0 );
 			logVerbose( "\tIs instance of: %s\n", result ? "yes" : "no" );
-			break;
+			NEXT_OPCODE;
 		}
 			
 		/* monitors */
-		case MONITORENTER: /* u1; enter synchronized region of code */
-		case MONITOREXIT: /* u1; leave synchronized region of code */
-			/* Both, MONITORENTER and MONITOREXIT do not need to be supported, as long as we only have a single thread running.
-			   To support multithreading, which the implementation has already been prepared for, these opcodes have to be supported. For now, simply ignore those
-				opcodes and don't generate an error either.*/
-			logWarning( "Warning: Opcode %s encountered and ignored!", opcodeNames[*pc] );
+		OPCODE( MONITORENTER ): /* u1; enter synchronized region of code */
+		{
+			/* The thread may wait for the monitor, so this is a safe point. The instance stays on the operand stack meanwhile, so that it can't be collected. */
+			sf->pc= pc;
+			reference objectRef= *(stack->stackPointer - 1);
+			
+			/* A green thread doesn't wait, but is parked and executes this instruction again when it's woken up. */
+			if( isSwitchingAllowed )
+			{
+				if( !monitor_enterOrPark(heap_getLockWord(objectRef)) )
+					return;
+			}
+			else
+				monitor_enter( heap_getLockWord(objectRef) );
+			
 			pc++;
 			stack_popSlot( stack );
-			break;
+			NEXT_OPCODE;
+		}
 			
-		case WIDE: /* u1; next instruction uses 16bit index */
+		OPCODE( MONITOREXIT ): /* u1; leave synchronized region of code */
+		{
+			pc++;
+			reference objectRef= stack_popSlot( stack );
+			monitor_exit( heap_getLockWord(objectRef) );
+			NEXT_OPCODE;
+		}
+			
+		OPCODE( WIDE ): /* u1; next instruction uses 16bit index */
 			/* No wide support yet. Many Opcodes will have to be extended for this. */
 			unsupportedError( pc );
-			break;
+			NEXT_OPCODE;
 				
 		/* array creation again */
-		case MULTIANEWARRAY: /* u1, u2, u1; allocate multi-dimensional array */
+		OPCODE( MULTIANEWARRAY ): /* u1, u2, u1; allocate multi-dimensional array */
 		{
-			pc++;
-			uint8 index1= *pc;
-			pc++;
-			uint8 index2= *pc;
-			pc++;
-			uint16 index= (index1 << 8) | index2;
+			sf->pc= pc;
+			gc_collectIfNecessary();
+			
+			uint16 index= opcode_readU2( pc+1 );
+			pc+= 3;
 			
 			uint8 dimensions= *pc;
 			pc++;
@@ -3345,11 +3591,11 @@ void interpreter_interpret( Stack* stack )
 			stack_pushSlot( stack, ref );
 			
 			logVerbose( "\tCreating multidimensional array with %i dimensions and type %s.\n", dimensions, cls_resolveConstantPoolIndexToClassName(sf->currentClass, index) );
-			break;
+			NEXT_OPCODE;
 		}
 			
 		/* some branches again */
-		case IFNULL: /* u1, s2; jump if null */
+		OPCODE( IFNULL ): /* u1, s2; jump if null */
 		{
 			pc++;
 			uint32 value= stack_popSlot( stack );
@@ -3357,27 +3603,21 @@ void interpreter_interpret( Stack* stack )
 			/* if value (a reference) equals null (i.e. NULL_REFERENCE), branch to the given opcode */
 			if( value == NULL_REFERENCE )
 			{
-				uint8 branchByte1= *pc;
-				pc++;
-				uint8 branchByte2= *pc;
-				pc++;
-			
-				int16 branchOffset= (branchByte1 << 8) | branchByte2;
-				pc-= 3; /* rewind pc to the original opcode address */
-				pc+= branchOffset;
+				uint16 branchTarget= opcode_readU2( pc );
+				BRANCH( branchTarget );
 				
-				logVerbose( "Reference %i is null, so branch to offset %i.\n", value, branchOffset );
-				break;
+				logVerbose( "Reference %i is null, so branch to pc %i.\n", value, branchTarget );
+				NEXT_OPCODE;
 			}
 			
 			/* do not branch, just continue with next opcode */
 			pc+= 2;
 
 			logVerbose( "Reference %i is not null, so do NOT branch.\n", value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case IFNONNULL: /* u1, s2; jump if non null */
+		OPCODE( IFNONNULL ): /* u1, s2; jump if non null */
 		{
 			pc++;
 			uint32 value= stack_popSlot( stack );
@@ -3385,136 +3625,416 @@ void interpreter_interpret( Stack* stack )
 			/* if value (a reference) does not equal null (i.e. NULL_REFERENCE), branch to the given opcode */
 			if( value != NULL_REFERENCE )
 			{
-				uint8 branchByte1= *pc;
-				pc++;
-				uint8 branchByte2= *pc;
-				pc++;
-				
-				int16 branchOffset= (branchByte1 << 8) | branchByte2;
-				pc-= 3; /* rewind pc to the original opcode address */
-				pc+= branchOffset;
+				uint16 branchTarget= opcode_readU2( pc );
+				BRANCH( branchTarget );
 				
-				logVerbose( "Reference %i is not null, so branch to offset %i.\n", value, branchOffset );
-				break;
+				logVerbose( "Reference %i is not null, so branch to pc %i.\n", value, branchTarget );
+				NEXT_OPCODE;
 			}
 			
 			/* do not branch, just continue with next opcode */
 			pc+= 2;
 			
 			logVerbose( "Reference %i is null, so do NOT branch.\n", value );
-			break;
+			NEXT_OPCODE;
 		}
 			
-		case GOTO_W: /* u1, s4; branch to address using wide offset */
+		OPCODE( GOTO_W ): /* u1, s4; branch to address using wide offset */
 		{
 			pc++;
-			uint8 branchByte1= *pc;
-			pc++;
-			uint8 branchByte2= *pc;
-			pc++;
-			uint8 branchByte3= *pc;
-			pc++;
-			uint8 branchByte4= *pc;
-			pc++;
-			
-			int32 branchOffset= (branchByte1 << 24) | (branchByte2 << 16) | (branchByte3 << 8) | branchByte4;
-			pc-= 5; /* rewind pc to the original opcode address */
-			pc+= branchOffset;
-			break;
+			int32 branchTarget= opcode_readS4( pc );
+			BRANCH( branchTarget );
+			NEXT_OPCODE;
 		}
 			
-		case JSR_W: /* u1, s4; jump to subroutine using wide offset */
+		OPCODE( JSR_W ): /* u1, s4; jump to subroutine using wide offset */
 		{
-			pc++;
-			uint8 branchByte1= *pc;
-			pc++;
-			uint8 branchByte2= *pc;
-			pc++;
-			uint8 branchByte3= *pc;
-			pc++;
-			uint8 branchByte4= *pc;
-			pc++;
+			int32 branchTarget= opcode_readS4( pc+1 );
+			pc+= 5;
 			
 			/* push the current pc, which points to the following opcode now, onto the stack */
 			/* Note: We're pushing a full address with the size of a pointer of the host system onto the stack. So make sure the slot size is greater than or equal the size
 				of a native pointer. */
 			stack_pushSlot( stack, (uint32)pc );
 			
-			int32 branchOffset= (branchByte1 << 24) | (branchByte2 << 16) | (branchByte3 << 8) | branchByte4;
-			pc-= 5; /* rewind pc to the original opcode address */
-			pc+= branchOffset;
-			break;
+			pc= code + branchTarget;
+			NEXT_OPCODE;
 		}
 			
-		case BREAKPOINT: /* RESEVED; must not appear in class file (fails verification) */
+		OPCODE( BREAKPOINT ): /* RESEVED; must not appear in class file (fails verification) */
 			/* It is not planned to have debugging support (yet). */
 			unsupportedError( pc );
-			break;
+			NEXT_OPCODE;
 					
 		/* quick opcodes (may only be internally used by VM) */
-		case LDC_QUICK: 
-		case UNKNOWN1: /* UNKNOWN */
-		case LDC2_W_QUICK: 
-		case GETFIELD_QUICK: 
-		case PUTFIELD_QUICK: 
-		case GETFIELD2_QUICK: 
-		case PUTFIELD2_QUICK: 
-		case UNKNOWN2: /* UNKNOWN */
-		case PUTSTATIC_QUICK: 
-		case GETSTATIC2_QUICK:
-		case PUTSTATIC2_QUICK:
-		case INVOKEVIRTUAL_QUICK:
-		case INVOKENONVIRTUAL_QUICK:
-		case INVOKESUPER_QUICK:
-		case INVOKESTATIC_QUICK:
-		case INVOKEINTERFACE_QUICK:
-		case INVOKEVIRTUALOBJECT_QUICK:
-		case UNKNOWN3: /* UNKNOWN */
-		case NEW_QUICK:
-		case ANEWARRAY_QUICK:
-		case MULTIANEWARRAY_QUICK:
-		case CHECKCAST_QUICK:
-		case INSTANCEOF_QUICK:
-		case INVOKEVIRTUAL_QUICK_W:
-		case GETFIELD_QUICK_W:
-		case PUTFIELD_QUICK_W:
+		/* The interpreter rewrites an instruction into its quick form as soon as it has been executed once, i.e. as soon as its constant pool entry has been
+		   resolved and the according class has been initialized. The quick forms use the resolved data from the constant pool entry directly (or, for
+		   GETFIELD and PUTFIELD, the slot index which replaces the constant pool index) and skip resolution, class initialization and access checks. */
+		OPCODE( LDC_QUICK ): /* u1, u1; LDC of an already created String constant */
+		{
+			pc++;
+			u1 index= *pc;
+			pc++;
+			CONSTANT_String_info* strInfo= (CONSTANT_String_info*)sf->currentClass->constant_pool[index];
+			stack_pushSlot( stack, strInfo->stringRef );
+			logVerbose( "\tPushing String %i from constant pool index %i.\n", strInfo->stringRef, index );
+			NEXT_OPCODE;
+		}
+			
+		OPCODE( LDC_W_QUICK ): /* u1, u2; LDC_W of an already created String constant */
+		{
+			uint16 index= opcode_readU2( pc+1 );
+			pc+= 3;
+			CONSTANT_String_info* strInfo= (CONSTANT_String_info*)sf->currentClass->constant_pool[index];
+			stack_pushSlot( stack, strInfo->stringRef );
+			logVerbose( "\tPushing String %i from constant pool index %i.\n", strInfo->stringRef, index );
+			NEXT_OPCODE;
+		}
+			
+		OPCODE( GETSTATIC_QUICK ): /* u1, u2; GETSTATIC of a resolved one slot field of an initialized class */
+		{
+			uint16 index= opcode_readU2( pc+1 );
+			pc+= 3;
+			
+			CONSTANT_Fieldref_info* fieldref= (CONSTANT_Fieldref_info*)sf->currentClass->constant_pool[index];
+			uint32 value= fieldref->class->class_inctance_variable_slots[fieldref->variableInfo->slot_index];
+			stack_pushSlot( stack, value );
+			
+			logVerbose( "\tGetting static field %s.%s, the value is %i.\n", fieldref->class->className, fieldref->variableInfo->name, value );
+			NEXT_OPCODE;
+		}
+			
+		OPCODE( GETSTATIC2_QUICK ): /* u1, u2; GETSTATIC of a resolved two slot field of an initialized class */
+		{
+			uint16 index= opcode_readU2( pc+1 );
+			pc+= 3;
+			
+			CONSTANT_Fieldref_info* fieldref= (CONSTANT_Fieldref_info*)sf->currentClass->constant_pool[index];
+			int32* slots= fieldref->class->class_inctance_variable_slots + fieldref->variableInfo->slot_index;
+			stack_pushLongParts( stack, slots[0], slots[1] );
+			
+			logVerbose( "\tGetting static field %s.%s.\n", fieldref->class->className, fieldref->variableInfo->name );
+			NEXT_OPCODE;
+		}
+			
+		OPCODE( PUTSTATIC_QUICK ): /* u1, u2; PUTSTATIC of a resolved one slot field of an initialized class */
+		{
+			uint16 index= opcode_readU2( pc+1 );
+			pc+= 3;
+			
+			CONSTANT_Fieldref_info* fieldref= (CONSTANT_Fieldref_info*)sf->currentClass->constant_pool[index];
+			uint32 value= stack_popSlot( stack );
+			fieldref->class->class_inctance_variable_slots[fieldref->variableInfo->slot_index]= value;
+			
+			logVerbose( "\tPutting into static field %s.%s, the value is %i.\n", fieldref->class->className, fieldref->variableInfo->name, value );
+			NEXT_OPCODE;
+		}
+			
+		OPCODE( PUTSTATIC2_QUICK ): /* u1, u2; PUTSTATIC of a resolved two slot field of an initialized class */
+		{
+			uint16 index= opcode_readU2( pc+1 );
+			pc+= 3;
+			
+			CONSTANT_Fieldref_info* fieldref= (CONSTANT_Fieldref_info*)sf->currentClass->constant_pool[index];
+			int32* slots= fieldref->class->class_inctance_variable_slots + fieldref->variableInfo->slot_index;
+			slots[1]= stack_popSlot( stack );
+			slots[0]= stack_popSlot( stack );
+			
+			logVerbose( "\tPutting into static field %s.%s.\n", fieldref->class->className, fieldref->variableInfo->name );
+			NEXT_OPCODE;
+		}
+			
+		OPCODE( GETFIELD_QUICK ): /* u1, u2 (slot index); GETFIELD of a resolved one slot field */
+		{
+			uint16 slotIndex= opcode_readU2( pc+1 );
+			pc+= 3;
+			
+			reference ref= stack_popSlot( stack );
+			uint32 value= heap_getInstanceSlots( ref )[slotIndex];
+			stack_pushSlot( stack, value );
+			
+			logVerbose( "\tGetting field slot %i of object with reference %i, the value is %i.\n", slotIndex, ref, value );
+			NEXT_OPCODE;
+		}
+			
+		OPCODE( GETFIELD2_QUICK ): /* u1, u2 (slot index); GETFIELD of a resolved two slot field */
+		{
+			uint16 slotIndex= opcode_readU2( pc+1 );
+			pc+= 3;
+			
+			reference ref= stack_popSlot( stack );
+			slot* slots= heap_getInstanceSlots( ref ) + slotIndex;
+			stack_pushLongParts( stack, slots[0], slots[1] );
+			
+			logVerbose( "\tGetting field slots %i and %i of object with reference %i.\n", slotIndex, slotIndex+1, ref );
+			NEXT_OPCODE;
+		}
+			
+		OPCODE( PUTFIELD_QUICK ): /* u1, u2 (slot index); PUTFIELD of a resolved one slot primitive field */
+		{
+			uint16 slotIndex= opcode_readU2( pc+1 );
+			pc+= 3;
+			
+			uint32 value= stack_popSlot( stack );
+			reference ref= stack_popSlot( stack );
+			heap_getInstanceSlots( ref )[slotIndex]= value;
+			
+			logVerbose( "\tPutting into field slot %i of object with reference %i, the value is %i.\n", slotIndex, ref, value );
+			NEXT_OPCODE;
+		}
+			
+		OPCODE( APUTFIELD_QUICK ): /* u1, u2 (slot index); PUTFIELD of a resolved reference field, which needs the write barrier */
+		{
+			uint16 slotIndex= opcode_readU2( pc+1 );
+			pc+= 3;
+			
+			reference value= stack_popSlot( stack );
+			reference ref= stack_popSlot( stack );
+			heap_getInstanceSlots( ref )[slotIndex]= value;
+			heap_writeBarrier( ref, value );
+			
+			logVerbose( "\tPutting reference %i into field slot %i of object with reference %i.\n", value, slotIndex, ref );
+			NEXT_OPCODE;
+		}
+			
+		OPCODE( PUTFIELD2_QUICK ): /* u1, u2 (slot index); PUTFIELD of a resolved two slot field */
+		{
+			uint16 slotIndex= opcode_readU2( pc+1 );
+			pc+= 3;
+			
+			uint32 value2= stack_popSlot( stack );
+			uint32 value1= stack_popSlot( stack );
+			reference ref= stack_popSlot( stack );
+			slot* slots= heap_getInstanceSlots( ref ) + slotIndex;
+			slots[0]= value1;
+			slots[1]= value2;
+			
+			logVerbose( "\tPutting into field slots %i and %i of object with reference %i.\n", slotIndex, slotIndex+1, ref );
+			NEXT_OPCODE;
+		}
+			
+		OPCODE( INVOKEVIRTUAL_QUICK ): /* u1, u2; INVOKEVIRTUAL of a resolved method with a vtable entry, operand is the inline cache index */
+		{
+			uint16 cacheIndex= opcode_readU2( pc+1 );
+			pc+= 3;
+			
+			InlineCache* cache= &sf->methodInfo->code->inlineCaches[cacheIndex];
+			
+			/* Select the implementation for the class of objectref, either from the inline cache or from the vtable. */
+			uint32 objectRef= *(stack->stackPointer - cache->methodInfo->parameterSlotCount);
+			method_info* methodInfo= ic_getTarget( cache, heap_getClassOfInstance(objectRef) );
+			Class* virtualCallClass= methodInfo->declaringClass;
+			
+			if( isFlagSet(methodInfo->access_flags, ACC_NATIVE) )
+			{
+				logVerbose( "\t===> Executing native method %s.%s%s...\n", virtualCallClass->className, methodInfo->name, methodInfo->descriptor );
+				sf->pc= pc;
+				native_handleNativeMethodCall( virtualCallClass, methodInfo, stack );
+				NEXT_OPCODE;
+			}
+			
+			/* prepare pc, push new stack frame and invoke method by continuing execution */
+			sf->pc= pc;
+			sf= stack_pushFrame( stack, virtualCallClass, methodInfo );  /* overwrites sf! */
+			code= sf->methodInfo->code->code;
+			pc= code;
+			SAFE_POINT();
+			
+			logVerbose( "\t===> Executing method %s.%s%s...\n", virtualCallClass->className, sf->methodInfo->name, sf->methodInfo->descriptor );
+			JIT_METHOD_ENTRY();
+			NEXT_OPCODE;
+		}
+			
+		OPCODE( INVOKENONVIRTUAL_QUICK ): /* u1, u2; INVOKESPECIAL (or INVOKEVIRTUAL of a private method) of a resolved, non native method */
+		OPCODE( INVOKESTATIC_QUICK ): /* u1, u2; INVOKESTATIC of a resolved, non native method of an initialized class */
+		{
+			uint16 index= opcode_readU2( pc+1 );
+			pc+= 3;
+			
+			CONSTANT_Methodref_info* methodref= (CONSTANT_Methodref_info*)sf->currentClass->constant_pool[index];
+			
+			/* prepare pc, push new stack frame and invoke method by continuing execution */
+			sf->pc= pc;
+			sf= stack_pushFrame( stack, methodref->class, methodref->methodInfo );  /* overwrites sf! */
+			code= sf->methodInfo->code->code;
+			pc= code;
+			SAFE_POINT();
+			
+			logVerbose( "\t===> Executing method %s.%s%s...\n", sf->currentClass->className, sf->methodInfo->name, sf->methodInfo->descriptor );
+			JIT_METHOD_ENTRY();
+			NEXT_OPCODE;
+		}
+			
+		OPCODE( INVOKEINTERFACE_QUICK ): /* u1, u2, u1, u1; INVOKEINTERFACE of a resolved interface method, operand is the inline cache index */
+		{
+			uint16 cacheIndex= opcode_readU2( pc+1 );
+			pc+= 3;
+			
+			uint8 parameterSlotCount= *pc;
+			pc++;
+			pc++; /* discard following 0 */
+			
+			/* The interface method itself is resolved, take the implementation from the inline cache or from the itable of the class of objectref. */
+			InlineCache* cache= &sf->methodInfo->code->inlineCaches[cacheIndex];
+			reference objectRef= (reference)*(stack->stackPointer - parameterSlotCount);
+			method_info* methodInfo= ic_getTarget( cache, heap_getClassOfInstance(objectRef) );
+			
+			if( methodInfo == NULL )
+			{
+				logVerbose( "Method not found %s.%s%s\n", cache->methodInfo->declaringClass->className, cache->methodInfo->name, cache->methodInfo->descriptor );
+				error( "Execution haltet." );
+			}
+			
+			Class* objectClass= methodInfo->declaringClass;
+			
+			if( isFlagSet(methodInfo->access_flags, ACC_NATIVE) )
+			{
+				logVerbose( "===> Executing native method %s.%s%s...\n", objectClass->className, methodInfo->name, methodInfo->descriptor );
+				sf->pc= pc;
+				native_handleNativeMethodCall( objectClass, methodInfo, stack  );
+				NEXT_OPCODE;
+			}
+			
+			/* prepare pc, push new stack frame and invoke method by continuing execution */
+			sf->pc= pc;
+			sf= stack_pushFrame( stack, objectClass, methodInfo );  /* overwrites sf! */
+			code= sf->methodInfo->code->code;
+			pc= code;
+			SAFE_POINT();
+			
+			logVerbose( "\t===> Executing method %s.%s%s...\n", sf->currentClass->className, sf->methodInfo->name, sf->methodInfo->descriptor );
+			JIT_METHOD_ENTRY();
+			NEXT_OPCODE;
+		}
+			
+		OPCODE( NEW_QUICK ): /* u1, u2; NEW of a resolved and initialized class */
+		{
+			sf->pc= pc;
+			gc_collectIfNecessary();
+			
+			uint16 index= opcode_readU2( pc+1 );
+			pc+= 3;
+			
+			Class* newCls= ((CONSTANT_Class_info*)sf->currentClass->constant_pool[index])->class;
+			reference newRef= heap_newInstance( newCls );
+			stack_pushSlot( stack, newRef );
+			logVerbose( "\tCreating new instance of class %s. Reference number is %i.\n", newCls->className, newRef );
+			NEXT_OPCODE;
+		}
+			
+		OPCODE( ANEWARRAY_QUICK ): /* u1, u2; ANEWARRAY of a resolved array class */
+		{
+			sf->pc= pc;
+			gc_collectIfNecessary();
+			
+			uint16 index= opcode_readU2( pc+1 );
+			pc+= 3;
+			
+			Class* arrayType= ((CONSTANT_Class_info*)sf->currentClass->constant_pool[index])->arrayClass;
+			int32 count= stack_popSlot( stack );
+			
+			if( count < 0 )
+				error( "NegativeArraySizeException: A negative number of array entries is not allowed." );
+			
+			reference arRef= heap_newOneSlotArrayInstance( count, arrayType );
+			stack_pushSlot( stack, arRef );
+			
+			logVerbose( "Creating new array of reference type. Reference is %i, size is %i.\n", arRef, count );
+			NEXT_OPCODE;
+		}
+			
+		OPCODE( CHECKCAST_QUICK ): /* u1, u2; CHECKCAST against a resolved class */
+		{
+			uint16 index= opcode_readU2( pc+1 );
+			pc+= 3;
+			
+			/* The reference stays on the stack, a null reference is fine in this case. */
+			reference objectRef= *(stack->stackPointer - 1);
+			if( objectRef == NULL_REFERENCE )
+				NEXT_OPCODE;
+			
+			Class* poolClass= ((CONSTANT_Class_info*)sf->currentClass->constant_pool[index])->class;
+			boolean result;
+			
+			if( isFlagSet(poolClass->access_flags, ACC_INTERFACE) )
+				result= cls_implementsInterface( heap_getClassOfInstance(objectRef), poolClass );
+			else
+				result= heap_isObjectInstanceOf( objectRef, poolClass );
+			
+			logVerbose( "\tIs instance of: %s\n", result ? "yes" : "no" );
+			
+			if( result == false )
+				error( "ClassCastException" );
+			
+			NEXT_OPCODE;
+		}
+			
+		OPCODE( INSTANCEOF_QUICK ): /* u1, u2; INSTANCEOF against a resolved class */
+		{
+			uint16 index= opcode_readU2( pc+1 );
+			pc+= 3;
+			
+			reference objectRef= stack_popSlot( stack );
+			boolean result= false;
+			
+			if( objectRef != NULL_REFERENCE )
+			{
+				Class* poolClass= ((CONSTANT_Class_info*)sf->currentClass->constant_pool[index])->class;
+			
+				if( isFlagSet(poolClass->access_flags, ACC_INTERFACE) )
+					result= cls_implementsInterface( heap_getClassOfInstance(objectRef), poolClass );
+				else
+					result= heap_isObjectInstanceOf( objectRef, poolClass );
+			}
+			
+			stack_pushSlot( stack, result ? 1 : 0 );
+			logVerbose( "\tIs instance of: %s\n", result ? "yes" : "no" );
+			NEXT_OPCODE;
+		}
+			
+		/* quick opcodes which are not used by Pura */
+		OPCODE( LDC2_W_QUICK ):
+		OPCODE( INVOKESUPER_QUICK ):
+		OPCODE( INVOKEVIRTUALOBJECT_QUICK ):
+		OPCODE( UNKNOWN3 ): /* UNKNOWN */
+		OPCODE( MULTIANEWARRAY_QUICK ):
+		OPCODE( INVOKEVIRTUAL_QUICK_W ):
+		OPCODE( GETFIELD_QUICK_W ):
 				
 		/* unused opcodes */
-		case UNUSED1:
-		case UNUSED2:
-		case UNUSED3:
-		case UNUSED4:
-		case UNUSED5:
-		case UNUSED6:
-		case UNUSED7:
-		case UNUSED8:
-		case UNUSED9:
-		case UNUSED10:
-		case UNUSED11:
-		case UNUSED12:
-		case UNUSED13:
-		case UNUSED14:
-		case UNUSED15:
-		case UNUSED16:
-		case UNUSED17:
-		case UNUSED18:
-		case UNUSED19:
-		case UNUSED20:
-		case UNUSED21:
-		case UNUSED22:
-		case UNUSED23:
-		case UNUSED24:
-		case UNUSED25:
+		OPCODE( UNUSED1 ):
+		OPCODE( UNUSED2 ):
+		OPCODE( UNUSED3 ):
+		OPCODE( UNUSED4 ):
+		OPCODE( UNUSED5 ):
+		OPCODE( UNUSED6 ):
+		OPCODE( UNUSED7 ):
+		OPCODE( UNUSED8 ):
+		OPCODE( UNUSED9 ):
+		OPCODE( UNUSED10 ):
+		OPCODE( UNUSED11 ):
+		OPCODE( UNUSED12 ):
+		OPCODE( UNUSED13 ):
+		OPCODE( UNUSED14 ):
+		OPCODE( UNUSED15 ):
+		OPCODE( UNUSED16 ):
+		OPCODE( UNUSED17 ):
+		OPCODE( UNUSED18 ):
+		OPCODE( UNUSED19 ):
+		OPCODE( UNUSED20 ):
+		OPCODE( UNUSED21 ):
+		OPCODE( UNUSED22 ):
+		OPCODE( UNUSED23 ):
+		OPCODE( UNUSED24 ):
+		OPCODE( UNUSED25 ):
 				
-		case IMPDEP1: /* RESERVED: implementation depedant 1; must not appear in class file */
-		case IMPDEP2: /* RESERVED: implementation depedant 2; must not appear in class file */
+		OPCODE( IMPDEP1 ): /* RESERVED: implementation depedant 1; must not appear in class file */
+		OPCODE( IMPDEP2 ): /* RESERVED: implementation depedant 2; must not appear in class file */
 				
 		default:
 			unsupportedError( pc );
-			break;
+			NEXT_OPCODE;
 		}
-		
-		numberOfBytecodesExecuted++;
 	}
 	
 	return;
@@ -26,5 +26,10 @@
 extern boolean opcodeStatsEnabled;
 
 void interpreter_start( const char* mainClass );
+void interpreter_runThread( Stack* stack );
+void interpreter_addThreadStatistics();
+void interpreter_beginOperandRewrite();
+void interpreter_endOperandRewrite();
+reference interpreter_newArray( uint8 arrayType, int32 count );
 
 #endif /*_interpreter_h_*/
\ No newline at end of file
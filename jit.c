@@ -0,0 +1,1225 @@
+/*
+ *  jit.c
+ *  Baseline just-in-time compiler. A method which has been invoked or has taken a backward branch often enough (see the thresholds in jit.h) is translated
+ *  into x86-64 machine code, every instruction by a fixed template. The machine code works on the same stack frame as the interpreter: the locals and the
+ *  operand stack stay in memory, only the stack pointer is kept in a register. So the machine code can be entered at the start of every instruction and can
+ *  leave to the interpreter at every instruction, too, just by storing the pc and the stack pointer.
+ *  The interpreter enters the machine code at method entries and at the return addresses of invokes. The machine code leaves to the interpreter at all
+ *  instructions it doesn't support: invokes (including natives), returns, athrow, monitors, instructions which haven't been quickened yet (i.e. which still
+ *  need resolution) and the rest of the less common instructions. The interpreter then executes the instruction and continues with the method until it is
+ *  entered again. Failed null and bounds checks and divisions by 0 leave to the interpreter, too, which executes the instruction again and handles the error.
+ *  Allocations, the write barrier and safe points call helper functions, with the pc and stack pointer stored, so the garbage collector can run.
+ *  Only x86-64 using the System V calling convention (i.e. Linux) is supported. On other platforms, everything is interpreted.
+ *
+ *  Copyright (c) 2006, 2007 Daniel Klein. All rights reserved.
+ *
+ *  Licensed under GPL version 2.
+ *  See here for the full license: http://www.gnu.org/licenses/gpl.html
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "puraGlobals.h"
+#include "memoryManager.h"
+#include "class.h"
+#include "stack.h"
+#include "heap.h"
+#include "opcodes.h"
+#include "garbageCollector.h"
+#include "interpreter.h"
+#include "thread.h"
+#include "scheduler.h"
+#include "jit.h"
+#include "optimizingCompiler.h"
+
+boolean isJitEnabled= true;
+uint32 jitInvocationThreshold= JIT_INVOCATION_THRESHOLD;
+uint32 jitBackwardBranchThreshold= JIT_BACKWARD_BRANCH_THRESHOLD;
+
+#ifdef JIT_ENABLED
+
+/* kinds of out of line code at the end of the machine code of a method */
+#define STUB_INTERPRET 0 /* leave to the interpreter at the pc of the stub */
+#define STUB_SAFE_POINT 1 /* enter the safe point with the pc of the stub, then go on at the resume position */
+#define STUB_SWITCH_CHECK 2 /* leave the worker if the time slice is over, otherwise branch to the pc of the stub */
+
+typedef struct sBranch
+{
+	uint32 position; /* of the 32 bit displacement */
+	uint32 target; /* bytecode offset */
+} Branch;
+
+typedef struct sStub
+{
+	uint8 kind;
+	uint32 position; /* of the 32 bit displacement of the jump to the stub */
+	uint32 pc; /* bytecode offset */
+	uint32 resumePosition;
+} Stub;
+
+/* State of the compilation of one method. The machine code is emitted into a temporary buffer, and copied into the code cache when it's complete. */
+typedef struct sCompilation
+{
+	method_info* method;
+	byte* bytecode;
+	CodeBuffer buffer;
+	uint32* entryOffsets;
+	uint32 exitPosition; /* leaves to the interpreter at the pc in esi */
+	uint32 switchExitPosition; /* leaves the worker with the pc in esi */
+	Branch* branches;
+	uint32 branchCount;
+	Stub* stubs;
+	uint32 stubCount;
+} Compilation;
+
+byte* codeCache;
+uint32 codeCacheUsed= 0;
+
+/* statistics */
+uint32 compiledMethodCount= 0;
+uint32 recompiledMethodCount= 0;
+uint32 compiledBytecodeSize= 0;
+uint32 machineCodeSize= 0;
+
+/* counted per thread like the opcodes (see interpreter_addThreadStatistics()) */
+THREAD_LOCAL uint32 machineCodeEntryCount= 0;
+THREAD_LOCAL uint32 interpreterFallbackCount= 0;
+uint32 totalMachineCodeEntryCount= 0;
+uint32 totalInterpreterFallbackCount= 0;
+
+void jit_init()
+{
+	if( !isJitEnabled )
+		return;
+	
+	codeCache= mm_mapExecutableMemory( JIT_CODE_CACHE_SIZE );
+}
+
+/* helpers called by the machine code */
+
+void newInstanceHelper( Stack* stack, Class* cls )
+{
+	gc_collectIfNecessary();
+	stack_pushSlot( stack, heap_newInstance(cls) );
+}
+
+void newArrayHelper( Stack* stack, uint32 arrayType )
+{
+	gc_collectIfNecessary();
+	
+	int32 count= stack_popSlot( stack );
+	
+	if( count < 0 )
+		error( "NegativeArraySizeException: A negative number of array entries is not allowed." );
+	
+	stack_pushSlot( stack, interpreter_newArray(arrayType, count) );
+}
+
+void newObjectArrayHelper( Stack* stack, Class* arrayClass )
+{
+	gc_collectIfNecessary();
+	
+	int32 count= stack_popSlot( stack );
+	
+	if( count < 0 )
+		error( "NegativeArraySizeException: A negative number of array entries is not allowed." );
+	
+	stack_pushSlot( stack, heap_newOneSlotArrayInstance(count, arrayClass) );
+}
+
+void writeBarrierHelper( reference ref, slot value )
+{
+	heap_writeBarrier( ref, value );
+}
+
+boolean isSwitchDueHelper()
+{
+	return sched_isSwitchDue();
+}
+
+/* emitting machine code */
+
+void jit_initCodeBuffer( CodeBuffer* buffer, uint32 size )
+{
+	buffer->code= mm_staticMalloc( size );
+	buffer->length= 0;
+	buffer->size= size;
+}
+
+void jit_ensureCapacity( CodeBuffer* buffer, uint32 size )
+{
+	if( buffer->length + size <= buffer->size )
+		return;
+	
+	uint32 newSize= 2*buffer->size + size;
+	byte* newCode= mm_staticMalloc( newSize );
+	memcpy( newCode, buffer->code, buffer->length );
+	mm_staticFree( buffer->code );
+	buffer->code= newCode;
+	buffer->size= newSize;
+}
+
+void jit_emit8( CodeBuffer* buffer, uint8 value )
+{
+	buffer->code[buffer->length]= value;
+	buffer->length++;
+}
+
+void jit_emit32( CodeBuffer* buffer, uint32 value )
+{
+	memcpy( buffer->code + buffer->length, &value, 4 );
+	buffer->length+= 4;
+}
+
+void jit_emit64( CodeBuffer* buffer, uint64 value )
+{
+	memcpy( buffer->code + buffer->length, &value, 8 );
+	buffer->length+= 8;
+}
+
+/* emits the given bytes, which are given as a string of hex values, e.g. "41 8B 45" */
+void jit_emit( CodeBuffer* buffer, const char* bytes )
+{
+	while( *bytes != '\0' )
+	{
+		if( *bytes == ' ' )
+		{
+			bytes++;
+			continue;
+		}
+		
+		uint32 value;
+		sscanf( bytes, "%2x", &value );
+		jit_emit8( buffer, value );
+		bytes+= 2;
+	}
+}
+
+/* Sets the 32 bit displacement at the given position, so that it points to the given target. */
+void jit_patch32( CodeBuffer* buffer, uint32 position, uint32 target )
+{
+	int32 displacement= target - (position + 4);
+	memcpy( buffer->code + position, &displacement, 4 );
+}
+
+/* Copies the machine code into the code cache and frees the buffer. The machine code must not depend on its address, i.e. all calls and global data use
+   absolute addresses. Returns NULL if the code cache is full. */
+void* jit_installCode( CodeBuffer* buffer )
+{
+	uint32 alignedLength= (buffer->length + 15) & ~15;
+	void* code= NULL;
+	
+	if( codeCacheUsed + alignedLength <= JIT_CODE_CACHE_SIZE )
+	{
+		code= codeCache + codeCacheUsed;
+		memcpy( code, buffer->code, buffer->length );
+		codeCacheUsed+= alignedLength;
+	}
+	
+	mm_staticFree( buffer->code );
+	return code;
+}
+
+/* mov reg, imm64 */
+void emitLoadImmediate( Compilation* c, uint8 reg, uint64 value )
+{
+	jit_emit8( &c->buffer, 0x48 );
+	jit_emit8( &c->buffer, 0xB8 + reg );
+	jit_emit64( &c->buffer, value );
+}
+
+/* mov rax, function; call rax */
+void emitCall( Compilation* c, void* function )
+{
+	emitLoadImmediate( c, RAX, (uintptr_t)function );
+	jit_emit( &c->buffer, "FF D0" );
+}
+
+/* mov reg, [r13+offset] (i.e. relative to the stack pointer), 4 or 8 bytes */
+void emitLoadStack( Compilation* c, uint8 reg, int8 offset, boolean isWide )
+{
+	jit_emit8( &c->buffer, isWide ? 0x49 : 0x41 );
+	jit_emit8( &c->buffer, 0x8B );
+	jit_emit8( &c->buffer, 0x45 | (reg << 3) );
+	jit_emit8( &c->buffer, offset );
+}
+
+/* mov [r13+offset], reg */
+void emitStoreStack( Compilation* c, uint8 reg, int8 offset, boolean isWide )
+{
+	jit_emit8( &c->buffer, isWide ? 0x49 : 0x41 );
+	jit_emit8( &c->buffer, 0x89 );
+	jit_emit8( &c->buffer, 0x45 | (reg << 3) );
+	jit_emit8( &c->buffer, offset );
+}
+
+/* mov reg, [r12+4*index] (i.e. the local variable index) */
+void emitLoadLocal( Compilation* c, uint8 reg, uint32 index, boolean isWide )
+{
+	jit_emit8( &c->buffer, isWide ? 0x49 : 0x41 );
+	jit_emit8( &c->buffer, 0x8B );
+	jit_emit8( &c->buffer, 0x84 | (reg << 3) );
+	jit_emit8( &c->buffer, 0x24 );
+	jit_emit32( &c->buffer, index * sizeof(slot) );
+}
+
+/* mov [r12+4*index], reg */
+void emitStoreLocal( Compilation* c, uint8 reg, uint32 index, boolean isWide )
+{
+	jit_emit8( &c->buffer, isWide ? 0x49 : 0x41 );
+	jit_emit8( &c->buffer, 0x89 );
+	jit_emit8( &c->buffer, 0x84 | (reg << 3) );
+	jit_emit8( &c->buffer, 0x24 );
+	jit_emit32( &c->buffer, index * sizeof(slot) );
+}
+
+/* add r13, 4*slotCount */
+void emitAdjustStack( Compilation* c, int32 slotCount )
+{
+	jit_emit( &c->buffer, "49 83 C5" );
+	jit_emit8( &c->buffer, slotCount * sizeof(slot) );
+}
+
+void emitPushConstant( Compilation* c, uint32 value )
+{
+	jit_emit( &c->buffer, "41 C7 45 00" );
+	jit_emit32( &c->buffer, value );
+	emitAdjustStack( c, 1 );
+}
+
+/* Pushes a long or double. The high word is in the first slot, so the order of the words is swapped for the 8 byte store. */
+void emitPushWideConstant( Compilation* c, uint64 value )
+{
+	emitLoadImmediate( c, RAX, (value << 32) | (value >> 32) );
+	emitStoreStack( c, RAX, 0, true );
+	emitAdjustStack( c, 2 );
+}
+
+/* Loads the 64 bit value from [r13+offset] into rax or rcx, with the words in the right order. */
+void emitLoadLong( Compilation* c, uint8 reg, int8 offset )
+{
+	emitLoadStack( c, reg, offset, true );
+	jit_emit( &c->buffer, "48 C1" );
+	jit_emit8( &c->buffer, 0xC0 | reg );
+	jit_emit8( &c->buffer, 32 );
+}
+
+void emitStoreLong( Compilation* c, int8 offset )
+{
+	jit_emit( &c->buffer, "48 C1 C0 20" );
+	emitStoreStack( c, RAX, offset, true );
+}
+
+/* Stores the pc in esi (as bytecode offset) and the stack pointer, so that the interpreter or the garbage collector can take over the frame. */
+void emitStoreFrameState( Compilation* c )
+{
+	jit_emit( &c->buffer, "48 8D 04 33" ); /* lea rax, [rbx+rsi] */
+	jit_emit( &c->buffer, "49 89 47" ); /* mov [r15+pc], rax */
+	jit_emit8( &c->buffer, offsetof(StackFrame, pc) );
+	jit_emit( &c->buffer, "4D 89 6E" ); /* mov [r14+stackPointer], r13 */
+	jit_emit8( &c->buffer, offsetof(Stack, stackPointer) );
+}
+
+void emitReloadStackPointer( Compilation* c )
+{
+	jit_emit( &c->buffer, "4D 8B 6E" ); /* mov r13, [r14+stackPointer] */
+	jit_emit8( &c->buffer, offsetof(Stack, stackPointer) );
+}
+
+void emitSetPc( Compilation* c, uint32 pc )
+{
+	jit_emit8( &c->buffer, 0xBE ); /* mov esi, pc */
+	jit_emit32( &c->buffer, pc );
+}
+
+void emitJump( Compilation* c, uint32 position )
+{
+	jit_emit8( &c->buffer, 0xE9 );
+	jit_emit32( &c->buffer, 0 );
+	jit_patch32( &c->buffer, c->buffer.length - 4, position );
+}
+
+/* Emits a conditional jump to a stub, which is added to the end of the machine code. */
+void emitJumpToStub( Compilation* c, uint8 condition, uint8 kind, uint32 pc )
+{
+	if( condition == CONDITION_ALWAYS )
+	{
+		jit_emit8( &c->buffer, 0xE9 );
+	}
+	else
+	{
+		jit_emit8( &c->buffer, 0x0F );
+		jit_emit8( &c->buffer, 0x80 | condition );
+	}
+	
+	jit_emit32( &c->buffer, 0 );
+	
+	Stub* stub= &c->stubs[c->stubCount];
+	stub->kind= kind;
+	stub->position= c->buffer.length - 4;
+	stub->pc= pc;
+	stub->resumePosition= c->buffer.length;
+	c->stubCount++;
+}
+
+/* Emits a conditional jump to the machine code of the instruction at the given bytecode offset, which is resolved when the whole method is emitted. */
+void emitBranch( Compilation* c, uint8 condition, uint32 target )
+{
+	if( condition == CONDITION_ALWAYS )
+	{
+		jit_emit8( &c->buffer, 0xE9 );
+	}
+	else
+	{
+		jit_emit8( &c->buffer, 0x0F );
+		jit_emit8( &c->buffer, 0x80 | condition );
+	}
+	
+	jit_emit32( &c->buffer, 0 );
+	
+	Branch* branch= &c->branches[c->branchCount];
+	branch->position= c->buffer.length - 4;
+	branch->target= target;
+	c->branchCount++;
+}
+
+/* Backward branches are safe points and switch points (see interpreter.c), so they poll the stop the world request and, if green threads are used, the time
+   slice. Both are handled by stubs. */
+void emitBackwardBranch( Compilation* c, uint8 condition, uint32 target )
+{
+	uint32 skipPosition= 0;
+	
+	if( condition != CONDITION_ALWAYS )
+	{
+		jit_emit8( &c->buffer, 0x0F );
+		jit_emit8( &c->buffer, 0x80 | invertCondition(condition) );
+		jit_emit32( &c->buffer, 0 );
+		skipPosition= c->buffer.length - 4;
+	}
+	
+	emitLoadImmediate( c, RAX, (uintptr_t)&isStopTheWorldRequested );
+	jit_emit( &c->buffer, "83 38 00" ); /* cmp dword [rax], 0 */
+	emitJumpToStub( c, CONDITION_NOT_EQUAL, STUB_SAFE_POINT, target );
+	
+	if( sched_isEnabled() )
+	{
+		jit_emit( &c->buffer, "85 ED" ); /* test ebp, ebp (isSwitchingAllowed) */
+		emitJumpToStub( c, CONDITION_NOT_EQUAL, STUB_SWITCH_CHECK, target );
+	}
+	
+	/* The loop iterations are counted, when the loop has become hot, the machine code leaves at the loop header to continue in optimized machine code. */
+	emitLoadImmediate( c, RAX, (uintptr_t)&c->method->backwardBranchCount );
+	jit_emit( &c->buffer, "FF 00" ); /* inc dword [rax] */
+	jit_emit( &c->buffer, "81 38" ); /* cmp dword [rax], threshold */
+	jit_emit32( &c->buffer, optimizationBackwardBranchThreshold );
+	emitJumpToStub( c, CONDITION_EQUAL, STUB_INTERPRET, target );
+	
+	emitBranch( c, CONDITION_ALWAYS, target );
+	
+	if( condition != CONDITION_ALWAYS )
+		jit_patch32( &c->buffer, skipPosition, c->buffer.length );
+}
+
+void emitConditionalBranch( Compilation* c, uint8 condition, uint32 pc, uint32 target )
+{
+	if( target < pc )
+		emitBackwardBranch( c, condition, target );
+	else
+		emitBranch( c, condition, target );
+}
+
+/* Loads the object with the reference in ecx into rax. */
+void emitLoadObject( Compilation* c )
+{
+	emitLoadImmediate( c, RAX, (uintptr_t)&objectPointerList );
+	jit_emit( &c->buffer, "48 8B 00" ); /* mov rax, [rax] */
+	jit_emit( &c->buffer, "48 8B 04 C8" ); /* mov rax, [rax+rcx*8] */
+}
+
+/* Loads the array reference and the index of an array access from the stack, the reference into ecx, the index into edx and the array object into rax. Leaves
+   to the interpreter, if the reference is null or the index is out of bounds. */
+void emitArrayAccess( Compilation* c, uint32 pc, int8 referenceOffset )
+{
+	emitLoadStack( c, RCX, referenceOffset, false );
+	jit_emit( &c->buffer, "85 C9" ); /* test ecx, ecx */
+	emitJumpToStub( c, CONDITION_EQUAL, STUB_INTERPRET, pc );
+	emitLoadObject( c );
+	emitLoadStack( c, RDX, referenceOffset + sizeof(slot), false );
+	jit_emit( &c->buffer, "3B 50" ); /* cmp edx, [rax+length] */
+	jit_emit8( &c->buffer, sizeof(Object) );
+	emitJumpToStub( c, CONDITION_ABOVE_OR_EQUAL_UNSIGNED, STUB_INTERPRET, pc );
+}
+
+/* Loads the reference of a field access from the stack into ecx and the object into rax, leaves to the interpreter if the reference is null. */
+void emitFieldAccess( Compilation* c, uint32 pc, int8 referenceOffset )
+{
+	emitLoadStack( c, RCX, referenceOffset, false );
+	jit_emit( &c->buffer, "85 C9" ); /* test ecx, ecx */
+	emitJumpToStub( c, CONDITION_EQUAL, STUB_INTERPRET, pc );
+	emitLoadObject( c );
+}
+
+/* Calls the write barrier for the reference in ecx and the value in esi, unless the value is null. */
+void emitWriteBarrier( Compilation* c )
+{
+	jit_emit( &c->buffer, "85 F6" ); /* test esi, esi */
+	jit_emit( &c->buffer, "74 0E" ); /* jz over the call */
+	jit_emit( &c->buffer, "89 CF" ); /* mov edi, ecx */
+	emitCall( c, writeBarrierHelper );
+}
+
+/* Calls an allocation helper with the stack and the given argument. The helper may run the garbage collector, so the frame state is stored before. */
+void emitAllocation( Compilation* c, uint32 pc, void* helper, uint64 argument )
+{
+	emitSetPc( c, pc );
+	emitStoreFrameState( c );
+	jit_emit( &c->buffer, "4C 89 F7" ); /* mov rdi, r14 */
+	emitLoadImmediate( c, RSI, argument );
+	emitCall( c, helper );
+	emitReloadStackPointer( c );
+}
+
+void emitEpilogue( Compilation* c )
+{
+	jit_emit( &c->buffer, "48 83 C4 08" ); /* add rsp, 8 */
+	jit_emit( &c->buffer, "41 5F 41 5E 41 5D 41 5C 5B 5D C3" ); /* pop r15, r14, r13, r12, rbx, rbp; ret */
+}
+
+/* The prologue saves the callee saved registers and sets up the registers used by the machine code of all instructions: rbx is the start of the bytecode,
+   r12 points to the locals, r13 is the stack pointer, r14 the stack, r15 the stack frame and ebp isSwitchingAllowed. Then it jumps to the given entry. */
+void emitPrologue( Compilation* c )
+{
+	jit_emit( &c->buffer, "55 53 41 54 41 55 41 56 41 57" ); /* push rbp, rbx, r12, r13, r14, r15 */
+	jit_emit( &c->buffer, "48 83 EC 08" ); /* sub rsp, 8 (keeps the stack aligned for calls) */
+	jit_emit( &c->buffer, "49 89 FE" ); /* mov r14, rdi */
+	jit_emit( &c->buffer, "49 89 F7" ); /* mov r15, rsi */
+	jit_emit( &c->buffer, "89 CD" ); /* mov ebp, ecx */
+	jit_emit( &c->buffer, "4C 8D 66" ); /* lea r12, [rsi+locals] */
+	jit_emit8( &c->buffer, sizeof(StackFrame) );
+	emitReloadStackPointer( c );
+	jit_emit( &c->buffer, "48 BB" ); /* mov rbx, bytecode */
+	jit_emit64( &c->buffer, (uintptr_t)c->bytecode );
+	jit_emit( &c->buffer, "FF E2" ); /* jmp rdx */
+	
+	c->exitPosition= c->buffer.length;
+	emitStoreFrameState( c );
+	jit_emit( &c->buffer, "31 C0" ); /* xor eax, eax */
+	emitEpilogue( c );
+	
+	c->switchExitPosition= c->buffer.length;
+	emitStoreFrameState( c );
+	jit_emit( &c->buffer, "B8 01 00 00 00" ); /* mov eax, 1 */
+	emitEpilogue( c );
+}
+
+void emitStubs( Compilation* c )
+{
+	uint32 i;
+	for( i= 0; i < c->stubCount; i++ )
+	{
+		jit_ensureCapacity( &c->buffer, 64 );
+		Stub* stub= &c->stubs[i];
+		jit_patch32( &c->buffer, stub->position, c->buffer.length );
+		
+		switch( stub->kind )
+		{
+			case STUB_INTERPRET:
+				emitSetPc( c, stub->pc );
+				emitJump( c, c->exitPosition );
+				break;
+			
+			case STUB_SAFE_POINT:
+				emitSetPc( c, stub->pc );
+				emitStoreFrameState( c );
+				emitCall( c, thread_enterSafePoint );
+				emitJump( c, stub->resumePosition );
+				break;
+			
+			case STUB_SWITCH_CHECK:
+				emitCall( c, isSwitchDueHelper );
+				jit_emit( &c->buffer, "85 C0" ); /* test eax, eax */
+				emitBranch( c, CONDITION_EQUAL, stub->pc );
+				emitSetPc( c, stub->pc );
+				emitJump( c, c->switchExitPosition );
+				break;
+		}
+	}
+}
+
+/* Emits the template of the instruction at the given pc. Returns false if the instruction isn't supported. */
+boolean emitInstruction( Compilation* c, uint8 opcode, uint32 pc )
+{
+	byte* operands= c->bytecode + pc + 1;
+	Class* cls= c->method->declaringClass;
+	
+	switch( opcode )
+	{
+		/* constants */
+		case NOP:
+			return true;
+		
+		case ACONST_NULL:
+			emitPushConstant( c, NULL_REFERENCE );
+			return true;
+		
+		case ICONST_M1: case ICONST_0: case ICONST_1: case ICONST_2: case ICONST_3: case ICONST_4: case ICONST_5:
+			emitPushConstant( c, opcode - ICONST_0 );
+			return true;
+		
+		case LCONST_0: case LCONST_1:
+			emitPushWideConstant( c, opcode - LCONST_0 );
+			return true;
+		
+		case FCONST_0: case FCONST_1: case FCONST_2:
+		{
+			float value= opcode - FCONST_0;
+			uint32 bits;
+			memcpy( &bits, &value, 4 );
+			emitPushConstant( c, bits );
+			return true;
+		}
+		
+		case DCONST_0: case DCONST_1:
+		{
+			double value= opcode - DCONST_0;
+			uint64 bits;
+			memcpy( &bits, &value, 8 );
+			emitPushWideConstant( c, bits );
+			return true;
+		}
+		
+		case BIPUSH:
+			emitPushConstant( c, (int8)operands[0] );
+			return true;
+		
+		case SIPUSH:
+			emitPushConstant( c, opcode_readS2(operands) );
+			return true;
+		
+		case LDC:
+		case LDC_W:
+		{
+			uint16 index= opcode == LDC ? operands[0] : opcode_readU2( operands );
+			uint8 tag= cls->constant_pool[index]->tag;
+			
+			/* Strings are created by the interpreter, when the instruction is executed the first time. */
+			if( tag != CONSTANT_Integer && tag != CONSTANT_Float )
+				return false;
+			
+			emitPushConstant( c, cls_getItemFromConstantPool(cls, index) );
+			return true;
+		}
+		
+		case LDC_QUICK:
+		case LDC_W_QUICK:
+		{
+			uint16 index= opcode == LDC_QUICK ? operands[0] : opcode_readU2( operands );
+			emitPushConstant( c, ((CONSTANT_String_info*)cls->constant_pool[index])->stringRef );
+			return true;
+		}
+		
+		case LDC2_W:
+			emitPushWideConstant( c, cls_getWideItemFromConstantPool(cls, opcode_readU2(operands)) );
+			return true;
+		
+		/* local variables */
+		case ILOAD: case FLOAD: case ALOAD:
+			emitLoadLocal( c, RAX, operands[0], false );
+			emitStoreStack( c, RAX, 0, false );
+			emitAdjustStack( c, 1 );
+			return true;
+		
+		case LLOAD: case DLOAD:
+			emitLoadLocal( c, RAX, operands[0], true );
+			emitStoreStack( c, RAX, 0, true );
+			emitAdjustStack( c, 2 );
+			return true;
+		
+		case ILOAD_0: case ILOAD_1: case ILOAD_2: case ILOAD_3:
+		case FLOAD_0: case FLOAD_1: case FLOAD_2: case FLOAD_3:
+		case ALOAD_0: case ALOAD_1: case ALOAD_2: case ALOAD_3:
+			emitLoadLocal( c, RAX, (opcode - ILOAD_0) % 4, false );
+			emitStoreStack( c, RAX, 0, false );
+			emitAdjustStack( c, 1 );
+			return true;
+		
+		case LLOAD_0: case LLOAD_1: case LLOAD_2: case LLOAD_3:
+		case DLOAD_0: case DLOAD_1: case DLOAD_2: case DLOAD_3:
+			emitLoadLocal( c, RAX, (opcode - ILOAD_0) % 4, true );
+			emitStoreStack( c, RAX, 0, true );
+			emitAdjustStack( c, 2 );
+			return true;
+		
+		case ISTORE: case FSTORE: case ASTORE:
+			emitAdjustStack( c, -1 );
+			emitLoadStack( c, RAX, 0, false );
+			emitStoreLocal( c, RAX, operands[0], false );
+			return true;
+		
+		case LSTORE: case DSTORE:
+			emitAdjustStack( c, -2 );
+			emitLoadStack( c, RAX, 0, true );
+			emitStoreLocal( c, RAX, operands[0], true );
+			return true;
+		
+		case ISTORE_0: case ISTORE_1: case ISTORE_2: case ISTORE_3:
+		case FSTORE_0: case FSTORE_1: case FSTORE_2: case FSTORE_3:
+		case ASTORE_0: case ASTORE_1: case ASTORE_2: case ASTORE_3:
+			emitAdjustStack( c, -1 );
+			emitLoadStack( c, RAX, 0, false );
+			emitStoreLocal( c, RAX, (opcode - ISTORE_0) % 4, false );
+			return true;
+		
+		case LSTORE_0: case LSTORE_1: case LSTORE_2: case LSTORE_3:
+		case DSTORE_0: case DSTORE_1: case DSTORE_2: case DSTORE_3:
+			emitAdjustStack( c, -2 );
+			emitLoadStack( c, RAX, 0, true );
+			emitStoreLocal( c, RAX, (opcode - ISTORE_0) % 4, true );
+			return true;
+		
+		case IINC:
+			jit_emit( &c->buffer, "41 83 84 24" ); /* add dword [r12+4*index], constant */
+			jit_emit32( &c->buffer, operands[0] * sizeof(slot) );
+			jit_emit8( &c->buffer, operands[1] );
+			return true;
+		
+		/* arrays */
+		case IALOAD: case FALOAD: case AALOAD:
+			emitArrayAccess( c, pc, -8 );
+			jit_emit( &c->buffer, "8B 44 90" ); /* mov eax, [rax+rdx*4+data] */
+			jit_emit8( &c->buffer, sizeof(Object) + sizeof(slot) );
+			emitStoreStack( c, RAX, -8, false );
+			emitAdjustStack( c, -1 );
+			return true;
+		
+		case BALOAD:
+			emitArrayAccess( c, pc, -8 );
+			jit_emit( &c->buffer, "0F BE 44 10" ); /* movsx eax, byte [rax+rdx+data] */
+			jit_emit8( &c->buffer, sizeof(Object) + sizeof(slot) );
+			emitStoreStack( c, RAX, -8, false );
+			emitAdjustStack( c, -1 );
+			return true;
+		
+		case CALOAD:
+			emitArrayAccess( c, pc, -8 );
+			jit_emit( &c->buffer, "0F B7 44 50" ); /* movzx eax, word [rax+rdx*2+data] */
+			jit_emit8( &c->buffer, sizeof(Object) + sizeof(slot) );
+			emitStoreStack( c, RAX, -8, false );
+			emitAdjustStack( c, -1 );
+			return true;
+		
+		case IASTORE: case FASTORE: case AASTORE:
+			emitArrayAccess( c, pc, -12 );
+			emitLoadStack( c, RSI, -4, false );
+			jit_emit( &c->buffer, "89 74 90" ); /* mov [rax+rdx*4+data], esi */
+			jit_emit8( &c->buffer, sizeof(Object) + sizeof(slot) );
+			emitAdjustStack( c, -3 );
+			if( opcode == AASTORE )
+				emitWriteBarrier( c );
+			return true;
+		
+		case BASTORE:
+			emitArrayAccess( c, pc, -12 );
+			emitLoadStack( c, RSI, -4, false );
+			jit_emit( &c->buffer, "40 88 74 10" ); /* mov [rax+rdx+data], sil */
+			jit_emit8( &c->buffer, sizeof(Object) + sizeof(slot) );
+			emitAdjustStack( c, -3 );
+			return true;
+		
+		case CASTORE:
+			emitArrayAccess( c, pc, -12 );
+			emitLoadStack( c, RSI, -4, false );
+			jit_emit( &c->buffer, "66 89 74 50" ); /* mov [rax+rdx*2+data], si */
+			jit_emit8( &c->buffer, sizeof(Object) + sizeof(slot) );
+			emitAdjustStack( c, -3 );
+			return true;
+		
+		case ARRAYLENGTH:
+			emitFieldAccess( c, pc, -4 );
+			jit_emit( &c->buffer, "8B 40" ); /* mov eax, [rax+length] */
+			jit_emit8( &c->buffer, sizeof(Object) );
+			emitStoreStack( c, RAX, -4, false );
+			return true;
+		
+		/* operand stack */
+		case POP:
+			emitAdjustStack( c, -1 );
+			return true;
+		
+		case POP2:
+			emitAdjustStack( c, -2 );
+			return true;
+		
+		case DUP:
+			emitLoadStack( c, RAX, -4, false );
+			emitStoreStack( c, RAX, 0, false );
+			emitAdjustStack( c, 1 );
+			return true;
+		
+		case DUP_X1:
+			emitLoadStack( c, RAX, -4, false );
+			emitLoadStack( c, RCX, -8, false );
+			emitStoreStack( c, RAX, -8, false );
+			emitStoreStack( c, RCX, -4, false );
+			emitStoreStack( c, RAX, 0, false );
+			emitAdjustStack( c, 1 );
+			return true;
+		
+		case DUP2:
+			emitLoadStack( c, RAX, -8, true );
+			emitStoreStack( c, RAX, 0, true );
+			emitAdjustStack( c, 2 );
+			return true;
+		
+		case SWAP:
+			emitLoadStack( c, RAX, -4, false );
+			emitLoadStack( c, RCX, -8, false );
+			emitStoreStack( c, RAX, -8, false );
+			emitStoreStack( c, RCX, -4, false );
+			return true;
+		
+		/* integer arithmetic */
+		case IADD:
+		case ISUB:
+		case IAND:
+		case IOR:
+		case IXOR:
+		{
+			uint8 operation= opcode == IADD ? 0x01 : opcode == ISUB ? 0x29 : opcode == IAND ? 0x21 : opcode == IOR ? 0x09 : 0x31;
+			emitLoadStack( c, RAX, -4, false );
+			jit_emit8( &c->buffer, 0x41 ); /* op [r13-8], eax */
+			jit_emit8( &c->buffer, operation );
+			jit_emit( &c->buffer, "45 F8" );
+			emitAdjustStack( c, -1 );
+			return true;
+		}
+		
+		case IMUL:
+			emitLoadStack( c, RAX, -8, false );
+			jit_emit( &c->buffer, "41 0F AF 45 FC" ); /* imul eax, [r13-4] */
+			emitStoreStack( c, RAX, -8, false );
+			emitAdjustStack( c, -1 );
+			return true;
+		
+		case IDIV:
+		case IREM:
+			/* Division by 0 is handled by the interpreter. Dividing the smallest int by -1 overflows, which raises a hardware exception on x86, so the
+			   interpreter does this, too. */
+			emitLoadStack( c, RCX, -4, false );
+			jit_emit( &c->buffer, "85 C9" ); /* test ecx, ecx */
+			emitJumpToStub( c, CONDITION_EQUAL, STUB_INTERPRET, pc );
+			jit_emit( &c->buffer, "83 F9 FF" ); /* cmp ecx, -1 */
+			emitJumpToStub( c, CONDITION_EQUAL, STUB_INTERPRET, pc );
+			emitLoadStack( c, RAX, -8, false );
+			jit_emit( &c->buffer, "99 F7 F9" ); /* cdq; idiv ecx */
+			emitStoreStack( c, opcode == IDIV ? RAX : RDX, -8, false );
+			emitAdjustStack( c, -1 );
+			return true;
+		
+		case INEG:
+			jit_emit( &c->buffer, "41 F7 5D FC" ); /* neg dword [r13-4] */
+			return true;
+		
+		case ISHL:
+		case ISHR:
+		case IUSHR:
+			emitLoadStack( c, RCX, -4, false );
+			emitAdjustStack( c, -1 );
+			jit_emit( &c->buffer, "41 D3" ); /* shl/sar/shr dword [r13-4], cl */
+			jit_emit8( &c->buffer, opcode == ISHL ? 0x65 : opcode == ISHR ? 0x7D : 0x6D );
+			jit_emit8( &c->buffer, 0xFC );
+			return true;
+		
+		case I2B:
+			jit_emit( &c->buffer, "41 0F BE 45 FC" ); /* movsx eax, byte [r13-4] */
+			emitStoreStack( c, RAX, -4, false );
+			return true;
+		
+		case I2C:
+			jit_emit( &c->buffer, "41 0F B7 45 FC" ); /* movzx eax, word [r13-4] */
+			emitStoreStack( c, RAX, -4, false );
+			return true;
+		
+		case I2S:
+			jit_emit( &c->buffer, "41 0F BF 45 FC" ); /* movsx eax, word [r13-4] */
+			emitStoreStack( c, RAX, -4, false );
+			return true;
+		
+		/* long arithmetic */
+		case LADD:
+		case LSUB:
+		case LAND:
+		case LOR:
+		case LXOR:
+		{
+			uint8 operation= opcode == LADD ? 0x01 : opcode == LSUB ? 0x29 : opcode == LAND ? 0x21 : opcode == LOR ? 0x09 : 0x31;
+			emitLoadLong( c, RAX, -16 );
+			emitLoadLong( c, RCX, -8 );
+			jit_emit8( &c->buffer, 0x48 ); /* op rax, rcx */
+			jit_emit8( &c->buffer, operation );
+			jit_emit8( &c->buffer, 0xC8 );
+			emitStoreLong( c, -16 );
+			emitAdjustStack( c, -2 );
+			return true;
+		}
+		
+		case LNEG:
+			emitLoadLong( c, RAX, -8 );
+			jit_emit( &c->buffer, "48 F7 D8" ); /* neg rax */
+			emitStoreLong( c, -8 );
+			return true;
+		
+		case LCMP:
+			emitLoadLong( c, RAX, -16 );
+			emitLoadLong( c, RCX, -8 );
+			jit_emit( &c->buffer, "48 39 C8" ); /* cmp rax, rcx */
+			jit_emit( &c->buffer, "0F 9F C0 0F 9C C1" ); /* setg al; setl cl */
+			jit_emit( &c->buffer, "0F B6 C0 0F B6 C9" ); /* movzx eax, al; movzx ecx, cl */
+			jit_emit( &c->buffer, "29 C8" ); /* sub eax, ecx */
+			emitStoreStack( c, RAX, -16, false );
+			emitAdjustStack( c, -3 );
+			return true;
+		
+		case I2L:
+			jit_emit( &c->buffer, "49 63 45 FC" ); /* movsxd rax, dword [r13-4] */
+			emitStoreLong( c, -4 );
+			emitAdjustStack( c, 1 );
+			return true;
+		
+		case L2I:
+			emitLoadStack( c, RAX, -4, false );
+			emitStoreStack( c, RAX, -8, false );
+			emitAdjustStack( c, -1 );
+			return true;
+		
+		/* branches */
+		case IFEQ: case IFNE: case IFLT: case IFGE: case IFGT: case IFLE:
+		case IFNULL: case IFNONNULL:
+		{
+			uint8 conditions[]= { CONDITION_EQUAL, CONDITION_NOT_EQUAL, CONDITION_LESS, CONDITION_GREATER_OR_EQUAL, CONDITION_GREATER, CONDITION_LESS_OR_EQUAL };
+			uint8 condition= opcode == IFNULL ? CONDITION_EQUAL : opcode == IFNONNULL ? CONDITION_NOT_EQUAL : conditions[opcode - IFEQ];
+			emitAdjustStack( c, -1 );
+			jit_emit( &c->buffer, "41 83 7D 00 00" ); /* cmp dword [r13], 0 */
+			emitConditionalBranch( c, condition, pc, opcode_readU2(operands) );
+			return true;
+		}
+		
+		case IF_ICMPEQ: case IF_ICMPNE: case IF_ICMPLT: case IF_ICMPGE: case IF_ICMPGT: case IF_ICMPLE:
+		case IF_ACMPEQ: case IF_ACMPNE:
+		{
+			uint8 conditions[]= { CONDITION_EQUAL, CONDITION_NOT_EQUAL, CONDITION_LESS, CONDITION_GREATER_OR_EQUAL, CONDITION_GREATER, CONDITION_LESS_OR_EQUAL,
+				CONDITION_EQUAL, CONDITION_NOT_EQUAL };
+			emitAdjustStack( c, -2 );
+			emitLoadStack( c, RAX, 0, false );
+			jit_emit( &c->buffer, "41 3B 45 04" ); /* cmp eax, [r13+4] */
+			emitConditionalBranch( c, conditions[opcode - IF_ICMPEQ], pc, opcode_readU2(operands) );
+			return true;
+		}
+		
+		case GOTO:
+			emitConditionalBranch( c, CONDITION_ALWAYS, pc, opcode_readU2(operands) );
+			return true;
+		
+		case GOTO_W:
+			emitConditionalBranch( c, CONDITION_ALWAYS, pc, opcode_readS4(operands) );
+			return true;
+		
+		/* fields of resolved instructions */
+		case GETSTATIC_QUICK:
+		case GETSTATIC2_QUICK:
+		{
+			CONSTANT_Fieldref_info* fieldref= (CONSTANT_Fieldref_info*)cls->constant_pool[opcode_readU2(operands)];
+			boolean isWide= opcode == GETSTATIC2_QUICK;
+			emitLoadImmediate( c, RAX, (uintptr_t)(fieldref->class->class_inctance_variable_slots + fieldref->variableInfo->slot_index) );
+			jit_emit( &c->buffer, isWide ? "48 8B 00" : "8B 00" ); /* mov rax, [rax] */
+			emitStoreStack( c, RAX, 0, isWide );
+			emitAdjustStack( c, isWide ? 2 : 1 );
+			return true;
+		}
+		
+		case PUTSTATIC_QUICK:
+		case PUTSTATIC2_QUICK:
+		{
+			CONSTANT_Fieldref_info* fieldref= (CONSTANT_Fieldref_info*)cls->constant_pool[opcode_readU2(operands)];
+			boolean isWide= opcode == PUTSTATIC2_QUICK;
+			emitAdjustStack( c, isWide ? -2 : -1 );
+			emitLoadStack( c, RSI, 0, isWide );
+			emitLoadImmediate( c, RAX, (uintptr_t)(fieldref->class->class_inctance_variable_slots + fieldref->variableInfo->slot_index) );
+			jit_emit( &c->buffer, isWide ? "48 89 30" : "89 30" ); /* mov [rax], rsi */
+			return true;
+		}
+		
+		case GETFIELD_QUICK:
+			emitFieldAccess( c, pc, -4 );
+			jit_emit( &c->buffer, "8B 80" ); /* mov eax, [rax+slot] */
+			jit_emit32( &c->buffer, sizeof(Object) + opcode_readU2(operands) * sizeof(slot) );
+			emitStoreStack( c, RAX, -4, false );
+			return true;
+		
+		case GETFIELD2_QUICK:
+			emitFieldAccess( c, pc, -4 );
+			jit_emit( &c->buffer, "48 8B 80" ); /* mov rax, [rax+slot] */
+			jit_emit32( &c->buffer, sizeof(Object) + opcode_readU2(operands) * sizeof(slot) );
+			emitStoreStack( c, RAX, -4, true );
+			emitAdjustStack( c, 1 );
+			return true;
+		
+		case PUTFIELD_QUICK:
+		case APUTFIELD_QUICK:
+			emitFieldAccess( c, pc, -8 );
+			emitLoadStack( c, RSI, -4, false );
+			jit_emit( &c->buffer, "89 B0" ); /* mov [rax+slot], esi */
+			jit_emit32( &c->buffer, sizeof(Object) + opcode_readU2(operands) * sizeof(slot) );
+			emitAdjustStack( c, -2 );
+			
+			if( opcode == APUTFIELD_QUICK )
+				emitWriteBarrier( c );
+			return true;
+		
+		case PUTFIELD2_QUICK:
+			emitFieldAccess( c, pc, -12 );
+			emitLoadStack( c, RSI, -8, true );
+			jit_emit( &c->buffer, "48 89 B0" ); /* mov [rax+slot], rsi */
+			jit_emit32( &c->buffer, sizeof(Object) + opcode_readU2(operands) * sizeof(slot) );
+			emitAdjustStack( c, -3 );
+			return true;
+		
+		/* allocation of resolved classes */
+		case NEW_QUICK:
+			emitAllocation( c, pc, newInstanceHelper, (uintptr_t)((CONSTANT_Class_info*)cls->constant_pool[opcode_readU2(operands)])->class );
+			return true;
+		
+		case ANEWARRAY_QUICK:
+			emitAllocation( c, pc, newObjectArrayHelper, (uintptr_t)((CONSTANT_Class_info*)cls->constant_pool[opcode_readU2(operands)])->arrayClass );
+			return true;
+		
+		case NEWARRAY:
+			emitAllocation( c, pc, newArrayHelper, operands[0] );
+			return true;
+	}
+	
+	return false;
+}
+
+/* Translates the given method into machine code. Several threads may try to compile the same method at the same time, so only the first one does. */
+void jit_compile( method_info* method )
+{
+	if( !isJitEnabled || method->code == NULL )
+		return;
+	
+	thread_lockMethodArea();
+	
+	if( method->compiledMethod != NULL || method->compilationCount >= JIT_MAX_COMPILATION_COUNT )
+	{
+		thread_unlockMethodArea();
+		return;
+	}
+	
+	method->compilationCount++;
+	
+	Compilation compilation;
+	Compilation* c= &compilation;
+	uint32 codeLength= method->code->code_length;
+	c->method= method;
+	c->bytecode= method->code->code;
+	jit_initCodeBuffer( &c->buffer, 64 * codeLength + 256 );
+	c->entryOffsets= mm_staticMalloc( codeLength * sizeof(uint32) );
+	c->branches= mm_staticMalloc( codeLength * sizeof(Branch) ); /* at most one per byte of bytecode */
+	c->branchCount= 0;
+	c->stubs= mm_staticMalloc( 2 * codeLength * sizeof(Stub) );
+	c->stubCount= 0;
+	
+	uint32 pc;
+	for( pc= 0; pc < codeLength; pc++ )
+		c->entryOffsets[pc]= NO_ENTRY_OFFSET;
+	
+	emitPrologue( c );
+	
+	uint32 length;
+	for( pc= 0; pc < codeLength; pc+= length )
+	{
+		/* The interpreter may quicken the instruction at the same time. Its operands are written before the opcode, so they have to be read after it. */
+		uint8 opcode= *(volatile byte*)(c->bytecode + pc);
+		__sync_synchronize();
+		length= opcode_getInstructionLength( c->bytecode, pc );
+		
+		jit_ensureCapacity( &c->buffer, 256 );
+		c->entryOffsets[pc]= c->buffer.length;
+		
+		if( !emitInstruction(c, opcode, pc) )
+		{
+			emitSetPc( c, pc );
+			emitJump( c, c->exitPosition );
+		}
+	}
+	
+	emitStubs( c );
+	
+	uint32 i;
+	for( i= 0; i < c->branchCount; i++ )
+		jit_patch32( &c->buffer, c->branches[i].position, c->entryOffsets[c->branches[i].target] );
+	
+	uint32 codeSize= c->buffer.length;
+	CompiledCode code= jit_installCode( &c->buffer );
+	
+	if( code == NULL )
+	{
+		logWarning( "The code cache is full, %s.%s%s is not compiled.\n", method->declaringClass->className, method->name, method->descriptor );
+		method->compilationCount= JIT_MAX_COMPILATION_COUNT;
+		mm_staticFree( c->entryOffsets );
+	}
+	else
+	{
+		CompiledMethod* compiledMethod= mm_staticMalloc( sizeof(CompiledMethod) );
+		compiledMethod->code= code;
+		compiledMethod->codeSize= codeSize;
+		compiledMethod->entryOffsets= c->entryOffsets;
+		
+		if( method->compilationCount > 1 )
+			recompiledMethodCount++;
+		else
+			compiledMethodCount++;
+		
+		compiledBytecodeSize+= codeLength;
+		machineCodeSize+= codeSize;
+		
+		logVerbose( "Compiled %s.%s%s: %i bytes of bytecode, %i bytes of machine code.\n", method->declaringClass->className, method->name, method->descriptor,
+			codeLength, codeSize );
+		
+		/* Other threads must not see the compiled method before its machine code. */
+		__sync_synchronize();
+		method->compiledMethod= compiledMethod;
+	}
+	
+	mm_staticFree( c->branches );
+	mm_staticFree( c->stubs );
+	
+	thread_unlockMethodArea();
+}
+
+/* Checks if the interpreter is going to quicken the given instruction, i.e. if its machine code could use the quick form now. */
+boolean isQuickenedByInterpreter( uint8 opcode )
+{
+	switch( opcode )
+	{
+		case LDC:
+		case LDC_W:
+		case GETSTATIC:
+		case PUTSTATIC:
+		case GETFIELD:
+		case PUTFIELD:
+		case NEW:
+		case ANEWARRAY:
+			return true;
+	}
+	
+	return false;
+}
+
+/* Runs the machine code of the current frame, starting at its stored pc. Returns true if the current green thread should give up its worker. Otherwise the
+   interpreter continues at the stored pc of the current frame. */
+boolean jit_run( Stack* stack, boolean isSwitchingAllowed )
+{
+	StackFrame* sf= stack->currentFrame;
+	method_info* method= sf->methodInfo;
+	
+	/* The optimized machine code is entered at the start of the method or at a loop header. It leaves at the first instruction it doesn't support, maybe in
+	   the frame of an inlined method, where the baseline machine code continues. */
+	if( method->optimizedMethod != NULL || method->loopOptimizedMethods != NULL )
+	{
+		if( opt_run(stack, isSwitchingAllowed) )
+			return true;
+		
+		sf= stack->currentFrame;
+		method= sf->methodInfo;
+	}
+	
+	CompiledMethod* compiledMethod= method->compiledMethod;
+	
+	/* The machine code may have been discarded by another thread in the meantime. */
+	if( compiledMethod == NULL )
+		return false;
+	
+	uint32 entryOffset= compiledMethod->entryOffsets[sf->pc - method->code->code];
+	if( opcodeStatsEnabled )
+		machineCodeEntryCount++;
+	
+	if( compiledMethod->code(stack, sf, (byte*)compiledMethod->code + entryOffset, isSwitchingAllowed) )
+		return true;
+	
+	if( opcodeStatsEnabled )
+		interpreterFallbackCount++;
+	
+	/* The machine code has been compiled before the instruction has been quickened, so it will always leave to the interpreter here. Compile the method
+	   again as soon as it's used often enough. The old machine code may still be used by other threads, so it is kept in the code cache. */
+	if( isQuickenedByInterpreter(*sf->pc) && method->compiledMethod == compiledMethod )
+	{
+		logVerbose( "Discarding the machine code of %s.%s%s, instruction %s is being quickened.\n", method->declaringClass->className, method->name,
+			method->descriptor, opcodeNames[*sf->pc] );
+		method->compiledMethod= NULL;
+		method->invocationCount= 0;
+		method->backwardBranchCount= 0;
+	}
+	
+	/* The machine code leaves at the header of a loop which has become hot, so that the loop continues in optimized machine code (on-stack
+	   replacement). */
+	if( method->backwardBranchCount == optimizationBackwardBranchThreshold )
+	{
+		opt_compileLoop( method, sf->pc - method->code->code );
+		return opt_run( stack, isSwitchingAllowed );
+	}
+	
+	return false;
+}
+
+/* Adds the entries and fallbacks of the current native thread to the totals and resets them. */
+void jit_addThreadStatistics()
+{
+	__sync_fetch_and_add( &totalMachineCodeEntryCount, machineCodeEntryCount );
+	__sync_fetch_and_add( &totalInterpreterFallbackCount, interpreterFallbackCount );
+	machineCodeEntryCount= 0;
+	interpreterFallbackCount= 0;
+}
+
+void jit_printStatistics()
+{
+	if( !isJitEnabled )
+		return;
+	
+	printf( "\nJIT Statistics:\n" );
+	printf( "Compiled methods: %i (recompiled: %i), %i bytes of bytecode, %i bytes of machine code\n", compiledMethodCount, recompiledMethodCount,
+		compiledBytecodeSize, machineCodeSize );
+	printf( "Entries into machine code: %i, fallbacks to the interpreter: %i\n", totalMachineCodeEntryCount,
+		totalInterpreterFallbackCount );
+	opt_printStatistics();
+}
+
+#else
+
+/* The JIT compiler isn't available on this platform, so everything is interpreted. */
+
+void jit_init()
+{
+	isJitEnabled= false;
+}
+
+void jit_compile( method_info* method )
+{
+}
+
+boolean jit_run( Stack* stack, boolean isSwitchingAllowed )
+{
+	return false;
+}
+
+void jit_addThreadStatistics()
+{
+}
+
+void jit_printStatistics()
+{
+}
+
+#endif
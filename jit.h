@@ -0,0 +1,107 @@
+/*
+ *  jit.h
+ *  Baseline just-in-time compiler, which translates frequently used methods into x86-64 machine code.
+ *
+ *  Copyright (c) 2006, 2007 Daniel Klein. All rights reserved.
+ *
+ *  Licensed under GPL version 2.
+ *  See here for the full license: http://www.gnu.org/licenses/gpl.html
+ */
+
+#ifndef _jit_h_
+#define _jit_h_
+
+#include "puraGlobals.h"
+#include "types.h"
+#include "class.h"
+#include "stack.h"
+
+/* thresholds of the mixed mode: a method is compiled as soon as it has been invoked or has taken a backward branch this often */
+#define JIT_INVOCATION_THRESHOLD 1000
+#define JIT_BACKWARD_BRANCH_THRESHOLD 10000
+
+/* A method is compiled again when its machine code leaves to the interpreter at an instruction which is just about to be quickened, but not more often than
+   this. */
+#define JIT_MAX_COMPILATION_COUNT 4
+
+/* size of the executable memory for the machine code of all methods */
+#define JIT_CODE_CACHE_SIZE (16*1024*1024)
+
+/* entry offset of the bytes which aren't the start of an instruction */
+#define NO_ENTRY_OFFSET 0xFFFFFFFF
+
+/* registers, numbered as in the ModRM byte, with the REX extension as bit 3 */
+#define RAX 0
+#define RCX 1
+#define RDX 2
+#define RBX 3
+#define RSP 4
+#define RBP 5
+#define RSI 6
+#define RDI 7
+#define R8 8
+#define R9 9
+#define R10 10
+#define R11 11
+#define R12 12
+#define R13 13
+#define R14 14
+#define R15 15
+
+/* condition codes of the conditional jumps */
+#define CONDITION_ABOVE_OR_EQUAL_UNSIGNED 0x3
+#define CONDITION_EQUAL 0x4
+#define CONDITION_NOT_EQUAL 0x5
+#define CONDITION_LESS 0xC
+#define CONDITION_GREATER_OR_EQUAL 0xD
+#define CONDITION_LESS_OR_EQUAL 0xE
+#define CONDITION_GREATER 0xF
+#define CONDITION_ALWAYS 0x10
+
+#define invertCondition( condition ) ((condition) ^ 1)
+
+/* Machine code of a method. It is called with the stack and the frame of the method and the address to start at, which is taken from the entry offsets. It
+   returns to the caller (i.e. the interpreter) with the pc of the frame and the stack pointer stored, true if the current green thread should give up its
+   worker and false if the interpreter should continue at the stored pc. */
+typedef boolean (*CompiledCode)( Stack* stack, StackFrame* sf, void* entry, boolean isSwitchingAllowed );
+
+typedef struct sCompiledMethod
+{
+	CompiledCode code;
+	uint32 codeSize;
+	uint32* entryOffsets; /* offset of the machine code of every instruction, indexed by the offset of its bytecode */
+} CompiledMethod;
+
+/* Machine code which is being emitted, by the baseline compiler or by the optimizing compiler (see optimizingCompiler.c). It grows as needed. */
+typedef struct sCodeBuffer
+{
+	byte* code;
+	uint32 length;
+	uint32 size;
+} CodeBuffer;
+
+/* false if started with -Xint */
+extern boolean isJitEnabled;
+extern uint32 jitInvocationThreshold;
+extern uint32 jitBackwardBranchThreshold;
+
+void jit_init();
+void jit_compile( method_info* method );
+boolean jit_run( Stack* stack, boolean isSwitchingAllowed );
+void jit_addThreadStatistics();
+void jit_printStatistics();
+
+void jit_initCodeBuffer( CodeBuffer* buffer, uint32 size );
+void jit_ensureCapacity( CodeBuffer* buffer, uint32 size );
+void jit_emit8( CodeBuffer* buffer, uint8 value );
+void jit_emit32( CodeBuffer* buffer, uint32 value );
+void jit_emit64( CodeBuffer* buffer, uint64 value );
+void jit_emit( CodeBuffer* buffer, const char* bytes );
+void jit_patch32( CodeBuffer* buffer, uint32 position, uint32 target );
+void* jit_installCode( CodeBuffer* buffer );
+
+/* helpers called by the machine code */
+void writeBarrierHelper( reference ref, slot value );
+boolean isSwitchDueHelper();
+
+#endif /*_jit_h_*/
@@ -6,6 +6,10 @@ public class Object
 	public native int hashCode();
 	public native String getClassName();
 	
+	public final native void wait();
+	public final native void notify();
+	public final native void notifyAll();
+	
 	public String toString()
 	{
 		// TODO: Implement Integer.toHexString() and use it here appropriately instead of Integer.toString()
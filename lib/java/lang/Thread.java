@@ -0,0 +1,24 @@
+package java.lang;
+
+public class Thread implements Runnable
+{
+	private Runnable target;
+	
+	public Thread()
+	{
+	}
+	
+	public Thread( Runnable target )
+	{
+		this.target= target;
+	}
+	
+	public void run()
+	{
+		if( target != null )
+			target.run();
+	}
+	
+	public native void start();
+	public native void join();
+}
@@ -11,6 +11,10 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "puraGlobals.h"
 #include "memoryManager.h"
 
 /* Note: This is a quick hack to get Pura running using the version of the GCC compiler that by default
@@ -37,14 +41,16 @@ long numberOfDynamicFrees= 0;
 long staticPaddingLoss= 0;
 long dynamicPaddingLoss= 0;
 
+/* The statistics are updated atomically, as memory is allocated by several threads. The maximum usage is only approximate. */
+
 void* mm_staticMalloc( uint32 size )
 {
 	void* ptr= malloc( size );
 	uint32 allocatedSize= malloc_size(ptr);
 
-	numberOfStaticAllocations++;
-	currentStaticMemoryUsage+= allocatedSize;
-	staticPaddingLoss+= allocatedSize - size;
+	__sync_fetch_and_add( &numberOfStaticAllocations, 1 );
+	__sync_fetch_and_add( &currentStaticMemoryUsage, allocatedSize );
+	__sync_fetch_and_add( &staticPaddingLoss, allocatedSize - size );
 	
 	if( maxStaticMemoryUsed < currentStaticMemoryUsage )
 		maxStaticMemoryUsed= currentStaticMemoryUsage;
@@ -58,9 +64,9 @@ void* mm_dynamicMalloc( uint32 size )
 	void* ptr= malloc( size );
 	uint32 allocatedSize= malloc_size(ptr);
 
-	numberOfDynamicAllocations++;
-	currentDynamicMemoryUsage+= allocatedSize;
-	dynamicPaddingLoss+= allocatedSize - size;
+	__sync_fetch_and_add( &numberOfDynamicAllocations, 1 );
+	__sync_fetch_and_add( &currentDynamicMemoryUsage, allocatedSize );
+	__sync_fetch_and_add( &dynamicPaddingLoss, allocatedSize - size );
 	
 	if( maxDynamicMemoryUsed < currentDynamicMemoryUsage )
 		maxDynamicMemoryUsed= currentDynamicMemoryUsage;
@@ -74,8 +80,8 @@ void mm_staticFree( void* ptr )
 	uint32 size= malloc_size(ptr);
 	free( ptr );
 
-	currentStaticMemoryUsage-= size;
-	numberOfStaticFrees++;
+	__sync_fetch_and_sub( &currentStaticMemoryUsage, size );
+	__sync_fetch_and_add( &numberOfStaticFrees, 1 );
 	
 	logMemory( "Freeing static memory block with size of %i bytes.\n", size );
 }
@@ -85,8 +91,8 @@ void mm_dynamicFree( void* ptr )
 	uint32 size= malloc_size(ptr);
 	free( ptr );
 
-	currentDynamicMemoryUsage-= size;
-	numberOfDynamicFrees++;
+	__sync_fetch_and_sub( &currentDynamicMemoryUsage, size );
+	__sync_fetch_and_add( &numberOfDynamicFrees, 1 );
 	
 	logMemory( "Freeing heap memory block with size of %i bytes.\n", size );
 }
@@ -101,9 +107,8 @@ void* mm_staticReAlloc( void* ptr, uint32 size )
 	
 	uint32 newSize= malloc_size(newPtr);
 	
-	currentStaticMemoryUsage-= oldSize;
-	currentStaticMemoryUsage+= newSize;
-	staticPaddingLoss+= newSize - size;
+	__sync_fetch_and_add( &currentStaticMemoryUsage, newSize - oldSize );
+	__sync_fetch_and_add( &staticPaddingLoss, newSize - size );
 
 	if( maxStaticMemoryUsed < currentStaticMemoryUsage )
 		maxStaticMemoryUsed= currentStaticMemoryUsage;
@@ -116,6 +121,51 @@ void* mm_staticReAlloc( void* ptr, uint32 size )
 	return newPtr;
 }
 
+/* Maps a block of zeroed memory directly from the operating system. Used for large regions that are managed by the VM itself (i.e. the nursery and the old
+	generation) and are never freed. The pages are only backed by physical memory as soon as they are used. This memory is not part of the static or dynamic memory 
+	statistics. */
+void* mm_mapMemory( uint32 size )
+{
+	void* ptr= mmap( NULL, size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANON, -1, 0 );
+	
+	if( ptr == MAP_FAILED )
+		error( "Memory Mapping Error!" );
+	
+	logMemory( "Mapping memory block with a size of %i bytes.\n", size );
+	return ptr;
+}
+
+/* Maps a block of memory which may be written and executed, used for the machine code of the JIT compiler (see jit.c). Like mm_mapMemory(), this memory is 
+	not part of the memory statistics. */
+void* mm_mapExecutableMemory( uint32 size )
+{
+	void* ptr= mmap( NULL, size, PROT_READ|PROT_WRITE|PROT_EXEC, MAP_PRIVATE|MAP_ANON, -1, 0 );
+	
+	if( ptr == MAP_FAILED )
+		error( "Memory Mapping Error!" );
+	
+	logMemory( "Mapping executable memory block with a size of %i bytes.\n", size );
+	return ptr;
+}
+
+/* Hands the physical pages of the given part of a mapped memory block back to the operating system. The memory stays mapped and reads as zeroes when it's used 
+	again. Only whole pages inside the given range are released. Returns the number of released bytes. */
+uint32 mm_releaseMemory( void* ptr, uint32 size )
+{
+	uintptr_t pageSize= sysconf( _SC_PAGESIZE );
+	uintptr_t start= ((uintptr_t)ptr + pageSize - 1) & ~(pageSize - 1);
+	uintptr_t end= ((uintptr_t)ptr + size) & ~(pageSize - 1);
+	
+	if( end <= start )
+		return 0;
+	
+	if( madvise( (void*)start, end - start, MADV_DONTNEED ) != 0 )
+		logWarning( "Releasing memory failed!" );
+	
+	logMemory( "Releasing %i bytes of mapped memory.\n", end - start );
+	return end - start;
+}
+
 uint32 mm_getGetCurrentMemoryUsage()
 {
 	return currentStaticMemoryUsage + currentDynamicMemoryUsage;
@@ -19,6 +19,9 @@ void* mm_dynamicMalloc( uint32 size );
 void mm_staticFree( void* ptr );
 void mm_dynamicFree( void* ptr );
 void* mm_staticReAlloc( void* ptr, uint32 size );
+void* mm_mapMemory( uint32 size );
+void* mm_mapExecutableMemory( uint32 size );
+uint32 mm_releaseMemory( void* ptr, uint32 size );
 uint32 mm_getGetCurrentMemoryUsage();
 uint32 mm_getGetCurrentStaticMemoryUsage();
 uint32 mm_getGetCurrentDynamicMemoryUsage();
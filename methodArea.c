@@ -13,26 +13,93 @@
 #include "fileClassLoader.h"
 #include "class.h"
 #include "memoryManager.h"
+#include "symbolTable.h"
+#include "thread.h"
 #include "methodArea.h"
 
-/* Please note that currently there is a limit of how many classes can be stored in the method area. If this is a problem, either adjust the value or implement
-	a growable array like it is done for the heap's pointer list. */
-#define MAX_CLASSES 64
+/* The loaded classes are stored in a hash table using open addressing, keyed by the (interned) class name. The table is doubled in size whenever it gets filled more 
+	than 3/4, so there is no limit on the number of classes. */
+Class** classTable;
+uint32 classTableSize= INITIAL_NUMBER_OF_POSSIBLE_CLASSES;
+uint32 numberOfLoadedClasses= 0;
 
-Class** loadedClasses;
-int numberOfLoadedClasses= 0;
+Class* javaLangObjectClass= NULL;
+Class* javaLangStringClass= NULL;
+Class* byteArrayClass= NULL;
+Class* charArrayClass= NULL;
+Class* shortArrayClass= NULL;
+Class* intArrayClass= NULL;
+Class* floatArrayClass= NULL;
+Class* longArrayClass= NULL;
+Class* doubleArrayClass= NULL;
+Class* objectArrayClass= NULL;
+Class* stringArrayClass= NULL;
+uint32 stringValueSlotIndex= 0;
+
+/* Returns the entry of the class table where the class with the given name is stored, or the empty entry where it would have to be inserted. Class names
+	are interned, so an interned className usually matches by its pointer already. */
+Class** findClassTableEntry( Class** table, uint32 tableSize, const char* className )
+{
+	uint32 i= sym_hash( className ) & (tableSize - 1);
+	
+	while( table[i] != NULL && table[i]->className != className && strcmp(table[i]->className, className) != 0 )
+		i= (i + 1) & (tableSize - 1);
+	
+	return &table[i];
+}
+
+/* Double the size of the class table and re-insert all classes. */
+void increaseClassTable()
+{
+	uint32 newSize= classTableSize * 2;
+	Class** newTable= (Class**)mm_staticMalloc( sizeof(Class*) * newSize );
+	
+	uint32 i;
+	for( i= 0; i < newSize; i++ )
+		newTable[i]= NULL;
+	
+	for( i= 0; i < classTableSize; i++ )
+		if( classTable[i] != NULL )
+			*findClassTableEntry( newTable, newSize, classTable[i]->className )= classTable[i];
+	
+	logVerbose( "Increasing class table size. Size was %i and is %i now.\n", classTableSize, newSize );
+	
+	mm_staticFree( classTable );
+	classTable= newTable;
+	classTableSize= newSize;
+}
 
 void ma_init()
 {
 	logVerbose( "Initializing Method Area...\n" );
-	loadedClasses= (Class**)mm_staticMalloc( sizeof(Class*) * MAX_CLASSES );
+	classTable= (Class**)mm_staticMalloc( sizeof(Class*) * classTableSize );
+	
+	uint32 i;
+	for( i= 0; i < classTableSize; i++ )
+		classTable[i]= NULL;
 }
 
-Class* ma_loadClass( const char* className )
+/* Loads the classes that are referenced directly by the VM. */
+void ma_loadSystemClasses()
 {
-	if( numberOfLoadedClasses >= MAX_CLASSES )
-		error( "Error: Maximum number of loadable classes reached!" );
+	javaLangObjectClass= ma_getClass( "java/lang/Object" );
+	javaLangStringClass= ma_getClass( "java/lang/String" );
+	byteArrayClass= ma_getClass( "[B" );
+	charArrayClass= ma_getClass( "[C" );
+	shortArrayClass= ma_getClass( "[S" );
+	intArrayClass= ma_getClass( "[I" );
+	floatArrayClass= ma_getClass( "[F" );
+	longArrayClass= ma_getClass( "[J" );
+	doubleArrayClass= ma_getClass( "[D" );
+	objectArrayClass= ma_getClass( "[Ljava/lang/Object;" );
+	stringArrayClass= ma_getClass( "[Ljava/lang/String;" );
 	
+	Class* stringClass= javaLangStringClass;
+	stringValueSlotIndex= cls_resolveField( &stringClass, sym_intern("value"), sym_intern("[C") )->slot_index;
+}
+
+Class* ma_loadClass( const char* className )
+{
 	logVerbose( "Loading class %s\n", className );
 	
 	ClassLoaderState clState;
@@ -55,40 +122,35 @@ Class* ma_loadClass( const char* className )
 		cl_free( &clState );
 	}
 	
-	/* add loaded class to the method area's class repository */
-	loadedClasses[numberOfLoadedClasses]= cl;
+	/* Add loaded class to the method area's class table. Note, that loading the class may have loaded other classes (i.e. its superclasses) in the meantime. */
+	if( (numberOfLoadedClasses+1)*4 > classTableSize*3 )
+		increaseClassTable();
+	
+	*findClassTableEntry( classTable, classTableSize, cl->className )= cl;
 	numberOfLoadedClasses++;
 	
 	return cl; 
 }
 
-/* Searches the method area's loaded classes repository for the given class. If the class is loaded it is returned, otherwise NULL. */
+/* Searches the method area's class table for the given class. If the class is loaded it is returned, otherwise NULL. */
 Class* ma_containsClass( const char* className )
 {
-	int i;
-	for( i= 0; i < numberOfLoadedClasses; i++ )
-	{
-		Class* cls= loadedClasses[i];
-		
-		if( strcmp(cls->className, className) == 0 )
-			return cls;
-	}
-
-	return NULL;
+	return *findClassTableEntry( classTable, classTableSize, className );
 }
 
 /* Returns an already loaded class, or tries to load the requested class if it is not present in the method area yet, and returns it afterwards.
-   If the class has not been found and can not be loaded, the VM stops execution. */
+   If the class has not been found and can not be loaded, the VM stops execution. The class table may be changed by other threads, so it is only accessed while 
+	holding the method area lock. */
 Class* ma_getClass( const char* className )
 {
+	thread_lockMethodArea();
 	Class* cls= ma_containsClass( className );
 	
-	/* found and done */
-	if( cls != NULL )
-		return cls;
-	
 	/* Not found? Try to load it. */
-	cls= ma_loadClass( className );
+	if( cls == NULL )
+		cls= ma_loadClass( className );
+	
+	thread_unlockMethodArea();
 	
 	/* Class present now? */
 	if( cls != NULL )
@@ -13,7 +13,31 @@
 
 #include "class.h"
 
+/* initial size of the class table, must be a power of two */
+#define INITIAL_NUMBER_OF_POSSIBLE_CLASSES 64
+
+/* Frequently used classes. They are loaded by ma_loadSystemClasses() and can be used directly, without looking them up in the class table. */
+extern Class* javaLangObjectClass;
+extern Class* javaLangStringClass;
+extern Class* byteArrayClass;
+extern Class* charArrayClass;
+extern Class* shortArrayClass;
+extern Class* intArrayClass;
+extern Class* floatArrayClass;
+extern Class* longArrayClass;
+extern Class* doubleArrayClass;
+extern Class* objectArrayClass;
+extern Class* stringArrayClass;
+
+/* slot index of the char[] of java.lang.String instances, resolved by ma_loadSystemClasses() as well */
+extern uint32 stringValueSlotIndex;
+
+/* class table, see methodArea.c */
+extern Class** classTable;
+extern uint32 classTableSize;
+
 void ma_init();
+void ma_loadSystemClasses();
 Class* ma_loadClass( const char* className );
 Class* ma_containsClass( const char* className );
 Class* ma_getClass( const char* className );
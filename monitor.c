@@ -0,0 +1,389 @@
+/*
+ *  monitor.c
+ *  Java monitors, implemented as thin locks: every instance (and every class, for static synchronized methods) has a lock word in its header. As long as a
+ *  monitor isn't contended, it is entered and exited by a single compare and swap of the lock word, which then holds the id of the owning thread and the
+ *  recursion count. A thread which finds the monitor owned by another thread inflates it: it replaces the lock word by the index of a heavyweight monitor (a
+ *  mutex and condition variables), which takes over the owner and recursion count, and then waits for the heavyweight monitor. The owner notices the inflation
+ *  when it exits the monitor, as its compare and swap fails. wait() and notify() always inflate the monitor, as only heavyweight monitors have a condition
+ *  variable. Inflated monitors stay inflated as long as their instance lives; the garbage collector frees the monitors of collected instances.
+ *  Green threads (see scheduler.c) don't wait for a contended monitor in MONITORENTER, but are parked on the heavyweight monitor, so that their worker can run
+ *  other threads. The next thread which exits the monitor wakes up one parked thread, which then tries to enter the monitor again.
+ *
+ *  Copyright (c) 2006, 2007 Daniel Klein. All rights reserved.
+ *
+ *  Licensed under GPL version 2.
+ *  See here for the full license: http://www.gnu.org/licenses/gpl.html
+ */
+
+#include <pthread.h>
+#include "puraGlobals.h"
+#include "memoryManager.h"
+#include "thread.h"
+#include "scheduler.h"
+#include "monitor.h"
+
+/* Layout of a lock word:
+	free:      0
+	thin lock: owner id (24 bits) | recursion count - 1 (7 bits) | 0
+	inflated:  monitor index (31 bits) | 1
+	The owner id of a thread is its thread id + 1, so that a thin lock is never 0. */
+#define LOCK_INFLATED 1
+#define THIN_LOCK_COUNT_UNIT 2
+#define THIN_LOCK_COUNT_MASK 0xFE
+#define THIN_LOCK_OWNER_SHIFT 8
+
+#define isInflated( lockWord ) ((lockWord) & LOCK_INFLATED)
+#define getMonitor( lockWord ) (monitors[(lockWord) >> 1])
+#define getOwnerId() (currentThread->id + 1)
+
+#define NO_MONITOR 0xFFFFFFFF
+
+/* Heavyweight monitor. The mutex only protects the fields of the monitor and is held for a short time, the owner of the Java monitor is stored in ownerId. */
+typedef struct sMonitor
+{
+	pthread_mutex_t mutex;
+	pthread_cond_t isExited; /* signaled whenever the monitor becomes free */
+	pthread_cond_t isNotified; /* signaled by notify() */
+	uint32 ownerId; /* 0 if the monitor is free */
+	uint32 recursionCount;
+	uint32 waitingThreadCount; /* number of threads which wait to enter the monitor or wait for a notification, including the parked threads */
+	JavaThread* parkedThreads; /* green threads which wait to enter the monitor */
+	uint32 nextFreeMonitor; /* list of free monitors */
+} Monitor;
+
+/* The table of heavyweight monitors is reserved at once, so that it never moves and can be read without locking. Allocated entries are never freed, but kept in
+	the list of free monitors for reuse. */
+Monitor** monitors;
+uint32 monitorCount= 0;
+uint32 firstFreeMonitor= NO_MONITOR;
+pthread_mutex_t monitorTableLock= PTHREAD_MUTEX_INITIALIZER;
+
+void monitor_init()
+{
+	monitors= mm_mapMemory( sizeof(Monitor*) * MAX_NUMBER_OF_MONITORS );
+}
+
+/* Returns the index of an unused heavyweight monitor, which is initialized with the given owner. */
+uint32 allocateMonitor( uint32 ownerId, uint32 recursionCount )
+{
+	uint32 index;
+	Monitor* monitor;
+	
+	pthread_mutex_lock( &monitorTableLock );
+	
+	if( firstFreeMonitor != NO_MONITOR )
+	{
+		index= firstFreeMonitor;
+		monitor= monitors[index];
+		firstFreeMonitor= monitor->nextFreeMonitor;
+	}
+	else
+	{
+		if( monitorCount == MAX_NUMBER_OF_MONITORS )
+			error( "Too many inflated monitors!" );
+		
+		index= monitorCount;
+		monitor= mm_staticMalloc( sizeof(Monitor) );
+		pthread_mutex_init( &monitor->mutex, NULL );
+		pthread_cond_init( &monitor->isExited, NULL );
+		pthread_cond_init( &monitor->isNotified, NULL );
+		monitors[index]= monitor;
+		monitorCount++;
+	}
+	
+	pthread_mutex_unlock( &monitorTableLock );
+	
+	monitor->ownerId= ownerId;
+	monitor->recursionCount= recursionCount;
+	monitor->waitingThreadCount= 0;
+	monitor->parkedThreads= NULL;
+	return index;
+}
+
+void freeMonitor( uint32 index )
+{
+	pthread_mutex_lock( &monitorTableLock );
+	monitors[index]->nextFreeMonitor= firstFreeMonitor;
+	firstFreeMonitor= index;
+	pthread_mutex_unlock( &monitorTableLock );
+}
+
+/* Replaces the given free or thin lock word by a new heavyweight monitor, which takes over its owner and recursion count. Fails, if the lock word has been
+	changed in the meantime. */
+boolean inflate( volatile uint32* lockWord, uint32 thinLock )
+{
+	uint32 ownerId= thinLock >> THIN_LOCK_OWNER_SHIFT;
+	uint32 recursionCount= ownerId == 0 ? 0 : ((thinLock & THIN_LOCK_COUNT_MASK) / THIN_LOCK_COUNT_UNIT) + 1;
+	uint32 index= allocateMonitor( ownerId, recursionCount );
+	
+	if( __sync_bool_compare_and_swap(lockWord, thinLock, (index << 1) | LOCK_INFLATED) )
+	{
+		logVerbose( "Inflated monitor %i, owned by thread %i.\n", index, (int32)ownerId - 1 );
+		return true;
+	}
+	
+	freeMonitor( index );
+	return false;
+}
+
+/* Lets a thread, which waits for the given monitor, know that the monitor is free now. The mutex of the monitor must be held. */
+void wakeWaitingThread( Monitor* monitor )
+{
+	if( monitor->waitingThreadCount == 0 )
+		return;
+	
+	pthread_cond_signal( &monitor->isExited );
+	
+	if( monitor->parkedThreads != NULL )
+	{
+		JavaThread* thread= monitor->parkedThreads;
+		monitor->parkedThreads= thread->nextParked;
+		monitor->waitingThreadCount--;
+		sched_wakeUp( thread );
+	}
+}
+
+/* Enters the given heavyweight monitor. Waits in a blocking region, if another thread owns it, or parks the current green thread and returns false, if parking
+	is allowed. */
+boolean enterMonitor( Monitor* monitor, uint32 ownerId, boolean isParkingAllowed )
+{
+	pthread_mutex_lock( &monitor->mutex );
+	
+	if( monitor->ownerId == ownerId )
+	{
+		monitor->recursionCount++;
+		pthread_mutex_unlock( &monitor->mutex );
+		return true;
+	}
+	
+	if( monitor->ownerId != 0 && isParkingAllowed )
+	{
+		/* The parked thread is woken up by wakeWaitingThread(), which may happen before it has left its worker, see sched_wakeUp(). */
+		currentThread->nextParked= monitor->parkedThreads;
+		monitor->parkedThreads= currentThread;
+		monitor->waitingThreadCount++;
+		sched_prepareParking();
+		pthread_mutex_unlock( &monitor->mutex );
+		return false;
+	}
+	
+	if( monitor->ownerId != 0 )
+	{
+		/* The waiting thread count keeps the garbage collector from freeing the monitor while we're waiting. */
+		monitor->waitingThreadCount++;
+		pthread_mutex_unlock( &monitor->mutex );
+		
+		thread_enterBlockingRegion();
+		pthread_mutex_lock( &monitor->mutex );
+		
+		while( monitor->ownerId != 0 )
+			pthread_cond_wait( &monitor->isExited, &monitor->mutex );
+		
+		monitor->ownerId= ownerId;
+		monitor->recursionCount= 1;
+		monitor->waitingThreadCount--;
+		pthread_mutex_unlock( &monitor->mutex );
+		thread_leaveBlockingRegion();
+		return true;
+	}
+	
+	monitor->ownerId= ownerId;
+	monitor->recursionCount= 1;
+	pthread_mutex_unlock( &monitor->mutex );
+	return true;
+}
+
+void exitMonitor( Monitor* monitor, uint32 ownerId )
+{
+	pthread_mutex_lock( &monitor->mutex );
+	
+	if( monitor->ownerId != ownerId )
+		error( "IllegalMonitorStateException: The current thread doesn't own the monitor." );
+	
+	monitor->recursionCount--;
+	
+	if( monitor->recursionCount == 0 )
+	{
+		monitor->ownerId= 0;
+		wakeWaitingThread( monitor );
+	}
+	
+	pthread_mutex_unlock( &monitor->mutex );
+}
+
+/* Enters the monitor of the given lock word. Returns false, if the monitor is owned by another thread and the current thread has been parked instead. */
+boolean enterOrPark( volatile uint32* lockWord, boolean isParkingAllowed )
+{
+	uint32 ownerId= getOwnerId();
+	uint32 thinLock= ownerId << THIN_LOCK_OWNER_SHIFT;
+	
+	while( true )
+	{
+		uint32 current= *lockWord;
+		
+		if( current == 0 )
+		{
+			/* fast path: the monitor is free */
+			if( __sync_bool_compare_and_swap(lockWord, 0, thinLock) )
+				return true;
+		}
+		else if( isInflated(current) )
+		{
+			/* The lock word doesn't change anymore, so it doesn't matter if the instance moves while we wait. */
+			return enterMonitor( getMonitor(current), ownerId, isParkingAllowed );
+		}
+		else if( (current & ~THIN_LOCK_COUNT_MASK) == thinLock )
+		{
+			/* Recursive enter. Contending threads may inflate the lock at the same time, so the count is changed by compare and swap as well. */
+			if( (current & THIN_LOCK_COUNT_MASK) != THIN_LOCK_COUNT_MASK )
+			{
+				if( __sync_bool_compare_and_swap(lockWord, current, current + THIN_LOCK_COUNT_UNIT) )
+					return true;
+			}
+			else
+			{
+				/* recursion count overflow */
+				inflate( lockWord, current );
+			}
+		}
+		else
+		{
+			/* contention */
+			inflate( lockWord, current );
+		}
+	}
+}
+
+/* Enters the monitor of the given lock word. The stack of the current thread must be consistent, because the thread may wait in a blocking region. */
+void monitor_enter( volatile uint32* lockWord )
+{
+	enterOrPark( lockWord, false );
+}
+
+/* Enters the monitor of the given lock word like monitor_enter(), but parks the current green thread instead of waiting for the monitor. Returns false, if the
+	thread has been parked, see sched_prepareParking(). */
+boolean monitor_enterOrPark( volatile uint32* lockWord )
+{
+	return enterOrPark( lockWord, true );
+}
+
+void monitor_exit( volatile uint32* lockWord )
+{
+	uint32 ownerId= getOwnerId();
+	
+	while( true )
+	{
+		uint32 current= *lockWord;
+		
+		if( isInflated(current) )
+		{
+			exitMonitor( getMonitor(current), ownerId );
+			return;
+		}
+		
+		if( (current >> THIN_LOCK_OWNER_SHIFT) != ownerId )
+			error( "IllegalMonitorStateException: The current thread doesn't own the monitor." );
+		
+		uint32 newLockWord= (current & THIN_LOCK_COUNT_MASK) != 0 ? current - THIN_LOCK_COUNT_UNIT : 0;
+		
+		if( __sync_bool_compare_and_swap(lockWord, current, newLockWord) )
+			return;
+	}
+}
+
+/* Returns the heavyweight monitor of the given lock word, which must be owned by the current thread. The monitor is inflated, if necessary. */
+Monitor* getOwnedMonitor( volatile uint32* lockWord, uint32 ownerId )
+{
+	uint32 current= *lockWord;
+	
+	while( !isInflated(current) )
+	{
+		if( (current >> THIN_LOCK_OWNER_SHIFT) != ownerId )
+			error( "IllegalMonitorStateException: The current thread doesn't own the monitor." );
+		
+		inflate( lockWord, current );
+		current= *lockWord;
+	}
+	
+	return getMonitor( current );
+}
+
+/* Object.wait(): Exits the monitor of the given lock word until another thread notifies it, then enters it again with the same recursion count. As in Java, the
+	thread may wake up without a notification as well. */
+void monitor_wait( volatile uint32* lockWord )
+{
+	uint32 ownerId= getOwnerId();
+	Monitor* monitor= getOwnedMonitor( lockWord, ownerId );
+	
+	/* The monitor is released and waited for while holding the mutex, so that no notification gets lost in between. */
+	thread_enterBlockingRegion();
+	pthread_mutex_lock( &monitor->mutex );
+	
+	if( monitor->ownerId != ownerId )
+		error( "IllegalMonitorStateException: The current thread doesn't own the monitor." );
+	
+	uint32 recursionCount= monitor->recursionCount;
+	monitor->ownerId= 0;
+	monitor->recursionCount= 0;
+	wakeWaitingThread( monitor );
+	monitor->waitingThreadCount++;
+	
+	pthread_cond_wait( &monitor->isNotified, &monitor->mutex );
+	
+	while( monitor->ownerId != 0 )
+		pthread_cond_wait( &monitor->isExited, &monitor->mutex );
+	
+	monitor->ownerId= ownerId;
+	monitor->recursionCount= recursionCount;
+	monitor->waitingThreadCount--;
+	pthread_mutex_unlock( &monitor->mutex );
+	thread_leaveBlockingRegion();
+}
+
+/* Object.notify() and Object.notifyAll() */
+void monitor_notify( volatile uint32* lockWord, boolean isNotifyingAll )
+{
+	uint32 ownerId= getOwnerId();
+	uint32 current= *lockWord;
+	
+	/* Nobody can wait for a monitor which isn't inflated. */
+	if( !isInflated(current) )
+	{
+		if( (current >> THIN_LOCK_OWNER_SHIFT) != ownerId )
+			error( "IllegalMonitorStateException: The current thread doesn't own the monitor." );
+		
+		return;
+	}
+	
+	Monitor* monitor= getMonitor( current );
+	pthread_mutex_lock( &monitor->mutex );
+	
+	if( monitor->ownerId != ownerId )
+		error( "IllegalMonitorStateException: The current thread doesn't own the monitor." );
+	
+	if( isNotifyingAll )
+		pthread_cond_broadcast( &monitor->isNotified );
+	else
+		pthread_cond_signal( &monitor->isNotified );
+	
+	pthread_mutex_unlock( &monitor->mutex );
+}
+
+/* Called by the garbage collector for the lock word of every collected instance, while the world is stopped. Frees the heavyweight monitor of the lock word, if
+	there is one and no thread uses it anymore. */
+void monitor_release( uint32 lockWord )
+{
+	if( !isInflated(lockWord) )
+		return;
+	
+	uint32 index= lockWord >> 1;
+	Monitor* monitor= monitors[index];
+	
+	/* Threads in a blocking region may still access the monitor. */
+	pthread_mutex_lock( &monitor->mutex );
+	boolean isUnused= monitor->ownerId == 0 && monitor->waitingThreadCount == 0;
+	pthread_mutex_unlock( &monitor->mutex );
+	
+	if( isUnused )
+		freeMonitor( index );
+}
@@ -0,0 +1,28 @@
+/*
+ *  monitor.h
+ *  Java monitors (synchronized methods and blocks, Object.wait() and Object.notify()), implemented as thin locks which are inflated under contention.
+ *
+ *  Copyright (c) 2006, 2007 Daniel Klein. All rights reserved.
+ *
+ *  Licensed under GPL version 2.
+ *  See here for the full license: http://www.gnu.org/licenses/gpl.html
+ */
+
+#ifndef _monitor_h_
+#define _monitor_h_
+
+#include "types.h"
+
+/* maximum number of inflated monitors at the same time, see monitor.c */
+#define MAX_NUMBER_OF_MONITORS (1024*1024)
+
+/* All functions work on the lock word of an instance or class. The lock word may only be accessed by these functions (and the garbage collector). */
+void monitor_init();
+void monitor_enter( volatile uint32* lockWord );
+boolean monitor_enterOrPark( volatile uint32* lockWord );
+void monitor_exit( volatile uint32* lockWord );
+void monitor_wait( volatile uint32* lockWord );
+void monitor_notify( volatile uint32* lockWord, boolean isNotifyingAll );
+void monitor_release( uint32 lockWord );
+
+#endif /*_monitor_h_*/
@@ -20,6 +20,9 @@
 #include "heap.h"
 #include "class.h"
 #include "methodArea.h"
+#include "symbolTable.h"
+#include "thread.h"
+#include "monitor.h"
 #include "native.h"
 
 /* All native method implementation-functions use the following semantics:
@@ -30,9 +33,7 @@
 /* Print String. Get the internal char[] and print the chars one after another. */
 int java_io_PrintStream_print_String( Class* cls, int parameterSlotCount, slot* parameters, Stack* stack )
 {
-	Class* stringClass= ma_getClass( "java/lang/String" );
-	variable* varInfo= cls_resolveField( &stringClass, "value", "[C" );
-	reference charArray= heap_getSlotFromInstance( parameters[1], stringClass, varInfo->slot_index );
+	reference charArray= heap_getSlotFromInstance( parameters[1], stringValueSlotIndex );
 	
 	int i;
 	int len= heap_getArraySize(charArray);
@@ -71,10 +72,11 @@ int java_io_PrintStream_print_double( Class* cls, int parameterSlotCount, slot*
 	return 0;
 }
 
-/* Resolve the (internal) address of the objectref (first parameter on the stack) and return it. */
+/* Return the reference of the objectref (first parameter on the stack). Its address can't be used as the hash code, because young instances are moved by the
+	garbage collector, but the reference stays the same for the whole lifetime of the instance. */
 int java_lang_Object_hashCode( Class* cls, int parameterSlotCount, slot* parameters, Stack* stack )
 {
-	slot value= heap_getAddressOfInstance( parameters[0] );
+	slot value= parameters[0];
 	stack_pushSlot( stack, value );
 	return 1;
 }
@@ -89,6 +91,25 @@ int java_lang_Object_getClassName( Class* cls, int parameterSlotCount, slot* par
 	return 1;
 }
 
+/* Wait until another thread calls notify() or notifyAll() on this instance. The current thread must own its monitor. */
+int java_lang_Object_wait( Class* cls, int parameterSlotCount, slot* parameters, Stack* stack )
+{
+	monitor_wait( heap_getLockWord(parameters[0]) );
+	return 0;
+}
+
+int java_lang_Object_notify( Class* cls, int parameterSlotCount, slot* parameters, Stack* stack )
+{
+	monitor_notify( heap_getLockWord(parameters[0]), false );
+	return 0;
+}
+
+int java_lang_Object_notifyAll( Class* cls, int parameterSlotCount, slot* parameters, Stack* stack )
+{
+	monitor_notify( heap_getLockWord(parameters[0]), true );
+	return 0;
+}
+
 /* Returns the current stack trace depth of the Java stack. This excludes all stack trace- and exeption-handling methods. */ 
 int java_lang_Throwable_getStackTraceDepth( Class* cls, int parameterSlotCount, slot* parameters, Stack* stack )
 {
@@ -147,30 +168,44 @@ int java_lang_Throwable_getStackTraceElement( Class* cls, int parameterSlotCount
 	
 	/* declaringClass */
 	reference strClassName= heap_newStringInstance( sf->currentClass->className );
-	heap_setSlotOfInstance( ste, steClass, 0, strClassName ); 
+	heap_setSlotOfInstance( ste, 0, strClassName ); 
 	
 	/* methodName */
 	reference strMethodName= heap_newStringInstance( sf->methodInfo->name );
-	heap_setSlotOfInstance( ste, steClass, 1, strMethodName ); 
+	heap_setSlotOfInstance( ste, 1, strMethodName ); 
 	
 	/* fileName */
 	if( sf->currentClass->sourceFileName != NULL )
 	{
 		reference strFileName= heap_newStringInstance( sf->currentClass->sourceFileName );
-		heap_setSlotOfInstance( ste, steClass, 2, strFileName );
+		heap_setSlotOfInstance( ste, 2, strFileName );
 	}
 	else
 	{
-		heap_setSlotOfInstance( ste, steClass, 2, NULL_REFERENCE );
+		heap_setSlotOfInstance( ste, 2, NULL_REFERENCE );
 	}
 	
 	/* lineNumber -> TODO: Not supported yet, we have to parse the LineNumberTable attribute before we can use this. */
-	heap_setSlotOfInstance( ste, steClass, 3, -1 ); 
+	heap_setSlotOfInstance( ste, 3, -1 ); 
 	
 	stack_pushSlot( stack, ste );
 	return 1;
 }
 
+/* Start a new thread, which calls the run() method of this Thread instance. */
+int java_lang_Thread_start( Class* cls, int parameterSlotCount, slot* parameters, Stack* stack )
+{
+	thread_start( parameters[0] );
+	return 0;
+}
+
+/* Wait until the thread of this Thread instance has finished. */
+int java_lang_Thread_join( Class* cls, int parameterSlotCount, slot* parameters, Stack* stack )
+{
+	thread_join( parameters[0] );
+	return 0;
+}
+
 /* static methods -> no instance reference supplied! */
 /* Return the current time in milliseconds.  */
 int java_lang_System_currentTimeMillis( Class* cls, int parameterSlotCount, slot* parameters, Stack* stack )
@@ -188,58 +223,55 @@ int java_lang_System_currentTimeMillis( Class* cls, int parameterSlotCount, slot
 	return 2;
 }
 
-/* This is where we decide which method to call. The return value is the number of slots on the stack that are return values. Return values should be normally pushed
-	onto the stack. */
-/* TODO: Is there a way to do this faster? Possibly via method pointers in the method_info structure? */
-int doNativeMethodCall( Class* cls, method_info* methodInfo, int parameterSlotCount, slot* parameters, Stack* stack )
+/* All available native methods. The implementation is looked up once, when the class of a native method is loaded, and stored in its method_info. */
+typedef struct sNativeMethod
 {
-	const char* className= cls->className;
-	char* methodName= methodInfo->name;
-	char* methodDescriptor= methodInfo->descriptor;
-	
-	/* Now look for the appropriate native method. */
+	const char* className;
+	const char* methodName;
+	const char* methodDescriptor;
+	NativeFunction function;
+} NativeMethod;
 
-	/* All methods for java.lang.System go here */
-	if( strcmp(className, "java/lang/System") == 0 )
-	{
-		if( strcmp(methodName, "currentTimeMillis") == 0 && strcmp(methodDescriptor, "()J") == 0 )
-			return java_lang_System_currentTimeMillis( cls, parameterSlotCount, parameters, stack );
-	}
-
-	/* All methods for java.lang.Object go here */
-	else if( strcmp(className, "java/lang/Object") == 0 )
-	{
-		if( strcmp(methodName, "hashCode") == 0 && strcmp(methodDescriptor, "()I") == 0 )
-			return java_lang_Object_hashCode( cls, parameterSlotCount, parameters, stack );
-		if( strcmp(methodName, "getClassName") == 0 && strcmp(methodDescriptor, "()Ljava/lang/String;") == 0 )
-			return java_lang_Object_getClassName( cls, parameterSlotCount, parameters, stack );
-	}
+NativeMethod nativeMethods[]=
+{
+	{ "java/lang/System", "currentTimeMillis", "()J", java_lang_System_currentTimeMillis },
 	
-	/* All methods for java.io.PrintStream go here */
-	else if( strcmp(className, "java/io/PrintStream") == 0 )
-	{
-		if( strcmp(methodName, "print") == 0 && strcmp(methodDescriptor, "(Ljava/lang/String;)V") == 0 )
-			return java_io_PrintStream_print_String( cls, parameterSlotCount, parameters, stack );
-		else if( strcmp(methodName, "print") == 0 && strcmp(methodDescriptor, "(I)V") == 0 )
-			return java_io_PrintStream_print_int( cls, parameterSlotCount, parameters, stack );
-		else if( strcmp(methodName, "print") == 0 && strcmp(methodDescriptor, "(J)V") == 0 )
-			return java_io_PrintStream_print_long( cls, parameterSlotCount, parameters, stack );
-		else if( strcmp(methodName, "print") == 0 && strcmp(methodDescriptor, "(F)V") == 0 )
-			return java_io_PrintStream_print_long( cls, parameterSlotCount, parameters, stack );
-		else if( strcmp(methodName, "print") == 0 && strcmp(methodDescriptor, "(D)V") == 0 )
-			return java_io_PrintStream_print_long( cls, parameterSlotCount, parameters, stack );
-	}
+	{ "java/lang/Object", "hashCode", "()I", java_lang_Object_hashCode },
+	{ "java/lang/Object", "getClassName", "()Ljava/lang/String;", java_lang_Object_getClassName },
+	{ "java/lang/Object", "wait", "()V", java_lang_Object_wait },
+	{ "java/lang/Object", "notify", "()V", java_lang_Object_notify },
+	{ "java/lang/Object", "notifyAll", "()V", java_lang_Object_notifyAll },
+	
+	{ "java/io/PrintStream", "print", "(Ljava/lang/String;)V", java_io_PrintStream_print_String },
+	{ "java/io/PrintStream", "print", "(I)V", java_io_PrintStream_print_int },
+	{ "java/io/PrintStream", "print", "(J)V", java_io_PrintStream_print_long },
+	{ "java/io/PrintStream", "print", "(F)V", java_io_PrintStream_print_long },
+	{ "java/io/PrintStream", "print", "(D)V", java_io_PrintStream_print_long },
+	
+	{ "java/lang/Thread", "start", "()V", java_lang_Thread_start },
+	{ "java/lang/Thread", "join", "()V", java_lang_Thread_join },
 	
-	else if( strcmp(className, "java/lang/Throwable") == 0 )
+	{ "java/lang/Throwable", "getStackTraceDepth", "()I", java_lang_Throwable_getStackTraceDepth },
+	{ "java/lang/Throwable", "getStackTraceElement", "(I)Ljava/lang/StackTraceElement;", java_lang_Throwable_getStackTraceElement },
+	
+	{ NULL, NULL, NULL, NULL }
+};
+
+/* Binds the given native method to its implementation. Methods without an implementation stay unbound and fail when they are called. */
+void native_bindMethod( Class* cls, method_info* methodInfo )
+{
+	NativeMethod* native;
+	for( native= nativeMethods; native->className != NULL; native++ )
 	{
-		if( strcmp(methodName, "getStackTraceDepth") == 0 && strcmp(methodDescriptor, "()I") == 0 )
-			return java_lang_Throwable_getStackTraceDepth( cls, parameterSlotCount, parameters, stack );
-		else if( strcmp(methodName, "getStackTraceElement") == 0 && strcmp(methodDescriptor, "(I)Ljava/lang/StackTraceElement;") == 0 )
-			return java_lang_Throwable_getStackTraceElement( cls, parameterSlotCount, parameters, stack );
+		if( strcmp(cls->className, native->className) == 0 && strcmp(methodInfo->name, native->methodName) == 0 && strcmp(methodInfo->descriptor, native->methodDescriptor) == 0 )
+		{
+			logVerbose( "Binding native method %s.%s%s.\n", cls->className, methodInfo->name, methodInfo->descriptor );
+			methodInfo->nativeFunction= native->function;
+			return;
+		}
 	}
 	
-	error( "Native method call failed!" );
-	return 0; /* just for the sacke of the compilers happyness */
+	logVerbose( "--> No implementation for native method %s.%s%s.\n", cls->className, methodInfo->name, methodInfo->descriptor );
 }
 
 /* Preparation and cleanup for a native method call. */
@@ -249,8 +281,11 @@ void native_handleNativeMethodCall( Class* cls, method_info* methodInfo, Stack*
 	int parameterSlotCount= methodInfo->parameterSlotCount;
 	slot* parameters= stack->stackPointer - parameterSlotCount;
 	
+	if( methodInfo->nativeFunction == NULL )
+		error( "Native method call failed!" );
+	
 	/* method call */
-	int numberOfReturnValues= doNativeMethodCall( cls, methodInfo, parameterSlotCount, parameters, stack );
+	int numberOfReturnValues= methodInfo->nativeFunction( cls, parameterSlotCount, parameters, stack );
 	
 	/* Copy the return parameter (one or two slots) to the correct position. */
 	int i;
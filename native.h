@@ -13,6 +13,7 @@
 #ifndef _native_h_
 #define _native_h_
 
+void native_bindMethod( Class* cls, method_info* methodInfo );
 void native_handleNativeMethodCall( Class* newClass, method_info* methodInfo, Stack* stack );
 
 #endif /* _native_h_ */
\ No newline at end of file
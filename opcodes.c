@@ -0,0 +1,175 @@
+/*
+ *  opcodes.c
+ *  Opcode reverse lookup table, instruction lengths and translation into the internal instruction format.
+ *
+ *  Copyright (c) 2006, 2007 Daniel Klein. All rights reserved.
+ *  
+ *  Licensed under GPL version 2.
+ *  See here for the full license: http://www.gnu.org/licenses/gpl.html
+ */
+
+#include "puraGlobals.h"
+#include "opcodes.h"
+
+char* opcodeNames[]= {"NOP", "ACONST_NULL", "ICONST_M1", "ICONST_0", "ICONST_1", "ICONST_2", "ICONST_3", "ICONST_4", "ICONST_5", "LCONST_0", "LCONST_1", "FCONST_0",
+	"FCONST_1", "FCONST_2", "DCONST_0", "DCONST_1", "BIPUSH", "SIPUSH", "LDC", "LDC_W", "LDC2_W", "ILOAD", "LLOAD", "FLOAD", "DLOAD", "ALOAD", "ILOAD_0", "ILOAD_1",
+	"ILOAD_2", "ILOAD_3", "LLOAD_0", "LLOAD_1", "LLOAD_2", "LLOAD_3", "FLOAD_0", "FLOAD_1", "FLOAD_2", "FLOAD_3", "DLOAD_0", "DLOAD_1", "DLOAD_2", "DLOAD_3", "ALOAD_0",
+	"ALOAD_1", "ALOAD_2", "ALOAD_3", "IALOAD", "LALOAD", "FALOAD", "DALOAD", "AALOAD", "BALOAD", "CALOAD", "SALOAD", "ISTORE", "LSTORE", "FSTORE", "DSTORE", "ASTORE",
+	"ISTORE_0", "ISTORE_1", "ISTORE_2", "ISTORE_3", "LSTORE_0", "LSTORE_1", "LSTORE_2", "LSTORE_3", "FSTORE_0", "FSTORE_1", "FSTORE_2", "FSTORE_3", "DSTORE_0",
+	"DSTORE_1", "DSTORE_2", "DSTORE_3", "ASTORE_0", "ASTORE_1", "ASTORE_2", "ASTORE_3", "IASTORE", "LASTORE", "FASTORE", "DASTORE", "AASTORE", "BASTORE", "CASTORE",
+	"SASTORE", "POP", "POP2", "DUP", "DUP_X1", "DUP_X2", "DUP2", "DUP2_X1", "DUP2_X2", "SWAP", "IADD", "LADD", "FADD", "DADD", "ISUB", "LSUB", "FSUB", "DSUB", "IMUL",
+	"LMUL", "FMUL", "DMUL", "IDIV", "LDIV", "FDIV", "DDIV", "IREM", "LREM", "FREM", "DREM", "INEG", "LNEG", "FNEG", "DNEG", "ISHL", "LSHL", "ISHR", "LSHR", "IUSHR", 
+	"LUSHR",	"IAND", "LAND", "IOR", "LOR", "IXOR", "LXOR", "IINC", "I2L", "I2F", "I2D", "L2I", "L2F", "L2D", "F2I", "F2L", "F2D", "D2I", "D2L", "D2F", "I2B", "I2C", 
+	"I2S", "LCMP", "FCMPL", "FCMPG", "DCMPL", "DCMPG", "IFEQ", "IFNE", "IFLT", "IFGE", "IFGT", "IFLE", "IF_ICMPEQ", "IF_ICMPNE", "IF_ICMPLT", "IF_ICMPGE", "IF_ICMPGT", 
+	"IF_ICMPLE", "IF_ACMPEQ", "IF_ACMPNE", "GOTO", "JSR", "RET", "TABLESWITCH", "LOOKUPSWITCH", "IRETURN", "LRETURN", "FRETURN", "DRETURN", "ARETURN", "RETURN", 
+	"GETSTATIC", "PUTSTATIC", "GETFIELD", "PUTFIELD", "INVOKEVIRTUAL", "INVOKESPECIAL", "INVOKESTATIC", "INVOKEINTERFACE", "XXX_UNUSED_XXX", "NEW", "NEWARRAY", 
+	"ANEWARRAY", "ARRAYLENGTH", "ATHROW", "CHECKCAST", "INSTANCEOF", "MONITORENTER", "MONITOREXIT", "WIDE", "MULTIANEWARRAY", "IFNULL", "IFNONNULL", "GOTO_W", "JSR_W", 
+	"BREAKPOINT", "LDC_QUICK", "LDC_W_QUICK", "LDC2_W_QUICK", "GETFIELD_QUICK", "PUTFIELD_QUICK", "GETFIELD2_QUICK", "PUTFIELD2_QUICK", "GETSTATIC_QUICK", "PUTSTATIC_QUICK",  
+	"GETSTATIC2_QUICK", "PUTSTATIC2_QUICK", "INVOKEVIRTUAL_QUICK", "INVOKENONVIRTUAL_QUICK", "INVOKESUPER_QUICK", "INVOKESTATIC_QUICK", "INVOKEINTERFACE_QUICK", 
+	"INVOKEVIRTUALOBJECT_QUICK", "UNKNOWN3", "NEW_QUICK", "ANEWARRAY_QUICK", "MULTIANEWARRAY_QUICK", "CHECKCAST_QUICK", "INSTANCEOF_QUICK", "INVOKEVIRTUAL_QUICK_W", 
+	"GETFIELD_QUICK_W", "APUTFIELD_QUICK", "UNUSED1", "UNUSED2", "UNUSED3", "UNUSED4", "UNUSED5", "UNUSED6", "UNUSED7", "UNUSED8", "UNUSED9", "UNUSED10", "UNUSED11", 
+	"UNUSED12", "UNUSED13", "UNUSED14", "UNUSED15", "UNUSED16", "UNUSED17", "UNUSED18", "UNUSED19", "UNUSED20", "UNUSED21", "UNUSED22", "UNUSED23", "UNUSED24", 
+	"UNUSED25", "IMPDEP1", "IMPDEP2"};
+
+/* Length of every instruction in bytes (including the opcode), 0 for instructions with variable length (TABLESWITCH, LOOKUPSWITCH, WIDE). */
+uint8 instructionLengths[]= {
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, /* NOP - DCONST_1 */
+	2, 3, 2, 3, 3, 2, 2, 2, 2, 2, /* BIPUSH - ALOAD */
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, /* ILOAD_0 - ALOAD_3 */
+	1, 1, 1, 1, 1, 1, 1, 1, /* IALOAD - SALOAD */
+	2, 2, 2, 2, 2, /* ISTORE - ASTORE */
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, /* ISTORE_0 - ASTORE_3 */
+	1, 1, 1, 1, 1, 1, 1, 1, /* IASTORE - SASTORE */
+	1, 1, 1, 1, 1, 1, 1, 1, 1, /* POP - SWAP */
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, /* IADD - LXOR */
+	3, /* IINC */
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, /* I2L - I2S */
+	1, 1, 1, 1, 1, /* LCMP - DCMPG */
+	3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, /* IFEQ - JSR */
+	2, 0, 0, /* RET, TABLESWITCH, LOOKUPSWITCH */
+	1, 1, 1, 1, 1, 1, /* IRETURN - RETURN */
+	3, 3, 3, 3, 3, 3, 3, 5, /* GETSTATIC - INVOKEINTERFACE */
+	1, 3, 2, 3, 1, 1, 3, 3, 1, 1, /* XXX_UNUSED_XXX - MONITOREXIT */
+	0, 4, 3, 3, 5, 5, 1, /* WIDE - BREAKPOINT */
+	2, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 5, 3, 1, 3, 3, 4, 3, 3, 3, 3, 3, /* LDC_QUICK - APUTFIELD_QUICK */
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 /* UNUSED1 - IMPDEP2 */
+};
+
+/* Returns the length in bytes of the instruction at the given position of the given code. */
+uint32 opcode_getInstructionLength( const u1* code, uint32 pc )
+{
+	uint8 length= instructionLengths[code[pc]];
+	
+	if( length != 0 )
+		return length;
+	
+	/* The operands of the switch instructions are 4 byte aligned, relative to the start of the code. */
+	uint32 padding= 3 - (pc % 4);
+	const u1* operands= code + pc + 1 + padding;
+	
+	switch( code[pc] )
+	{
+		case TABLESWITCH:
+		{
+			int32 low= opcode_readS4( operands+4 );
+			int32 high= opcode_readS4( operands+8 );
+			return 1 + padding + 12 + (high - low + 1)*4;
+		}
+			
+		case LOOKUPSWITCH:
+		{
+			int32 npairs= opcode_readS4( operands+4 );
+			return 1 + padding + 8 + npairs*8;
+		}
+			
+		case WIDE:
+			return code[pc+1] == IINC ? 6 : 4;
+	}
+	
+	error( "Unknown instruction length!" );
+	return 0;
+}
+
+/* operands of the class file, which are big-endian */
+
+uint16 readBigEndianU2( const u1* p )
+{
+	return (uint16)((p[0] << 8) | p[1]);
+}
+
+int32 readBigEndianS4( const u1* p )
+{
+	return (int32)(((uint32)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3]);
+}
+
+/* Converts the big-endian 4 byte operands of a switch instruction into native ones, the relative branch offsets into absolute targets. */
+void predecodeSwitch( u1* code, uint32 pc )
+{
+	int32* operands= (int32*)(code + pc + 1 + 3 - (pc % 4));
+	int32 count;
+	int32 i;
+	
+	operands[0]= pc + readBigEndianS4( (u1*)&operands[0] );
+	
+	if( code[pc] == TABLESWITCH )
+	{
+		operands[1]= readBigEndianS4( (u1*)&operands[1] );
+		operands[2]= readBigEndianS4( (u1*)&operands[2] );
+		count= operands[2] - operands[1] + 1;
+		for( i= 0; i < count; i++ )
+			operands[3 + i]= pc + readBigEndianS4( (u1*)&operands[3 + i] );
+	}
+	else
+	{
+		count= operands[1]= readBigEndianS4( (u1*)&operands[1] );
+		for( i= 0; i < count; i++ )
+		{
+			operands[2 + i*2]= readBigEndianS4( (u1*)&operands[2 + i*2] );
+			operands[3 + i*2]= pc + readBigEndianS4( (u1*)&operands[3 + i*2] );
+		}
+	}
+}
+
+/* Translates the code of a method from the class file format into the internal instruction format, in place (see opcodes.h). It is done once, when the class
+   is loaded. */
+void opcode_predecode( u1* code, uint32 codeLength )
+{
+	uint32 pc= 0;
+	
+	while( pc < codeLength )
+	{
+		u1 opcode= code[pc];
+		
+		switch( opcode )
+		{
+			case SIPUSH: case LDC_W: case LDC2_W:
+			case GETSTATIC: case PUTSTATIC: case GETFIELD: case PUTFIELD:
+			case INVOKEVIRTUAL: case INVOKESPECIAL: case INVOKESTATIC: case INVOKEINTERFACE:
+			case NEW: case ANEWARRAY: case CHECKCAST: case INSTANCEOF: case MULTIANEWARRAY:
+				opcode_writeU2( code+pc+1, readBigEndianU2(code+pc+1) );
+				break;
+				
+			case IFEQ: case IFNE: case IFLT: case IFGE: case IFGT: case IFLE:
+			case IF_ICMPEQ: case IF_ICMPNE: case IF_ICMPLT: case IF_ICMPGE: case IF_ICMPGT: case IF_ICMPLE: case IF_ACMPEQ: case IF_ACMPNE:
+			case GOTO: case JSR: case IFNULL: case IFNONNULL:
+				opcode_writeU2( code+pc+1, (uint16)(pc + (int16)readBigEndianU2(code+pc+1)) );
+				break;
+				
+			case GOTO_W: case JSR_W:
+				opcode_writeS4( code+pc+1, (int32)pc + readBigEndianS4(code+pc+1) );
+				break;
+				
+			case TABLESWITCH: case LOOKUPSWITCH:
+				predecodeSwitch( code, pc );
+				break;
+				
+			case WIDE:
+				opcode_writeU2( code+pc+2, readBigEndianU2(code+pc+2) );
+				if( code[pc+1] == IINC )
+					opcode_writeU2( code+pc+4, readBigEndianU2(code+pc+4) );
+				break;
+		}
+		
+		pc+= opcode_getInstructionLength( code, pc );
+	}
+}
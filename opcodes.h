@@ -1,6 +1,6 @@
 /*
  *  opcodes.h
- *  Opcode definitions and reverse lookup table. 
+ *  Opcode definitions, reverse lookup table, instruction lengths and the internal instruction format.
  *
  *  Copyright (c) 2006, 2007 Daniel Klein. All rights reserved.
  *  
@@ -11,6 +11,8 @@
 #ifndef _opcodes_h_
 #define _opcodes_h_
 
+#include <string.h>
+
 #define NOP 0 /* no operation opcode */
 
 /* push constants onto the stack */
@@ -303,32 +305,32 @@
 #define BREAKPOINT 202 /* RESEVED; must not appear in class file (fails verification) */
 
 /* quick opcodes (may only be internally used by VM) */
-#define LDC_QUICK 203 
-#define UNKNOWN1 204 /* UNKNOWN */
+#define LDC_QUICK 203 /* u1, u1; LDC of an already created String constant */
+#define LDC_W_QUICK 204 /* u1, u2; LDC_W of an already created String constant */
 #define LDC2_W_QUICK 205 
-#define GETFIELD_QUICK 206 
-#define PUTFIELD_QUICK 207 
-#define GETFIELD2_QUICK 208 
-#define PUTFIELD2_QUICK 209 
-#define UNKNOWN2 210 /* UNKNOWN */
-#define PUTSTATIC_QUICK 211 
-#define GETSTATIC2_QUICK 212
-#define PUTSTATIC2_QUICK 213
-#define INVOKEVIRTUAL_QUICK 214
-#define INVOKENONVIRTUAL_QUICK 215
+#define GETFIELD_QUICK 206 /* u1, u2 (slot index); GETFIELD of a resolved one slot field */
+#define PUTFIELD_QUICK 207 /* u1, u2 (slot index); PUTFIELD of a resolved one slot primitive field */
+#define GETFIELD2_QUICK 208 /* u1, u2 (slot index); GETFIELD of a resolved two slot field */
+#define PUTFIELD2_QUICK 209 /* u1, u2 (slot index); PUTFIELD of a resolved two slot field */
+#define GETSTATIC_QUICK 210 /* u1, u2; GETSTATIC of a resolved one slot field of an initialized class */
+#define PUTSTATIC_QUICK 211 /* u1, u2; PUTSTATIC of a resolved one slot field of an initialized class */
+#define GETSTATIC2_QUICK 212 /* u1, u2; GETSTATIC of a resolved two slot field of an initialized class */
+#define PUTSTATIC2_QUICK 213 /* u1, u2; PUTSTATIC of a resolved two slot field of an initialized class */
+#define INVOKEVIRTUAL_QUICK 214 /* u1, u2; INVOKEVIRTUAL of a resolved method with a vtable entry, operand is the inline cache index */
+#define INVOKENONVIRTUAL_QUICK 215 /* u1, u2; INVOKESPECIAL (or INVOKEVIRTUAL of a private method) of a resolved, non native method */
 #define INVOKESUPER_QUICK 216
-#define INVOKESTATIC_QUICK 217
-#define INVOKEINTERFACE_QUICK 218
+#define INVOKESTATIC_QUICK 217 /* u1, u2; INVOKESTATIC of a resolved, non native method of an initialized class */
+#define INVOKEINTERFACE_QUICK 218 /* u1, u2, u1, u1; INVOKEINTERFACE of a resolved interface method, operand is the inline cache index */
 #define INVOKEVIRTUALOBJECT_QUICK 219
 #define UNKNOWN3 220 /* UNKNOWN */
-#define NEW_QUICK 221
-#define ANEWARRAY_QUICK 222
+#define NEW_QUICK 221 /* u1, u2; NEW of a resolved and initialized class */
+#define ANEWARRAY_QUICK 222 /* u1, u2; ANEWARRAY of a resolved array class */
 #define MULTIANEWARRAY_QUICK 223
-#define CHECKCAST_QUICK 224
-#define INSTANCEOF_QUICK 225
+#define CHECKCAST_QUICK 224 /* u1, u2; CHECKCAST against a resolved class */
+#define INSTANCEOF_QUICK 225 /* u1, u2; INSTANCEOF against a resolved class */
 #define INVOKEVIRTUAL_QUICK_W 226
 #define GETFIELD_QUICK_W 227
-#define PUTFIELD_QUICK_W 228
+#define APUTFIELD_QUICK 228 /* u1, u2 (slot index); PUTFIELD of a resolved reference field, which needs the write barrier (instead of PUTFIELD_QUICK_W) */
 
 /* unused opcodes */
 #define UNUSED1 229
@@ -360,24 +362,55 @@
 #define IMPDEP1 254 /* RESERVED: implementation depedant 1; must not appear in class file */
 #define IMPDEP2 255 /* RESERVED: implementation depedant 2; must not appear in class file */
 
-char* opcodeNames[]= {"NOP", "ACONST_NULL", "ICONST_M1", "ICONST_0", "ICONST_1", "ICONST_2", "ICONST_3", "ICONST_4", "ICONST_5", "LCONST_0", "LCONST_1", "FCONST_0",
-	"FCONST_1", "FCONST_2", "DCONST_0", "DCONST_1", "BIPUSH", "SIPUSH", "LDC", "LDC_W", "LDC2_W", "ILOAD", "LLOAD", "FLOAD", "DLOAD", "ALOAD", "ILOAD_0", "ILOAD_1",
-	"ILOAD_2", "ILOAD_3", "LLOAD_0", "LLOAD_1", "LLOAD_2", "LLOAD_3", "FLOAD_0", "FLOAD_1", "FLOAD_2", "FLOAD_3", "DLOAD_0", "DLOAD_1", "DLOAD_2", "DLOAD_3", "ALOAD_0",
-	"ALOAD_1", "ALOAD_2", "ALOAD_3", "IALOAD", "LALOAD", "FALOAD", "DALOAD", "AALOAD", "BALOAD", "CALOAD", "SALOAD", "ISTORE", "LSTORE", "FSTORE", "DSTORE", "ASTORE",
-	"ISTORE_0", "ISTORE_1", "ISTORE_2", "ISTORE_3", "LSTORE_0", "LSTORE_1", "LSTORE_2", "LSTORE_3", "FSTORE_0", "FSTORE_1", "FSTORE_2", "FSTORE_3", "DSTORE_0",
-	"DSTORE_1", "DSTORE_2", "DSTORE_3", "ASTORE_0", "ASTORE_1", "ASTORE_2", "ASTORE_3", "IASTORE", "LASTORE", "FASTORE", "DASTORE", "AASTORE", "BASTORE", "CASTORE",
-	"SASTORE", "POP", "POP2", "DUP", "DUP_X1", "DUP_X2", "DUP2", "DUP2_X1", "DUP2_X2", "SWAP", "IADD", "LADD", "FADD", "DADD", "ISUB", "LSUB", "FSUB", "DSUB", "IMUL",
-	"LMUL", "FMUL", "DMUL", "IDIV", "LDIV", "FDIV", "DDIV", "IREM", "LREM", "FREM", "DREM", "INEG", "LNEG", "FNEG", "DNEG", "ISHL", "LSHL", "ISHR", "LSHR", "IUSHR", 
-	"LUSHR",	"IAND", "LAND", "IOR", "LOR", "IXOR", "LXOR", "IINC", "I2L", "I2F", "I2D", "L2I", "L2F", "L2D", "F2I", "F2L", "F2D", "D2I", "D2L", "D2F", "I2B", "I2C", 
-	"I2S", "LCMP", "FCMPL", "FCMPG", "DCMPL", "DCMPG", "IFEQ", "IFNE", "IFLT", "IFGE", "IFGT", "IFLE", "IF_ICMPEQ", "IF_ICMPNE", "IF_ICMPLT", "IF_ICMPGE", "IF_ICMPGT", 
-	"IF_ICMPLE", "IF_ACMPEQ", "IF_ACMPNE", "GOTO", "JSR", "RET", "TABLESWITCH", "LOOKUPSWITCH", "IRETURN", "LRETURN", "FRETURN", "DRETURN", "ARETURN", "RETURN", 
-	"GETSTATIC", "PUTSTATIC", "GETFIELD", "PUTFIELD", "INVOKEVIRTUAL", "INVOKESPECIAL", "INVOKESTATIC", "INVOKEINTERFACE", "XXX_UNUSED_XXX", "NEW", "NEWARRAY", 
-	"ANEWARRAY", "ARRAYLENGTH", "ATHROW", "CHECKCAST", "INSTANCEOF", "MONITORENTER", "MONITOREXIT", "WIDE", "MULTIANEWARRAY", "IFNULL", "IFNONNULL", "GOTO_W", "JSR_W", 
-	"BREAKPOINT", "LDC_QUICK", "UNKNOWN1", "LDC2_W_QUICK", "GETFIELD_QUICK", "PUTFIELD_QUICK", "GETFIELD2_QUICK", "PUTFIELD2_QUICK", "UNKNOWN2", "PUTSTATIC_QUICK",  
-	"GETSTATIC2_QUICK", "PUTSTATIC2_QUICK", "INVOKEVIRTUAL_QUICK", "INVOKENONVIRTUAL_QUICK", "INVOKESUPER_QUICK", "INVOKESTATIC_QUICK", "INVOKEINTERFACE_QUICK", 
-	"INVOKEVIRTUALOBJECT_QUICK", "UNKNOWN3", "NEW_QUICK", "ANEWARRAY_QUICK", "MULTIANEWARRAY_QUICK", "CHECKCAST_QUICK", "INSTANCEOF_QUICK", "INVOKEVIRTUAL_QUICK_W", 
-	"GETFIELD_QUICK_W", "PUTFIELD_QUICK_W", "UNUSED1", "UNUSED2", "UNUSED3", "UNUSED4", "UNUSED5", "UNUSED6", "UNUSED7", "UNUSED8", "UNUSED9", "UNUSED10", "UNUSED11", 
-	"UNUSED12", "UNUSED13", "UNUSED14", "UNUSED15", "UNUSED16", "UNUSED17", "UNUSED18", "UNUSED19", "UNUSED20", "UNUSED21", "UNUSED22", "UNUSED23", "UNUSED24", 
-	"UNUSED25", "IMPDEP1", "IMPDEP2"};
+/* opcode names, see opcodes.c */
+extern char* opcodeNames[];
+
+uint32 opcode_getInstructionLength( const u1* code, uint32 pc );
+void opcode_predecode( u1* code, uint32 codeLength );
+
+/* The internal instruction format: the code of a method is translated once when its class is loaded (see opcode_predecode()). Every instruction keeps its
+   position and length, so pcs are the same as in the class file, but the operands are decoded already:
+   - 2 byte operands (indices, the value of SIPUSH, and the index and constant of WIDE) are native-endian
+   - the targets of branches are absolute pcs, 2 bytes wide (code is at most 65535 bytes long), 4 bytes for GOTO_W and JSR_W
+   - all 4 byte operands of TABLESWITCH and LOOKUPSWITCH are native-endian and aligned, their targets are absolute, too
+   The operands following the opcode byte aren't aligned (except for the switches), so they are copied with memcpy(), which compilers turn into a single
+   load or store on the supported hosts.
+   This is deliberately not a fixed-width format with resolved constant pool pointers: the reference maps, exception tables, the entry offsets of the JIT
+   compilers and the ahead-of-time compiler all address instructions by their class file pcs, which a different layout would break. Operands still index
+   the constant pool, and resolved entries are reached through the quick forms. The aligned, fixed-width format is the register code of the register
+   interpreter (see registerInterpreter.h), which maps the pcs by its entry table. */
+static __inline__ uint16 opcode_readU2( const void* operands )
+{
+	uint16 value;
+	
+	memcpy( &value, operands, sizeof(value) );
+	return value;
+}
+
+static __inline__ int16 opcode_readS2( const void* operands )
+{
+	int16 value;
+	
+	memcpy( &value, operands, sizeof(value) );
+	return value;
+}
+
+static __inline__ int32 opcode_readS4( const void* operands )
+{
+	int32 value;
+	
+	memcpy( &value, operands, sizeof(value) );
+	return value;
+}
+
+static __inline__ void opcode_writeU2( void* operands, uint16 value )
+{
+	memcpy( operands, &value, sizeof(value) );
+}
+
+static __inline__ void opcode_writeS4( void* operands, int32 value )
+{
+	memcpy( operands, &value, sizeof(value) );
+}
 
 #endif /*_opcodes_h_*/
@@ -0,0 +1,3491 @@
+/*
+ *  optimizingCompiler.c
+ *  Optimizing just-in-time compiler, the second tier of the mixed mode. A method which has been invoked often enough (see optimizingCompiler.h) has been
+ *  compiled by the baseline compiler (see jit.c) before, so its instructions are quickened and the inline caches of its call sites know the receiver classes.
+ *  It's compiled again, in these steps:
+ *  - The bytecode is translated into a graph of basic blocks of nodes in SSA form, by abstract interpretation of the operand stack and the locals. Phis are
+ *    placed at every merge point and removed again where they are redundant. Constant expressions and branches are folded on the fly.
+ *  - Small static and private methods are inlined. Virtual and interface calls are inlined, too, if their inline cache has seen only one receiver class, behind
+ *    a class check of the receiver.
+ *  - Global value numbering over the dominator tree removes common subexpressions and redundant null, bounds and class checks. Bounds checks of indexes which
+ *    are known to be in range (e.g. the counter of a loop up to the array length) are removed, then dead nodes.
+ *  - A linear scan allocates registers (or spill slots) for all values, and the machine code is generated from the nodes.
+ *  Only int, long and reference arithmetic, locals, branches, array and field accesses and inlined calls are supported. Everything else leaves the machine
+ *  code: every node which may fail (a null, bounds or class check, a division) and every unsupported instruction (calls which aren't inlined, returns,
+ *  allocation, floating point arithmetic, instructions which haven't been quickened) has a frame state, i.e. the values of the locals and the operand stack at
+ *  its bytecode offset, including the states of the callers if it's in an inlined method. At an exit, the machine code saves its registers and a helper
+ *  rebuilds the frames of the interpreter from the frame state: the frame of the method itself and a new frame for every inlined method, with its stored pc at
+ *  the instruction to continue at. The interpreter (or the baseline machine code) then continues there, e.g. executes the call or throws the exception.
+ *  Exits due to failed speculations deoptimize the method, i.e. its optimized machine code is discarded after too many of them.
+ *  Loop headers are safe points: if the world has to be stopped, or the time slice of a green thread is over, the machine code leaves to the interpreter,
+ *  which then continues the loop. So the garbage collector never sees a frame of optimized code, and the values in registers stay valid.
+ *  A hot loop of a method which isn't invoked often is optimized separately, for an entry at its loop header (on-stack replacement): the start block loads
+ *  the locals and the operand stack from the interpreter frame and jumps to the loop header, and only the code which can be reached from there is parsed.
+ *  The reference map of the loop header tells which of the values are longs.
+ *
+ *  Copyright (c) 2006, 2007 Daniel Klein. All rights reserved.
+ *
+ *  Licensed under GPL version 2.
+ *  See here for the full license: http://www.gnu.org/licenses/gpl.html
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "puraGlobals.h"
+#include "memoryManager.h"
+#include "class.h"
+#include "stack.h"
+#include "heap.h"
+#include "opcodes.h"
+#include "inlineCache.h"
+#include "thread.h"
+#include "scheduler.h"
+#include "jit.h"
+#include "referenceMap.h"
+#include "optimizingCompiler.h"
+
+uint32 optimizationThreshold= OPT_INVOCATION_THRESHOLD;
+uint32 optimizationBackwardBranchThreshold= OPT_BACKWARD_BRANCH_THRESHOLD;
+
+#ifdef JIT_ENABLED
+
+/* types of values: ints, floats and references take one slot, longs and doubles two. Floats and doubles are only moved around, never computed. */
+#define TYPE_VOID 0
+#define TYPE_INT 1
+#define TYPE_LONG 2
+
+/* operations of the nodes */
+#define OP_CONSTANT 0 /* constant: the value, not part of any block */
+#define OP_PARAMETER 1 /* constant: index of the slot in the frame, i.e. of the local variable, or of the operand stack slot following them */
+#define OP_PHI 2
+#define OP_ADD 3
+#define OP_SUB 4
+#define OP_MUL 5
+#define OP_AND 6
+#define OP_OR 7
+#define OP_XOR 8
+#define OP_SHL 9
+#define OP_SHR 10
+#define OP_USHR 11
+#define OP_DIV 12 /* state: leaves if the divisor is 0 or -1 */
+#define OP_REM 13
+#define OP_NEG 14
+#define OP_EXTEND_BYTE 15
+#define OP_EXTEND_CHAR 16
+#define OP_EXTEND_SHORT 17
+#define OP_INT_TO_LONG 18
+#define OP_LONG_TO_INT 19
+#define OP_COMPARE_LONG 20
+#define OP_ARRAY_LENGTH 21
+#define OP_ARRAY_LOAD 22 /* kind: element kind */
+#define OP_ARRAY_STORE 23
+#define OP_FIELD_LOAD 24 /* constant: offset of the field in the object */
+#define OP_FIELD_STORE 25
+#define OP_STATIC_LOAD 26 /* constant: address of the field */
+#define OP_STATIC_STORE 27
+#define OP_NULL_CHECK 28 /* state: leaves if the reference is null */
+#define OP_BOUNDS_CHECK 29 /* state: leaves unless 0 <= index < length */
+#define OP_CLASS_CHECK 30 /* constant: expected class; state: leaves if the object is of another class */
+#define OP_SAFE_POINT 31 /* state: leaves if the world has to be stopped or the time slice is over */
+#define OP_IF 32 /* kind: condition; the first successor is taken if it's true */
+#define OP_GOTO 33
+#define OP_EXIT 34 /* kind: reason; state: where the interpreter continues */
+
+/* kinds of array elements */
+#define ELEMENT_INT 0
+#define ELEMENT_REFERENCE 1
+#define ELEMENT_BYTE 2
+#define ELEMENT_CHAR 3
+
+/* reasons to leave the optimized machine code */
+#define EXIT_INTERPRET 0 /* an instruction which isn't supported, e.g. a call which hasn't been inlined, or a return */
+#define EXIT_SAFE_POINT 1
+#define EXIT_SWITCH 2 /* the green thread gives up its worker */
+#define EXIT_DEOPTIMIZE 3 /* a speculation has failed: another receiver class, an instruction which hasn't been quickened or a failed check */
+
+/* Registers used for values, the others are rax, rcx and rdx (scratch registers of the machine code of the nodes) and rsp. Locations of values are indexes
+   into this table, or spill slots from REGISTER_COUNT on. */
+#define REGISTER_COUNT 12
+#define FIRST_CALLER_SAVED_REGISTER 6
+#define NO_LOCATION -1
+
+uint8 allocatableRegisters[REGISTER_COUNT]= { RBX, RBP, R12, R13, R14, R15, RSI, RDI, R8, R9, R10, R11 };
+
+/* Layout of the native stack frame of the machine code: the arguments, then the save area, which holds the registers when the machine code is left, then the
+   spill slots. So every location is an index into the save area. */
+#define STACK_OFFSET 0
+#define FRAME_OFFSET 8
+#define SWITCHING_OFFSET 16
+#define SAVE_AREA_OFFSET 24
+
+#define NO_POSITION 0xFFFFFFFF
+
+/* sources of the moves of phis, besides locations */
+#define MOVE_CONSTANT -2
+#define MOVE_TEMPORARY -3 /* rdx */
+
+/* size of the chunks of memory used during one compilation */
+#define CHUNK_SIZE (64*1024)
+
+/* Compilations with more nodes are abandoned. */
+#define MAX_NODE_COUNT 100000
+
+/* Values of the locals and the operand stack at a bytecode offset, where the interpreter can continue. The values are NULL for undefined slots and for the
+   second slot of longs and doubles. */
+typedef struct sFrameState
+{
+	Class* cls;
+	method_info* method;
+	uint32 pc;
+	uint16 localCount;
+	uint16 stackCount;
+	struct sNode** values; /* the locals, then the operand stack */
+	struct sFrameState* outer; /* state of the caller at the return address, if the method is inlined */
+} FrameState;
+
+typedef struct sNode
+{
+	uint8 operation;
+	uint8 type;
+	uint8 kind; /* condition of OP_IF, element kind of array accesses and field stores, reason of OP_EXIT */
+	boolean isRemoved;
+	boolean isUndefined; /* phi of a slot which isn't defined on all paths */
+	boolean isLive;
+	boolean isVisited;
+	uint32 id;
+	int64 constant;
+	struct sNode** inputs;
+	uint32 inputCount;
+	uint32 inputCapacity;
+	FrameState* state;
+	struct sBlock* block;
+	struct sNode* next;
+	struct sNode* previous;
+	struct sNode* replacement; /* the node is the same value as its replacement */
+	struct sNode* nextInBucket; /* value numbering */
+	uint32 position; /* in the linear order of all nodes */
+	uint32 intervalStart;
+	uint32 intervalEnd;
+	int32 location;
+} Node;
+
+typedef struct sBlock
+{
+	uint32 id;
+	uint32 pc;
+	struct sScope* scope;
+	Node* first;
+	Node* last;
+	struct sBlock** predecessors;
+	uint32 predecessorCount;
+	uint32 predecessorCapacity;
+	struct sBlock* successors[2];
+	uint32 successorCount;
+	/* parsing */
+	uint32 expectedPredecessorCount; /* number of branches to the block in the bytecode */
+	boolean isLoopHeader;
+	boolean isReturnBlock; /* continuation of an inlined method in its caller */
+	Node** entryValues; /* NULL as long as the block hasn't been reached */
+	uint16 entryStackCount;
+	/* analysis */
+	boolean isVisited;
+	uint32 order; /* index in the reverse postorder */
+	struct sBlock* dominator;
+	struct sBlock** children; /* in the dominator tree */
+	uint32 childCount;
+	uint32 childCapacity;
+	uint32* liveIn;
+	uint32 startPosition;
+	uint32 endPosition;
+	uint32 codeOffset;
+} Block;
+
+/* A method which is parsed, either the optimized method or an inlined one. */
+typedef struct sScope
+{
+	Class* cls;
+	method_info* method;
+	byte* bytecode;
+	uint32 codeLength;
+	uint16 localCount;
+	uint16 maxStack;
+	Block** blockAt; /* block which starts at each bytecode offset */
+	Block** worklist;
+	uint32 worklistCount;
+	uint32 worklistCapacity;
+	uint32 depth;
+	struct sScope* outer; /* the caller, if the method is inlined */
+	FrameState* callerState; /* state of the caller at the return address, without the arguments */
+	Block* returnBlock; /* where the returns of an inlined method continue in the caller */
+} Scope;
+
+/* Values of the locals and the operand stack while a block is parsed. */
+typedef struct sState
+{
+	Node** values; /* the locals, then the operand stack */
+	uint16 stackCount;
+} State;
+
+typedef struct sChunk
+{
+	struct sChunk* next;
+	uint32 used;
+	uint32 size;
+	byte data[];
+} Chunk;
+
+typedef struct sJump
+{
+	uint32 position; /* of the 32 bit displacement */
+	Block* target;
+} Jump;
+
+typedef struct sExitStub
+{
+	uint32 position; /* of the 32 bit displacement of the jump to the stub */
+	uint32 exitIndex;
+	uint32 resumePosition; /* where a switch check continues if the time slice isn't over, 0 for all other stubs */
+} ExitStub;
+
+typedef struct sMove
+{
+	int32 destination;
+	int32 source; /* a location, MOVE_CONSTANT or MOVE_TEMPORARY */
+	Node* value;
+} Move;
+
+/* where the value of a slot of an interpreter frame is found when the machine code is left */
+typedef struct sExitValue
+{
+	uint8 type; /* TYPE_VOID for undefined slots and the second slot of longs */
+	int32 location; /* index into the save area, NO_LOCATION for constants */
+	int64 constant;
+} ExitValue;
+
+/* an interpreter frame which is rebuilt at an exit */
+typedef struct sExitFrame
+{
+	Class* cls;
+	method_info* method;
+	uint32 pc;
+	uint16 localCount;
+	uint16 stackCount;
+	ExitValue* values;
+} ExitFrame;
+
+typedef struct sExit
+{
+	uint8 reason;
+	uint8 frameCount;
+	ExitFrame* frames; /* starting with the frame of the optimized method, followed by those of the inlined methods */
+} Exit;
+
+/* State of the optimization of one method. All nodes and blocks are allocated from chunks, which are freed at the end. */
+typedef struct sOptimization
+{
+	method_info* method;
+	uint32 entryPc; /* loop header where the machine code is entered, or 0 */
+	Chunk* chunks;
+	boolean hasFailed;
+	Node** nodes; /* indexed by id */
+	uint32 nodeCount;
+	uint32 nodeCapacity;
+	Block** blocks;
+	uint32 blockCount;
+	uint32 blockCapacity;
+	Block* startBlock;
+	Block** order; /* reverse postorder, which is the order of the machine code, too */
+	uint32 orderCount;
+	uint32 inlinedBytecodeSize;
+	uint32 spillSlotCount;
+	uint32 frameSize;
+	CodeBuffer buffer;
+	uint32 exitPosition; /* saves the registers and leaves with the exit index in eax */
+	Jump* jumps;
+	uint32 jumpCount;
+	uint32 jumpCapacity;
+	ExitStub* stubs;
+	uint32 stubCount;
+	uint32 stubCapacity;
+	Exit* exits;
+	uint32 exitCount;
+	uint32 exitCapacity;
+	OptimizedMethod* optimizedMethod;
+} Optimization;
+
+/* statistics */
+uint32 optimizedMethodCount= 0;
+uint32 optimizedLoopCount= 0;
+uint32 reoptimizedMethodCount= 0;
+uint32 failedOptimizationCount= 0;
+uint32 optimizedBytecodeSize= 0;
+uint32 optimizedMachineCodeSize= 0;
+uint32 inlinedMethodCount= 0;
+uint32 eliminatedNullCheckCount= 0;
+uint32 eliminatedBoundsCheckCount= 0;
+uint32 optimizedCodeEntryCount= 0;
+uint32 optimizedCodeExitCount= 0;
+uint32 deoptimizationCount= 0;
+uint32 discardedOptimizedMethodCount= 0;
+
+/* memory of a compilation */
+
+/* Returns zeroed memory, which lives until the end of the compilation. */
+void* allocate( Optimization* o, uint32 size )
+{
+	size= (size + 7) & ~7;
+	Chunk* chunk= o->chunks;
+	
+	if( chunk == NULL || chunk->used + size > chunk->size )
+	{
+		uint32 chunkSize= size > CHUNK_SIZE ? size : CHUNK_SIZE;
+		chunk= mm_staticMalloc( sizeof(Chunk) + chunkSize );
+		chunk->next= o->chunks;
+		chunk->used= 0;
+		chunk->size= chunkSize;
+		o->chunks= chunk;
+	}
+	
+	void* memory= chunk->data + chunk->used;
+	chunk->used+= size;
+	memset( memory, 0, size );
+	return memory;
+}
+
+/* Makes room for one more element at the end of an array which has been allocated by allocate(). */
+void* growArray( Optimization* o, void* array, uint32 count, uint32* capacity, uint32 elementSize )
+{
+	if( count < *capacity )
+		return array;
+	
+	uint32 newCapacity= 2 * *capacity + 8;
+	void* newArray= allocate( o, newCapacity * elementSize );
+	
+	if( count > 0 )
+		memcpy( newArray, array, count * elementSize );
+	
+	*capacity= newCapacity;
+	return newArray;
+}
+
+void freeChunks( Optimization* o )
+{
+	while( o->chunks != NULL )
+	{
+		Chunk* next= o->chunks->next;
+		mm_staticFree( o->chunks );
+		o->chunks= next;
+	}
+}
+
+/* nodes and blocks */
+
+void appendNode( Block* block, Node* node )
+{
+	node->block= block;
+	node->previous= block->last;
+	
+	if( block->last != NULL )
+		block->last->next= node;
+	else
+		block->first= node;
+	
+	block->last= node;
+}
+
+/* Creates a node, which is appended to the given block, unless it's NULL. */
+Node* newNode( Optimization* o, Block* block, uint8 operation, uint8 type, uint32 inputCount )
+{
+	Node* node= allocate( o, sizeof(Node) );
+	node->operation= operation;
+	node->type= type;
+	node->id= o->nodeCount;
+	node->inputCount= inputCount;
+	node->inputCapacity= inputCount;
+	node->inputs= inputCount > 0 ? allocate( o, inputCount * sizeof(Node*) ) : NULL;
+	node->location= NO_LOCATION;
+	node->intervalStart= NO_POSITION;
+	
+	o->nodes= growArray( o, o->nodes, o->nodeCount, &o->nodeCapacity, sizeof(Node*) );
+	o->nodes[o->nodeCount]= node;
+	o->nodeCount++;
+	
+	if( o->nodeCount > MAX_NODE_COUNT )
+		o->hasFailed= true;
+	
+	if( block != NULL )
+		appendNode( block, node );
+	
+	return node;
+}
+
+Node* newConstant( Optimization* o, uint8 type, int64 value )
+{
+	Node* node= newNode( o, NULL, OP_CONSTANT, type, 0 );
+	node->constant= type == TYPE_INT ? (int32)value : value;
+	return node;
+}
+
+boolean isConstant( Node* node )
+{
+	return node->operation == OP_CONSTANT;
+}
+
+void addInput( Optimization* o, Node* node, Node* input )
+{
+	node->inputs= growArray( o, node->inputs, node->inputCount, &node->inputCapacity, sizeof(Node*) );
+	node->inputs[node->inputCount]= input;
+	node->inputCount++;
+}
+
+Block* newBlock( Optimization* o, Scope* scope, uint32 pc )
+{
+	Block* block= allocate( o, sizeof(Block) );
+	block->id= o->blockCount;
+	block->scope= scope;
+	block->pc= pc;
+	
+	o->blocks= growArray( o, o->blocks, o->blockCount, &o->blockCapacity, sizeof(Block*) );
+	o->blocks[o->blockCount]= block;
+	o->blockCount++;
+	return block;
+}
+
+void addPredecessor( Optimization* o, Block* block, Block* predecessor )
+{
+	block->predecessors= growArray( o, block->predecessors, block->predecessorCount, &block->predecessorCapacity, sizeof(Block*) );
+	block->predecessors[block->predecessorCount]= predecessor;
+	block->predecessorCount++;
+}
+
+uint32 getPredecessorIndex( Block* block, Block* predecessor )
+{
+	uint32 i;
+	for( i= 0; i < block->predecessorCount; i++ )
+	{
+		if( block->predecessors[i] == predecessor )
+			return i;
+	}
+	
+	return 0;
+}
+
+/* Follows the replacements of a node. Returns NULL for undefined values. */
+Node* resolve( Node* node )
+{
+	while( node != NULL && node->replacement != NULL )
+		node= node->replacement;
+	
+	if( node != NULL && node->isUndefined )
+		return NULL;
+	
+	return node;
+}
+
+boolean definesValue( Node* node )
+{
+	return node->type != TYPE_VOID && node->operation != OP_CONSTANT;
+}
+
+/* Nodes which must not be removed, even if their value isn't used. */
+boolean hasSideEffects( Node* node )
+{
+	switch( node->operation )
+	{
+		case OP_DIV:
+		case OP_REM:
+		case OP_ARRAY_STORE:
+		case OP_FIELD_STORE:
+		case OP_STATIC_STORE:
+		case OP_NULL_CHECK:
+		case OP_BOUNDS_CHECK:
+		case OP_CLASS_CHECK:
+		case OP_SAFE_POINT:
+		case OP_IF:
+		case OP_GOTO:
+		case OP_EXIT:
+			return true;
+	}
+	
+	return false;
+}
+
+/* frame states */
+
+FrameState* newFrameState( Optimization* o, Scope* s, State* state, uint32 pc )
+{
+	FrameState* frameState= allocate( o, sizeof(FrameState) );
+	frameState->cls= s->cls;
+	frameState->method= s->method;
+	frameState->pc= pc;
+	frameState->localCount= s->localCount;
+	frameState->stackCount= state->stackCount;
+	frameState->values= allocate( o, (s->localCount + state->stackCount) * sizeof(Node*) );
+	memcpy( frameState->values, state->values, (s->localCount + state->stackCount) * sizeof(Node*) );
+	frameState->outer= s->callerState;
+	return frameState;
+}
+
+void resolveFrameState( FrameState* frameState )
+{
+	for( ; frameState != NULL; frameState= frameState->outer )
+	{
+		uint32 i;
+		for( i= 0; i < frameState->localCount + frameState->stackCount; i++ )
+			frameState->values[i]= resolve( frameState->values[i] );
+	}
+}
+
+/* parsing the bytecode */
+
+uint8 readOpcode( byte* bytecode, uint32 pc )
+{
+	/* The interpreter may quicken the instruction at the same time. Its operands are written before the opcode, so they have to be read after it. */
+	uint8 opcode= *(volatile byte*)(bytecode + pc);
+	__sync_synchronize();
+	return opcode;
+}
+
+uint16 readOperand16( byte* operands )
+{
+	return opcode_readU2( operands );
+}
+
+/* Branch targets are absolute pcs (see opcode_predecode()). */
+uint32 readBranchTarget( byte* bytecode, uint32 pc, uint8 opcode )
+{
+	byte* operands= bytecode + pc + 1;
+	
+	if( opcode == GOTO_W )
+		return opcode_readS4( operands );
+	
+	return opcode_readU2( operands );
+}
+
+boolean isBranch( uint8 opcode )
+{
+	return (opcode >= IFEQ && opcode <= GOTO) || opcode == IFNULL || opcode == IFNONNULL || opcode == GOTO_W;
+}
+
+/* Checks if the next instruction may be executed after the given one. */
+boolean fallsThrough( uint8 opcode )
+{
+	switch( opcode )
+	{
+		case GOTO:
+		case GOTO_W:
+		case JSR:
+		case JSR_W:
+		case RET:
+		case TABLESWITCH:
+		case LOOKUPSWITCH:
+		case IRETURN:
+		case LRETURN:
+		case FRETURN:
+		case DRETURN:
+		case ARETURN:
+		case RETURN:
+		case ATHROW:
+			return false;
+	}
+	
+	return true;
+}
+
+Block* getBlockAt( Optimization* o, Scope* s, uint32 pc )
+{
+	if( s->blockAt[pc] == NULL )
+		s->blockAt[pc]= newBlock( o, s, pc );
+	
+	return s->blockAt[pc];
+}
+
+/* Creates the blocks of a method, i.e. one at every branch target and after every branch, and counts the branches to every block. */
+boolean createBlocks( Optimization* o, Scope* s )
+{
+	uint32 pc;
+	uint32 length;
+	s->blockAt= allocate( o, s->codeLength * sizeof(Block*) );
+	getBlockAt( o, s, 0 )->expectedPredecessorCount++;
+	
+	for( pc= 0; pc < s->codeLength; pc+= length )
+	{
+		uint8 opcode= readOpcode( s->bytecode, pc );
+		length= opcode_getInstructionLength( s->bytecode, pc );
+		
+		if( isBranch(opcode) )
+		{
+			uint32 target= readBranchTarget( s->bytecode, pc, opcode );
+			
+			if( target >= s->codeLength )
+				return false;
+			
+			Block* block= getBlockAt( o, s, target );
+			block->expectedPredecessorCount++;
+			
+			if( target <= pc )
+				block->isLoopHeader= true;
+		}
+		
+		if( (isBranch(opcode) || !fallsThrough(opcode)) && pc + length < s->codeLength )
+			getBlockAt( o, s, pc + length );
+	}
+	
+	/* instructions which fall through into the next block */
+	boolean previousFallsThrough= false;
+	for( pc= 0; pc < s->codeLength; pc+= length )
+	{
+		if( previousFallsThrough && s->blockAt[pc] != NULL )
+			s->blockAt[pc]->expectedPredecessorCount++;
+		
+		uint8 opcode= readOpcode( s->bytecode, pc );
+		length= opcode_getInstructionLength( s->bytecode, pc );
+		previousFallsThrough= fallsThrough( opcode );
+	}
+	
+	return true;
+}
+
+Scope* newScope( Optimization* o, Class* cls, method_info* method, Scope* outer )
+{
+	Scope* s= allocate( o, sizeof(Scope) );
+	s->cls= cls;
+	s->method= method;
+	s->bytecode= method->code->code;
+	s->codeLength= method->code->code_length;
+	s->localCount= method->code->max_locals;
+	s->maxStack= method->code->max_stack;
+	s->depth= outer != NULL ? outer->depth + 1 : 0;
+	s->outer= outer;
+	
+	if( !createBlocks(o, s) )
+		o->hasFailed= true;
+	
+	return s;
+}
+
+State* newState( Optimization* o, Scope* s )
+{
+	State* state= allocate( o, sizeof(State) );
+	state->values= allocate( o, (s->localCount + s->maxStack) * sizeof(Node*) );
+	return state;
+}
+
+void pushValue( Optimization* o, Scope* s, State* state, Node* value )
+{
+	if( state->stackCount >= s->maxStack )
+	{
+		o->hasFailed= true;
+		return;
+	}
+	
+	state->values[s->localCount + state->stackCount]= value;
+	state->stackCount++;
+}
+
+Node* popValue( Optimization* o, Scope* s, State* state )
+{
+	if( state->stackCount == 0 )
+	{
+		o->hasFailed= true;
+		return NULL;
+	}
+	
+	state->stackCount--;
+	return state->values[s->localCount + state->stackCount];
+}
+
+/* Longs and doubles take two slots, the second one is NULL. */
+void pushWideValue( Optimization* o, Scope* s, State* state, Node* value )
+{
+	pushValue( o, s, state, value );
+	pushValue( o, s, state, NULL );
+}
+
+Node* popWideValue( Optimization* o, Scope* s, State* state )
+{
+	popValue( o, s, state );
+	return popValue( o, s, state );
+}
+
+/* Every value which is used must be defined, otherwise the bytecode is invalid. */
+Node* use( Optimization* o, Node* value )
+{
+	if( value == NULL )
+		o->hasFailed= true;
+	
+	return value;
+}
+
+void storeLocal( Optimization* o, Scope* s, State* state, uint32 index, Node* value, boolean isWide )
+{
+	if( index + (isWide ? 1 : 0) >= s->localCount )
+	{
+		o->hasFailed= true;
+		return;
+	}
+	
+	/* A long which is overwritten partly isn't defined anymore. */
+	if( index > 0 && state->values[index - 1] != NULL && state->values[index - 1]->type == TYPE_LONG )
+		state->values[index - 1]= NULL;
+	
+	state->values[index]= value;
+	
+	if( isWide )
+		state->values[index + 1]= NULL;
+}
+
+Node* loadLocal( Optimization* o, Scope* s, State* state, uint32 index )
+{
+	if( index >= s->localCount )
+	{
+		o->hasFailed= true;
+		return NULL;
+	}
+	
+	return use( o, state->values[index] );
+}
+
+/* Adds an edge from the end of the given block to the given successor, with the given values of the locals and the operand stack. The values of the first
+   edge to a block become its entry values, if it's a merge point, they are phis of all edges. */
+void addEdge( Optimization* o, Block* block, Block* successor, State* state )
+{
+	Scope* s= successor->scope;
+	uint32 slotCount= s->localCount + state->stackCount;
+	boolean isMerge= successor->isReturnBlock || successor->expectedPredecessorCount > 1;
+	uint32 i;
+	
+	addPredecessor( o, successor, block );
+	block->successors[block->successorCount]= successor;
+	block->successorCount++;
+	
+	if( successor->entryValues == NULL )
+	{
+		successor->entryValues= allocate( o, (s->localCount + s->maxStack) * sizeof(Node*) );
+		successor->entryStackCount= state->stackCount;
+		
+		for( i= 0; i < slotCount; i++ )
+		{
+			Node* value= state->values[i];
+			
+			if( value != NULL && isMerge )
+			{
+				Node* phi= newNode( o, successor, OP_PHI, value->type, 0 );
+				addInput( o, phi, value );
+				value= phi;
+			}
+			
+			successor->entryValues[i]= value;
+		}
+		
+		if( !successor->isReturnBlock )
+		{
+			s->worklist= growArray( o, s->worklist, s->worklistCount, &s->worklistCapacity, sizeof(Block*) );
+			s->worklist[s->worklistCount]= successor;
+			s->worklistCount++;
+		}
+		
+		return;
+	}
+	
+	if( !isMerge || successor->entryStackCount != state->stackCount )
+	{
+		o->hasFailed= true;
+		return;
+	}
+	
+	for( i= 0; i < slotCount; i++ )
+	{
+		Node* phi= successor->entryValues[i];
+		
+		if( phi == NULL )
+			continue;
+		
+		Node* value= state->values[i];
+		
+		if( value == NULL || value->type != phi->type )
+			phi->isUndefined= true;
+		
+		addInput( o, phi, value );
+	}
+}
+
+void addGoto( Optimization* o, Block* block, Block* successor, State* state )
+{
+	newNode( o, block, OP_GOTO, TYPE_VOID, 0 );
+	addEdge( o, block, successor, state );
+}
+
+/* Leaves the machine code at the given instruction. Ends the block. */
+boolean addExit( Optimization* o, Block* block, State* state, uint32 pc, uint8 reason )
+{
+	Node* exit= newNode( o, block, OP_EXIT, TYPE_VOID, 0 );
+	exit->kind= reason;
+	exit->state= newFrameState( o, block->scope, state, pc );
+	return false;
+}
+
+/* constant folding */
+
+boolean foldArithmetic( uint8 operation, uint8 type, int64 x, int64 y, int64* result )
+{
+	switch( operation )
+	{
+		case OP_INT_TO_LONG:
+			*result= (int32)x;
+			return true;
+		
+		case OP_LONG_TO_INT:
+			*result= (int32)x;
+			return true;
+		
+		case OP_COMPARE_LONG:
+			*result= x > y ? 1 : x < y ? -1 : 0;
+			return true;
+	}
+	
+	if( type == TYPE_LONG )
+	{
+		switch( operation )
+		{
+			case OP_ADD: *result= (int64)((uint64)x + (uint64)y); return true;
+			case OP_SUB: *result= (int64)((uint64)x - (uint64)y); return true;
+			case OP_MUL: *result= (int64)((uint64)x * (uint64)y); return true;
+			case OP_AND: *result= x & y; return true;
+			case OP_OR: *result= x | y; return true;
+			case OP_XOR: *result= x ^ y; return true;
+			case OP_NEG: *result= (int64)(0 - (uint64)x); return true;
+		}
+		
+		return false;
+	}
+	
+	int32 a= x;
+	int32 b= y;
+	int32 value;
+	
+	switch( operation )
+	{
+		case OP_ADD: value= (int32)((uint32)a + (uint32)b); break;
+		case OP_SUB: value= (int32)((uint32)a - (uint32)b); break;
+		case OP_MUL: value= (int32)((uint32)a * (uint32)b); break;
+		case OP_AND: value= a & b; break;
+		case OP_OR: value= a | b; break;
+		case OP_XOR: value= a ^ b; break;
+		case OP_SHL: value= (int32)((uint32)a << (b & 0x1F)); break;
+		case OP_SHR: value= a >> (b & 0x1F); break;
+		case OP_USHR: value= (int32)((uint32)a >> (b & 0x1F)); break;
+		case OP_NEG: value= (int32)(0 - (uint32)a); break;
+		case OP_EXTEND_BYTE: value= (int8)a; break;
+		case OP_EXTEND_CHAR: value= (uint16)a; break;
+		case OP_EXTEND_SHORT: value= (int16)a; break;
+		
+		case OP_DIV:
+		case OP_REM:
+			/* Divisions by 0 and -1 are left to the interpreter. */
+			if( b == 0 || b == -1 )
+				return false;
+			
+			value= operation == OP_DIV ? a / b : a % b;
+			break;
+		
+		default:
+			return false;
+	}
+	
+	*result= value;
+	return true;
+}
+
+boolean isCommutative( uint8 operation )
+{
+	return operation == OP_ADD || operation == OP_MUL || operation == OP_AND || operation == OP_OR || operation == OP_XOR;
+}
+
+/* Creates an arithmetic node with one or two inputs, unless its value is known already. */
+Node* newArithmetic( Optimization* o, Block* block, uint8 operation, uint8 type, Node* x, Node* y )
+{
+	int64 result;
+	
+	if( x == NULL || (y == NULL && operation != OP_NEG && operation < OP_EXTEND_BYTE) )
+	{
+		o->hasFailed= true;
+		return newConstant( o, type, 0 );
+	}
+	
+	if( isConstant(x) && (y == NULL || isConstant(y)) && foldArithmetic(operation, type, x->constant, y != NULL ? y->constant : 0, &result) )
+		return newConstant( o, type, result );
+	
+	/* constants are the second input */
+	if( y != NULL && isConstant(x) && !isConstant(y) && isCommutative(operation) )
+	{
+		Node* swap= x;
+		x= y;
+		y= swap;
+	}
+	
+	if( y != NULL && isConstant(y) )
+	{
+		boolean isShift= operation == OP_SHL || operation == OP_SHR || operation == OP_USHR;
+		
+		if( y->constant == 0 && (operation == OP_ADD || operation == OP_SUB || operation == OP_OR || operation == OP_XOR) )
+			return x;
+		
+		if( isShift && (y->constant & 0x1F) == 0 )
+			return x;
+		
+		if( (operation == OP_MUL && y->constant == 1) || (operation == OP_AND && y->constant == -1) )
+			return x;
+	}
+	
+	Node* node= newNode( o, block, operation, type, y != NULL ? 2 : 1 );
+	node->inputs[0]= x;
+	
+	if( y != NULL )
+		node->inputs[1]= y;
+	
+	return node;
+}
+
+Node* newDivision( Optimization* o, Block* block, uint8 operation, Node* x, Node* y, FrameState* state )
+{
+	Node* node= newArithmetic( o, block, operation, TYPE_INT, x, y );
+	
+	if( node->operation == operation )
+		node->state= state;
+	
+	return node;
+}
+
+boolean evaluateCondition( uint8 condition, int32 x, int32 y )
+{
+	switch( condition )
+	{
+		case CONDITION_EQUAL: return x == y;
+		case CONDITION_NOT_EQUAL: return x != y;
+		case CONDITION_LESS: return x < y;
+		case CONDITION_GREATER_OR_EQUAL: return x >= y;
+		case CONDITION_GREATER: return x > y;
+		case CONDITION_LESS_OR_EQUAL: return x <= y;
+	}
+	
+	return false;
+}
+
+/* Ends the block with a conditional branch, or with a goto if the condition is constant. */
+boolean addIf( Optimization* o, Block* block, State* state, Node* x, Node* y, uint8 condition, uint32 target, uint32 next )
+{
+	Scope* s= block->scope;
+	
+	if( x == NULL || y == NULL || next >= s->codeLength )
+	{
+		o->hasFailed= true;
+		return false;
+	}
+	
+	if( isConstant(x) && isConstant(y) )
+	{
+		addGoto( o, block, s->blockAt[evaluateCondition(condition, x->constant, y->constant) ? target : next], state );
+		return false;
+	}
+	
+	Node* node= newNode( o, block, OP_IF, TYPE_VOID, 2 );
+	node->kind= condition;
+	node->inputs[0]= x;
+	node->inputs[1]= y;
+	addEdge( o, block, s->blockAt[target], state );
+	addEdge( o, block, s->blockAt[next], state );
+	return false;
+}
+
+void addNullCheck( Optimization* o, Block* block, Node* reference, FrameState* state )
+{
+	if( reference == NULL || (isConstant(reference) && reference->constant != NULL_REFERENCE) )
+		return;
+	
+	Node* check= newNode( o, block, OP_NULL_CHECK, TYPE_VOID, 1 );
+	check->inputs[0]= reference;
+	check->state= state;
+}
+
+void addArrayChecks( Optimization* o, Block* block, Node* array, Node* index, FrameState* state )
+{
+	addNullCheck( o, block, array, state );
+	
+	Node* length= newNode( o, block, OP_ARRAY_LENGTH, TYPE_INT, 1 );
+	length->inputs[0]= array;
+	
+	Node* check= newNode( o, block, OP_BOUNDS_CHECK, TYPE_VOID, 2 );
+	check->inputs[0]= index;
+	check->inputs[1]= length;
+	check->state= state;
+}
+
+Node* newAccess( Optimization* o, Block* block, uint8 operation, uint8 type, Node* x, Node* y, Node* z )
+{
+	Node* node= newNode( o, block, operation, type, z != NULL ? 3 : y != NULL ? 2 : x != NULL ? 1 : 0 );
+	
+	if( x != NULL )
+		node->inputs[0]= x;
+	
+	if( y != NULL )
+		node->inputs[1]= y;
+	
+	if( z != NULL )
+		node->inputs[2]= z;
+	
+	return node;
+}
+
+boolean isInlinable( Optimization* o, Scope* s, method_info* method )
+{
+	if( method == NULL || method->code == NULL || isFlagSet(method->access_flags, ACC_NATIVE) || isFlagSet(method->access_flags, ACC_SYNCHRONIZED) )
+		return false;
+	
+	if( method->code->code_length > OPT_MAX_INLINE_SIZE || s->depth + 1 >= OPT_MAX_INLINE_DEPTH )
+		return false;
+	
+	return o->inlinedBytecodeSize + method->code->code_length <= OPT_MAX_INLINED_BYTECODE_SIZE;
+}
+
+void parseScope( Optimization* o, Scope* s );
+
+/* Inlines a call, or leaves the machine code if the method can't be inlined. If the receiver class is given, the call is only inlined for receivers of this
+   class. Returns true if the caller continues after the call in the (new) current block. */
+boolean addInvoke( Optimization* o, Block** currentBlock, State* state, uint32 pc, uint32 length, Class* cls, method_info* method, Class* receiverClass )
+{
+	Block* block= *currentBlock;
+	Scope* s= block->scope;
+	
+	if( !isInlinable(o, s, method) || state->stackCount < method->parameterSlotCount )
+		return addExit( o, block, state, pc, EXIT_INTERPRET );
+	
+	if( receiverClass != NULL )
+	{
+		FrameState* stateBefore= newFrameState( o, s, state, pc );
+		Node* receiver= use( o, state->values[s->localCount + state->stackCount - method->parameterSlotCount] );
+		addNullCheck( o, block, receiver, stateBefore );
+		
+		Node* check= newNode( o, block, OP_CLASS_CHECK, TYPE_VOID, 1 );
+		check->inputs[0]= receiver;
+		check->constant= (uintptr_t)receiverClass;
+		check->state= stateBefore;
+	}
+	
+	Scope* callee= newScope( o, cls, method, s );
+	
+	if( o->hasFailed )
+		return false;
+	
+	/* The arguments become the first locals of the inlined method. */
+	State* calleeState= newState( o, callee );
+	state->stackCount-= method->parameterSlotCount;
+	memcpy( calleeState->values, state->values + s->localCount + state->stackCount, method->parameterSlotCount * sizeof(Node*) );
+	
+	callee->callerState= newFrameState( o, s, state, pc + length );
+	callee->returnBlock= newBlock( o, s, pc + length );
+	callee->returnBlock->isReturnBlock= true;
+	o->inlinedBytecodeSize+= method->code->code_length;
+	inlinedMethodCount++;
+	
+	logVerbose( "\tInlining %s.%s%s.\n", cls->className, method->name, method->descriptor );
+	addGoto( o, block, callee->blockAt[0], calleeState );
+	parseScope( o, callee );
+	
+	/* continue after the call with the merged states of all returns, unless the method never returns */
+	Block* returnBlock= callee->returnBlock;
+	
+	if( o->hasFailed || returnBlock->entryValues == NULL )
+		return false;
+	
+	memcpy( state->values, returnBlock->entryValues, (s->localCount + returnBlock->entryStackCount) * sizeof(Node*) );
+	state->stackCount= returnBlock->entryStackCount;
+	*currentBlock= returnBlock;
+	return true;
+}
+
+boolean addReturn( Optimization* o, Block* block, State* state, uint32 pc, uint32 slotCount )
+{
+	Scope* s= block->scope;
+	
+	if( state->stackCount < slotCount )
+	{
+		o->hasFailed= true;
+		return false;
+	}
+	
+	/* The return of the optimized method itself is executed by the interpreter. */
+	if( s->outer == NULL )
+		return addExit( o, block, state, pc, EXIT_INTERPRET );
+	
+	/* An inlined method continues in the caller, with the result pushed onto its operand stack. */
+	Scope* caller= s->outer;
+	FrameState* callerState= s->callerState;
+	State* returnState= newState( o, caller );
+	memcpy( returnState->values, callerState->values, (callerState->localCount + callerState->stackCount) * sizeof(Node*) );
+	returnState->stackCount= callerState->stackCount;
+	
+	uint32 i;
+	for( i= 0; i < slotCount; i++ )
+		pushValue( o, caller, returnState, state->values[s->localCount + state->stackCount - slotCount + i] );
+	
+	addGoto( o, block, s->returnBlock, returnState );
+	return false;
+}
+
+/* Translates one instruction. Returns false if it ends the block. */
+boolean parseInstruction( Optimization* o, Block** currentBlock, State* state, uint8 opcode, uint32 pc, uint32 length )
+{
+	Block* block= *currentBlock;
+	Scope* s= block->scope;
+	Class* cls= s->cls;
+	byte* operands= s->bytecode + pc + 1;
+	Node* x;
+	Node* y;
+	Node* z;
+	
+	switch( opcode )
+	{
+		/* constants */
+		case NOP:
+			return true;
+		
+		case ACONST_NULL:
+			pushValue( o, s, state, newConstant(o, TYPE_INT, NULL_REFERENCE) );
+			return true;
+		
+		case ICONST_M1: case ICONST_0: case ICONST_1: case ICONST_2: case ICONST_3: case ICONST_4: case ICONST_5:
+			pushValue( o, s, state, newConstant(o, TYPE_INT, opcode - ICONST_0) );
+			return true;
+		
+		case LCONST_0: case LCONST_1:
+			pushWideValue( o, s, state, newConstant(o, TYPE_LONG, opcode - LCONST_0) );
+			return true;
+		
+		case FCONST_0: case FCONST_1: case FCONST_2:
+		{
+			float value= opcode - FCONST_0;
+			uint32 bits;
+			memcpy( &bits, &value, 4 );
+			pushValue( o, s, state, newConstant(o, TYPE_INT, bits) );
+			return true;
+		}
+		
+		case DCONST_0: case DCONST_1:
+		{
+			double value= opcode - DCONST_0;
+			int64 bits;
+			memcpy( &bits, &value, 8 );
+			pushWideValue( o, s, state, newConstant(o, TYPE_LONG, bits) );
+			return true;
+		}
+		
+		case BIPUSH:
+			pushValue( o, s, state, newConstant(o, TYPE_INT, (int8)operands[0]) );
+			return true;
+		
+		case SIPUSH:
+			pushValue( o, s, state, newConstant(o, TYPE_INT, opcode_readS2(operands)) );
+			return true;
+		
+		case LDC:
+		case LDC_W:
+		{
+			uint16 index= opcode == LDC ? operands[0] : readOperand16( operands );
+			uint8 tag= cls->constant_pool[index]->tag;
+			
+			/* Strings are created by the interpreter, when the instruction is executed the first time. */
+			if( tag != CONSTANT_Integer && tag != CONSTANT_Float )
+				return addExit( o, block, state, pc, EXIT_DEOPTIMIZE );
+			
+			pushValue( o, s, state, newConstant(o, TYPE_INT, cls_getItemFromConstantPool(cls, index)) );
+			return true;
+		}
+		
+		case LDC_QUICK:
+		case LDC_W_QUICK:
+		{
+			uint16 index= opcode == LDC_QUICK ? operands[0] : readOperand16( operands );
+			pushValue( o, s, state, newConstant(o, TYPE_INT, ((CONSTANT_String_info*)cls->constant_pool[index])->stringRef) );
+			return true;
+		}
+		
+		case LDC2_W:
+			pushWideValue( o, s, state, newConstant(o, TYPE_LONG, cls_getWideItemFromConstantPool(cls, readOperand16(operands))) );
+			return true;
+		
+		/* local variables */
+		case ILOAD: case FLOAD: case ALOAD:
+			pushValue( o, s, state, loadLocal(o, s, state, operands[0]) );
+			return true;
+		
+		case LLOAD: case DLOAD:
+			pushWideValue( o, s, state, loadLocal(o, s, state, operands[0]) );
+			return true;
+		
+		case ILOAD_0: case ILOAD_1: case ILOAD_2: case ILOAD_3:
+		case FLOAD_0: case FLOAD_1: case FLOAD_2: case FLOAD_3:
+		case ALOAD_0: case ALOAD_1: case ALOAD_2: case ALOAD_3:
+			pushValue( o, s, state, loadLocal(o, s, state, (opcode - ILOAD_0) % 4) );
+			return true;
+		
+		case LLOAD_0: case LLOAD_1: case LLOAD_2: case LLOAD_3:
+		case DLOAD_0: case DLOAD_1: case DLOAD_2: case DLOAD_3:
+			pushWideValue( o, s, state, loadLocal(o, s, state, (opcode - ILOAD_0) % 4) );
+			return true;
+		
+		case ISTORE: case FSTORE: case ASTORE:
+			storeLocal( o, s, state, operands[0], use(o, popValue(o, s, state)), false );
+			return true;
+		
+		case LSTORE: case DSTORE:
+			storeLocal( o, s, state, operands[0], use(o, popWideValue(o, s, state)), true );
+			return true;
+		
+		case ISTORE_0: case ISTORE_1: case ISTORE_2: case ISTORE_3:
+		case FSTORE_0: case FSTORE_1: case FSTORE_2: case FSTORE_3:
+		case ASTORE_0: case ASTORE_1: case ASTORE_2: case ASTORE_3:
+			storeLocal( o, s, state, (opcode - ISTORE_0) % 4, use(o, popValue(o, s, state)), false );
+			return true;
+		
+		case LSTORE_0: case LSTORE_1: case LSTORE_2: case LSTORE_3:
+		case DSTORE_0: case DSTORE_1: case DSTORE_2: case DSTORE_3:
+			storeLocal( o, s, state, (opcode - ISTORE_0) % 4, use(o, popWideValue(o, s, state)), true );
+			return true;
+		
+		case IINC:
+			x= loadLocal( o, s, state, operands[0] );
+			storeLocal( o, s, state, operands[0], newArithmetic(o, block, OP_ADD, TYPE_INT, x, newConstant(o, TYPE_INT, (int8)operands[1])), false );
+			return true;
+		
+		/* arrays */
+		case IALOAD: case FALOAD: case AALOAD: case BALOAD: case CALOAD:
+		{
+			FrameState* stateBefore= newFrameState( o, s, state, pc );
+			y= use( o, popValue(o, s, state) );
+			x= use( o, popValue(o, s, state) );
+			addArrayChecks( o, block, x, y, stateBefore );
+			z= newAccess( o, block, OP_ARRAY_LOAD, TYPE_INT, x, y, NULL );
+			z->kind= opcode == BALOAD ? ELEMENT_BYTE : opcode == CALOAD ? ELEMENT_CHAR : ELEMENT_INT;
+			pushValue( o, s, state, z );
+			return true;
+		}
+		
+		case IASTORE: case FASTORE: case AASTORE: case BASTORE: case CASTORE:
+		{
+			FrameState* stateBefore= newFrameState( o, s, state, pc );
+			z= use( o, popValue(o, s, state) );
+			y= use( o, popValue(o, s, state) );
+			x= use( o, popValue(o, s, state) );
+			addArrayChecks( o, block, x, y, stateBefore );
+			Node* store= newAccess( o, block, OP_ARRAY_STORE, TYPE_VOID, x, y, z );
+			store->kind= opcode == BASTORE ? ELEMENT_BYTE : opcode == CASTORE ? ELEMENT_CHAR : opcode == AASTORE ? ELEMENT_REFERENCE : ELEMENT_INT;
+			return true;
+		}
+		
+		case ARRAYLENGTH:
+		{
+			FrameState* stateBefore= newFrameState( o, s, state, pc );
+			x= use( o, popValue(o, s, state) );
+			addNullCheck( o, block, x, stateBefore );
+			pushValue( o, s, state, newAccess(o, block, OP_ARRAY_LENGTH, TYPE_INT, x, NULL, NULL) );
+			return true;
+		}
+		
+		/* operand stack, the second slots of longs and doubles are moved like all other slots */
+		case POP:
+			popValue( o, s, state );
+			return true;
+		
+		case POP2:
+			popValue( o, s, state );
+			popValue( o, s, state );
+			return true;
+		
+		case DUP:
+			x= popValue( o, s, state );
+			pushValue( o, s, state, x );
+			pushValue( o, s, state, x );
+			return true;
+		
+		case DUP_X1:
+			x= popValue( o, s, state );
+			y= popValue( o, s, state );
+			pushValue( o, s, state, x );
+			pushValue( o, s, state, y );
+			pushValue( o, s, state, x );
+			return true;
+		
+		case DUP_X2:
+		{
+			x= popValue( o, s, state );
+			y= popValue( o, s, state );
+			z= popValue( o, s, state );
+			pushValue( o, s, state, x );
+			pushValue( o, s, state, z );
+			pushValue( o, s, state, y );
+			pushValue( o, s, state, x );
+			return true;
+		}
+		
+		case DUP2:
+			x= popValue( o, s, state );
+			y= popValue( o, s, state );
+			pushValue( o, s, state, y );
+			pushValue( o, s, state, x );
+			pushValue( o, s, state, y );
+			pushValue( o, s, state, x );
+			return true;
+		
+		case DUP2_X1:
+			x= popValue( o, s, state );
+			y= popValue( o, s, state );
+			z= popValue( o, s, state );
+			pushValue( o, s, state, y );
+			pushValue( o, s, state, x );
+			pushValue( o, s, state, z );
+			pushValue( o, s, state, y );
+			pushValue( o, s, state, x );
+			return true;
+		
+		case DUP2_X2:
+		{
+			x= popValue( o, s, state );
+			y= popValue( o, s, state );
+			z= popValue( o, s, state );
+			Node* w= popValue( o, s, state );
+			pushValue( o, s, state, y );
+			pushValue( o, s, state, x );
+			pushValue( o, s, state, w );
+			pushValue( o, s, state, z );
+			pushValue( o, s, state, y );
+			pushValue( o, s, state, x );
+			return true;
+		}
+		
+		case SWAP:
+			x= popValue( o, s, state );
+			y= popValue( o, s, state );
+			pushValue( o, s, state, x );
+			pushValue( o, s, state, y );
+			return true;
+		
+		/* integer arithmetic */
+		case IADD: case ISUB: case IMUL: case IAND: case IOR: case IXOR: case ISHL: case ISHR: case IUSHR:
+		{
+			uint8 operation= opcode == IADD ? OP_ADD : opcode == ISUB ? OP_SUB : opcode == IMUL ? OP_MUL : opcode == IAND ? OP_AND : opcode == IOR ? OP_OR :
+				opcode == IXOR ? OP_XOR : opcode == ISHL ? OP_SHL : opcode == ISHR ? OP_SHR : OP_USHR;
+			y= popValue( o, s, state );
+			x= popValue( o, s, state );
+			pushValue( o, s, state, newArithmetic(o, block, operation, TYPE_INT, x, y) );
+			return true;
+		}
+		
+		case IDIV:
+		case IREM:
+		{
+			FrameState* stateBefore= newFrameState( o, s, state, pc );
+			y= popValue( o, s, state );
+			x= popValue( o, s, state );
+			pushValue( o, s, state, newDivision(o, block, opcode == IDIV ? OP_DIV : OP_REM, x, y, stateBefore) );
+			return true;
+		}
+		
+		case INEG:
+			pushValue( o, s, state, newArithmetic(o, block, OP_NEG, TYPE_INT, popValue(o, s, state), NULL) );
+			return true;
+		
+		case I2B:
+		case I2C:
+		case I2S:
+			pushValue( o, s, state, newArithmetic(o, block, opcode == I2B ? OP_EXTEND_BYTE : opcode == I2C ? OP_EXTEND_CHAR : OP_EXTEND_SHORT, TYPE_INT,
+				popValue(o, s, state), NULL) );
+			return true;
+		
+		/* long arithmetic */
+		case LADD: case LSUB: case LMUL: case LAND: case LOR: case LXOR:
+		{
+			uint8 operation= opcode == LADD ? OP_ADD : opcode == LSUB ? OP_SUB : opcode == LMUL ? OP_MUL : opcode == LAND ? OP_AND : opcode == LOR ? OP_OR :
+				OP_XOR;
+			y= popWideValue( o, s, state );
+			x= popWideValue( o, s, state );
+			pushWideValue( o, s, state, newArithmetic(o, block, operation, TYPE_LONG, x, y) );
+			return true;
+		}
+		
+		case LNEG:
+			pushWideValue( o, s, state, newArithmetic(o, block, OP_NEG, TYPE_LONG, popWideValue(o, s, state), NULL) );
+			return true;
+		
+		case LCMP:
+			y= popWideValue( o, s, state );
+			x= popWideValue( o, s, state );
+			pushValue( o, s, state, newArithmetic(o, block, OP_COMPARE_LONG, TYPE_INT, x, y) );
+			return true;
+		
+		case I2L:
+			pushWideValue( o, s, state, newArithmetic(o, block, OP_INT_TO_LONG, TYPE_LONG, popValue(o, s, state), NULL) );
+			return true;
+		
+		case L2I:
+			pushValue( o, s, state, newArithmetic(o, block, OP_LONG_TO_INT, TYPE_INT, popWideValue(o, s, state), NULL) );
+			return true;
+		
+		/* branches */
+		case IFEQ: case IFNE: case IFLT: case IFGE: case IFGT: case IFLE:
+		case IFNULL: case IFNONNULL:
+		{
+			uint8 conditions[]= { CONDITION_EQUAL, CONDITION_NOT_EQUAL, CONDITION_LESS, CONDITION_GREATER_OR_EQUAL, CONDITION_GREATER, CONDITION_LESS_OR_EQUAL };
+			uint8 condition= opcode == IFNULL ? CONDITION_EQUAL : opcode == IFNONNULL ? CONDITION_NOT_EQUAL : conditions[opcode - IFEQ];
+			x= popValue( o, s, state );
+			return addIf( o, block, state, x, newConstant(o, TYPE_INT, 0), condition, readBranchTarget(s->bytecode, pc, opcode), pc + length );
+		}
+		
+		case IF_ICMPEQ: case IF_ICMPNE: case IF_ICMPLT: case IF_ICMPGE: case IF_ICMPGT: case IF_ICMPLE:
+		case IF_ACMPEQ: case IF_ACMPNE:
+		{
+			uint8 conditions[]= { CONDITION_EQUAL, CONDITION_NOT_EQUAL, CONDITION_LESS, CONDITION_GREATER_OR_EQUAL, CONDITION_GREATER, CONDITION_LESS_OR_EQUAL,
+				CONDITION_EQUAL, CONDITION_NOT_EQUAL };
+			y= popValue( o, s, state );
+			x= popValue( o, s, state );
+			return addIf( o, block, state, x, y, conditions[opcode - IF_ICMPEQ], readBranchTarget(s->bytecode, pc, opcode), pc + length );
+		}
+		
+		case GOTO:
+		case GOTO_W:
+			addGoto( o, block, s->blockAt[readBranchTarget(s->bytecode, pc, opcode)], state );
+			return false;
+		
+		/* fields of resolved instructions */
+		case GETSTATIC_QUICK:
+		case GETSTATIC2_QUICK:
+		{
+			CONSTANT_Fieldref_info* fieldref= (CONSTANT_Fieldref_info*)cls->constant_pool[readOperand16(operands)];
+			x= newAccess( o, block, OP_STATIC_LOAD, opcode == GETSTATIC2_QUICK ? TYPE_LONG : TYPE_INT, NULL, NULL, NULL );
+			x->constant= (uintptr_t)(fieldref->class->class_inctance_variable_slots + fieldref->variableInfo->slot_index);
+			
+			if( opcode == GETSTATIC2_QUICK )
+				pushWideValue( o, s, state, x );
+			else
+				pushValue( o, s, state, x );
+			
+			return true;
+		}
+		
+		case PUTSTATIC_QUICK:
+		case PUTSTATIC2_QUICK:
+		{
+			CONSTANT_Fieldref_info* fieldref= (CONSTANT_Fieldref_info*)cls->constant_pool[readOperand16(operands)];
+			x= use( o, opcode == PUTSTATIC2_QUICK ? popWideValue(o, s, state) : popValue(o, s, state) );
+			y= newAccess( o, block, OP_STATIC_STORE, TYPE_VOID, x, NULL, NULL );
+			y->constant= (uintptr_t)(fieldref->class->class_inctance_variable_slots + fieldref->variableInfo->slot_index);
+			return true;
+		}
+		
+		case GETFIELD_QUICK:
+		case GETFIELD2_QUICK:
+		{
+			FrameState* stateBefore= newFrameState( o, s, state, pc );
+			x= use( o, popValue(o, s, state) );
+			addNullCheck( o, block, x, stateBefore );
+			y= newAccess( o, block, OP_FIELD_LOAD, opcode == GETFIELD2_QUICK ? TYPE_LONG : TYPE_INT, x, NULL, NULL );
+			y->constant= sizeof(Object) + readOperand16(operands) * sizeof(slot);
+			
+			if( opcode == GETFIELD2_QUICK )
+				pushWideValue( o, s, state, y );
+			else
+				pushValue( o, s, state, y );
+			
+			return true;
+		}
+		
+		case PUTFIELD_QUICK:
+		case PUTFIELD2_QUICK:
+		case APUTFIELD_QUICK:
+		{
+			FrameState* stateBefore= newFrameState( o, s, state, pc );
+			y= use( o, opcode == PUTFIELD2_QUICK ? popWideValue(o, s, state) : popValue(o, s, state) );
+			x= use( o, popValue(o, s, state) );
+			addNullCheck( o, block, x, stateBefore );
+			z= newAccess( o, block, OP_FIELD_STORE, TYPE_VOID, x, y, NULL );
+			z->constant= sizeof(Object) + readOperand16(operands) * sizeof(slot);
+			z->kind= opcode == APUTFIELD_QUICK ? ELEMENT_REFERENCE : ELEMENT_INT;
+			return true;
+		}
+		
+		/* calls of resolved methods */
+		case INVOKESTATIC_QUICK:
+		case INVOKENONVIRTUAL_QUICK:
+		{
+			CONSTANT_Methodref_info* methodref= (CONSTANT_Methodref_info*)cls->constant_pool[readOperand16(operands)];
+			return addInvoke( o, currentBlock, state, pc, length, methodref->class, methodref->methodInfo, NULL );
+		}
+		
+		case INVOKEVIRTUAL_QUICK:
+		case INVOKEINTERFACE_QUICK:
+		{
+			/* The inline cache is the type profile of the call site: if it has seen one receiver class only, the call is inlined for this class. */
+			InlineCache* cache= &s->method->code->inlineCaches[readOperand16(operands)];
+			uint8 entryCount= cache->entryCount;
+			
+			if( entryCount == 0 )
+				return addExit( o, block, state, pc, EXIT_DEOPTIMIZE );
+			
+			if( entryCount > 1 || cache->isMegamorphic || cache->targets[0] == NULL )
+				return addExit( o, block, state, pc, EXIT_INTERPRET );
+			
+			method_info* target= cache->targets[0];
+			return addInvoke( o, currentBlock, state, pc, length, target->declaringClass, target, cache->receiverClasses[0] );
+		}
+		
+		case IRETURN: case FRETURN: case ARETURN:
+			return addReturn( o, block, state, pc, 1 );
+		
+		case LRETURN: case DRETURN:
+			return addReturn( o, block, state, pc, 2 );
+		
+		case RETURN:
+			return addReturn( o, block, state, pc, 0 );
+		
+		/* instructions which haven't been quickened yet, because they haven't been executed */
+		case GETSTATIC: case PUTSTATIC: case GETFIELD: case PUTFIELD:
+		case INVOKEVIRTUAL: case INVOKESPECIAL: case INVOKESTATIC: case INVOKEINTERFACE:
+		case NEW: case ANEWARRAY: case CHECKCAST: case INSTANCEOF:
+			return addExit( o, block, state, pc, EXIT_DEOPTIMIZE );
+	}
+	
+	return addExit( o, block, state, pc, EXIT_INTERPRET );
+}
+
+void parseBlock( Optimization* o, Block* block )
+{
+	Scope* s= block->scope;
+	State* state= newState( o, s );
+	memcpy( state->values, block->entryValues, (s->localCount + block->entryStackCount) * sizeof(Node*) );
+	state->stackCount= block->entryStackCount;
+	uint32 pc= block->pc;
+	
+	/* Loop headers are safe points. */
+	if( block->isLoopHeader )
+	{
+		Node* safePoint= newNode( o, block, OP_SAFE_POINT, TYPE_VOID, 0 );
+		safePoint->state= newFrameState( o, s, state, pc );
+	}
+	
+	while( !o->hasFailed )
+	{
+		if( pc >= s->codeLength )
+		{
+			o->hasFailed= true;
+			return;
+		}
+		
+		if( s->blockAt[pc] != NULL && s->blockAt[pc] != block )
+		{
+			addGoto( o, block, s->blockAt[pc], state );
+			return;
+		}
+		
+		uint8 opcode= readOpcode( s->bytecode, pc );
+		uint32 length= opcode_getInstructionLength( s->bytecode, pc );
+		
+		if( !parseInstruction(o, &block, state, opcode, pc, length) )
+			return;
+		
+		pc+= length;
+	}
+}
+
+void parseScope( Optimization* o, Scope* s )
+{
+	while( s->worklistCount > 0 && !o->hasFailed )
+	{
+		s->worklistCount--;
+		parseBlock( o, s->worklist[s->worklistCount] );
+	}
+}
+
+/* For an entry at a loop header, the values of the locals and the operand stack at the loop header are loaded from the interpreter frame by the start block. The
+   code before the loop isn't parsed, so the sizes of the values are taken from the reference map of the loop header (see referenceMap.c). */
+void addLoopEntry( Optimization* o, Scope* s )
+{
+	Block* loopHeader= o->entryPc < s->codeLength ? s->blockAt[o->entryPc] : NULL;
+	ReferenceMap* map= o->method->hasReferenceMaps ? rm_getReferenceMap( o->method, o->entryPc ) : NULL;
+	
+	if( loopHeader == NULL || !loopHeader->isLoopHeader || map == NULL || map->stackHeight > s->maxStack )
+	{
+		o->hasFailed= true;
+		return;
+	}
+	
+	o->startBlock= newBlock( o, NULL, o->entryPc );
+	State* state= newState( o, s );
+	state->stackCount= map->stackHeight;
+	uint32 slotCount= s->localCount + state->stackCount;
+	
+	uint32 i;
+	for( i= 0; i < slotCount; i++ )
+	{
+		/* second slot of a long */
+		if( i > 0 && state->values[i - 1] != NULL && state->values[i - 1]->type == TYPE_LONG )
+			continue;
+		
+		/* The operand stack follows the locals in the frame, so the index of a slot is its offset from the locals. Locals which haven't been stored yet are
+		   loaded, too, they just aren't used. */
+		Node* parameter= newNode( o, o->startBlock, OP_PARAMETER, rm_isWide(map, i) && i + 1 < slotCount ? TYPE_LONG : TYPE_INT, 0 );
+		parameter->constant= i;
+		state->values[i]= parameter;
+	}
+	
+	/* The entry is another branch to the loop header. */
+	loopHeader->expectedPredecessorCount++;
+	addGoto( o, o->startBlock, loopHeader, state );
+}
+
+/* Builds the graph of the optimized method. Its parameters are taken from the locals of its frame at the start, or from the locals and the operand stack at
+   the loop header where it's entered. */
+void buildGraph( Optimization* o )
+{
+	method_info* method= o->method;
+	Scope* s= newScope( o, method->declaringClass, method, NULL );
+	
+	if( o->hasFailed )
+		return;
+	
+	if( o->entryPc != 0 )
+	{
+		addLoopEntry( o, s );
+		parseScope( o, s );
+		return;
+	}
+	
+	o->startBlock= newBlock( o, NULL, 0 );
+	State* state= newState( o, s );
+	uint32 index= 0;
+	
+	if( !isFlagSet(method->access_flags, ACC_STATIC) )
+	{
+		Node* parameter= newNode( o, o->startBlock, OP_PARAMETER, TYPE_INT, 0 );
+		state->values[index]= parameter;
+		index++;
+	}
+	
+	char* descriptor= method->descriptor + 1;
+	while( *descriptor != ')' && index < s->localCount )
+	{
+		boolean isWide= *descriptor == 'J' || *descriptor == 'D';
+		
+		while( *descriptor == '[' )
+			descriptor++;
+		
+		if( *descriptor == 'L' )
+			descriptor= strchr( descriptor, ';' );
+		
+		descriptor++;
+		
+		Node* parameter= newNode( o, o->startBlock, OP_PARAMETER, isWide ? TYPE_LONG : TYPE_INT, 0 );
+		parameter->constant= index;
+		state->values[index]= parameter;
+		index+= isWide ? 2 : 1;
+	}
+	
+	addGoto( o, o->startBlock, s->blockAt[0], state );
+	parseScope( o, s );
+}
+
+/* optimizations */
+
+/* Removes the phis which merge the same value only (besides themselves), and those of slots which aren't defined on all paths. */
+void removeRedundantPhis( Optimization* o )
+{
+	boolean hasChanged= true;
+	
+	while( hasChanged )
+	{
+		hasChanged= false;
+		
+		uint32 i;
+		for( i= 0; i < o->blockCount; i++ )
+		{
+			Node* phi;
+			for( phi= o->blocks[i]->first; phi != NULL && phi->operation == OP_PHI; phi= phi->next )
+			{
+				if( phi->isRemoved )
+					continue;
+				
+				Node* same= NULL;
+				boolean isRedundant= true;
+				
+				uint32 j;
+				for( j= 0; j < phi->inputCount && !phi->isUndefined; j++ )
+				{
+					Node* input= resolve( phi->inputs[j] );
+					
+					if( input == NULL )
+						phi->isUndefined= true;
+					else if( input != phi && input != same )
+					{
+						if( same != NULL )
+							isRedundant= false;
+						
+						same= input;
+					}
+				}
+				
+				if( phi->isUndefined || (isRedundant && same != NULL) )
+				{
+					if( !phi->isUndefined )
+						phi->replacement= same;
+					
+					phi->isRemoved= true;
+					hasChanged= true;
+				}
+			}
+		}
+	}
+}
+
+/* Replaces all inputs and values of frame states by their replacements. */
+void resolveInputs( Optimization* o )
+{
+	uint32 i;
+	for( i= 0; i < o->blockCount; i++ )
+	{
+		Node* node;
+		for( node= o->blocks[i]->first; node != NULL; node= node->next )
+		{
+			if( node->isRemoved )
+				continue;
+			
+			uint32 j;
+			for( j= 0; j < node->inputCount; j++ )
+			{
+				node->inputs[j]= resolve( node->inputs[j] );
+				
+				if( node->inputs[j] == NULL )
+					o->hasFailed= true;
+			}
+			
+			resolveFrameState( node->state );
+		}
+	}
+}
+
+/* Splits the edges from blocks with several successors to blocks with several predecessors, so that the moves of phis have a place. */
+void splitCriticalEdges( Optimization* o )
+{
+	uint32 blockCount= o->blockCount;
+	uint32 i;
+	for( i= 0; i < blockCount; i++ )
+	{
+		Block* block= o->blocks[i];
+		
+		if( block->successorCount < 2 )
+			continue;
+		
+		uint32 j;
+		for( j= 0; j < block->successorCount; j++ )
+		{
+			Block* successor= block->successors[j];
+			
+			if( successor->predecessorCount < 2 )
+				continue;
+			
+			Block* edge= newBlock( o, NULL, successor->pc );
+			newNode( o, edge, OP_GOTO, TYPE_VOID, 0 );
+			addPredecessor( o, edge, block );
+			edge->successors[0]= successor;
+			edge->successorCount= 1;
+			block->successors[j]= edge;
+			successor->predecessors[getPredecessorIndex(successor, block)]= edge;
+		}
+	}
+}
+
+void visitBlock( Optimization* o, Block* block )
+{
+	block->isVisited= true;
+	
+	uint32 i;
+	for( i= 0; i < block->successorCount; i++ )
+	{
+		if( !block->successors[i]->isVisited )
+			visitBlock( o, block->successors[i] );
+	}
+	
+	o->order[o->orderCount]= block;
+	o->orderCount++;
+}
+
+Block* intersectDominators( Block* a, Block* b )
+{
+	while( a != b )
+	{
+		while( a->order > b->order )
+			a= a->dominator;
+		
+		while( b->order > a->order )
+			b= b->dominator;
+	}
+	
+	return a;
+}
+
+/* Orders the blocks in reverse postorder, so that the fall through successor of a branch is placed right after it, and computes the dominator tree. */
+void computeDominators( Optimization* o )
+{
+	o->order= allocate( o, o->blockCount * sizeof(Block*) );
+	o->orderCount= 0;
+	visitBlock( o, o->startBlock );
+	
+	uint32 i;
+	for( i= 0; i < o->orderCount / 2; i++ )
+	{
+		Block* swap= o->order[i];
+		o->order[i]= o->order[o->orderCount - 1 - i];
+		o->order[o->orderCount - 1 - i]= swap;
+	}
+	
+	for( i= 0; i < o->orderCount; i++ )
+		o->order[i]->order= i;
+	
+	o->startBlock->dominator= o->startBlock;
+	
+	boolean hasChanged= true;
+	while( hasChanged )
+	{
+		hasChanged= false;
+		
+		for( i= 1; i < o->orderCount; i++ )
+		{
+			Block* block= o->order[i];
+			Block* dominator= NULL;
+			
+			uint32 j;
+			for( j= 0; j < block->predecessorCount; j++ )
+			{
+				Block* predecessor= block->predecessors[j];
+				
+				if( predecessor->dominator == NULL )
+					continue;
+				
+				dominator= dominator == NULL ? predecessor : intersectDominators( predecessor, dominator );
+			}
+			
+			if( block->dominator != dominator )
+			{
+				block->dominator= dominator;
+				hasChanged= true;
+			}
+		}
+	}
+	
+	for( i= 1; i < o->orderCount; i++ )
+	{
+		Block* dominator= o->order[i]->dominator;
+		dominator->children= growArray( o, dominator->children, dominator->childCount, &dominator->childCapacity, sizeof(Block*) );
+		dominator->children[dominator->childCount]= o->order[i];
+		dominator->childCount++;
+	}
+}
+
+boolean isSameValue( Node* a, Node* b )
+{
+	return a == b || (isConstant(a) && isConstant(b) && a->type == b->type && a->constant == b->constant);
+}
+
+/* Nodes which are the same if their operation and inputs are the same. For the checks this means that they can't fail if they are dominated by the same
+   check. */
+boolean isValueNumbered( Node* node )
+{
+	switch( node->operation )
+	{
+		case OP_ADD: case OP_SUB: case OP_MUL: case OP_AND: case OP_OR: case OP_XOR: case OP_SHL: case OP_SHR: case OP_USHR: case OP_NEG:
+		case OP_EXTEND_BYTE: case OP_EXTEND_CHAR: case OP_EXTEND_SHORT: case OP_INT_TO_LONG: case OP_LONG_TO_INT: case OP_COMPARE_LONG:
+		case OP_ARRAY_LENGTH: case OP_NULL_CHECK: case OP_BOUNDS_CHECK: case OP_CLASS_CHECK:
+			return true;
+	}
+	
+	return false;
+}
+
+uint32 hashNode( Node* node )
+{
+	uint32 hash= node->operation * 31 + node->type;
+	hash= hash * 31 + (uint32)node->constant;
+	
+	uint32 i;
+	for( i= 0; i < node->inputCount; i++ )
+	{
+		Node* input= node->inputs[i];
+		hash= hash * 31 + (isConstant(input) ? (uint32)input->constant : input->id);
+	}
+	
+	return hash;
+}
+
+boolean isSameNode( Node* a, Node* b )
+{
+	if( a->operation != b->operation || a->type != b->type || a->kind != b->kind || a->constant != b->constant || a->inputCount != b->inputCount )
+		return false;
+	
+	uint32 i;
+	for( i= 0; i < a->inputCount; i++ )
+	{
+		if( !isSameValue(a->inputs[i], b->inputs[i]) )
+			return false;
+	}
+	
+	return true;
+}
+
+typedef struct sValueTable
+{
+	Node** buckets;
+	uint32 mask;
+	Node** added; /* in the order of adding, to remove them when a subtree of the dominator tree is left */
+	uint32 addedCount;
+} ValueTable;
+
+/* Global value numbering: walks the dominator tree, a node which is the same as a node in a dominating block is replaced by it. */
+void numberValues( Optimization* o, ValueTable* table, Block* block )
+{
+	uint32 addedCount= table->addedCount;
+	Node* node;
+	
+	for( node= block->first; node != NULL; node= node->next )
+	{
+		if( node->isRemoved || !isValueNumbered(node) )
+			continue;
+		
+		uint32 i;
+		for( i= 0; i < node->inputCount; i++ )
+			node->inputs[i]= resolve( node->inputs[i] );
+		
+		if( node->operation == OP_NULL_CHECK && isConstant(node->inputs[0]) && node->inputs[0]->constant != NULL_REFERENCE )
+		{
+			node->isRemoved= true;
+			eliminatedNullCheckCount++;
+			continue;
+		}
+		
+		uint32 bucket= hashNode( node ) & table->mask;
+		Node* same;
+		
+		for( same= table->buckets[bucket]; same != NULL; same= same->nextInBucket )
+		{
+			if( isSameNode(node, same) )
+				break;
+		}
+		
+		if( same != NULL )
+		{
+			node->isRemoved= true;
+			
+			if( definesValue(node) )
+				node->replacement= same;
+			else if( node->operation == OP_NULL_CHECK )
+				eliminatedNullCheckCount++;
+			else if( node->operation == OP_BOUNDS_CHECK )
+				eliminatedBoundsCheckCount++;
+			
+			continue;
+		}
+		
+		node->nextInBucket= table->buckets[bucket];
+		table->buckets[bucket]= node;
+		table->added[table->addedCount]= node;
+		table->addedCount++;
+	}
+	
+	uint32 i;
+	for( i= 0; i < block->childCount; i++ )
+		numberValues( o, table, block->children[i] );
+	
+	/* The nodes of this block don't dominate the siblings. They have been added to the head of their bucket, so they are removed in reverse order. */
+	while( table->addedCount > addedCount )
+	{
+		table->addedCount--;
+		node= table->added[table->addedCount];
+		uint32 bucket= hashNode( node ) & table->mask;
+		table->buckets[bucket]= node->nextInBucket;
+	}
+}
+
+/* Checks if the given block is only reached by a branch on which smaller < larger holds. If larger is NULL, any upper bound will do. */
+boolean isLessOnAllPaths( Block* block, Node* smaller, Node* larger )
+{
+	for( ; block->dominator != block; block= block->dominator )
+	{
+		if( block->predecessorCount != 1 )
+			continue;
+		
+		Block* predecessor= block->predecessors[0];
+		Node* branch= predecessor->last;
+		
+		if( branch == NULL || branch->operation != OP_IF || predecessor->successors[0] == predecessor->successors[1] )
+			continue;
+		
+		uint8 condition= predecessor->successors[0] == block ? branch->kind : invertCondition( branch->kind );
+		Node* x= branch->inputs[0];
+		Node* y= branch->inputs[1];
+		
+		if( condition == CONDITION_LESS && x == smaller && (larger == NULL || isSameValue(y, larger)) )
+			return true;
+		
+		if( condition == CONDITION_GREATER && y == smaller && (larger == NULL || isSameValue(x, larger)) )
+			return true;
+	}
+	
+	return false;
+}
+
+/* Checks if an int value is never negative. Phis are assumed to be non negative while they are checked, which is right if all their inputs are non negative
+   under this assumption, e.g. the counter of a loop which starts at 0 and is incremented after it has been compared with an upper bound. */
+boolean isNonNegative( Node* node, uint32 depth )
+{
+	if( depth > 8 )
+		return false;
+	
+	switch( node->operation )
+	{
+		case OP_CONSTANT:
+			return node->constant >= 0;
+		
+		case OP_ARRAY_LENGTH:
+		case OP_EXTEND_CHAR:
+			return true;
+		
+		case OP_AND:
+			return isNonNegative( node->inputs[0], depth + 1 ) || isNonNegative( node->inputs[1], depth + 1 );
+		
+		case OP_USHR:
+			return isConstant( node->inputs[1] ) && (node->inputs[1]->constant & 0x1F) != 0;
+		
+		case OP_ADD:
+		{
+			/* i + 1 doesn't overflow if i < n holds, for any int n */
+			Node* x= node->inputs[0];
+			Node* y= node->inputs[1];
+			return isConstant( y ) && y->constant == 1 && isNonNegative( x, depth + 1 ) && isLessOnAllPaths( node->block, x, NULL );
+		}
+		
+		case OP_PHI:
+		{
+			if( node->isVisited )
+				return true;
+			
+			node->isVisited= true;
+			boolean isResult= true;
+			
+			uint32 i;
+			for( i= 0; i < node->inputCount && isResult; i++ )
+				isResult= isNonNegative( node->inputs[i], depth + 1 );
+			
+			node->isVisited= false;
+			return isResult;
+		}
+	}
+	
+	return false;
+}
+
+/* Removes the bounds checks of indexes which are known to be within the bounds: not negative, and less than the length of the array on all paths. */
+void eliminateBoundsChecks( Optimization* o )
+{
+	uint32 i;
+	for( i= 0; i < o->orderCount; i++ )
+	{
+		Block* block= o->order[i];
+		Node* node;
+		
+		for( node= block->first; node != NULL; node= node->next )
+		{
+			if( node->isRemoved || node->operation != OP_BOUNDS_CHECK )
+				continue;
+			
+			if( isLessOnAllPaths(block, node->inputs[0], node->inputs[1]) && isNonNegative(node->inputs[0], 0) )
+			{
+				node->isRemoved= true;
+				eliminatedBoundsCheckCount++;
+			}
+		}
+	}
+}
+
+void markLive( Node* node, Node** worklist, uint32* worklistCount )
+{
+	if( node == NULL || isConstant(node) || node->isLive )
+		return;
+	
+	node->isLive= true;
+	worklist[*worklistCount]= node;
+	(*worklistCount)++;
+}
+
+/* Removes the nodes whose values aren't used, neither by other nodes nor by frame states. */
+void removeDeadNodes( Optimization* o )
+{
+	Node** worklist= allocate( o, o->nodeCount * sizeof(Node*) );
+	uint32 worklistCount= 0;
+	uint32 i;
+	
+	for( i= 0; i < o->orderCount; i++ )
+	{
+		Node* node;
+		for( node= o->order[i]->first; node != NULL; node= node->next )
+		{
+			if( !node->isRemoved && hasSideEffects(node) )
+				markLive( node, worklist, &worklistCount );
+		}
+	}
+	
+	while( worklistCount > 0 )
+	{
+		worklistCount--;
+		Node* node= worklist[worklistCount];
+		
+		uint32 j;
+		for( j= 0; j < node->inputCount; j++ )
+			markLive( node->inputs[j], worklist, &worklistCount );
+		
+		FrameState* state;
+		for( state= node->state; state != NULL; state= state->outer )
+		{
+			for( j= 0; j < state->localCount + state->stackCount; j++ )
+				markLive( state->values[j], worklist, &worklistCount );
+		}
+	}
+	
+	for( i= 0; i < o->orderCount; i++ )
+	{
+		Node* node;
+		for( node= o->order[i]->first; node != NULL; node= node->next )
+		{
+			if( !node->isLive )
+				node->isRemoved= true;
+		}
+	}
+}
+
+void optimize( Optimization* o )
+{
+	removeRedundantPhis( o );
+	resolveInputs( o );
+	
+	if( o->hasFailed )
+		return;
+	
+	splitCriticalEdges( o );
+	computeDominators( o );
+	
+	ValueTable table;
+	table.mask= 1;
+	
+	while( table.mask < o->nodeCount )
+		table.mask*= 2;
+	
+	table.buckets= allocate( o, table.mask * sizeof(Node*) );
+	table.mask--;
+	table.added= allocate( o, o->nodeCount * sizeof(Node*) );
+	table.addedCount= 0;
+	numberValues( o, &table, o->startBlock );
+	resolveInputs( o );
+	
+	eliminateBoundsChecks( o );
+	removeDeadNodes( o );
+}
+
+/* register allocation */
+
+boolean isBitSet( uint32* set, uint32 index )
+{
+	return (set[index / 32] & (1 << (index % 32))) != 0;
+}
+
+void setBit( uint32* set, uint32 index )
+{
+	set[index / 32]|= 1 << (index % 32);
+}
+
+void clearBit( uint32* set, uint32 index )
+{
+	set[index / 32]&= ~(1 << (index % 32));
+}
+
+/* Numbers all nodes in the order of the machine code. Phis are defined at the start of their block. */
+void numberPositions( Optimization* o )
+{
+	uint32 position= 0;
+	uint32 i;
+	
+	for( i= 0; i < o->orderCount; i++ )
+	{
+		Block* block= o->order[i];
+		block->startPosition= position;
+		position+= 2;
+		
+		Node* node;
+		for( node= block->first; node != NULL; node= node->next )
+		{
+			if( node->isRemoved )
+				continue;
+			
+			if( node->operation == OP_PHI )
+				node->position= block->startPosition;
+			else
+			{
+				node->position= position;
+				position+= 2;
+			}
+		}
+		
+		block->endPosition= position;
+		position+= 2;
+	}
+}
+
+/* The values which are live at the end of the block: those live at the start of its successors, and the inputs of their phis from this block. */
+void computeLiveOut( Block* block, uint32* live, uint32 wordCount )
+{
+	memset( live, 0, wordCount * sizeof(uint32) );
+	
+	uint32 i;
+	for( i= 0; i < block->successorCount; i++ )
+	{
+		Block* successor= block->successors[i];
+		uint32 index= getPredecessorIndex( successor, block );
+		
+		uint32 j;
+		for( j= 0; j < wordCount; j++ )
+			live[j]|= successor->liveIn[j];
+		
+		Node* phi;
+		for( phi= successor->first; phi != NULL && phi->operation == OP_PHI; phi= phi->next )
+		{
+			if( !phi->isRemoved && !isConstant(phi->inputs[index]) )
+				setBit( live, phi->inputs[index]->id );
+		}
+	}
+}
+
+void setFrameStateLive( FrameState* state, uint32* live )
+{
+	for( ; state != NULL; state= state->outer )
+	{
+		uint32 i;
+		for( i= 0; i < state->localCount + state->stackCount; i++ )
+		{
+			if( state->values[i] != NULL && !isConstant(state->values[i]) )
+				setBit( live, state->values[i]->id );
+		}
+	}
+}
+
+void computeLiveness( Optimization* o, uint32 wordCount )
+{
+	uint32* live= allocate( o, wordCount * sizeof(uint32) );
+	uint32 i;
+	
+	for( i= 0; i < o->orderCount; i++ )
+		o->order[i]->liveIn= allocate( o, wordCount * sizeof(uint32) );
+	
+	boolean hasChanged= true;
+	while( hasChanged )
+	{
+		hasChanged= false;
+		
+		for( i= o->orderCount; i > 0; i-- )
+		{
+			Block* block= o->order[i - 1];
+			computeLiveOut( block, live, wordCount );
+			
+			Node* node;
+			for( node= block->last; node != NULL; node= node->previous )
+			{
+				if( node->isRemoved )
+					continue;
+				
+				if( definesValue(node) )
+					clearBit( live, node->id );
+				
+				if( node->operation == OP_PHI )
+					continue;
+				
+				uint32 j;
+				for( j= 0; j < node->inputCount; j++ )
+				{
+					if( !isConstant(node->inputs[j]) )
+						setBit( live, node->inputs[j]->id );
+				}
+				
+				setFrameStateLive( node->state, live );
+			}
+			
+			if( memcmp(live, block->liveIn, wordCount * sizeof(uint32)) != 0 )
+			{
+				memcpy( block->liveIn, live, wordCount * sizeof(uint32) );
+				hasChanged= true;
+			}
+		}
+	}
+}
+
+void extendInterval( Node* node, uint32 position )
+{
+	if( node->intervalStart == NO_POSITION || position < node->intervalStart )
+		node->intervalStart= position;
+	
+	if( position > node->intervalEnd )
+		node->intervalEnd= position;
+}
+
+void extendFrameStateIntervals( FrameState* state, uint32 position )
+{
+	for( ; state != NULL; state= state->outer )
+	{
+		uint32 i;
+		for( i= 0; i < state->localCount + state->stackCount; i++ )
+		{
+			if( state->values[i] != NULL && !isConstant(state->values[i]) )
+				extendInterval( state->values[i], position );
+		}
+	}
+}
+
+/* Computes one live interval per value, from the first to the last position where it's live. Holes aren't taken into account. */
+void buildIntervals( Optimization* o, uint32 wordCount )
+{
+	uint32* live= allocate( o, wordCount * sizeof(uint32) );
+	uint32 i;
+	
+	for( i= 0; i < o->orderCount; i++ )
+	{
+		Block* block= o->order[i];
+		computeLiveOut( block, live, wordCount );
+		
+		uint32 j;
+		for( j= 0; j < o->nodeCount; j++ )
+		{
+			if( isBitSet(live, j) )
+				extendInterval( o->nodes[j], block->endPosition );
+			
+			if( isBitSet(block->liveIn, j) )
+				extendInterval( o->nodes[j], block->startPosition );
+		}
+		
+		Node* node;
+		for( node= block->first; node != NULL; node= node->next )
+		{
+			if( node->isRemoved )
+				continue;
+			
+			if( definesValue(node) )
+				extendInterval( node, node->position );
+			
+			/* The value of a phi is moved into its location at the end of the predecessors. */
+			if( node->operation == OP_PHI )
+			{
+				for( j= 0; j < block->predecessorCount; j++ )
+					extendInterval( node, block->predecessors[j]->endPosition );
+				
+				continue;
+			}
+			
+			for( j= 0; j < node->inputCount; j++ )
+			{
+				if( !isConstant(node->inputs[j]) )
+					extendInterval( node->inputs[j], node->position );
+			}
+			
+			extendFrameStateIntervals( node->state, node->position );
+		}
+	}
+}
+
+int compareIntervalStarts( const void* a, const void* b )
+{
+	Node* x= *(Node**)a;
+	Node* y= *(Node**)b;
+	return x->intervalStart < y->intervalStart ? -1 : x->intervalStart > y->intervalStart ? 1 : (int)x->id - (int)y->id;
+}
+
+/* Linear scan register allocation: the intervals are visited by their start. If no register is free, the interval which ends last is spilled. */
+void allocateRegisters( Optimization* o )
+{
+	uint32 wordCount= (o->nodeCount + 31) / 32;
+	numberPositions( o );
+	computeLiveness( o, wordCount );
+	buildIntervals( o, wordCount );
+	
+	Node** intervals= allocate( o, o->nodeCount * sizeof(Node*) );
+	uint32 intervalCount= 0;
+	uint32 i;
+	
+	for( i= 0; i < o->nodeCount; i++ )
+	{
+		Node* node= o->nodes[i];
+		
+		if( !node->isRemoved && node->block != NULL && definesValue(node) && node->intervalStart != NO_POSITION )
+		{
+			intervals[intervalCount]= node;
+			intervalCount++;
+		}
+	}
+	
+	qsort( intervals, intervalCount, sizeof(Node*), compareIntervalStarts );
+	
+	Node* active[REGISTER_COUNT];
+	uint32 activeCount= 0;
+	boolean isRegisterFree[REGISTER_COUNT];
+	
+	for( i= 0; i < REGISTER_COUNT; i++ )
+		isRegisterFree[i]= true;
+	
+	for( i= 0; i < intervalCount; i++ )
+	{
+		Node* current= intervals[i];
+		uint32 j;
+		
+		for( j= 0; j < activeCount; )
+		{
+			if( active[j]->intervalEnd < current->intervalStart )
+			{
+				isRegisterFree[active[j]->location]= true;
+				activeCount--;
+				active[j]= active[activeCount];
+			}
+			else
+				j++;
+		}
+		
+		for( j= 0; j < REGISTER_COUNT && !isRegisterFree[j]; j++ )
+			;
+		
+		if( j < REGISTER_COUNT )
+		{
+			current->location= j;
+			isRegisterFree[j]= false;
+			active[activeCount]= current;
+			activeCount++;
+			continue;
+		}
+		
+		uint32 spilled= 0;
+		for( j= 1; j < activeCount; j++ )
+		{
+			if( active[j]->intervalEnd > active[spilled]->intervalEnd )
+				spilled= j;
+		}
+		
+		if( active[spilled]->intervalEnd > current->intervalEnd )
+		{
+			current->location= active[spilled]->location;
+			active[spilled]->location= REGISTER_COUNT + o->spillSlotCount;
+			active[spilled]= current;
+		}
+		else
+			current->location= REGISTER_COUNT + o->spillSlotCount;
+		
+		o->spillSlotCount++;
+	}
+	
+	/* The native stack frame keeps the stack aligned to 16 bytes, after the return address and the six saved registers. */
+	o->frameSize= SAVE_AREA_OFFSET + (REGISTER_COUNT + o->spillSlotCount) * 8;
+	
+	if( o->frameSize % 16 != 8 )
+		o->frameSize+= 8;
+}
+
+/* generating machine code */
+
+/* Emits an instruction with a ModRM byte. The opcode has one byte, or two starting with 0x0F. The reg field is a register or an opcode extension, the operand
+   is a register or, if isMemory is set, [rsp+offset]. */
+void generateInstruction( Optimization* o, uint16 opcode, uint8 reg, uint8 operand, boolean isMemory, uint32 offset, boolean isWide )
+{
+	uint8 rex= 0x40 | (isWide ? 0x08 : 0) | ((reg & 8) ? 0x04 : 0) | (!isMemory && (operand & 8) ? 0x01 : 0);
+	
+	if( rex != 0x40 )
+		jit_emit8( &o->buffer, rex );
+	
+	if( opcode > 0xFF )
+		jit_emit8( &o->buffer, opcode >> 8 );
+	
+	jit_emit8( &o->buffer, opcode & 0xFF );
+	
+	if( isMemory )
+	{
+		jit_emit8( &o->buffer, 0x84 | ((reg & 7) << 3) );
+		jit_emit8( &o->buffer, 0x24 );
+		jit_emit32( &o->buffer, offset );
+	}
+	else
+		jit_emit8( &o->buffer, 0xC0 | ((reg & 7) << 3) | (operand & 7) );
+}
+
+/* Emits an instruction whose operand is the given location, i.e. a register or a slot of the save area. */
+void generateWithLocation( Optimization* o, uint16 opcode, uint8 reg, int32 location, boolean isWide )
+{
+	if( location < REGISTER_COUNT )
+		generateInstruction( o, opcode, reg, allocatableRegisters[location], false, 0, isWide );
+	else
+		generateInstruction( o, opcode, reg, RSP, true, SAVE_AREA_OFFSET + location * 8, isWide );
+}
+
+boolean isInt32( int64 value )
+{
+	return value == (int32)value;
+}
+
+/* Loads a constant into one of the scratch registers. */
+void generateLoadConstant( Optimization* o, uint8 reg, int64 value, boolean isWide )
+{
+	if( !isWide )
+	{
+		jit_emit8( &o->buffer, 0xB8 + reg ); /* mov reg, imm32 */
+		jit_emit32( &o->buffer, value );
+	}
+	else if( isInt32(value) )
+	{
+		jit_emit( &o->buffer, "48 C7" ); /* mov reg, simm32 */
+		jit_emit8( &o->buffer, 0xC0 + reg );
+		jit_emit32( &o->buffer, value );
+	}
+	else
+	{
+		jit_emit8( &o->buffer, 0x48 ); /* mov reg, imm64 */
+		jit_emit8( &o->buffer, 0xB8 + reg );
+		jit_emit64( &o->buffer, value );
+	}
+}
+
+/* Loads a value into one of the scratch registers. */
+void generateLoad( Optimization* o, uint8 reg, Node* value )
+{
+	if( isConstant(value) )
+		generateLoadConstant( o, reg, value->constant, value->type == TYPE_LONG );
+	else
+		generateWithLocation( o, 0x8B, reg, value->location, value->type == TYPE_LONG ); /* mov reg, location */
+}
+
+/* Stores a scratch register into the location of the given node. */
+void generateStore( Optimization* o, uint8 reg, Node* node )
+{
+	generateWithLocation( o, 0x89, reg, node->location, node->type == TYPE_LONG ); /* mov location, reg */
+}
+
+/* mov rax, function; call rax */
+void generateCall( Optimization* o, void* function )
+{
+	generateLoadConstant( o, RAX, (uintptr_t)function, true );
+	jit_emit( &o->buffer, "FF D0" );
+}
+
+/* The values in caller saved registers are saved around calls. Six pushes keep the stack aligned. */
+void generateSaveCallerSavedRegisters( Optimization* o )
+{
+	jit_emit( &o->buffer, "56 57 41 50 41 51 41 52 41 53" ); /* push rsi, rdi, r8, r9, r10, r11 */
+}
+
+void generateRestoreCallerSavedRegisters( Optimization* o )
+{
+	jit_emit( &o->buffer, "41 5B 41 5A 41 59 41 58 5F 5E" ); /* pop r11, r10, r9, r8, rdi, rsi */
+}
+
+/* Loads the object with the reference in ecx into rax. The object pointer list never moves. */
+void generateLoadObject( Optimization* o )
+{
+	generateLoadConstant( o, RAX, (uintptr_t)objectPointerList, true );
+	jit_emit( &o->buffer, "48 8B 04 C8" ); /* mov rax, [rax+rcx*8] */
+}
+
+/* Calls the write barrier for the reference in ecx and the value in edx, unless the value is null. */
+void generateWriteBarrier( Optimization* o )
+{
+	jit_emit( &o->buffer, "85 D2 0F 84 00 00 00 00" ); /* test edx, edx; jz over the call */
+	uint32 skipPosition= o->buffer.length - 4;
+	generateSaveCallerSavedRegisters( o );
+	jit_emit( &o->buffer, "89 CF 89 D6" ); /* mov edi, ecx; mov esi, edx */
+	generateCall( o, writeBarrierHelper );
+	generateRestoreCallerSavedRegisters( o );
+	jit_patch32( &o->buffer, skipPosition, o->buffer.length );
+}
+
+/* Creates the description of an exit, i.e. of the interpreter frames to be built from the given frame state. */
+uint32 newExit( Optimization* o, FrameState* state, uint8 reason )
+{
+	if( o->exitCount == o->exitCapacity )
+	{
+		o->exitCapacity= 2 * o->exitCapacity + 16;
+		o->exits= mm_staticReAlloc( o->exits, o->exitCapacity * sizeof(Exit) );
+	}
+	
+	Exit* exit= &o->exits[o->exitCount];
+	exit->reason= reason;
+	exit->frameCount= 0;
+	
+	FrameState* frameState;
+	for( frameState= state; frameState != NULL; frameState= frameState->outer )
+		exit->frameCount++;
+	
+	exit->frames= mm_staticMalloc( exit->frameCount * sizeof(ExitFrame) );
+	
+	uint32 i= exit->frameCount;
+	for( frameState= state; frameState != NULL; frameState= frameState->outer )
+	{
+		i--;
+		ExitFrame* frame= &exit->frames[i];
+		frame->cls= frameState->cls;
+		frame->method= frameState->method;
+		frame->pc= frameState->pc;
+		frame->localCount= frameState->localCount;
+		frame->stackCount= frameState->stackCount;
+		frame->values= mm_staticMalloc( (frame->localCount + frame->stackCount + 1) * sizeof(ExitValue) );
+		
+		uint32 j;
+		for( j= 0; j < frame->localCount + frame->stackCount; j++ )
+		{
+			Node* value= frameState->values[j];
+			ExitValue* exitValue= &frame->values[j];
+			exitValue->type= value != NULL ? value->type : TYPE_VOID;
+			exitValue->location= value != NULL && !isConstant(value) ? value->location : NO_LOCATION;
+			exitValue->constant= value != NULL && isConstant(value) ? value->constant : 0;
+		}
+	}
+	
+	o->exitCount++;
+	return o->exitCount - 1;
+}
+
+void freeExits( Exit* exits, uint32 exitCount )
+{
+	uint32 i;
+	for( i= 0; i < exitCount; i++ )
+	{
+		uint32 j;
+		for( j= 0; j < exits[i].frameCount; j++ )
+			mm_staticFree( exits[i].frames[j].values );
+		
+		mm_staticFree( exits[i].frames );
+	}
+	
+	mm_staticFree( exits );
+}
+
+/* Emits a conditional jump to a stub at the end of the machine code, which leaves through the given exit. */
+void generateExitJump( Optimization* o, uint8 condition, FrameState* state, uint8 reason, uint32 resumePosition )
+{
+	jit_emit8( &o->buffer, 0x0F );
+	jit_emit8( &o->buffer, 0x80 | condition );
+	jit_emit32( &o->buffer, 0 );
+	
+	o->stubs= growArray( o, o->stubs, o->stubCount, &o->stubCapacity, sizeof(ExitStub) );
+	ExitStub* stub= &o->stubs[o->stubCount];
+	stub->position= o->buffer.length - 4;
+	stub->exitIndex= newExit( o, state, reason );
+	stub->resumePosition= resumePosition;
+	o->stubCount++;
+}
+
+void generateJump( Optimization* o, uint8 condition, Block* target )
+{
+	if( condition == CONDITION_ALWAYS )
+		jit_emit8( &o->buffer, 0xE9 );
+	else
+	{
+		jit_emit8( &o->buffer, 0x0F );
+		jit_emit8( &o->buffer, 0x80 | condition );
+	}
+	
+	jit_emit32( &o->buffer, 0 );
+	
+	o->jumps= growArray( o, o->jumps, o->jumpCount, &o->jumpCapacity, sizeof(Jump) );
+	o->jumps[o->jumpCount].position= o->buffer.length - 4;
+	o->jumps[o->jumpCount].target= target;
+	o->jumpCount++;
+}
+
+void generateMove( Optimization* o, Move* move )
+{
+	jit_ensureCapacity( &o->buffer, 64 );
+	
+	if( move->source == MOVE_CONSTANT )
+	{
+		generateLoadConstant( o, RAX, move->value->constant, move->value->type == TYPE_LONG );
+		generateWithLocation( o, 0x89, RAX, move->destination, true );
+	}
+	else if( move->source == MOVE_TEMPORARY )
+		generateWithLocation( o, 0x89, RDX, move->destination, true );
+	else if( move->destination < REGISTER_COUNT )
+		generateWithLocation( o, 0x8B, allocatableRegisters[move->destination], move->source, true );
+	else if( move->source < REGISTER_COUNT )
+		generateWithLocation( o, 0x89, allocatableRegisters[move->source], move->destination, true );
+	else
+	{
+		generateWithLocation( o, 0x8B, RAX, move->source, true );
+		generateWithLocation( o, 0x89, RAX, move->destination, true );
+	}
+}
+
+/* Moves the inputs of the phis of the given successor into their locations. The moves happen in parallel, i.e. no move may overwrite the source of another
+   one, so they are ordered, and cycles are broken by a temporary register. */
+void generatePhiMoves( Optimization* o, Block* block, Block* successor )
+{
+	uint32 index= getPredecessorIndex( successor, block );
+	uint32 moveCount= 0;
+	Node* phi;
+	
+	for( phi= successor->first; phi != NULL && phi->operation == OP_PHI; phi= phi->next )
+		moveCount++;
+	
+	Move* moves= allocate( o, (moveCount + 1) * sizeof(Move) );
+	moveCount= 0;
+	
+	for( phi= successor->first; phi != NULL && phi->operation == OP_PHI; phi= phi->next )
+	{
+		if( phi->isRemoved )
+			continue;
+		
+		Node* value= phi->inputs[index];
+		Move* move= &moves[moveCount];
+		move->destination= phi->location;
+		move->source= isConstant( value ) ? MOVE_CONSTANT : value->location;
+		move->value= value;
+		
+		if( move->source != move->destination )
+			moveCount++;
+	}
+	
+	while( moveCount > 0 )
+	{
+		uint32 i;
+		uint32 j;
+		
+		for( i= 0; i < moveCount; i++ )
+		{
+			for( j= 0; j < moveCount && (j == i || moves[j].source != moves[i].destination); j++ )
+				;
+			
+			if( j == moveCount )
+				break;
+		}
+		
+		if( i == moveCount )
+		{
+			int32 saved= moves[0].destination;
+			generateWithLocation( o, 0x8B, RDX, saved, true );
+			
+			for( j= 0; j < moveCount; j++ )
+			{
+				if( moves[j].source == saved )
+					moves[j].source= MOVE_TEMPORARY;
+			}
+			
+			continue;
+		}
+		
+		generateMove( o, &moves[i] );
+		moveCount--;
+		moves[i]= moves[moveCount];
+	}
+}
+
+/* Compares x with y. Both may be constants. */
+void generateCompare( Optimization* o, Node* x, Node* y )
+{
+	generateLoad( o, RAX, x );
+	
+	if( isConstant(y) )
+	{
+		jit_emit8( &o->buffer, 0x3D ); /* cmp eax, imm32 */
+		jit_emit32( &o->buffer, y->constant );
+	}
+	else
+		generateWithLocation( o, 0x3B, RAX, y->location, false ); /* cmp eax, location */
+}
+
+/* Emits an arithmetic operation of eax/rax and the given operand. */
+void generateArithmetic( Optimization* o, uint8 operation, Node* y, boolean isWide )
+{
+	uint8 extensions[]= { 0, 5, 0, 4, 1, 6 }; /* add, sub, -, and, or, xor */
+	uint16 opcodes[]= { 0x03, 0x2B, 0x0FAF, 0x23, 0x0B, 0x33 };
+	uint32 index= operation - OP_ADD;
+	
+	if( isConstant(y) && isInt32(y->constant) )
+	{
+		if( operation == OP_MUL )
+			generateInstruction( o, 0x69, RAX, RAX, false, 0, isWide ); /* imul eax, eax, imm32 */
+		else
+			generateInstruction( o, 0x81, extensions[index], RAX, false, 0, isWide ); /* op eax, imm32 */
+		
+		jit_emit32( &o->buffer, y->constant );
+	}
+	else if( isConstant(y) )
+	{
+		generateLoadConstant( o, RCX, y->constant, true );
+		generateInstruction( o, opcodes[index], RAX, RCX, false, 0, isWide ); /* op rax, rcx */
+	}
+	else
+		generateWithLocation( o, opcodes[index], RAX, y->location, isWide ); /* op eax, location */
+}
+
+void generateNode( Optimization* o, Node* node, Block* nextBlock )
+{
+	Block* block= node->block;
+	Node* x= node->inputCount > 0 ? node->inputs[0] : NULL;
+	Node* y= node->inputCount > 1 ? node->inputs[1] : NULL;
+	Node* z= node->inputCount > 2 ? node->inputs[2] : NULL;
+	
+	switch( node->operation )
+	{
+		case OP_PARAMETER:
+		case OP_PHI:
+			return;
+		
+		case OP_ADD:
+		case OP_SUB:
+		case OP_MUL:
+		case OP_AND:
+		case OP_OR:
+		case OP_XOR:
+			generateLoad( o, RAX, x );
+			generateArithmetic( o, node->operation, y, node->type == TYPE_LONG );
+			generateStore( o, RAX, node );
+			return;
+		
+		case OP_SHL:
+		case OP_SHR:
+		case OP_USHR:
+		{
+			uint8 extension= node->operation == OP_SHL ? 4 : node->operation == OP_SHR ? 7 : 5;
+			generateLoad( o, RAX, x );
+			
+			if( isConstant(y) )
+			{
+				generateInstruction( o, 0xC1, extension, RAX, false, 0, false ); /* shl/sar/shr eax, imm8 */
+				jit_emit8( &o->buffer, y->constant & 0x1F );
+			}
+			else
+			{
+				generateLoad( o, RCX, y );
+				generateInstruction( o, 0xD3, extension, RAX, false, 0, false ); /* shl/sar/shr eax, cl */
+			}
+			
+			generateStore( o, RAX, node );
+			return;
+		}
+		
+		case OP_DIV:
+		case OP_REM:
+			/* Division by 0 is handled by the interpreter. Dividing the smallest int by -1 overflows, which raises a hardware exception on x86, so the
+			   interpreter does this, too. */
+			generateLoad( o, RCX, y );
+			
+			if( !isConstant(y) || y->constant == 0 || y->constant == -1 )
+			{
+				jit_emit( &o->buffer, "85 C9" ); /* test ecx, ecx */
+				generateExitJump( o, CONDITION_EQUAL, node->state, EXIT_DEOPTIMIZE, 0 );
+				jit_emit( &o->buffer, "83 F9 FF" ); /* cmp ecx, -1 */
+				generateExitJump( o, CONDITION_EQUAL, node->state, EXIT_DEOPTIMIZE, 0 );
+			}
+			
+			generateLoad( o, RAX, x );
+			jit_emit( &o->buffer, "99 F7 F9" ); /* cdq; idiv ecx */
+			generateStore( o, node->operation == OP_DIV ? RAX : RDX, node );
+			return;
+		
+		case OP_NEG:
+			generateLoad( o, RAX, x );
+			generateInstruction( o, 0xF7, 3, RAX, false, 0, node->type == TYPE_LONG ); /* neg eax */
+			generateStore( o, RAX, node );
+			return;
+		
+		case OP_EXTEND_BYTE:
+		case OP_EXTEND_CHAR:
+		case OP_EXTEND_SHORT:
+			generateLoad( o, RAX, x );
+			jit_emit( &o->buffer, node->operation == OP_EXTEND_BYTE ? "0F BE C0" : node->operation == OP_EXTEND_CHAR ? "0F B7 C0" : "0F BF C0" );
+			generateStore( o, RAX, node );
+			return;
+		
+		case OP_INT_TO_LONG:
+			generateLoad( o, RAX, x );
+			jit_emit( &o->buffer, "48 63 C0" ); /* movsxd rax, eax */
+			generateStore( o, RAX, node );
+			return;
+		
+		case OP_LONG_TO_INT:
+			generateLoad( o, RAX, x );
+			generateStore( o, RAX, node );
+			return;
+		
+		case OP_COMPARE_LONG:
+			generateLoad( o, RAX, x );
+			generateLoad( o, RCX, y );
+			jit_emit( &o->buffer, "48 39 C8" ); /* cmp rax, rcx */
+			jit_emit( &o->buffer, "0F 9F C0 0F 9C C1" ); /* setg al; setl cl */
+			jit_emit( &o->buffer, "0F B6 C0 0F B6 C9" ); /* movzx eax, al; movzx ecx, cl */
+			jit_emit( &o->buffer, "29 C8" ); /* sub eax, ecx */
+			generateStore( o, RAX, node );
+			return;
+		
+		case OP_ARRAY_LENGTH:
+			generateLoad( o, RCX, x );
+			generateLoadObject( o );
+			jit_emit( &o->buffer, "8B 40" ); /* mov eax, [rax+length] */
+			jit_emit8( &o->buffer, sizeof(Object) );
+			generateStore( o, RAX, node );
+			return;
+		
+		case OP_ARRAY_LOAD:
+			generateLoad( o, RCX, x );
+			generateLoadObject( o );
+			generateLoad( o, RDX, y );
+			
+			if( node->kind == ELEMENT_BYTE )
+				jit_emit( &o->buffer, "0F BE 44 10" ); /* movsx eax, byte [rax+rdx+data] */
+			else if( node->kind == ELEMENT_CHAR )
+				jit_emit( &o->buffer, "0F B7 44 50" ); /* movzx eax, word [rax+rdx*2+data] */
+			else
+				jit_emit( &o->buffer, "8B 44 90" ); /* mov eax, [rax+rdx*4+data] */
+			
+			jit_emit8( &o->buffer, sizeof(Object) + sizeof(slot) );
+			generateStore( o, RAX, node );
+			return;
+		
+		case OP_ARRAY_STORE:
+			generateLoad( o, RCX, x );
+			generateLoadObject( o );
+			generateLoad( o, RDX, y );
+			jit_emit( &o->buffer, node->kind == ELEMENT_BYTE ? "48 8D 44 10" : node->kind == ELEMENT_CHAR ? "48 8D 44 50" : "48 8D 44 90" ); /* lea rax, [element] */
+			jit_emit8( &o->buffer, sizeof(Object) + sizeof(slot) );
+			generateLoad( o, RDX, z );
+			jit_emit( &o->buffer, node->kind == ELEMENT_BYTE ? "88 10" : node->kind == ELEMENT_CHAR ? "66 89 10" : "89 10" ); /* mov [rax], edx */
+			
+			if( node->kind == ELEMENT_REFERENCE )
+				generateWriteBarrier( o );
+			
+			return;
+		
+		case OP_FIELD_LOAD:
+			generateLoad( o, RCX, x );
+			generateLoadObject( o );
+			jit_emit( &o->buffer, node->type == TYPE_LONG ? "48 8B 80" : "8B 80" ); /* mov rax, [rax+offset] */
+			jit_emit32( &o->buffer, node->constant );
+			
+			/* The high word of a long is in the first slot. */
+			if( node->type == TYPE_LONG )
+				jit_emit( &o->buffer, "48 C1 C0 20" ); /* rol rax, 32 */
+			
+			generateStore( o, RAX, node );
+			return;
+		
+		case OP_FIELD_STORE:
+			generateLoad( o, RCX, x );
+			generateLoadObject( o );
+			generateLoad( o, RDX, y );
+			
+			if( y->type == TYPE_LONG )
+				jit_emit( &o->buffer, "48 C1 C2 20" ); /* rol rdx, 32 */
+			
+			jit_emit( &o->buffer, y->type == TYPE_LONG ? "48 89 90" : "89 90" ); /* mov [rax+offset], rdx */
+			jit_emit32( &o->buffer, node->constant );
+			
+			if( node->kind == ELEMENT_REFERENCE )
+				generateWriteBarrier( o );
+			
+			return;
+		
+		case OP_STATIC_LOAD:
+			generateLoadConstant( o, RAX, node->constant, true );
+			jit_emit( &o->buffer, node->type == TYPE_LONG ? "48 8B 00" : "8B 00" ); /* mov rax, [rax] */
+			
+			if( node->type == TYPE_LONG )
+				jit_emit( &o->buffer, "48 C1 C0 20" ); /* rol rax, 32 */
+			
+			generateStore( o, RAX, node );
+			return;
+		
+		case OP_STATIC_STORE:
+			generateLoad( o, RDX, x );
+			
+			if( x->type == TYPE_LONG )
+				jit_emit( &o->buffer, "48 C1 C2 20" ); /* rol rdx, 32 */
+			
+			generateLoadConstant( o, RAX, node->constant, true );
+			jit_emit( &o->buffer, x->type == TYPE_LONG ? "48 89 10" : "89 10" ); /* mov [rax], rdx */
+			return;
+		
+		case OP_NULL_CHECK:
+			if( isConstant(x) )
+				jit_emit( &o->buffer, "85 E4" ); /* test esp, esp (never zero) */
+			else if( x->location < REGISTER_COUNT )
+				generateWithLocation( o, 0x85, allocatableRegisters[x->location], x->location, false ); /* test reg, reg */
+			else
+			{
+				generateWithLocation( o, 0x83, 7, x->location, false ); /* cmp location, 0 */
+				jit_emit8( &o->buffer, 0 );
+			}
+			
+			/* A constant is null here, the check always fails. */
+			generateExitJump( o, isConstant(x) ? CONDITION_NOT_EQUAL : CONDITION_EQUAL, node->state, EXIT_DEOPTIMIZE, 0 );
+			return;
+		
+		case OP_BOUNDS_CHECK:
+			generateCompare( o, x, y );
+			generateExitJump( o, CONDITION_ABOVE_OR_EQUAL_UNSIGNED, node->state, EXIT_DEOPTIMIZE, 0 );
+			return;
+		
+		case OP_CLASS_CHECK:
+			generateLoad( o, RCX, x );
+			generateLoadObject( o );
+			generateLoadConstant( o, RDX, node->constant, true );
+			jit_emit( &o->buffer, "48 39 10" ); /* cmp [rax+cls], rdx */
+			generateExitJump( o, CONDITION_NOT_EQUAL, node->state, EXIT_DEOPTIMIZE, 0 );
+			return;
+		
+		case OP_SAFE_POINT:
+			generateLoadConstant( o, RAX, (uintptr_t)&isStopTheWorldRequested, true );
+			jit_emit( &o->buffer, "83 38 00" ); /* cmp dword [rax], 0 */
+			generateExitJump( o, CONDITION_NOT_EQUAL, node->state, EXIT_SAFE_POINT, 0 );
+			
+			if( sched_isEnabled() )
+			{
+				jit_emit( &o->buffer, "83 7C 24" ); /* cmp dword [rsp+isSwitchingAllowed], 0 */
+				jit_emit8( &o->buffer, SWITCHING_OFFSET );
+				jit_emit8( &o->buffer, 0 );
+				generateExitJump( o, CONDITION_NOT_EQUAL, node->state, EXIT_SWITCH, o->buffer.length + 6 );
+			}
+			
+			return;
+		
+		case OP_IF:
+		{
+			uint8 condition= node->kind;
+			generateCompare( o, x, y );
+			
+			if( block->successors[0] == nextBlock )
+				generateJump( o, invertCondition(condition), block->successors[1] );
+			else
+			{
+				generateJump( o, condition, block->successors[0] );
+				
+				if( block->successors[1] != nextBlock )
+					generateJump( o, CONDITION_ALWAYS, block->successors[1] );
+			}
+			
+			return;
+		}
+		
+		case OP_GOTO:
+			generatePhiMoves( o, block, block->successors[0] );
+			
+			if( block->successors[0] != nextBlock )
+				generateJump( o, CONDITION_ALWAYS, block->successors[0] );
+			
+			return;
+		
+		case OP_EXIT:
+			jit_emit8( &o->buffer, 0xB8 ); /* mov eax, exit */
+			jit_emit32( &o->buffer, newExit(o, node->state, node->kind) );
+			jit_emit8( &o->buffer, 0xE9 ); /* jmp exit */
+			jit_emit32( &o->buffer, 0 );
+			jit_patch32( &o->buffer, o->buffer.length - 4, o->exitPosition );
+			return;
+	}
+}
+
+boolean leaveOptimizedCodeHelper( Stack* stack, StackFrame* sf, OptimizedMethod* optimizedMethod, uint32 exitIndex, uint64* saveArea );
+
+/* The prologue saves the callee saved registers, allocates the native stack frame, stores the arguments in it and loads the parameters (or, for an entry at
+   a loop header, the values of the locals and the operand stack) from the frame into their locations. The exit code saves all registers in the save area and calls the helper which rebuilds the interpreter frames. */
+void generatePrologue( Optimization* o )
+{
+	jit_emit( &o->buffer, "55 53 41 54 41 55 41 56 41 57" ); /* push rbp, rbx, r12, r13, r14, r15 */
+	jit_emit( &o->buffer, "48 81 EC" ); /* sub rsp, frameSize */
+	jit_emit32( &o->buffer, o->frameSize );
+	jit_emit( &o->buffer, "48 89 3C 24" ); /* mov [rsp+stack], rdi */
+	jit_emit( &o->buffer, "48 89 74 24" ); /* mov [rsp+frame], rsi */
+	jit_emit8( &o->buffer, FRAME_OFFSET );
+	jit_emit( &o->buffer, "48 89 4C 24" ); /* mov [rsp+isSwitchingAllowed], rcx */
+	jit_emit8( &o->buffer, SWITCHING_OFFSET );
+	jit_emit( &o->buffer, "48 89 F2" ); /* mov rdx, rsi */
+	
+	Node* node;
+	for( node= o->startBlock->first; node != NULL; node= node->next )
+	{
+		if( node->isRemoved || node->operation != OP_PARAMETER )
+			continue;
+		
+		jit_emit( &o->buffer, node->type == TYPE_LONG ? "48 8B 82" : "8B 82" ); /* mov rax, [rdx+local] */
+		jit_emit32( &o->buffer, sizeof(StackFrame) + node->constant * sizeof(slot) );
+		
+		if( node->type == TYPE_LONG )
+			jit_emit( &o->buffer, "48 C1 C0 20" ); /* rol rax, 32 */
+		
+		generateStore( o, RAX, node );
+	}
+	
+	jit_emit( &o->buffer, "E9 00 00 00 00" ); /* jmp over the exit code */
+	uint32 skipPosition= o->buffer.length - 4;
+	
+	o->exitPosition= o->buffer.length;
+	
+	uint32 i;
+	for( i= 0; i < REGISTER_COUNT; i++ )
+		generateInstruction( o, 0x89, allocatableRegisters[i], RSP, true, SAVE_AREA_OFFSET + i * 8, true ); /* mov [rsp+save], reg */
+	
+	jit_emit( &o->buffer, "48 8B 3C 24" ); /* mov rdi, [rsp+stack] */
+	jit_emit( &o->buffer, "48 8B 74 24" ); /* mov rsi, [rsp+frame] */
+	jit_emit8( &o->buffer, FRAME_OFFSET );
+	generateLoadConstant( o, RDX, (uintptr_t)o->optimizedMethod, true );
+	jit_emit( &o->buffer, "89 C1" ); /* mov ecx, eax */
+	jit_emit( &o->buffer, "4C 8D 44 24" ); /* lea r8, [rsp+save] */
+	jit_emit8( &o->buffer, SAVE_AREA_OFFSET );
+	generateCall( o, leaveOptimizedCodeHelper );
+	jit_emit( &o->buffer, "48 81 C4" ); /* add rsp, frameSize */
+	jit_emit32( &o->buffer, o->frameSize );
+	jit_emit( &o->buffer, "41 5F 41 5E 41 5D 41 5C 5B 5D C3" ); /* pop r15, r14, r13, r12, rbx, rbp; ret */
+	
+	jit_patch32( &o->buffer, skipPosition, o->buffer.length );
+}
+
+void generateStubs( Optimization* o )
+{
+	uint32 i;
+	for( i= 0; i < o->stubCount; i++ )
+	{
+		ExitStub* stub= &o->stubs[i];
+		jit_ensureCapacity( &o->buffer, 64 );
+		jit_patch32( &o->buffer, stub->position, o->buffer.length );
+		
+		/* The time slice is checked only when switching is allowed. If it isn't over, the machine code goes on. */
+		if( stub->resumePosition != 0 )
+		{
+			generateSaveCallerSavedRegisters( o );
+			generateCall( o, isSwitchDueHelper );
+			generateRestoreCallerSavedRegisters( o );
+			jit_emit( &o->buffer, "85 C0 0F 84 00 00 00 00" ); /* test eax, eax; jz resume */
+			jit_patch32( &o->buffer, o->buffer.length - 4, stub->resumePosition );
+		}
+		
+		jit_emit8( &o->buffer, 0xB8 ); /* mov eax, exit */
+		jit_emit32( &o->buffer, stub->exitIndex );
+		jit_emit8( &o->buffer, 0xE9 ); /* jmp exit */
+		jit_emit32( &o->buffer, 0 );
+		jit_patch32( &o->buffer, o->buffer.length - 4, o->exitPosition );
+	}
+}
+
+void generateCode( Optimization* o )
+{
+	jit_initCodeBuffer( &o->buffer, 64 * o->nodeCount + 1024 );
+	generatePrologue( o );
+	
+	uint32 i;
+	for( i= 0; i < o->orderCount; i++ )
+	{
+		Block* block= o->order[i];
+		Block* nextBlock= i + 1 < o->orderCount ? o->order[i + 1] : NULL;
+		block->codeOffset= o->buffer.length;
+		
+		Node* node;
+		for( node= block->first; node != NULL; node= node->next )
+		{
+			if( node->isRemoved )
+				continue;
+			
+			jit_ensureCapacity( &o->buffer, 256 );
+			generateNode( o, node, nextBlock );
+		}
+	}
+	
+	generateStubs( o );
+	
+	for( i= 0; i < o->jumpCount; i++ )
+		jit_patch32( &o->buffer, o->jumps[i].position, o->jumps[i].target->codeOffset );
+}
+
+/* Optimizes the given method, for an entry at its start or at the given loop header. Returns NULL if the method can't be optimized. The method area is locked
+   by the caller. */
+OptimizedMethod* optimizeMethod( method_info* method, uint32 entryPc )
+{
+	Optimization optimization;
+	Optimization* o= &optimization;
+	memset( o, 0, sizeof(Optimization) );
+	o->method= method;
+	o->entryPc= entryPc;
+	
+	logVerbose( "Optimizing %s.%s%s (entry at %i)...\n", method->declaringClass->className, method->name, method->descriptor, entryPc );
+	buildGraph( o );
+	
+	if( !o->hasFailed )
+		optimize( o );
+	
+	if( o->hasFailed )
+	{
+		logVerbose( "The bytecode of %s.%s%s can't be optimized.\n", method->declaringClass->className, method->name, method->descriptor );
+		failedOptimizationCount++;
+		freeChunks( o );
+		return NULL;
+	}
+	
+	allocateRegisters( o );
+	o->optimizedMethod= mm_staticMalloc( sizeof(OptimizedMethod) );
+	generateCode( o );
+	
+	uint32 codeSize= o->buffer.length;
+	CompiledCode code= jit_installCode( &o->buffer );
+	
+	if( code == NULL )
+	{
+		logWarning( "The code cache is full, %s.%s%s is not optimized.\n", method->declaringClass->className, method->name, method->descriptor );
+		mm_staticFree( o->optimizedMethod );
+		freeExits( o->exits, o->exitCount );
+		freeChunks( o );
+		return NULL;
+	}
+	
+	OptimizedMethod* optimizedMethod= o->optimizedMethod;
+	optimizedMethod->code= code;
+	optimizedMethod->codeSize= codeSize;
+	optimizedMethod->entryPc= entryPc;
+	optimizedMethod->isDiscarded= false;
+	optimizedMethod->exits= o->exits;
+	optimizedMethod->exitCount= o->exitCount;
+	optimizedMethod->deoptimizationCount= 0;
+	optimizedMethod->next= NULL;
+	
+	optimizedBytecodeSize+= method->code->code_length;
+	optimizedMachineCodeSize+= codeSize;
+	
+	logVerbose( "Optimized %s.%s%s: %i bytes of bytecode (%i inlined), %i nodes, %i spill slots, %i bytes of machine code.\n",
+		method->declaringClass->className, method->name, method->descriptor, method->code->code_length, o->inlinedBytecodeSize, o->nodeCount,
+		o->spillSlotCount, codeSize );
+	
+	freeChunks( o );
+	
+	/* Other threads must not see the optimized method before its machine code. */
+	__sync_synchronize();
+	return optimizedMethod;
+}
+
+/* Optimizes the given method for an entry at its start. Several threads may try to optimize the same method at the same time, so only the first one does. */
+void opt_compile( method_info* method )
+{
+	if( !isJitEnabled || method->code == NULL || method->code->code_length > OPT_MAX_METHOD_SIZE )
+		return;
+	
+	thread_lockMethodArea();
+	
+	if( method->optimizedMethod != NULL || method->optimizationCount >= JIT_MAX_COMPILATION_COUNT )
+	{
+		thread_unlockMethodArea();
+		return;
+	}
+	
+	method->optimizationCount++;
+	OptimizedMethod* optimizedMethod= optimizeMethod( method, 0 );
+	
+	if( optimizedMethod == NULL )
+		method->optimizationCount= JIT_MAX_COMPILATION_COUNT;
+	else
+	{
+		if( method->optimizationCount > 1 )
+			reoptimizedMethodCount++;
+		else
+			optimizedMethodCount++;
+		
+		method->optimizedMethod= optimizedMethod;
+	}
+	
+	thread_unlockMethodArea();
+}
+
+/* Returns the optimized machine code of the given method which is entered at the given loop header, or NULL. */
+OptimizedMethod* findLoopOptimizedMethod( method_info* method, uint32 entryPc )
+{
+	OptimizedMethod* optimizedMethod;
+	for( optimizedMethod= method->loopOptimizedMethods; optimizedMethod != NULL; optimizedMethod= optimizedMethod->next )
+	{
+		if( optimizedMethod->entryPc == entryPc && !optimizedMethod->isDiscarded )
+			return optimizedMethod;
+	}
+	
+	return NULL;
+}
+
+/* Optimizes the given method for an entry at the given loop header, where the interpreter or the baseline machine code is just about to continue. The
+   machine code of all loops of the method is kept in a list, which only grows. */
+void opt_compileLoop( method_info* method, uint32 entryPc )
+{
+	if( !isJitEnabled || method->code == NULL || method->code->code_length > OPT_MAX_METHOD_SIZE )
+		return;
+	
+	/* Only the parameters are defined at the start of the method, so the machine code for the start works for a loop there, too. */
+	if( entryPc == 0 )
+	{
+		opt_compile( method );
+		return;
+	}
+	
+	thread_lockMethodArea();
+	
+	if( findLoopOptimizedMethod(method, entryPc) != NULL || method->loopOptimizationCount >= JIT_MAX_COMPILATION_COUNT )
+	{
+		thread_unlockMethodArea();
+		return;
+	}
+	
+	/* Every attempt counts, because the loop header may be any backward branch target, which may not be supported. */
+	method->loopOptimizationCount++;
+	OptimizedMethod* optimizedMethod= optimizeMethod( method, entryPc );
+	
+	if( optimizedMethod != NULL )
+	{
+		optimizedLoopCount++;
+		optimizedMethod->next= method->loopOptimizedMethods;
+		method->loopOptimizedMethods= optimizedMethod;
+	}
+	
+	thread_unlockMethodArea();
+}
+
+/* leaving the machine code */
+
+void writeExitValues( slot* slots, ExitValue* values, uint32 count, uint64* saveArea )
+{
+	uint32 i;
+	for( i= 0; i < count; i++ )
+	{
+		ExitValue* value= &values[i];
+		uint64 bits= value->location == NO_LOCATION ? (uint64)value->constant : saveArea[value->location];
+		
+		if( value->type == TYPE_VOID )
+			slots[i]= 0;
+		else if( value->type == TYPE_LONG )
+		{
+			/* The high word of a long is in the first slot. */
+			slots[i]= (slot)(bits >> 32);
+			slots[i + 1]= (slot)bits;
+			i++;
+		}
+		else
+			slots[i]= (slot)bits;
+	}
+}
+
+/* Called by the machine code at an exit, with all registers in the save area. Rebuilds the interpreter frames of the exit: the frame of the optimized method
+   is the current frame, the frames of the inlined methods are pushed onto it. Returns true if the current green thread should give up its worker. */
+boolean leaveOptimizedCodeHelper( Stack* stack, StackFrame* sf, OptimizedMethod* optimizedMethod, uint32 exitIndex, uint64* saveArea )
+{
+	Exit* exit= &optimizedMethod->exits[exitIndex];
+	
+	uint32 i;
+	for( i= 0; i < exit->frameCount; i++ )
+	{
+		ExitFrame* frame= &exit->frames[i];
+		
+		/* The arguments of an inlined method have been popped from the operand stack of the caller, but stack_pushFrame() copies them from there. The
+		   locals are overwritten anyway. */
+		if( i > 0 )
+		{
+			stack->stackPointer+= frame->method->parameterSlotCount;
+			sf= stack_pushFrame( stack, frame->cls, frame->method );
+		}
+		
+		slot* locals= (slot*)(sf + 1);
+		slot* operands= locals + frame->method->code->max_locals;
+		writeExitValues( locals, frame->values, frame->localCount, saveArea );
+		writeExitValues( operands, frame->values + frame->localCount, frame->stackCount, saveArea );
+		sf->pc= frame->method->code->code + frame->pc;
+		stack->stackPointer= operands + frame->stackCount;
+	}
+	
+	optimizedCodeExitCount++;
+	
+	/* The method is optimized again with the new profile, if its speculations fail too often. The old machine code may still be used by other threads, so it
+	   is kept in the code cache. */
+	if( exit->reason == EXIT_DEOPTIMIZE )
+	{
+		method_info* method= exit->frames[0].method;
+		deoptimizationCount++;
+		optimizedMethod->deoptimizationCount++;
+		
+		logVerbose( "Deoptimizing %s.%s%s at %s.%s%s:%i.\n", method->declaringClass->className, method->name, method->descriptor,
+			exit->frames[exit->frameCount - 1].cls->className, exit->frames[exit->frameCount - 1].method->name,
+			exit->frames[exit->frameCount - 1].method->descriptor, exit->frames[exit->frameCount - 1].pc );
+		
+		if( optimizedMethod->deoptimizationCount == OPT_MAX_DEOPTIMIZATION_COUNT && !optimizedMethod->isDiscarded )
+		{
+			logVerbose( "Discarding the optimized machine code of %s.%s%s (entry at %i).\n", method->declaringClass->className, method->name,
+				method->descriptor, optimizedMethod->entryPc );
+			optimizedMethod->isDiscarded= true;
+			discardedOptimizedMethodCount++;
+			
+			if( method->optimizedMethod == optimizedMethod )
+			{
+				method->optimizedMethod= NULL;
+				method->invocationCount= jitInvocationThreshold;
+			}
+			else
+				method->backwardBranchCount= jitBackwardBranchThreshold;
+		}
+	}
+	
+	return exit->reason == EXIT_SWITCH;
+}
+
+/* Runs the optimized machine code of the current frame, if there is one for its stored pc, i.e. at the start of the method or at a loop header. Returns true if
+   the current green thread should give up its worker. Otherwise the interpreter continues at the stored pc of the current frame, which may be the frame of an
+   inlined method. */
+boolean opt_run( Stack* stack, boolean isSwitchingAllowed )
+{
+	StackFrame* sf= stack->currentFrame;
+	method_info* method= sf->methodInfo;
+	uint32 pc= sf->pc - method->code->code;
+	OptimizedMethod* optimizedMethod= pc == 0 ? method->optimizedMethod : findLoopOptimizedMethod( method, pc );
+	
+	/* The machine code may have been discarded by another thread in the meantime. */
+	if( optimizedMethod == NULL )
+		return false;
+	
+	optimizedCodeEntryCount++;
+	return optimizedMethod->code( stack, sf, NULL, isSwitchingAllowed );
+}
+
+void opt_printStatistics()
+{
+	printf( "Optimized methods: %i (reoptimized: %i, loops: %i, failed: %i, discarded: %i), %i bytes of bytecode, %i bytes of machine code\n",
+		optimizedMethodCount, reoptimizedMethodCount, optimizedLoopCount, failedOptimizationCount, discardedOptimizedMethodCount, optimizedBytecodeSize,
+		optimizedMachineCodeSize );
+	printf( "Inlined methods: %i, eliminated null checks: %i, eliminated bounds checks: %i\n", inlinedMethodCount, eliminatedNullCheckCount,
+		eliminatedBoundsCheckCount );
+	printf( "Entries into optimized machine code: %i, exits: %i (deoptimizations: %i)\n", optimizedCodeEntryCount, optimizedCodeExitCount,
+		deoptimizationCount );
+}
+
+#else
+
+/* The JIT compiler isn't available on this platform, so everything is interpreted. */
+
+void opt_compile( method_info* method )
+{
+}
+
+void opt_compileLoop( method_info* method, uint32 entryPc )
+{
+}
+
+boolean opt_run( Stack* stack, boolean isSwitchingAllowed )
+{
+	return false;
+}
+
+void opt_printStatistics()
+{
+}
+
+#endif
@@ -0,0 +1,65 @@
+/*
+ *  optimizingCompiler.h
+ *  Optimizing just-in-time compiler, the second tier of the mixed mode. Hot methods are translated into an SSA intermediate representation, optimized and
+ *  compiled into x86-64 machine code with the values in registers.
+ *
+ *  Copyright (c) 2006, 2007 Daniel Klein. All rights reserved.
+ *
+ *  Licensed under GPL version 2.
+ *  See here for the full license: http://www.gnu.org/licenses/gpl.html
+ */
+
+#ifndef _optimizingCompiler_h_
+#define _optimizingCompiler_h_
+
+#include "puraGlobals.h"
+#include "types.h"
+#include "class.h"
+#include "stack.h"
+#include "jit.h"
+
+/* A method is optimized as soon as it has been invoked this often. By then the baseline machine code and the interpreter have quickened its instructions and
+   filled the inline caches of its call sites, which are the type profile for inlining. */
+#define OPT_INVOCATION_THRESHOLD 10000
+
+/* A loop is optimized as soon as the backward branches of its method have been taken this often. The optimized machine code is entered at the loop header,
+   with the values of the locals and the operand stack taken from the interpreter frame (on-stack replacement). */
+#define OPT_BACKWARD_BRANCH_THRESHOLD 100000
+
+/* The optimized machine code of a method is discarded when its speculations have failed this often. The method is optimized again with the new profile as
+   soon as it's used often enough, but not more often than JIT_MAX_COMPILATION_COUNT times. */
+#define OPT_MAX_DEOPTIMIZATION_COUNT 16
+
+/* largest method which is optimized, in bytes of bytecode */
+#define OPT_MAX_METHOD_SIZE 4096
+
+/* inlining limits: bytecode size of an inlined method, nesting depth of inlined methods and bytecode size of all methods inlined into one method */
+#define OPT_MAX_INLINE_SIZE 64
+#define OPT_MAX_INLINE_DEPTH 4
+#define OPT_MAX_INLINED_BYTECODE_SIZE 1024
+
+struct sExit;
+
+/* Optimized machine code of a method. It is called like the baseline machine code (see CompiledCode), but it has only one entry: the start of the method, or a
+   loop header. It always returns through one of its exits, which rebuild the frames of the interpreter from the registers. */
+typedef struct sOptimizedMethod
+{
+	CompiledCode code;
+	uint32 codeSize;
+	uint32 entryPc; /* offset of the loop header in the bytecode, 0 for machine code entered at the start of the method */
+	boolean isDiscarded;
+	struct sExit* exits;
+	uint32 exitCount;
+	uint32 deoptimizationCount;
+	struct sOptimizedMethod* next; /* the machine code for the other loops of the method */
+} OptimizedMethod;
+
+extern uint32 optimizationThreshold;
+extern uint32 optimizationBackwardBranchThreshold;
+
+void opt_compile( method_info* method );
+void opt_compileLoop( method_info* method, uint32 entryPc );
+boolean opt_run( Stack* stack, boolean isSwitchingAllowed );
+void opt_printStatistics();
+
+#endif /*_optimizingCompiler_h_*/
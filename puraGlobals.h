@@ -22,6 +22,34 @@
 #define logVerbose(a,...) ""
 #endif
 
+/* interpreter dispatch */
+
+/* Enable to use direct threaded dispatch (one computed goto per opcode handler) instead of the switch based interpreter loop. This requires GCC's labels
+   as values extension, but gets rid of most of the dispatch overhead. */
+/* #define THREADED_DISPATCH_ENABLED */
+
+#if defined(THREADED_DISPATCH_ENABLED) && !defined(__GNUC__)
+#error "Threaded dispatch requires GCC's computed goto (labels as values)."
+#endif
+
+/* just-in-time compiler */
+
+/* The baseline JIT compiler (see jit.c) emits x86-64 machine code, so it is only built on x86-64 Linux. Enable to leave it out anyway and only interpret. */
+/* #define JIT_DISABLED */
+
+#if defined(__x86_64__) && defined(__linux__) && !defined(JIT_DISABLED)
+#define JIT_ENABLED
+#endif
+
+/* ahead-of-time compiler */
+
+/* Defined when building an executable from the C file written by the ahead-of-time compiler (see aot.c), which contains the compiled methods and class files
+   of the program. */
+/* #define AOT_IMAGE */
+
+/* thread local variables (GCC extension), used for the per thread state of the VM */
+#define THREAD_LOCAL __thread
+
 /*#ifndef __inline__
 #define __inline ""
 #endif*/
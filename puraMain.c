@@ -12,15 +12,29 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "puraGlobals.h"
+#include "symbolTable.h"
 #include "methodArea.h"
 #include "memoryManager.h"
 #include "interpreter.h"
 #include "heap.h"
+#include "garbageCollector.h"
+#include "thread.h"
+#include "monitor.h"
+#include "scheduler.h"
+#include "jit.h"
+#include "optimizingCompiler.h"
+#include "aot.h"
+#include "registerInterpreter.h"
 
 const char* mainClass;
 
 void handleParameters( int argcnt, const char** args )
 {
+#ifdef AOT_IMAGE
+	/* An executable built by the ahead-of-time compiler runs the main class it has been compiled for, all arguments which aren't parameters are passed to it. */
+	mainClass= aotMainClass;
+	mainClassArguments= args+argcnt;
+#else
 	/* check if command line parameters exist */
 	if( argcnt == 1 )
 	{
@@ -30,13 +44,21 @@ void handleParameters( int argcnt, const char** args )
 		logError( "-silent => Disable debug output. (Set log level to WARNING.)\n" );
 		logError( "-mem | -memory => Show memory usage information.\n" );
 		logError( "-opcodestats => Show Opcode usage statistics.\n" );
+		logError( "-gc => Show garbage collector statistics.\n" );
 		logError( "-all => Show all possible debug output.\n" );
 		logError( "-stack <stack size>\n" );
+		logError( "-workers <count> => Run Java threads as green threads on <count> native worker threads.\n" );
+		logError( "-Xint => Interpret all methods, don't use the JIT compiler.\n" );
+		logError( "-Xjit => Compile every method when it's invoked the first time, and optimize it when it's invoked the second time.\n" );
+		logError( "-Xstack => Interpret the stack bytecode only, don't translate methods into register code.\n" );
+		logError( "-aot <file> => Translate the main class and all classes it uses into the C file <file> instead of running it. Compiled with -DAOT_IMAGE\n" );
+		logError( "               and the sources of the VM, this is an executable of the program.\n" );
 		/*logError( "-kp - Stop until key pressed after output.\n" );*/
 		/*logError( "-d <delay> - Delay execution after output for <delay> ms.\n" );*/
 		logError( "\n" );
 		exit( 0 );
 	}
+#endif
 	
 	/* check for all possible parameters */
 	int i;
@@ -74,6 +96,61 @@ void handleParameters( int argcnt, const char** args )
 
 			continue;
 		}
+	
+		/* green threads */
+		else if( strcasecmp(args[i], "-workers") == 0 )
+		{
+			/* is there a parameter left? */
+			if( argcnt < i+1 )
+				error( "Error while parsing parameters!\n" );
+	
+			int32 parsedWorkerCount= atoi( args[++i] );
+	
+			if( parsedWorkerCount < 1 || parsedWorkerCount > 1024 )
+				error( "The provided number of workers is not allowed." );
+	
+			workerCount= parsedWorkerCount;
+			continue;
+		}
+		
+		/* interpreter only */
+		else if( strcasecmp(args[i], "-Xint") == 0 )
+		{
+			isJitEnabled= false;
+			continue;
+		}
+		
+		/* compile everything */
+		else if( strcasecmp(args[i], "-Xjit") == 0 )
+		{
+#ifndef JIT_ENABLED
+			error( "The JIT compiler is not available on this platform." );
+#endif
+			isJitEnabled= true;
+			jitInvocationThreshold= 1;
+			jitBackwardBranchThreshold= 1;
+			optimizationThreshold= 2;
+			optimizationBackwardBranchThreshold= 2;
+			continue;
+		}
+		
+		/* stack interpreter only */
+		else if( strcasecmp(args[i], "-Xstack") == 0 )
+		{
+			isRegisterInterpreterEnabled= false;
+			continue;
+		}
+		
+		/* ahead-of-time compiler */
+		else if( strcasecmp(args[i], "-aot") == 0 )
+		{
+			/* is there a parameter left? */
+			if( argcnt < i+1 )
+				error( "Error while parsing parameters!\n" );
+			
+			aotOutputFileName= args[++i];
+			continue;
+		}
 		
 		/* silent */
 		else if( strcasecmp(args[i], "-silent") == 0 )
@@ -95,6 +172,7 @@ void handleParameters( int argcnt, const char** args )
 			currentLogLevel= LOG_VERBOSE;
 			logMemoryEnabled= true;
 			opcodeStatsEnabled= true;
+			gcStatsEnabled= true;
 			continue;
 		}
 		
@@ -105,8 +183,20 @@ void handleParameters( int argcnt, const char** args )
 			continue;
 		}
 		
+		/* gc */
+		else if( strcasecmp(args[i], "-gc") == 0 )
+		{
+			gcStatsEnabled= true;
+			continue;
+		}
+		
 		/* add more parameters here */
 		
+#ifdef AOT_IMAGE
+		mainClassArguments= args+i;
+		return;
+#endif
+		
 		/* No suitable parameter found? Must be the main class then. */
 		mainClass= args[i];
 
@@ -152,9 +242,18 @@ int main( int argcnt, const char** args )
 
 	logInfo( "Pura Experimental Java Virtual Machine v%s - (c) 2007 Daniel Klein\n", STR_VERSION );
 
+	thread_init();
+	monitor_init();
+	sym_init();
 	ma_init();
 	heap_init();
-	interpreter_start( mainClass );
+	jit_init();
+
+	if( aotOutputFileName != NULL )
+		aot_translate( mainClass, aotOutputFileName );
+	else
+		interpreter_start( mainClass );
+
 	mm_printStatistics();
 
 	return 0;
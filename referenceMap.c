@@ -0,0 +1,852 @@
+/*
+ *  referenceMap.c
+ *  Computes the reference maps of a method. The types of all local variables and operand stack slots are inferred by a dataflow analysis over the bytecode (similar
+ *  to the type inference of the verifier, but only distinguishing references from all other values). A slot is a reference at a given pc only if it holds a
+ *  reference on every path to that pc, all other slots can't be used as a reference by the bytecode and are ignored by the garbage collector.
+ *  Reference maps are only stored for the safe points of a method: the allocating instructions and the ones that may initialize a class (and thereby run Java
+ *  code), the return addresses of all method invocations, MONITORENTER, the targets of backward branches and the method entry. The interpreter polls for stop
+ *  the world requests at all but MONITORENTER, the scheduler suspends green threads at the last two (see scheduler.c), and synchronized methods wait for their
+ *  monitor at the method entry.
+ *  Methods using subroutines (JSR/RET) get no reference maps, their frames are scanned conservatively.
+ *  
+ *  Copyright (c) 2006, 2007 Daniel Klein. All rights reserved.
+ *  
+ *  Licensed under GPL version 2.
+ *  See here for the full license: http://www.gnu.org/licenses/gpl.html
+ */
+
+#include <string.h>
+#include "puraGlobals.h"
+#include "memoryManager.h"
+#include "class.h"
+#include "opcodes.h"
+#include "referenceMap.h"
+
+#define TYPE_VALUE 0
+#define TYPE_REFERENCE 1
+#define TYPE_WIDE 2 /* first slot of a long or double */
+
+/* inferred types of the locals and operand stack slots before an instruction is executed */
+typedef struct sFrameState
+{
+	u2 stackHeight;
+	uint8* types; /* max_locals local variable types followed by stackHeight operand stack types */
+} FrameState;
+
+/* data of the analysis of one method */
+typedef struct sAnalysis
+{
+	Class* cls;
+	Code_attribute* code;
+	uint32 slotCount; /* max_locals + max_stack */
+	FrameState** states; /* indexed by pc, NULL for instructions that haven't been reached (yet) */
+	FrameState current; /* state of the instruction that is currently analyzed */
+	FrameState handler; /* state at the beginning of an exception handler */
+	u2* worklist;
+	uint32 worklistCount;
+	boolean* isQueued;
+} Analysis;
+
+/* Returns the number of slots used by a value of the given type. */
+uint32 getSlotCountOfType( const char* descriptor )
+{
+	switch( *descriptor )
+	{
+		case 'V':
+			return 0;
+		case BASE_TYPE_LONG:
+		case BASE_TYPE_DOUBLE:
+			return 2;
+		default:
+			return 1;
+	}
+}
+
+/* Returns the type of the next parameter in the given descriptor and moves the descriptor to the parameter after it. */
+uint8 getNextParameterType( const char** descriptor, uint32* slotCount )
+{
+	const char* d= *descriptor;
+	*slotCount= getSlotCountOfType( d );
+	
+	if( *d == BASE_TYPE_ONE_ARRAY_DIMENSION || *d == BASE_TYPE_REFERENCE )
+	{
+		while( *d == BASE_TYPE_ONE_ARRAY_DIMENSION )
+			d++;
+		
+		if( *d == BASE_TYPE_REFERENCE )
+			while( *d != ';' )
+				d++;
+		
+		*descriptor= d+1;
+		return TYPE_REFERENCE;
+	}
+	
+	*descriptor= d+1;
+	return *slotCount == 2 ? TYPE_WIDE : TYPE_VALUE;
+}
+
+/* Returns the descriptor of the field or method referenced by the given Fieldref, Methodref or InterfaceMethodref constant pool entry. */
+const char* getMemberDescriptor( Class* cls, u2 index )
+{
+	CONSTANT_Fieldref_info* ref= (CONSTANT_Fieldref_info*)cls->constant_pool[index];
+	return cls_resolveConstantPoolIndexToNameAndType( cls, ref->name_and_type_index )->descriptor;
+}
+
+void enqueue( Analysis* analysis, uint32 pc )
+{
+	if( analysis->isQueued[pc] )
+		return;
+	
+	analysis->isQueued[pc]= true;
+	analysis->worklist[analysis->worklistCount]= pc;
+	analysis->worklistCount++;
+}
+
+/* Merges the given state into the state of the instruction at the given pc. A slot stays a reference (or the first slot of a long or double) only if it is one
+	in both states. The instruction is (re-)analyzed if its state has changed. */
+void mergeState( Analysis* analysis, uint32 pc, FrameState* state )
+{
+	if( pc >= analysis->code->code_length )
+		error( "Invalid branch target!" );
+	
+	FrameState* target= analysis->states[pc];
+	uint32 count= analysis->code->max_locals + state->stackHeight;
+	
+	if( target == NULL )
+	{
+		target= mm_staticMalloc( sizeof(FrameState) + analysis->slotCount );
+		target->types= (uint8*)(target+1);
+		target->stackHeight= state->stackHeight;
+		memcpy( target->types, state->types, count );
+		
+		analysis->states[pc]= target;
+		enqueue( analysis, pc );
+		return;
+	}
+	
+	if( target->stackHeight != state->stackHeight )
+		error( "Inconsistent operand stack height!" );
+	
+	boolean hasChanged= false;
+	
+	uint32 i;
+	for( i= 0; i < count; i++ )
+	{
+		if( target->types[i] != TYPE_VALUE && state->types[i] != target->types[i] )
+		{
+			target->types[i]= TYPE_VALUE;
+			hasChanged= true;
+		}
+	}
+	
+	if( hasChanged )
+		enqueue( analysis, pc );
+}
+
+/* Merges the locals of the current state into all exception handlers which cover the given pc. The operand stack of a handler only holds the exception. */
+void mergeIntoExceptionHandlers( Analysis* analysis, uint32 pc )
+{
+	Code_attribute* code= analysis->code;
+	
+	int i;
+	for( i= 0; i < code->exception_table_length; i++ )
+	{
+		exception_table* ex= code->exception_table_tab[i];
+		
+		if( pc < ex->start_pc || pc >= ex->end_pc )
+			continue;
+		
+		memcpy( analysis->handler.types, analysis->current.types, code->max_locals );
+		analysis->handler.types[code->max_locals]= TYPE_REFERENCE;
+		analysis->handler.stackHeight= 1;
+		mergeState( analysis, ex->handler_pc, &analysis->handler );
+	}
+}
+
+void push( Analysis* analysis, uint8 type )
+{
+	if( analysis->current.stackHeight >= analysis->code->max_stack )
+		error( "Operand stack overflow while computing reference maps!" );
+	
+	analysis->current.types[analysis->code->max_locals + analysis->current.stackHeight]= type;
+	analysis->current.stackHeight++;
+}
+
+/* Pushes a value which isn't a reference and takes the given number of slots. */
+void pushValues( Analysis* analysis, uint32 count )
+{
+	if( count == 2 )
+	{
+		push( analysis, TYPE_WIDE );
+		count--;
+	}
+	
+	while( count-- > 0 )
+		push( analysis, TYPE_VALUE );
+}
+
+void pop( Analysis* analysis, uint32 count )
+{
+	if( analysis->current.stackHeight < count )
+		error( "Operand stack underflow while computing reference maps!" );
+	
+	analysis->current.stackHeight-= count;
+}
+
+/* Returns the type of the operand stack slot at the given depth (0 is the top of the stack). */
+uint8 peek( Analysis* analysis, uint32 depth )
+{
+	return analysis->current.types[analysis->code->max_locals + analysis->current.stackHeight - 1 - depth];
+}
+
+/* Pushes a value of the type given by the descriptor. */
+void pushType( Analysis* analysis, const char* descriptor )
+{
+	if( *descriptor == BASE_TYPE_REFERENCE || *descriptor == BASE_TYPE_ONE_ARRAY_DIMENSION )
+		push( analysis, TYPE_REFERENCE );
+	else
+		pushValues( analysis, getSlotCountOfType(descriptor) );
+}
+
+void setLocal( Analysis* analysis, uint32 index, uint8 type )
+{
+	if( index >= analysis->code->max_locals )
+		error( "Invalid local variable index!" );
+	
+	/* A long or double which is overwritten partly isn't one anymore. */
+	if( index > 0 && analysis->current.types[index - 1] == TYPE_WIDE )
+		analysis->current.types[index - 1]= TYPE_VALUE;
+	
+	analysis->current.types[index]= type;
+}
+
+void setWideLocal( Analysis* analysis, uint32 index )
+{
+	setLocal( analysis, index + 1, TYPE_VALUE );
+	setLocal( analysis, index, TYPE_WIDE );
+}
+
+/* Rearranges the top of the operand stack for the DUP and SWAP instructions. The given pattern lists the new slots from the bottom to the top, as depths of the
+	old ones (0 is the top). */
+void shuffle( Analysis* analysis, uint32 popCount, const char* pattern )
+{
+	uint8 old[4];
+	
+	uint32 i;
+	for( i= 0; i < popCount; i++ )
+		old[i]= peek( analysis, i );
+	
+	pop( analysis, popCount );
+	
+	for( ; *pattern; pattern++ )
+		push( analysis, old[*pattern - '0'] );
+}
+
+/* Computes the state after the instruction at the given pc and merges it into all of its successors. Returns false if the instruction isn't supported by the
+	analysis (subroutines). */
+boolean analyzeInstruction( Analysis* analysis, uint32 pc )
+{
+	Code_attribute* code= analysis->code;
+	FrameState* state= analysis->states[pc];
+	const u1* operands= code->code + pc + 1;
+	u1 opcode= code->code[pc];
+	uint32 length= opcode_getInstructionLength( code->code, pc );
+	boolean fallsThrough= true;
+	
+	analysis->current.stackHeight= state->stackHeight;
+	memcpy( analysis->current.types, state->types, code->max_locals + state->stackHeight );
+	
+	/* An exception may be thrown before the instruction changes anything. */
+	mergeIntoExceptionHandlers( analysis, pc );
+	
+	switch( opcode )
+	{
+		case NOP:
+		case IINC:
+		case CHECKCAST:
+			break;
+		
+		case ACONST_NULL:
+		case NEW:
+			push( analysis, TYPE_REFERENCE );
+			break;
+		
+		case ICONST_M1: case ICONST_0: case ICONST_1: case ICONST_2: case ICONST_3: case ICONST_4: case ICONST_5:
+		case FCONST_0: case FCONST_1: case FCONST_2:
+		case BIPUSH: case SIPUSH:
+		case ILOAD: case FLOAD:
+		case ILOAD_0: case ILOAD_1: case ILOAD_2: case ILOAD_3:
+		case FLOAD_0: case FLOAD_1: case FLOAD_2: case FLOAD_3:
+			push( analysis, TYPE_VALUE );
+			break;
+		
+		case LCONST_0: case LCONST_1:
+		case DCONST_0: case DCONST_1:
+		case LDC2_W:
+		case LLOAD: case DLOAD:
+		case LLOAD_0: case LLOAD_1: case LLOAD_2: case LLOAD_3:
+		case DLOAD_0: case DLOAD_1: case DLOAD_2: case DLOAD_3:
+			pushValues( analysis, 2 );
+			break;
+		
+		case LDC:
+		case LDC_W:
+		{
+			u2 index= opcode == LDC ? operands[0] : opcode_readU2( operands );
+			u1 tag= analysis->cls->constant_pool[index]->tag;
+			push( analysis, tag == CONSTANT_String || tag == CONSTANT_Class ? TYPE_REFERENCE : TYPE_VALUE );
+			break;
+		}
+		
+		case ALOAD:
+			push( analysis, analysis->current.types[operands[0]] );
+			break;
+		
+		case ALOAD_0: case ALOAD_1: case ALOAD_2: case ALOAD_3:
+			push( analysis, analysis->current.types[opcode - ALOAD_0] );
+			break;
+		
+		case IALOAD: case FALOAD: case BALOAD: case CALOAD: case SALOAD:
+			pop( analysis, 2 );
+			push( analysis, TYPE_VALUE );
+			break;
+		
+		case LALOAD: case DALOAD:
+			pop( analysis, 2 );
+			pushValues( analysis, 2 );
+			break;
+		
+		case AALOAD:
+			pop( analysis, 2 );
+			push( analysis, TYPE_REFERENCE );
+			break;
+		
+		case ISTORE: case FSTORE:
+			pop( analysis, 1 );
+			setLocal( analysis, operands[0], TYPE_VALUE );
+			break;
+		
+		case ISTORE_0: case ISTORE_1: case ISTORE_2: case ISTORE_3:
+			pop( analysis, 1 );
+			setLocal( analysis, opcode - ISTORE_0, TYPE_VALUE );
+			break;
+		
+		case FSTORE_0: case FSTORE_1: case FSTORE_2: case FSTORE_3:
+			pop( analysis, 1 );
+			setLocal( analysis, opcode - FSTORE_0, TYPE_VALUE );
+			break;
+		
+		case LSTORE: case DSTORE:
+			pop( analysis, 2 );
+			setWideLocal( analysis, operands[0] );
+			break;
+		
+		case LSTORE_0: case LSTORE_1: case LSTORE_2: case LSTORE_3:
+			pop( analysis, 2 );
+			setWideLocal( analysis, opcode - LSTORE_0 );
+			break;
+		
+		case DSTORE_0: case DSTORE_1: case DSTORE_2: case DSTORE_3:
+			pop( analysis, 2 );
+			setWideLocal( analysis, opcode - DSTORE_0 );
+			break;
+		
+		case ASTORE:
+		{
+			uint8 type= peek( analysis, 0 );
+			pop( analysis, 1 );
+			setLocal( analysis, operands[0], type );
+			break;
+		}
+		
+		case ASTORE_0: case ASTORE_1: case ASTORE_2: case ASTORE_3:
+		{
+			uint8 type= peek( analysis, 0 );
+			pop( analysis, 1 );
+			setLocal( analysis, opcode - ASTORE_0, type );
+			break;
+		}
+		
+		case IASTORE: case FASTORE: case AASTORE: case BASTORE: case CASTORE: case SASTORE:
+			pop( analysis, 3 );
+			break;
+		
+		case LASTORE: case DASTORE:
+			pop( analysis, 4 );
+			break;
+		
+		case POP:
+		case MONITORENTER:
+		case MONITOREXIT:
+			pop( analysis, 1 );
+			break;
+		
+		case POP2:
+			pop( analysis, 2 );
+			break;
+		
+		case DUP:
+			shuffle( analysis, 1, "00" );
+			break;
+		
+		case DUP_X1:
+			shuffle( analysis, 2, "010" );
+			break;
+		
+		case DUP_X2:
+			shuffle( analysis, 3, "0210" );
+			break;
+		
+		case DUP2:
+			shuffle( analysis, 2, "1010" );
+			break;
+		
+		case DUP2_X1:
+			shuffle( analysis, 3, "10210" );
+			break;
+		
+		case DUP2_X2:
+			shuffle( analysis, 4, "103210" );
+			break;
+		
+		case SWAP:
+			shuffle( analysis, 2, "01" );
+			break;
+		
+		case IADD: case ISUB: case IMUL: case IDIV: case IREM: case ISHL: case ISHR: case IUSHR: case IAND: case IOR: case IXOR:
+		case FADD: case FSUB: case FMUL: case FDIV: case FREM:
+		case FCMPL: case FCMPG:
+			pop( analysis, 2 );
+			push( analysis, TYPE_VALUE );
+			break;
+		
+		case LADD: case LSUB: case LMUL: case LDIV: case LREM: case LAND: case LOR: case LXOR:
+		case DADD: case DSUB: case DMUL: case DDIV: case DREM:
+			pop( analysis, 4 );
+			pushValues( analysis, 2 );
+			break;
+		
+		case LSHL: case LSHR: case LUSHR:
+			pop( analysis, 3 );
+			pushValues( analysis, 2 );
+			break;
+		
+		case LCMP:
+		case DCMPL: case DCMPG:
+			pop( analysis, 4 );
+			push( analysis, TYPE_VALUE );
+			break;
+		
+		case INEG: case FNEG:
+		case I2F: case F2I: case I2B: case I2C: case I2S:
+		case ARRAYLENGTH:
+		case INSTANCEOF:
+			pop( analysis, 1 );
+			push( analysis, TYPE_VALUE );
+			break;
+		
+		case LNEG: case DNEG:
+		case L2D: case D2L:
+			pop( analysis, 2 );
+			pushValues( analysis, 2 );
+			break;
+		
+		case I2L: case I2D: case F2L: case F2D:
+			pop( analysis, 1 );
+			pushValues( analysis, 2 );
+			break;
+		
+		case L2I: case L2F: case D2I: case D2F:
+			pop( analysis, 2 );
+			push( analysis, TYPE_VALUE );
+			break;
+		
+		case IFEQ: case IFNE: case IFLT: case IFGE: case IFGT: case IFLE:
+		case IFNULL: case IFNONNULL:
+			pop( analysis, 1 );
+			mergeState( analysis, opcode_readU2(operands), &analysis->current );
+			break;
+		
+		case IF_ICMPEQ: case IF_ICMPNE: case IF_ICMPLT: case IF_ICMPGE: case IF_ICMPGT: case IF_ICMPLE:
+		case IF_ACMPEQ: case IF_ACMPNE:
+			pop( analysis, 2 );
+			mergeState( analysis, opcode_readU2(operands), &analysis->current );
+			break;
+		
+		case GOTO:
+			mergeState( analysis, opcode_readU2(operands), &analysis->current );
+			fallsThrough= false;
+			break;
+		
+		case GOTO_W:
+			mergeState( analysis, opcode_readS4(operands), &analysis->current );
+			fallsThrough= false;
+			break;
+		
+		case TABLESWITCH:
+		case LOOKUPSWITCH:
+		{
+			pop( analysis, 1 );
+			
+			const u1* table= operands + (3 - (pc % 4));
+			mergeState( analysis, opcode_readS4(table), &analysis->current );
+			
+			int32 i;
+			if( opcode == TABLESWITCH )
+			{
+				int32 count= opcode_readS4( table+8 ) - opcode_readS4( table+4 ) + 1;
+				for( i= 0; i < count; i++ )
+					mergeState( analysis, opcode_readS4(table + 12 + i*4), &analysis->current );
+			}
+			else
+			{
+				int32 count= opcode_readS4( table+4 );
+				for( i= 0; i < count; i++ )
+					mergeState( analysis, opcode_readS4(table + 12 + i*8), &analysis->current );
+			}
+			
+			fallsThrough= false;
+			break;
+		}
+		
+		case IRETURN: case LRETURN: case FRETURN: case DRETURN: case ARETURN: case RETURN:
+		case ATHROW:
+			fallsThrough= false;
+			break;
+		
+		case GETSTATIC:
+			pushType( analysis, getMemberDescriptor(analysis->cls, opcode_readU2(operands)) );
+			break;
+		
+		case PUTSTATIC:
+			pop( analysis, getSlotCountOfType(getMemberDescriptor(analysis->cls, opcode_readU2(operands))) );
+			break;
+		
+		case GETFIELD:
+			pop( analysis, 1 );
+			pushType( analysis, getMemberDescriptor(analysis->cls, opcode_readU2(operands)) );
+			break;
+		
+		case PUTFIELD:
+			pop( analysis, getSlotCountOfType(getMemberDescriptor(analysis->cls, opcode_readU2(operands))) + 1 );
+			break;
+		
+		case INVOKEVIRTUAL:
+		case INVOKESPECIAL:
+		case INVOKESTATIC:
+		case INVOKEINTERFACE:
+		{
+			const char* descriptor= getMemberDescriptor( analysis->cls, opcode_readU2(operands) ) + 1;
+			uint32 parameterSlotCount= opcode == INVOKESTATIC ? 0 : 1;
+			
+			while( *descriptor != ')' )
+			{
+				uint32 slotCount;
+				getNextParameterType( &descriptor, &slotCount );
+				parameterSlotCount+= slotCount;
+			}
+			
+			pop( analysis, parameterSlotCount );
+			pushType( analysis, descriptor+1 );
+			break;
+		}
+		
+		case NEWARRAY:
+		case ANEWARRAY:
+			pop( analysis, 1 );
+			push( analysis, TYPE_REFERENCE );
+			break;
+		
+		case MULTIANEWARRAY:
+			pop( analysis, operands[2] );
+			push( analysis, TYPE_REFERENCE );
+			break;
+		
+		case WIDE:
+		{
+			u2 index= opcode_readU2( operands+1 );
+			
+			switch( operands[0] )
+			{
+				case ILOAD: case FLOAD:
+					push( analysis, TYPE_VALUE );
+					break;
+				case LLOAD: case DLOAD:
+					pushValues( analysis, 2 );
+					break;
+				case ALOAD:
+					push( analysis, analysis->current.types[index] );
+					break;
+				case ISTORE: case FSTORE:
+					pop( analysis, 1 );
+					setLocal( analysis, index, TYPE_VALUE );
+					break;
+				case LSTORE: case DSTORE:
+					pop( analysis, 2 );
+					setWideLocal( analysis, index );
+					break;
+				case ASTORE:
+				{
+					uint8 type= peek( analysis, 0 );
+					pop( analysis, 1 );
+					setLocal( analysis, index, type );
+					break;
+				}
+				case IINC:
+					break;
+				default: /* RET */
+					return false;
+			}
+			break;
+		}
+		
+		default: /* JSR, JSR_W, RET and all opcodes that must not appear in a class file */
+			return false;
+	}
+	
+	/* The locals stored by this instruction are visible to the exception handlers, too. */
+	mergeIntoExceptionHandlers( analysis, pc );
+	
+	if( fallsThrough )
+		mergeState( analysis, pc + length, &analysis->current );
+	
+	return true;
+}
+
+/* Marks the safe points of the given code, i.e. the instructions where the garbage collector may run while a frame of the method is suspended. */
+void findSafePoints( Code_attribute* code, boolean* isSafePoint )
+{
+	memset( isSafePoint, 0, code->code_length * sizeof(boolean) );
+	
+	/* method entry */
+	isSafePoint[0]= true;
+	
+	u1 prevOpcode= NOP;
+	uint32 pc;
+	for( pc= 0; pc < code->code_length; pc+= opcode_getInstructionLength(code->code, pc) )
+	{
+		u1 opcode= code->code[pc];
+	
+		switch( prevOpcode )
+		{
+			/* The pc of a frame which has invoked a method points to the next instruction. */
+			case INVOKEVIRTUAL:
+			case INVOKESPECIAL:
+			case INVOKESTATIC:
+			case INVOKEINTERFACE:
+				isSafePoint[pc]= true;
+				break;
+		}
+	
+		switch( opcode )
+		{
+			case NEW:
+			case NEWARRAY:
+			case ANEWARRAY:
+			case MULTIANEWARRAY:
+			case GETSTATIC:
+			case PUTSTATIC:
+			case GETFIELD:
+			case PUTFIELD:
+			case INVOKESTATIC:
+			case MONITORENTER:
+				isSafePoint[pc]= true;
+				break;
+		
+			/* A thread may be suspended at the target of a backward branch (see SWITCH_POINT() in interpreter.c). */
+			case IFEQ: case IFNE: case IFLT: case IFGE: case IFGT: case IFLE:
+			case IF_ICMPEQ: case IF_ICMPNE: case IF_ICMPLT: case IF_ICMPGE: case IF_ICMPGT: case IF_ICMPLE:
+			case IF_ACMPEQ: case IF_ACMPNE:
+			case IFNULL: case IFNONNULL:
+			case GOTO:
+				if( opcode_readU2(code->code+pc+1) < pc )
+					isSafePoint[opcode_readU2(code->code+pc+1)]= true;
+				break;
+		
+			case GOTO_W:
+				if( opcode_readS4(code->code+pc+1) < (int32)pc )
+					isSafePoint[opcode_readS4(code->code+pc+1)]= true;
+				break;
+		}
+	
+		prevOpcode= opcode;
+	}
+}
+
+/* Stores the reference maps of all reachable safe points of the analyzed method. */
+void storeReferenceMaps( Analysis* analysis, method_info* method )
+{
+	Code_attribute* code= analysis->code;
+	uint32 bytesPerMap= (analysis->slotCount + 7) / 8;
+	
+	boolean* isSafePoint= mm_staticMalloc( code->code_length * sizeof(boolean) );
+	findSafePoints( code, isSafePoint );
+	
+	/* count safe points first */
+	uint32 count= 0;
+	uint32 pc;
+	for( pc= 0; pc < code->code_length; pc++ )
+		if( analysis->states[pc] != NULL && isSafePoint[pc] )
+			count++;
+	
+	method->reference_map_count= count;
+	method->referenceMaps= mm_staticMalloc( count * (sizeof(ReferenceMap) + 2*bytesPerMap) );
+	uint8* bits= (uint8*)(method->referenceMaps + count);
+	memset( bits, 0, count * 2*bytesPerMap );
+	
+	/* The maps are sorted by their pc. */
+	ReferenceMap* map= method->referenceMaps;
+	for( pc= 0; pc < code->code_length; pc++ )
+	{
+		FrameState* state= analysis->states[pc];
+		
+		if( state != NULL && isSafePoint[pc] )
+		{
+			map->pc= pc;
+			map->stackHeight= state->stackHeight;
+			map->bits= bits;
+			map->wideBits= bits + bytesPerMap;
+			
+			uint32 i;
+			for( i= 0; i < code->max_locals + state->stackHeight; i++ )
+				if( state->types[i] == TYPE_REFERENCE )
+					bits[i >> 3]|= 1 << (i & 7);
+				else if( state->types[i] == TYPE_WIDE )
+					map->wideBits[i >> 3]|= 1 << (i & 7);
+			
+			map++;
+			bits+= 2*bytesPerMap;
+		}
+	}
+		
+	mm_staticFree( isSafePoint );
+}
+
+/* Analyzes the given method, which must have code. Returns false if the method uses subroutines, which aren't supported. The analysis has to be freed
+	afterwards in any case. */
+boolean runAnalysis( Analysis* analysis, Class* cls, method_info* method )
+{
+	Code_attribute* code= method->code;
+	
+	analysis->cls= cls;
+	analysis->code= code;
+	analysis->slotCount= code->max_locals + code->max_stack;
+	analysis->states= mm_staticMalloc( code->code_length * sizeof(FrameState*) );
+	analysis->current.types= mm_staticMalloc( analysis->slotCount );
+	analysis->handler.types= mm_staticMalloc( analysis->slotCount );
+	analysis->worklist= mm_staticMalloc( code->code_length * sizeof(u2) );
+	analysis->worklistCount= 0;
+	analysis->isQueued= mm_staticMalloc( code->code_length * sizeof(boolean) );
+	memset( analysis->states, 0, code->code_length * sizeof(FrameState*) );
+	memset( analysis->isQueued, 0, code->code_length * sizeof(boolean) );
+	
+	/* The parameters are the initial locals, all other locals are unusable until they are stored. */
+	memset( analysis->current.types, TYPE_VALUE, analysis->slotCount );
+	analysis->current.stackHeight= 0;
+	
+	uint32 local= 0;
+	if( !isFlagSet(method->access_flags, ACC_STATIC) )
+	{
+		setLocal( analysis, local, TYPE_REFERENCE );
+		local++;
+	}
+	
+	const char* descriptor= method->descriptor + 1;
+	while( *descriptor != ')' )
+	{
+		uint32 slotCount;
+		setLocal( analysis, local, getNextParameterType(&descriptor, &slotCount) );
+		local+= slotCount;
+	}
+	
+	mergeState( analysis, 0, &analysis->current );
+	
+	boolean isSupported= true;
+	while( analysis->worklistCount > 0 && isSupported )
+	{
+		analysis->worklistCount--;
+		uint32 pc= analysis->worklist[analysis->worklistCount];
+		analysis->isQueued[pc]= false;
+		isSupported= analyzeInstruction( analysis, pc );
+	}
+	
+	return isSupported;
+}
+
+void freeAnalysis( Analysis* analysis )
+{
+	uint32 pc;
+	for( pc= 0; pc < analysis->code->code_length; pc++ )
+		if( analysis->states[pc] != NULL )
+			mm_staticFree( analysis->states[pc] );
+	
+	mm_staticFree( analysis->states );
+	mm_staticFree( analysis->current.types );
+	mm_staticFree( analysis->handler.types );
+	mm_staticFree( analysis->worklist );
+	mm_staticFree( analysis->isQueued );
+}
+
+/* Computes the reference maps of the given method. */
+void rm_computeReferenceMaps( Class* cls, method_info* method )
+{
+	method->hasReferenceMaps= false;
+	method->reference_map_count= 0;
+	method->referenceMaps= NULL;
+	
+	if( method->code == NULL )
+		return;
+	
+	Analysis analysis;
+	
+	if( runAnalysis(&analysis, cls, method) )
+	{
+		storeReferenceMaps( &analysis, method );
+		method->hasReferenceMaps= true;
+		logVerbose( "Computed %i reference maps for method %s%s.\n", method->reference_map_count, method->name, method->descriptor );
+	}
+	else
+	{
+		logVerbose( "--> Method %s%s uses subroutines, its stack frames are scanned conservatively.\n", method->name, method->descriptor );
+	}
+	
+	freeAnalysis( &analysis );
+}
+
+/* Computes the number of operand stack slots before every instruction of the given method, which must have code. Instructions which are never reached get
+	-1. Returns false if the method uses subroutines. Used by the ahead-of-time compiler (see aot.c). */
+boolean rm_computeStackHeights( Class* cls, method_info* method, int32* stackHeights )
+{
+	Analysis analysis;
+	boolean isSupported= runAnalysis( &analysis, cls, method );
+	
+	uint32 pc;
+	for( pc= 0; pc < method->code->code_length; pc++ )
+		stackHeights[pc]= analysis.states[pc] != NULL ? analysis.states[pc]->stackHeight : -1;
+	
+	freeAnalysis( &analysis );
+	return isSupported;
+}
+
+/* Returns the reference map of the safe point at the given pc of the given method, or NULL if there is none. */
+ReferenceMap* rm_getReferenceMap( method_info* method, u2 pc )
+{
+	int32 low= 0;
+	int32 high= method->reference_map_count - 1;
+	
+	while( low <= high )
+	{
+		int32 middle= (low + high) / 2;
+		ReferenceMap* map= method->referenceMaps + middle;
+		
+		if( map->pc == pc )
+			return map;
+		
+		if( map->pc < pc )
+			low= middle + 1;
+		else
+			high= middle - 1;
+	}
+	
+	return NULL;
+}
@@ -0,0 +1,33 @@
+/*
+ *  referenceMap.h
+ *  Reference maps (GC root maps) of the stack frames of a method, computed by a dataflow analysis of the bytecode when the method is loaded.
+ *  
+ *  Copyright (c) 2006, 2007 Daniel Klein. All rights reserved.
+ *  
+ *  Licensed under GPL version 2.
+ *  See here for the full license: http://www.gnu.org/licenses/gpl.html
+ */
+
+#ifndef _referenceMap_h_
+#define _referenceMap_h_
+
+#include "class.h"
+
+/* The types of the local variables and operand stack slots of a stack frame at one safe point (i.e. a pc where the frame may be suspended while the garbage
+	collector runs). */
+typedef struct sReferenceMap
+{
+	u2 pc;
+	u2 stackHeight; /* number of operand stack slots */
+	uint8* bits; /* one bit per local variable followed by one bit per operand stack slot, set if the slot holds a reference */
+	uint8* wideBits; /* the same for the first slots of longs and doubles, which the optimizing compiler needs to enter a loop (see optimizingCompiler.c) */
+} ReferenceMap;
+
+#define rm_isReference( map, index ) (((map)->bits[(index) >> 3] >> ((index) & 7)) & 1)
+#define rm_isWide( map, index ) (((map)->wideBits[(index) >> 3] >> ((index) & 7)) & 1)
+
+void rm_computeReferenceMaps( Class* cls, method_info* method );
+boolean rm_computeStackHeights( Class* cls, method_info* method, int32* stackHeights );
+ReferenceMap* rm_getReferenceMap( method_info* method, u2 pc );
+
+#endif /*_referenceMap_h_*/
@@ -0,0 +1,1211 @@
+/*
+ *  registerInterpreter.c
+ *  Translates the stack bytecode of a method into a three-address register code when the method is loaded, and interprets the register code.
+ *
+ *  The registers are the slots of the stack frame: register i < max_locals is local variable i, and register max_locals + d is the operand stack slot at depth
+ *  d. So the frame of a method looks the same in both interpreters wherever they hand over to each other, and the reference maps, the JIT compiler and the
+ *  garbage collector don't have to know about the register code. The translator keeps an abstract operand stack, whose entries are either a register or a
+ *  constant. Loads of locals and constants only push an entry, which becomes an operand of the instruction consuming it, and a store into a local becomes
+ *  the destination of the instruction which computed the value. So "ILOAD_1; ILOAD_2; IADD; ISTORE_3" is the single instruction "IADD 3, 1, 2".
+ *
+ *  Values are only moved into their operand stack slots (materialized) where the stack interpreter could see the frame: at branches, at branch targets and
+ *  where the register code leaves to the stack interpreter. The register code covers the integer arithmetic, loads and stores of locals, array and field
+ *  accesses and branches, which is what the inner loops of most programs consist of. Everything else (invokes, returns, allocations, longs, floats...) leaves
+ *  to the stack interpreter, which continues in the register code at the next method entry, return address or backward branch (see interpreter.c).
+ *
+ *  Copyright (c) 2006, 2007 Daniel Klein. All rights reserved.
+ *
+ *  Licensed under GPL version 2.
+ *  See here for the full license: http://www.gnu.org/licenses/gpl.html
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "memoryManager.h"
+#include "puraGlobals.h"
+#include "class.h"
+#include "heap.h"
+#include "opcodes.h"
+#include "referenceMap.h"
+#include "garbageCollector.h"
+#include "thread.h"
+#include "scheduler.h"
+#include "jit.h"
+#include "optimizingCompiler.h"
+#include "registerInterpreter.h"
+
+/* kinds of the entries of the abstract operand stack */
+#define OPERAND_REGISTER 0
+#define OPERAND_CONSTANT 1
+
+typedef struct sOperand
+{
+	uint8 kind;
+	u2 reg;
+	int32 constant;
+} Operand;
+
+#define NO_RESULT 0xFFFFFFFF
+#define NO_CONSTANT_FORM 0xFF
+
+typedef struct sRegisterTranslation
+{
+	Class* cls;
+	method_info* method;
+	Code_attribute* code;
+	Operand* stack; /* the abstract operand stack */
+	uint32 height;
+	RegisterInstruction* instructions;
+	uint32 instructionCount;
+	uint32 instructionCapacity;
+	RegisterInstruction* exits; /* instructions which leave to the stack interpreter out of line, appended to the instructions at the end */
+	uint32 exitCount;
+	uint32 exitCapacity;
+	uint32 lastResult; /* index of the last instruction, as long as its result is the topmost entry of the abstract stack, NO_RESULT otherwise */
+} RegisterTranslation;
+
+#define stackRegister( t, depth ) ((u2)((t)->code->max_locals + (depth)))
+
+boolean isRegisterInterpreterEnabled= true;
+
+/* statistics */
+uint32 registerTranslatedMethodCount= 0;
+uint32 registerTranslatedBytecodeCount= 0;
+uint32 registerInstructionTotal= 0;
+
+/* translation */
+
+RegisterInstruction* appendRegisterInstruction( RegisterInstruction** instructions, uint32* count, uint32* capacity, uint8 opcode, u2 a, u2 b, u2 c,
+	int32 constant )
+{
+	if( *count == *capacity )
+	{
+		*capacity*= 2;
+		*instructions= mm_staticReAlloc( *instructions, *capacity * sizeof(RegisterInstruction) );
+	}
+	
+	RegisterInstruction* instruction= *instructions + (*count)++;
+	instruction->opcode= opcode;
+	instruction->isBackwardBranch= false;
+	instruction->a= a;
+	instruction->b= b;
+	instruction->c= c;
+	instruction->pc= 0;
+	instruction->constant= constant;
+	instruction->target= 0;
+	return instruction;
+}
+
+RegisterInstruction* emitRegisterInstruction( RegisterTranslation* t, uint8 opcode, u2 a, u2 b, u2 c, int32 constant )
+{
+	t->lastResult= NO_RESULT;
+	return appendRegisterInstruction( &t->instructions, &t->instructionCount, &t->instructionCapacity, opcode, a, b, c, constant );
+}
+
+/* Emits an instruction which computes the new topmost entry of the abstract stack into its operand stack slot. */
+RegisterInstruction* emitRegisterResult( RegisterTranslation* t, uint8 opcode, u2 b, u2 c, int32 constant )
+{
+	u2 destination= stackRegister( t, t->height );
+	RegisterInstruction* instruction= emitRegisterInstruction( t, opcode, destination, b, c, constant );
+	
+	t->stack[t->height].kind= OPERAND_REGISTER;
+	t->stack[t->height].reg= destination;
+	t->height++;
+	t->lastResult= t->instructionCount - 1;
+	return instruction;
+}
+
+void pushRegisterOperand( RegisterTranslation* t, uint8 kind, u2 reg, int32 constant )
+{
+	t->stack[t->height].kind= kind;
+	t->stack[t->height].reg= reg;
+	t->stack[t->height].constant= constant;
+	t->height++;
+}
+
+/* Moves the entry of the abstract stack at the given depth into its operand stack slot. Entries only refer to the slots of lower depths if these hold their
+   own value, so materializing from the bottom up never overwrites a slot which is still referred to. */
+void materializeOperand( RegisterTranslation* t, uint32 depth )
+{
+	Operand* operand= t->stack + depth;
+	u2 reg= stackRegister( t, depth );
+	
+	if( operand->kind == OPERAND_CONSTANT )
+		emitRegisterInstruction( t, RI_CONST, reg, 0, 0, operand->constant );
+	else if( operand->reg != reg )
+		emitRegisterInstruction( t, RI_MOVE, reg, operand->reg, 0, 0 );
+	else
+		return;
+	
+	operand->kind= OPERAND_REGISTER;
+	operand->reg= reg;
+}
+
+/* Materializes the given number of entries from the bottom of the abstract stack. */
+void materializeOperands( RegisterTranslation* t, uint32 height )
+{
+	uint32 depth;
+	for( depth= 0; depth < height; depth++ )
+		materializeOperand( t, depth );
+}
+
+/* Materializes the entries which refer to the given local, before it is overwritten. */
+void materializeLocalOperands( RegisterTranslation* t, u2 local )
+{
+	uint32 depth;
+	for( depth= 0; depth < t->height; depth++ )
+		if( t->stack[depth].kind == OPERAND_REGISTER && t->stack[depth].reg == local )
+			materializeOperand( t, depth );
+}
+
+/* Returns the register of the entry at the given depth. Constants are materialized. */
+u2 getOperandRegister( RegisterTranslation* t, uint32 depth )
+{
+	if( t->stack[depth].kind == OPERAND_CONSTANT )
+		materializeOperand( t, depth );
+	
+	return t->stack[depth].reg;
+}
+
+/* Emits the out of line instructions which leave to the stack interpreter at the given pc, with the abstract stack materialized, and returns the index of
+   the first one. */
+uint32 emitRegisterExit( RegisterTranslation* t, uint32 pc )
+{
+	uint32 start= t->exitCount;
+	
+	uint32 depth;
+	for( depth= 0; depth < t->height; depth++ )
+	{
+		Operand* operand= t->stack + depth;
+		u2 reg= stackRegister( t, depth );
+		
+		if( operand->kind == OPERAND_CONSTANT )
+			appendRegisterInstruction( &t->exits, &t->exitCount, &t->exitCapacity, RI_CONST, reg, 0, 0, operand->constant );
+		else if( operand->reg != reg )
+			appendRegisterInstruction( &t->exits, &t->exitCount, &t->exitCapacity, RI_MOVE, reg, operand->reg, 0, 0 );
+	}
+	
+	appendRegisterInstruction( &t->exits, &t->exitCount, &t->exitCapacity, RI_EXIT, t->height, 0, 0, 0 )->pc= pc;
+	return start;
+}
+
+/* Stores the topmost entry of the abstract stack into the given local. If the last instruction computed it, that instruction writes the local instead. */
+void translateRegisterStore( RegisterTranslation* t, u2 local )
+{
+	materializeLocalOperands( t, local );
+	
+	t->height--;
+	Operand* operand= t->stack + t->height;
+	
+	if( operand->kind == OPERAND_CONSTANT )
+		emitRegisterInstruction( t, RI_CONST, local, 0, 0, operand->constant );
+	else if( t->lastResult == t->instructionCount - 1 && operand->reg == stackRegister(t, t->height) )
+		t->instructions[t->lastResult].a= local;
+	else if( operand->reg != local )
+		emitRegisterInstruction( t, RI_MOVE, local, operand->reg, 0, 0 );
+	
+	t->lastResult= NO_RESULT;
+}
+
+/* Translates a binary integer operation. If there is a form with a constant and one of the operands is a constant, that form is used (the first operand can
+   only be the constant of commutative operations). */
+void translateRegisterOperation( RegisterTranslation* t, uint8 opcode, uint8 constantOpcode, boolean isCommutative )
+{
+	Operand* first= t->stack + t->height - 2;
+	Operand* second= t->stack + t->height - 1;
+	
+	if( constantOpcode != NO_CONSTANT_FORM && (second->kind == OPERAND_CONSTANT || (isCommutative && first->kind == OPERAND_CONSTANT)) )
+	{
+		if( second->kind != OPERAND_CONSTANT )
+		{
+			Operand swapped= *first;
+			*first= *second;
+			*second= swapped;
+		}
+		
+		int32 constant= second->constant;
+		u2 reg= getOperandRegister( t, t->height - 2 );
+		t->height-= 2;
+		emitRegisterResult( t, constantOpcode, reg, 0, constant );
+		return;
+	}
+	
+	u2 firstReg= getOperandRegister( t, t->height - 2 );
+	u2 secondReg= getOperandRegister( t, t->height - 1 );
+	t->height-= 2;
+	emitRegisterResult( t, opcode, firstReg, secondReg, 0 );
+}
+
+void translateRegisterUnaryOperation( RegisterTranslation* t, uint8 opcode )
+{
+	u2 reg= getOperandRegister( t, t->height - 1 );
+	t->height--;
+	emitRegisterResult( t, opcode, reg, 0, 0 );
+}
+
+/* Translates a conditional branch, which compares the given number of operands (one operand is compared to zero). The condition is the offset from IFEQ or
+   IF_ICMPEQ. */
+void translateRegisterBranch( RegisterTranslation* t, uint32 condition, uint32 operandCount, uint32 pc, uint32 target )
+{
+	/* the condition with the operands swapped, e.g. "c < x" is "x > c" */
+	static const uint8 swappedConditions[6]= { 0, 1, 4, 5, 2, 3 };
+	
+	materializeOperands( t, t->height - operandCount );
+	
+	RegisterInstruction* instruction;
+	if( operandCount == 1 )
+		instruction= emitRegisterInstruction( t, RI_IFEQ_CONST + condition, getOperandRegister(t, t->height - 1), 0, 0, 0 );
+	else
+	{
+		Operand* first= t->stack + t->height - 2;
+		Operand* second= t->stack + t->height - 1;
+		
+		if( second->kind == OPERAND_CONSTANT )
+			instruction= emitRegisterInstruction( t, RI_IFEQ_CONST + condition, getOperandRegister(t, t->height - 2), 0, 0, second->constant );
+		else if( first->kind == OPERAND_CONSTANT )
+			instruction= emitRegisterInstruction( t, RI_IFEQ_CONST + swappedConditions[condition], second->reg, 0, 0, first->constant );
+		else
+			instruction= emitRegisterInstruction( t, RI_IF_ICMPEQ + condition, first->reg, second->reg, 0, 0 );
+	}
+	
+	t->height-= operandCount;
+	instruction->pc= target;
+	instruction->isBackwardBranch= target < pc;
+}
+
+/* Returns true if the field referenced by the given Fieldref constant pool entry occupies one slot. */
+boolean isOneSlotFieldref( Class* cls, u2 index )
+{
+	CONSTANT_Fieldref_info* ref= (CONSTANT_Fieldref_info*)cls->constant_pool[index];
+	char type= cls_resolveConstantPoolIndexToNameAndType( cls, ref->name_and_type_index )->descriptor[0];
+	return type != BASE_TYPE_LONG && type != BASE_TYPE_DOUBLE;
+}
+
+/* Translates the instruction at the given pc. Returns false if it doesn't fall through to the next instruction. Instructions which aren't supported leave
+   to the stack interpreter. */
+boolean translateRegisterInstruction( RegisterTranslation* t, uint32 pc )
+{
+	byte* code= t->code->code;
+	uint8 opcode= code[pc];
+	u2 index;
+	
+	switch( opcode )
+	{
+		case NOP:
+			return true;
+		
+		/* constants */
+		
+		case ACONST_NULL:
+			pushRegisterOperand( t, OPERAND_CONSTANT, 0, NULL_REFERENCE );
+			return true;
+		
+		case ICONST_M1: case ICONST_0: case ICONST_1: case ICONST_2: case ICONST_3: case ICONST_4: case ICONST_5:
+			pushRegisterOperand( t, OPERAND_CONSTANT, 0, (int32)opcode - ICONST_0 );
+			return true;
+		
+		case BIPUSH:
+			pushRegisterOperand( t, OPERAND_CONSTANT, 0, (int8)code[pc+1] );
+			return true;
+		
+		case SIPUSH:
+			pushRegisterOperand( t, OPERAND_CONSTANT, 0, opcode_readS2(code+pc+1) );
+			return true;
+		
+		case LDC:
+		case LDC_W:
+		{
+			index= opcode == LDC ? code[pc+1] : opcode_readU2( code+pc+1 );
+			uint8 tag= t->cls->constant_pool[index]->tag;
+			
+			if( tag != CONSTANT_Integer && tag != CONSTANT_Float )
+				break;
+			
+			pushRegisterOperand( t, OPERAND_CONSTANT, 0, cls_getItemFromConstantPool(t->cls, index) );
+			return true;
+		}
+		
+		/* locals */
+		
+		case ILOAD: case FLOAD: case ALOAD:
+			pushRegisterOperand( t, OPERAND_REGISTER, code[pc+1], 0 );
+			return true;
+		
+		case LLOAD: case DLOAD:
+			pushRegisterOperand( t, OPERAND_REGISTER, code[pc+1], 0 );
+			pushRegisterOperand( t, OPERAND_REGISTER, code[pc+1] + 1, 0 );
+			return true;
+		
+		case ILOAD_0: case ILOAD_1: case ILOAD_2: case ILOAD_3:
+			pushRegisterOperand( t, OPERAND_REGISTER, opcode - ILOAD_0, 0 );
+			return true;
+		
+		case FLOAD_0: case FLOAD_1: case FLOAD_2: case FLOAD_3:
+			pushRegisterOperand( t, OPERAND_REGISTER, opcode - FLOAD_0, 0 );
+			return true;
+		
+		case ALOAD_0: case ALOAD_1: case ALOAD_2: case ALOAD_3:
+			pushRegisterOperand( t, OPERAND_REGISTER, opcode - ALOAD_0, 0 );
+			return true;
+		
+		case LLOAD_0: case LLOAD_1: case LLOAD_2: case LLOAD_3:
+		case DLOAD_0: case DLOAD_1: case DLOAD_2: case DLOAD_3:
+			index= (opcode - LLOAD_0) % 4;
+			pushRegisterOperand( t, OPERAND_REGISTER, index, 0 );
+			pushRegisterOperand( t, OPERAND_REGISTER, index + 1, 0 );
+			return true;
+		
+		case ISTORE: case FSTORE: case ASTORE:
+			translateRegisterStore( t, code[pc+1] );
+			return true;
+		
+		case LSTORE: case DSTORE:
+			translateRegisterStore( t, code[pc+1] + 1 );
+			translateRegisterStore( t, code[pc+1] );
+			return true;
+		
+		case ISTORE_0: case ISTORE_1: case ISTORE_2: case ISTORE_3:
+			translateRegisterStore( t, opcode - ISTORE_0 );
+			return true;
+		
+		case FSTORE_0: case FSTORE_1: case FSTORE_2: case FSTORE_3:
+			translateRegisterStore( t, opcode - FSTORE_0 );
+			return true;
+		
+		case ASTORE_0: case ASTORE_1: case ASTORE_2: case ASTORE_3:
+			translateRegisterStore( t, opcode - ASTORE_0 );
+			return true;
+		
+		case LSTORE_0: case LSTORE_1: case LSTORE_2: case LSTORE_3:
+		case DSTORE_0: case DSTORE_1: case DSTORE_2: case DSTORE_3:
+			index= (opcode - LSTORE_0) % 4;
+			translateRegisterStore( t, index + 1 );
+			translateRegisterStore( t, index );
+			return true;
+		
+		case IINC:
+			materializeLocalOperands( t, code[pc+1] );
+			emitRegisterInstruction( t, RI_IADD_CONST, code[pc+1], code[pc+1], 0, (int8)code[pc+2] );
+			return true;
+		
+		case WIDE:
+		{
+			/* The index and the constant of IINC are native-endian (see opcode_predecode()). */
+			index= opcode_readU2( code+pc+2 );
+			
+			switch( code[pc+1] )
+			{
+				case ILOAD: case FLOAD: case ALOAD:
+					pushRegisterOperand( t, OPERAND_REGISTER, index, 0 );
+					return true;
+				case ISTORE: case FSTORE: case ASTORE:
+					translateRegisterStore( t, index );
+					return true;
+				case IINC:
+					materializeLocalOperands( t, index );
+					emitRegisterInstruction( t, RI_IADD_CONST, index, index, 0, opcode_readS2(code+pc+4) );
+					return true;
+			}
+			break;
+		}
+		
+		/* operand stack */
+		
+		case POP:
+			t->height--;
+			return true;
+		
+		case POP2:
+			t->height-= 2;
+			return true;
+		
+		case DUP:
+			t->stack[t->height]= t->stack[t->height - 1];
+			t->height++;
+			return true;
+		
+		case DUP2:
+			t->stack[t->height]= t->stack[t->height - 2];
+			t->stack[t->height + 1]= t->stack[t->height - 1];
+			t->height+= 2;
+			return true;
+		
+		/* arithmetic */
+		
+		case IADD:
+			translateRegisterOperation( t, RI_IADD, RI_IADD_CONST, true );
+			return true;
+		
+		case ISUB:
+			/* subtracting a constant is adding its negation, which wraps around for the smallest integer just like the subtraction */
+			if( t->stack[t->height - 1].kind == OPERAND_CONSTANT )
+			{
+				t->stack[t->height - 1].constant= (int32)(0u - (uint32)t->stack[t->height - 1].constant);
+				translateRegisterOperation( t, RI_IADD, RI_IADD_CONST, false );
+			}
+			else
+				translateRegisterOperation( t, RI_ISUB, NO_CONSTANT_FORM, false );
+			return true;
+		
+		case IMUL:
+			translateRegisterOperation( t, RI_IMUL, RI_IMUL_CONST, true );
+			return true;
+		
+		case IDIV:
+			translateRegisterOperation( t, RI_IDIV, NO_CONSTANT_FORM, false );
+			return true;
+		
+		case IREM:
+			translateRegisterOperation( t, RI_IREM, NO_CONSTANT_FORM, false );
+			return true;
+		
+		case IAND:
+			translateRegisterOperation( t, RI_IAND, RI_IAND_CONST, true );
+			return true;
+		
+		case IOR:
+			translateRegisterOperation( t, RI_IOR, RI_IOR_CONST, true );
+			return true;
+		
+		case IXOR:
+			translateRegisterOperation( t, RI_IXOR, RI_IXOR_CONST, true );
+			return true;
+		
+		case ISHL:
+			translateRegisterOperation( t, RI_ISHL, RI_ISHL_CONST, false );
+			return true;
+		
+		case ISHR:
+			translateRegisterOperation( t, RI_ISHR, RI_ISHR_CONST, false );
+			return true;
+		
+		case IUSHR:
+			translateRegisterOperation( t, RI_IUSHR, RI_IUSHR_CONST, false );
+			return true;
+		
+		case INEG:
+			translateRegisterUnaryOperation( t, RI_INEG );
+			return true;
+		
+		case I2B:
+			translateRegisterUnaryOperation( t, RI_I2B );
+			return true;
+		
+		case I2C:
+			translateRegisterUnaryOperation( t, RI_I2C );
+			return true;
+		
+		case I2S:
+			translateRegisterUnaryOperation( t, RI_I2S );
+			return true;
+		
+		/* arrays */
+		
+		case IALOAD: case FALOAD: case AALOAD:
+		case BALOAD:
+		case CALOAD:
+		{
+			u2 arrayReg= getOperandRegister( t, t->height - 2 );
+			u2 indexReg= getOperandRegister( t, t->height - 1 );
+			t->height-= 2;
+			emitRegisterResult( t, opcode == BALOAD ? RI_BALOAD : opcode == CALOAD ? RI_CALOAD : RI_IALOAD, arrayReg, indexReg, 0 );
+			return true;
+		}
+		
+		case IASTORE: case FASTORE:
+		case BASTORE:
+		case CASTORE:
+		{
+			u2 arrayReg= getOperandRegister( t, t->height - 3 );
+			u2 indexReg= getOperandRegister( t, t->height - 2 );
+			u2 valueReg= getOperandRegister( t, t->height - 1 );
+			t->height-= 3;
+			emitRegisterInstruction( t, opcode == BASTORE ? RI_BASTORE : opcode == CASTORE ? RI_CASTORE : RI_IASTORE, arrayReg, indexReg, valueReg, 0 );
+			return true;
+		}
+		
+		case ARRAYLENGTH:
+			translateRegisterUnaryOperation( t, RI_ARRAYLENGTH );
+			return true;
+		
+		/* fields, only as long as they occupy one slot: the instructions check at run time if they have been quickened */
+		
+		case GETFIELD:
+		{
+			if( !isOneSlotFieldref(t->cls, opcode_readU2(code+pc+1)) )
+				break;
+			
+			u2 objectReg= getOperandRegister( t, t->height - 1 );
+			uint32 exit= emitRegisterExit( t, pc );
+			t->height--;
+			
+			RegisterInstruction* instruction= emitRegisterResult( t, RI_GETFIELD, objectReg, 0, 0 );
+			instruction->pc= pc;
+			instruction->target= exit;
+			return true;
+		}
+		
+		case PUTFIELD:
+		{
+			if( !isOneSlotFieldref(t->cls, opcode_readU2(code+pc+1)) )
+				break;
+			
+			u2 objectReg= getOperandRegister( t, t->height - 2 );
+			u2 valueReg= getOperandRegister( t, t->height - 1 );
+			uint32 exit= emitRegisterExit( t, pc );
+			t->height-= 2;
+			
+			RegisterInstruction* instruction= emitRegisterInstruction( t, RI_PUTFIELD, objectReg, valueReg, 0, 0 );
+			instruction->pc= pc;
+			instruction->target= exit;
+			return true;
+		}
+		
+		case GETSTATIC:
+		{
+			if( !isOneSlotFieldref(t->cls, opcode_readU2(code+pc+1)) )
+				break;
+			
+			uint32 exit= emitRegisterExit( t, pc );
+			RegisterInstruction* instruction= emitRegisterResult( t, RI_GETSTATIC, 0, 0, 0 );
+			instruction->pc= pc;
+			instruction->target= exit;
+			return true;
+		}
+		
+		case PUTSTATIC:
+		{
+			if( !isOneSlotFieldref(t->cls, opcode_readU2(code+pc+1)) )
+				break;
+			
+			u2 valueReg= getOperandRegister( t, t->height - 1 );
+			uint32 exit= emitRegisterExit( t, pc );
+			t->height--;
+			
+			RegisterInstruction* instruction= emitRegisterInstruction( t, RI_PUTSTATIC, valueReg, 0, 0, 0 );
+			instruction->pc= pc;
+			instruction->target= exit;
+			return true;
+		}
+		
+		/* branches, the targets are absolute (see opcode_predecode()) */
+		
+		case IFEQ: case IFNE: case IFLT: case IFGE: case IFGT: case IFLE:
+			translateRegisterBranch( t, opcode - IFEQ, 1, pc, opcode_readU2(code+pc+1) );
+			return true;
+		
+		case IF_ICMPEQ: case IF_ICMPNE: case IF_ICMPLT: case IF_ICMPGE: case IF_ICMPGT: case IF_ICMPLE:
+			translateRegisterBranch( t, opcode - IF_ICMPEQ, 2, pc, opcode_readU2(code+pc+1) );
+			return true;
+		
+		/* references are compared like integers */
+		case IF_ACMPEQ: case IF_ACMPNE:
+			translateRegisterBranch( t, opcode - IF_ACMPEQ, 2, pc, opcode_readU2(code+pc+1) );
+			return true;
+		
+		case IFNULL: case IFNONNULL:
+			translateRegisterBranch( t, opcode - IFNULL, 1, pc, opcode_readU2(code+pc+1) );
+			return true;
+		
+		case GOTO:
+		case GOTO_W:
+		{
+			uint32 target= opcode == GOTO ? opcode_readU2( code+pc+1 ) : (uint32)opcode_readS4( code+pc+1 );
+			materializeOperands( t, t->height );
+			
+			RegisterInstruction* instruction= emitRegisterInstruction( t, RI_GOTO, 0, 0, 0, 0 );
+			instruction->pc= target;
+			instruction->isBackwardBranch= target < pc;
+			return false;
+		}
+	}
+	
+	/* not supported: the stack interpreter continues with the frame as it expects it */
+	materializeOperands( t, t->height );
+	emitRegisterInstruction( t, RI_EXIT, t->height, 0, 0, 0 )->pc= pc;
+	return false;
+}
+
+/* Marks the branch targets and exception handlers of the given code, at which the abstract stack has to be materialized. */
+void markRegisterLeaders( Code_attribute* code, int32* stackHeights, boolean* isLeader )
+{
+	uint32 pc;
+	for( pc= 0; pc < code->code_length; pc+= opcode_getInstructionLength(code->code, pc) )
+	{
+		if( stackHeights[pc] < 0 )
+			continue;
+		
+		uint8 opcode= code->code[pc];
+		if( (opcode >= IFEQ && opcode <= GOTO) || opcode == IFNULL || opcode == IFNONNULL )
+			isLeader[opcode_readU2(code->code + pc + 1)]= true;
+		else if( opcode == GOTO_W )
+			isLeader[opcode_readS4(code->code + pc + 1)]= true;
+		else if( opcode == TABLESWITCH || opcode == LOOKUPSWITCH )
+		{
+			/* the aligned table: default target, low and high or the number of pairs, then the targets or the match/target pairs */
+			const int32* operands= (const int32*)(code->code + ((pc + 4) & ~3));
+			isLeader[operands[0]]= true;
+			
+			int32 i;
+			if( opcode == TABLESWITCH )
+				for( i= 0; i < operands[2] - operands[1] + 1; i++ )
+					isLeader[operands[3 + i]]= true;
+			else
+				for( i= 0; i < operands[1]; i++ )
+					isLeader[operands[3 + 2*i]]= true;
+		}
+	}
+	
+	uint32 i;
+	for( i= 0; i < code->exception_table_length; i++ )
+		isLeader[code->exception_table_tab[i]->handler_pc]= true;
+}
+
+/* Translates the given method into register code. Methods which have been compiled ahead of time or use subroutines (JSR/RET) are left to the stack
+   interpreter. */
+void ri_translate( Class* cls, method_info* method )
+{
+	Code_attribute* code= method->code;
+	
+	if( !isRegisterInterpreterEnabled || code == NULL || method->aotCode != NULL || code->max_locals + code->max_stack > 0xFFFF )
+		return;
+	
+	int32* stackHeights= mm_staticMalloc( code->code_length * sizeof(int32) );
+	if( !rm_computeStackHeights(cls, method, stackHeights) )
+	{
+		mm_staticFree( stackHeights );
+		return;
+	}
+	
+	boolean* isLeader= mm_staticMalloc( code->code_length * sizeof(boolean) );
+	memset( isLeader, 0, code->code_length * sizeof(boolean) );
+	markRegisterLeaders( code, stackHeights, isLeader );
+	
+	int32* entries= mm_staticMalloc( code->code_length * sizeof(int32) );
+	uint32 pc;
+	for( pc= 0; pc < code->code_length; pc++ )
+		entries[pc]= NO_REGISTER_ENTRY;
+	
+	RegisterTranslation translation;
+	RegisterTranslation* t= &translation;
+	t->cls= cls;
+	t->method= method;
+	t->code= code;
+	t->stack= mm_staticMalloc( (code->max_stack + 1) * sizeof(Operand) );
+	t->height= 0;
+	t->instructionCapacity= 16;
+	t->instructionCount= 0;
+	t->instructions= mm_staticMalloc( t->instructionCapacity * sizeof(RegisterInstruction) );
+	t->exitCapacity= 4;
+	t->exitCount= 0;
+	t->exits= mm_staticMalloc( t->exitCapacity * sizeof(RegisterInstruction) );
+	t->lastResult= NO_RESULT;
+	
+	/* The register code is entered at the start of the method, at branch targets and behind instructions which left to the stack interpreter (i.e. at return
+	   addresses). */
+	boolean isFallingThrough= false;
+	uint32 bytecodeCount= 0;
+	for( pc= 0; pc < code->code_length; pc+= opcode_getInstructionLength(code->code, pc) )
+	{
+		if( stackHeights[pc] < 0 )
+		{
+			isFallingThrough= false;
+			continue;
+		}
+		
+		if( isLeader[pc] || !isFallingThrough )
+		{
+			if( isFallingThrough )
+				materializeOperands( t, t->height );
+			
+			t->height= stackHeights[pc];
+			
+			uint32 depth;
+			for( depth= 0; depth < t->height; depth++ )
+			{
+				t->stack[depth].kind= OPERAND_REGISTER;
+				t->stack[depth].reg= stackRegister( t, depth );
+			}
+			
+			t->lastResult= NO_RESULT;
+			entries[pc]= t->instructionCount;
+		}
+		
+		isFallingThrough= translateRegisterInstruction( t, pc );
+		bytecodeCount++;
+	}
+	
+	/* Branches continue at the entry of their target, and the exits are appended behind the instructions. */
+	uint32 i;
+	for( i= 0; i < t->instructionCount; i++ )
+	{
+		RegisterInstruction* instruction= t->instructions + i;
+		
+		if( instruction->opcode >= RI_IF_ICMPEQ && instruction->opcode <= RI_GOTO )
+			instruction->target= entries[instruction->pc];
+		else if( instruction->opcode >= RI_GETFIELD && instruction->opcode <= RI_PUTSTATIC )
+			instruction->target+= t->instructionCount;
+	}
+	
+	RegisterCode* registerCode= mm_staticMalloc( sizeof(RegisterCode) );
+	registerCode->instructionCount= t->instructionCount + t->exitCount;
+	registerCode->instructions= mm_staticMalloc( registerCode->instructionCount * sizeof(RegisterInstruction) );
+	memcpy( registerCode->instructions, t->instructions, t->instructionCount * sizeof(RegisterInstruction) );
+	memcpy( registerCode->instructions + t->instructionCount, t->exits, t->exitCount * sizeof(RegisterInstruction) );
+	registerCode->entries= entries;
+	registerCode->stackHeights= stackHeights;
+	method->registerCode= registerCode;
+	
+	registerTranslatedMethodCount++;
+	registerTranslatedBytecodeCount+= bytecodeCount;
+	registerInstructionTotal+= registerCode->instructionCount;
+	
+	logVerbose( "Translated %s.%s%s into %i register instructions.\n", cls->className, method->name, method->descriptor, registerCode->instructionCount );
+	
+	mm_staticFree( t->instructions );
+	mm_staticFree( t->exits );
+	mm_staticFree( t->stack );
+	mm_staticFree( isLeader );
+}
+
+/* execution */
+
+/* Instruction handler entry and exit, like the opcode handlers of the stack interpreter (see interpreter.c). */
+#ifdef THREADED_DISPATCH_ENABLED
+#define INSTRUCTION(op) case op: op##_HANDLER
+#define NEXT_INSTRUCTION goto *dispatchTable[ip->opcode]
+#else
+#define INSTRUCTION(op) case op
+#define NEXT_INSTRUCTION break
+#endif
+
+#define R( index ) registers[(index)]
+#define S( index ) ((int32)registers[(index)])
+
+/* Leaves to the stack interpreter, which continues at the given pc with the given number of operand stack slots. */
+#define LEAVE_REGISTER_CODE( exitPc, stackHeight ) \
+	do { \
+		sf->pc= code + (exitPc); \
+		stack->stackPointer= registers + method->code->max_locals + (stackHeight); \
+	} while( false )
+
+/* Backward branch to the current instruction's target: a safe point and switch point like in the interpreter (see SAFE_POINT() in interpreter.c), which
+   counts the loop iterations of the mixed mode, too. A hot loop continues in the stack interpreter at the loop header, where it enters the machine code. */
+#ifdef JIT_ENABLED
+#define COUNT_BACKWARD_BRANCH() \
+	do { \
+		if( isJitEnabled ) \
+		{ \
+			uint32 backwardBranchCount= ++method->backwardBranchCount; \
+			if( backwardBranchCount == jitBackwardBranchThreshold && method->compiledMethod == NULL ) \
+				jit_compile( method ); \
+			if( backwardBranchCount == optimizationBackwardBranchThreshold ) \
+				opt_compileLoop( method, ip->pc ); \
+			if( method->compiledMethod != NULL || method->loopOptimizedMethods != NULL ) \
+			{ \
+				LEAVE_REGISTER_CODE( ip->pc, registerCode->stackHeights[ip->pc] ); \
+				return false; \
+			} \
+		} \
+	} while( false )
+#else
+#define COUNT_BACKWARD_BRANCH()
+#endif
+
+#define BRANCH() \
+	do { \
+		if( ip->isBackwardBranch ) \
+		{ \
+			if( isStopTheWorldRequested || (isSwitchingAllowed && sched_isSwitchDue()) ) \
+			{ \
+				LEAVE_REGISTER_CODE( ip->pc, registerCode->stackHeights[ip->pc] ); \
+				if( !isStopTheWorldRequested ) \
+					return true; \
+				thread_enterSafePoint(); \
+			} \
+			COUNT_BACKWARD_BRANCH(); \
+		} \
+		ip= instructions + ip->target; \
+	} while( false )
+
+#define CONDITIONAL_BRANCH( condition ) \
+	do { \
+		if( condition ) \
+			BRANCH(); \
+		else \
+			ip++; \
+	} while( false )
+
+/* Runs the register code of the current method, starting at the stored pc of the frame. Like the compiled code of the JIT compiler, it returns with the pc and
+   the stack pointer stored, true if the current green thread should give up its worker and false if the stack interpreter should continue at the stored pc.
+   Without an entry at the stored pc, it returns right away. */
+boolean ri_run( Stack* stack, StackFrame* sf, boolean isSwitchingAllowed )
+{
+	method_info* method= sf->methodInfo;
+	RegisterCode* registerCode= method->registerCode;
+	byte* code= method->code->code;
+	
+	int32 entry= registerCode->entries[sf->pc - code];
+	if( entry == NO_REGISTER_ENTRY )
+		return false;
+
+#ifdef THREADED_DISPATCH_ENABLED
+	/* handler addresses, indexed by register opcode */
+	static const void* dispatchTable[RI_OPCODE_COUNT]= {
+		&&RI_MOVE_HANDLER, &&RI_CONST_HANDLER, &&RI_IADD_HANDLER, &&RI_ISUB_HANDLER, &&RI_IMUL_HANDLER, &&RI_IDIV_HANDLER, &&RI_IREM_HANDLER,
+		&&RI_IAND_HANDLER, &&RI_IOR_HANDLER, &&RI_IXOR_HANDLER, &&RI_ISHL_HANDLER, &&RI_ISHR_HANDLER, &&RI_IUSHR_HANDLER, &&RI_IADD_CONST_HANDLER,
+		&&RI_IMUL_CONST_HANDLER, &&RI_IAND_CONST_HANDLER, &&RI_IOR_CONST_HANDLER, &&RI_IXOR_CONST_HANDLER, &&RI_ISHL_CONST_HANDLER,
+		&&RI_ISHR_CONST_HANDLER, &&RI_IUSHR_CONST_HANDLER, &&RI_INEG_HANDLER, &&RI_I2B_HANDLER, &&RI_I2C_HANDLER, &&RI_I2S_HANDLER,
+		&&RI_IALOAD_HANDLER, &&RI_BALOAD_HANDLER, &&RI_CALOAD_HANDLER, &&RI_IASTORE_HANDLER, &&RI_BASTORE_HANDLER, &&RI_CASTORE_HANDLER,
+		&&RI_ARRAYLENGTH_HANDLER, &&RI_GETFIELD_HANDLER, &&RI_PUTFIELD_HANDLER, &&RI_GETSTATIC_HANDLER, &&RI_PUTSTATIC_HANDLER,
+		&&RI_IF_ICMPEQ_HANDLER, &&RI_IF_ICMPNE_HANDLER, &&RI_IF_ICMPLT_HANDLER, &&RI_IF_ICMPGE_HANDLER, &&RI_IF_ICMPGT_HANDLER,
+		&&RI_IF_ICMPLE_HANDLER, &&RI_IFEQ_CONST_HANDLER, &&RI_IFNE_CONST_HANDLER, &&RI_IFLT_CONST_HANDLER, &&RI_IFGE_CONST_HANDLER,
+		&&RI_IFGT_CONST_HANDLER, &&RI_IFLE_CONST_HANDLER, &&RI_GOTO_HANDLER, &&RI_EXIT_HANDLER
+	};
+#endif
+	
+	slot* registers= (slot*)(sf+1);
+	const RegisterInstruction* instructions= registerCode->instructions;
+	register const RegisterInstruction* ip= instructions + entry;
+	
+	while( true )
+	{
+		switch( ip->opcode )
+		{
+		INSTRUCTION( RI_MOVE ):
+			R( ip->a )= R( ip->b );
+			ip++;
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_CONST ):
+			R( ip->a )= ip->constant;
+			ip++;
+			NEXT_INSTRUCTION;
+		
+		/* integer arithmetic, computed unsigned so that it wraps around like in Java */
+		
+		INSTRUCTION( RI_IADD ):
+			R( ip->a )= R( ip->b ) + R( ip->c );
+			ip++;
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_ISUB ):
+			R( ip->a )= R( ip->b ) - R( ip->c );
+			ip++;
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_IMUL ):
+			R( ip->a )= R( ip->b ) * R( ip->c );
+			ip++;
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_IDIV ):
+		{
+			int32 divisor= S( ip->c );
+			
+			if( divisor == 0 )
+				error( "ArithmeticException: Division by zero." );
+			
+			/* The smallest integer divided by -1 overflows, which Java defines as the smallest integer again. */
+			R( ip->a )= divisor == -1 ? 0u - R( ip->b ) : (slot)(S( ip->b ) / divisor);
+			ip++;
+			NEXT_INSTRUCTION;
+		}
+		
+		INSTRUCTION( RI_IREM ):
+		{
+			int32 divisor= S( ip->c );
+			
+			if( divisor == 0 )
+				error( "ArithmeticException: Division by zero." );
+			
+			R( ip->a )= divisor == -1 ? 0 : (slot)(S( ip->b ) % divisor);
+			ip++;
+			NEXT_INSTRUCTION;
+		}
+		
+		INSTRUCTION( RI_IAND ):
+			R( ip->a )= R( ip->b ) & R( ip->c );
+			ip++;
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_IOR ):
+			R( ip->a )= R( ip->b ) | R( ip->c );
+			ip++;
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_IXOR ):
+			R( ip->a )= R( ip->b ) ^ R( ip->c );
+			ip++;
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_ISHL ):
+			R( ip->a )= R( ip->b ) << (R( ip->c ) & 0x1F);
+			ip++;
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_ISHR ):
+			R( ip->a )= (slot)(S( ip->b ) >> (R( ip->c ) & 0x1F));
+			ip++;
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_IUSHR ):
+			R( ip->a )= R( ip->b ) >> (R( ip->c ) & 0x1F);
+			ip++;
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_IADD_CONST ):
+			R( ip->a )= R( ip->b ) + (slot)ip->constant;
+			ip++;
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_IMUL_CONST ):
+			R( ip->a )= R( ip->b ) * (slot)ip->constant;
+			ip++;
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_IAND_CONST ):
+			R( ip->a )= R( ip->b ) & (slot)ip->constant;
+			ip++;
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_IOR_CONST ):
+			R( ip->a )= R( ip->b ) | (slot)ip->constant;
+			ip++;
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_IXOR_CONST ):
+			R( ip->a )= R( ip->b ) ^ (slot)ip->constant;
+			ip++;
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_ISHL_CONST ):
+			R( ip->a )= R( ip->b ) << (ip->constant & 0x1F);
+			ip++;
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_ISHR_CONST ):
+			R( ip->a )= (slot)(S( ip->b ) >> (ip->constant & 0x1F));
+			ip++;
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_IUSHR_CONST ):
+			R( ip->a )= R( ip->b ) >> (ip->constant & 0x1F);
+			ip++;
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_INEG ):
+			R( ip->a )= 0u - R( ip->b );
+			ip++;
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_I2B ):
+			R( ip->a )= (slot)(int32)(int8)R( ip->b );
+			ip++;
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_I2C ):
+			R( ip->a )= (uint16)R( ip->b );
+			ip++;
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_I2S ):
+			R( ip->a )= (slot)(int32)(int16)R( ip->b );
+			ip++;
+			NEXT_INSTRUCTION;
+		
+		/* arrays, checked like in the stack interpreter */
+		
+		INSTRUCTION( RI_IALOAD ):
+		INSTRUCTION( RI_BALOAD ):
+		INSTRUCTION( RI_CALOAD ):
+		{
+			reference arRef= R( ip->b );
+			int32 index= S( ip->c );
+			
+			if( arRef == NULL_REFERENCE )
+				error( "NullPointerException" );
+			if( index < 0 || index >= heap_getArraySize(arRef) )
+				error( "ArrayIndexOutOfBoundsException" );
+			
+			if( ip->opcode == RI_IALOAD )
+				R( ip->a )= heap_getSlotFromArray( arRef, index );
+			else if( ip->opcode == RI_BALOAD )
+				R( ip->a )= heap_getByteFromArray( arRef, index );
+			else
+				R( ip->a )= heap_getShortFromArray( arRef, index );
+			
+			ip++;
+			NEXT_INSTRUCTION;
+		}
+		
+		INSTRUCTION( RI_IASTORE ):
+		INSTRUCTION( RI_BASTORE ):
+		INSTRUCTION( RI_CASTORE ):
+		{
+			reference arRef= R( ip->a );
+			int32 index= S( ip->b );
+			
+			if( arRef == NULL_REFERENCE )
+				error( "NullPointerException" );
+			if( index < 0 || index >= heap_getArraySize(arRef) )
+				error( "ArrayIndexOutOfBoundsException" );
+			
+			if( ip->opcode == RI_IASTORE )
+				heap_setSlotInArray( arRef, index, R(ip->c) );
+			else if( ip->opcode == RI_BASTORE )
+				heap_setByteInArray( arRef, index, R(ip->c) );
+			else
+				heap_setShortInArray( arRef, index, R(ip->c) );
+			
+			ip++;
+			NEXT_INSTRUCTION;
+		}
+		
+		INSTRUCTION( RI_ARRAYLENGTH ):
+		{
+			reference arRef= R( ip->b );
+			
+			if( arRef == NULL_REFERENCE )
+				error( "NullPointerException" );
+			
+			R( ip->a )= heap_getArraySize( arRef );
+			ip++;
+			NEXT_INSTRUCTION;
+		}
+		
+		/* fields: the stack interpreter resolves and quickens the instruction the first time (see quickenFieldAccess() in interpreter.c) */
+		
+		INSTRUCTION( RI_GETFIELD ):
+			if( code[ip->pc] != GETFIELD_QUICK )
+			{
+				ip= instructions + ip->target;
+				NEXT_INSTRUCTION;
+			}
+			
+			R( ip->a )= heap_getInstanceSlots( R(ip->b) )[opcode_readU2( code + ip->pc + 1 )];
+			ip++;
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_PUTFIELD ):
+		{
+			uint8 opcode= code[ip->pc];
+			if( opcode != PUTFIELD_QUICK && opcode != APUTFIELD_QUICK )
+			{
+				ip= instructions + ip->target;
+				NEXT_INSTRUCTION;
+			}
+			
+			reference ref= R( ip->a );
+			slot value= R( ip->b );
+			heap_getInstanceSlots( ref )[opcode_readU2( code + ip->pc + 1 )]= value;
+			
+			if( opcode == APUTFIELD_QUICK )
+				heap_writeBarrier( ref, value );
+			ip++;
+			NEXT_INSTRUCTION;
+		}
+		
+		INSTRUCTION( RI_GETSTATIC ):
+		{
+			if( code[ip->pc] != GETSTATIC_QUICK )
+			{
+				ip= instructions + ip->target;
+				NEXT_INSTRUCTION;
+			}
+			
+			CONSTANT_Fieldref_info* fieldref= (CONSTANT_Fieldref_info*)sf->currentClass->constant_pool[opcode_readU2( code + ip->pc + 1 )];
+			R( ip->a )= fieldref->class->class_inctance_variable_slots[fieldref->variableInfo->slot_index];
+			ip++;
+			NEXT_INSTRUCTION;
+		}
+		
+		INSTRUCTION( RI_PUTSTATIC ):
+		{
+			if( code[ip->pc] != PUTSTATIC_QUICK )
+			{
+				ip= instructions + ip->target;
+				NEXT_INSTRUCTION;
+			}
+			
+			CONSTANT_Fieldref_info* fieldref= (CONSTANT_Fieldref_info*)sf->currentClass->constant_pool[opcode_readU2( code + ip->pc + 1 )];
+			fieldref->class->class_inctance_variable_slots[fieldref->variableInfo->slot_index]= R( ip->a );
+			ip++;
+			NEXT_INSTRUCTION;
+		}
+		
+		/* branches */
+		
+		INSTRUCTION( RI_IF_ICMPEQ ):
+			CONDITIONAL_BRANCH( S(ip->a) == S(ip->b) );
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_IF_ICMPNE ):
+			CONDITIONAL_BRANCH( S(ip->a) != S(ip->b) );
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_IF_ICMPLT ):
+			CONDITIONAL_BRANCH( S(ip->a) < S(ip->b) );
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_IF_ICMPGE ):
+			CONDITIONAL_BRANCH( S(ip->a) >= S(ip->b) );
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_IF_ICMPGT ):
+			CONDITIONAL_BRANCH( S(ip->a) > S(ip->b) );
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_IF_ICMPLE ):
+			CONDITIONAL_BRANCH( S(ip->a) <= S(ip->b) );
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_IFEQ_CONST ):
+			CONDITIONAL_BRANCH( S(ip->a) == ip->constant );
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_IFNE_CONST ):
+			CONDITIONAL_BRANCH( S(ip->a) != ip->constant );
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_IFLT_CONST ):
+			CONDITIONAL_BRANCH( S(ip->a) < ip->constant );
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_IFGE_CONST ):
+			CONDITIONAL_BRANCH( S(ip->a) >= ip->constant );
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_IFGT_CONST ):
+			CONDITIONAL_BRANCH( S(ip->a) > ip->constant );
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_IFLE_CONST ):
+			CONDITIONAL_BRANCH( S(ip->a) <= ip->constant );
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_GOTO ):
+			BRANCH();
+			NEXT_INSTRUCTION;
+		
+		INSTRUCTION( RI_EXIT ):
+			LEAVE_REGISTER_CODE( ip->pc, ip->a );
+			return false;
+		
+		default:
+			error( "Unknown register instruction!" );
+		}
+	}
+	
+	return false;
+}
+
+void ri_printStatistics()
+{
+	if( !isRegisterInterpreterEnabled )
+		return;
+	
+	printf( "\nRegister Interpreter Statistics:\n" );
+	printf( "Translated methods: %i, %i bytecode instructions into %i register instructions\n", registerTranslatedMethodCount,
+		registerTranslatedBytecodeCount, registerInstructionTotal );
+}
@@ -0,0 +1,107 @@
+/*
+ *  registerInterpreter.h
+ *  Translates the stack bytecode of a method into a three-address register code when the method is loaded, and interprets the register code. Locals and
+ *  operand stack slots are the registers, so the frame layout is the same for both interpreters.
+ *
+ *  Copyright (c) 2006, 2007 Daniel Klein. All rights reserved.
+ *
+ *  Licensed under GPL version 2.
+ *  See here for the full license: http://www.gnu.org/licenses/gpl.html
+ */
+
+#ifndef _registerInterpreter_h_
+#define _registerInterpreter_h_
+
+#include "puraGlobals.h"
+#include "types.h"
+#include "class.h"
+#include "stack.h"
+
+/* register instructions: A is the destination register (or the first operand of instructions without a result), B and C are the operand registers, K is the
+   constant of the instruction, pc is the bytecode pc of the instruction or of the branch target */
+#define RI_MOVE 0 /* A= B */
+#define RI_CONST 1 /* A= K */
+#define RI_IADD 2 /* A= B + C */
+#define RI_ISUB 3
+#define RI_IMUL 4
+#define RI_IDIV 5
+#define RI_IREM 6
+#define RI_IAND 7
+#define RI_IOR 8
+#define RI_IXOR 9
+#define RI_ISHL 10
+#define RI_ISHR 11
+#define RI_IUSHR 12
+#define RI_IADD_CONST 13 /* A= B + K */
+#define RI_IMUL_CONST 14
+#define RI_IAND_CONST 15
+#define RI_IOR_CONST 16
+#define RI_IXOR_CONST 17
+#define RI_ISHL_CONST 18
+#define RI_ISHR_CONST 19
+#define RI_IUSHR_CONST 20
+#define RI_INEG 21 /* A= -B */
+#define RI_I2B 22
+#define RI_I2C 23
+#define RI_I2S 24
+#define RI_IALOAD 25 /* A= B[C], also for floats and references */
+#define RI_BALOAD 26
+#define RI_CALOAD 27
+#define RI_IASTORE 28 /* A[B]= C, also for floats */
+#define RI_BASTORE 29
+#define RI_CASTORE 30
+#define RI_ARRAYLENGTH 31 /* A= length of B */
+#define RI_GETFIELD 32 /* A= field of B, if the GETFIELD at pc has been quickened */
+#define RI_PUTFIELD 33 /* field of A= B, if the PUTFIELD at pc has been quickened */
+#define RI_GETSTATIC 34 /* A= static field, if the GETSTATIC at pc has been quickened */
+#define RI_PUTSTATIC 35 /* static field= A, if the PUTSTATIC at pc has been quickened */
+#define RI_IF_ICMPEQ 36 /* branch to pc if A == B */
+#define RI_IF_ICMPNE 37
+#define RI_IF_ICMPLT 38
+#define RI_IF_ICMPGE 39
+#define RI_IF_ICMPGT 40
+#define RI_IF_ICMPLE 41
+#define RI_IFEQ_CONST 42 /* branch to pc if A == K */
+#define RI_IFNE_CONST 43
+#define RI_IFLT_CONST 44
+#define RI_IFGE_CONST 45
+#define RI_IFGT_CONST 46
+#define RI_IFLE_CONST 47
+#define RI_GOTO 48
+#define RI_EXIT 49 /* leaves to the stack interpreter, which continues at pc with A operand stack slots */
+
+#define RI_OPCODE_COUNT 50
+
+typedef struct sRegisterInstruction
+{
+	uint8 opcode;
+	uint8 isBackwardBranch; /* branches only: a safe point (see ri_run()) */
+	u2 a;
+	u2 b;
+	u2 c;
+	u2 pc;
+	int32 constant;
+	uint32 target; /* branches: index of the instruction at the branch target; field accesses: index of the instructions which leave to the interpreter
+					  if the bytecode instruction hasn't been quickened yet */
+} RegisterInstruction;
+
+/* register code of a method */
+typedef struct sRegisterCode
+{
+	RegisterInstruction* instructions;
+	uint32 instructionCount;
+	int32* entries; /* index of the instruction at which the register code is entered, indexed by the bytecode pc, NO_REGISTER_ENTRY if it can't be entered
+					   there */
+	int32* stackHeights; /* operand stack height at every bytecode pc, -1 for unreachable code */
+} RegisterCode;
+
+#define NO_REGISTER_ENTRY -1
+
+/* false if started with -Xstack */
+extern boolean isRegisterInterpreterEnabled;
+
+void ri_translate( Class* cls, method_info* method );
+boolean ri_run( Stack* stack, StackFrame* sf, boolean isSwitchingAllowed );
+void ri_printStatistics();
+
+#endif /*_registerInterpreter_h_*/
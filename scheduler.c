@@ -0,0 +1,450 @@
+/*
+ *  scheduler.c
+ *  Green threads (M:N threading). If enabled by -workers <count>, Java threads don't get their own native thread, but are multiplexed over a small pool of
+ *  workers. A worker is the right to run Java code, together with a run queue of runnable green threads; there are exactly workerCount workers, each of them
+ *  used by one native worker thread at a time. All Java state of a thread is kept in its Stack and the stored pc of its current frame, so switching threads is
+ *  just leaving the interpreter loop of one thread and entering the one of another thread.
+ *  A green thread gives up its worker at the switch points of the interpreter (backward branches and method entries) when its time slice is over and another
+ *  thread is runnable, and when MONITORENTER finds the monitor owned by another thread (it's parked on the monitor until it's exited, see monitor.c). Both only
+ *  happen in the outermost interpreter loop of a thread, the nested loops of class initializers don't switch threads.
+ *  Natives that block (e.g. Thread.join()) and other waits in a blocking region can't leave the native thread. They hand their worker over to a spare worker
+ *  thread instead, so the other green threads keep running, and take a free worker again when they're done.
+ *  Every worker takes the threads of its own run queue in FIFO order. A worker with an empty run queue steals threads from the queues of the other workers.
+ *
+ *  Copyright (c) 2006, 2007 Daniel Klein. All rights reserved.
+ *
+ *  Licensed under GPL version 2.
+ *  See here for the full license: http://www.gnu.org/licenses/gpl.html
+ */
+
+#include <pthread.h>
+#include "puraGlobals.h"
+#include "memoryManager.h"
+#include "class.h"
+#include "heap.h"
+#include "interpreter.h"
+#include "thread.h"
+#include "scheduler.h"
+
+#define INITIAL_RUN_QUEUE_SIZE 64
+
+typedef struct sWorker
+{
+	uint32 id;
+	pthread_mutex_t queueLock; /* protects the run queue */
+	JavaThread** runQueue; /* ring buffer */
+	uint32 queueStart;
+	uint32 queueLength;
+	uint32 queueSize;
+	struct sWorker* nextFree; /* list of the workers which aren't used by a worker thread */
+} Worker;
+
+uint32 workerCount= 0;
+Worker* workers;
+THREAD_LOCAL Worker* currentWorker= NULL;
+THREAD_LOCAL boolean isWorkerReleased= false; /* set while the current thread is in a blocking region and has given its worker away */
+THREAD_LOCAL int32 timeSliceCountdown= TIME_SLICE;
+
+/* number of threads in all run queues */
+volatile uint32 queuedThreadCount= 0;
+
+/* Protects the state of the workers and worker threads below. */
+pthread_mutex_t schedulerLock= PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t workAvailable= PTHREAD_COND_INITIALIZER; /* signaled when a thread has been queued */
+pthread_cond_t workerFreed= PTHREAD_COND_INITIALIZER; /* signaled when a worker has been added to the free workers */
+
+Worker* freeWorkers= NULL;
+uint32 greenThreadCount= 0; /* started green threads which haven't finished yet */
+uint32 idleWorkerThreadCount= 0; /* worker threads which have a worker, but wait for work */
+uint32 spareWorkerThreadCount= 0; /* worker threads which wait for a free worker */
+uint32 workerThreadCount= 0; /* all worker threads, except the main thread */
+uint32 blockedThreadCount= 0; /* threads which want to take a free worker again after a blocking region */
+boolean isFinished= false;
+
+void* runWorkerThread( void* argument );
+
+/* Appends the given thread to the run queue of the given worker. */
+void enqueueThread( Worker* worker, JavaThread* thread )
+{
+	pthread_mutex_lock( &worker->queueLock );
+	
+	if( worker->queueLength == worker->queueSize )
+	{
+		/* Grow the ring buffer and move the queued threads to the start of the new buffer. */
+		JavaThread** runQueue= mm_staticMalloc( 2 * worker->queueSize * sizeof(JavaThread*) );
+		
+		uint32 i;
+		for( i= 0; i < worker->queueLength; i++ )
+			runQueue[i]= worker->runQueue[(worker->queueStart + i) % worker->queueSize];
+		
+		mm_staticFree( worker->runQueue );
+		worker->runQueue= runQueue;
+		worker->queueStart= 0;
+		worker->queueSize*= 2;
+	}
+	
+	worker->runQueue[(worker->queueStart + worker->queueLength) % worker->queueSize]= thread;
+	worker->queueLength++;
+	__sync_fetch_and_add( &queuedThreadCount, 1 );
+	
+	pthread_mutex_unlock( &worker->queueLock );
+}
+
+/* Removes the first (i.e. oldest) thread from the run queue of the given worker. Returns NULL if the queue is empty. */
+JavaThread* dequeueThread( Worker* worker )
+{
+	JavaThread* thread= NULL;
+	pthread_mutex_lock( &worker->queueLock );
+	
+	if( worker->queueLength > 0 )
+	{
+		thread= worker->runQueue[worker->queueStart];
+		worker->queueStart= (worker->queueStart + 1) % worker->queueSize;
+		worker->queueLength--;
+		__sync_fetch_and_sub( &queuedThreadCount, 1 );
+	}
+	
+	pthread_mutex_unlock( &worker->queueLock );
+	return thread;
+}
+
+/* Removes the last (i.e. newest) thread from the run queue of the given worker, which belongs to another worker thread. Returns NULL if the queue is empty. */
+JavaThread* stealThread( Worker* worker )
+{
+	JavaThread* thread= NULL;
+	pthread_mutex_lock( &worker->queueLock );
+	
+	if( worker->queueLength > 0 )
+	{
+		worker->queueLength--;
+		thread= worker->runQueue[(worker->queueStart + worker->queueLength) % worker->queueSize];
+		__sync_fetch_and_sub( &queuedThreadCount, 1 );
+	}
+	
+	pthread_mutex_unlock( &worker->queueLock );
+	return thread;
+}
+
+/* Returns the next thread to run on the given worker: the first one of its own run queue, or one stolen from another worker. */
+JavaThread* takeThread( Worker* worker )
+{
+	JavaThread* thread= dequeueThread( worker );
+	
+	uint32 i;
+	for( i= 1; thread == NULL && i < workerCount && queuedThreadCount > 0; i++ )
+		thread= stealThread( &workers[(worker->id + i) % workerCount] );
+	
+	return thread;
+}
+
+/* Makes sure that a worker thread takes care of newly queued threads: wakes an idle worker thread, or lets a spare worker thread take a free worker. A new
+	worker thread is started, if there's a free worker but no spare worker thread. The scheduler lock must be held. */
+void wakeWorkerThread()
+{
+	if( idleWorkerThreadCount > 0 )
+	{
+		pthread_cond_signal( &workAvailable );
+	}
+	else if( freeWorkers != NULL && blockedThreadCount == 0 )
+	{
+		if( spareWorkerThreadCount > 0 )
+		{
+			pthread_cond_broadcast( &workerFreed );
+		}
+		else
+		{
+			pthread_t nativeThread;
+			
+			if( pthread_create(&nativeThread, NULL, runWorkerThread, NULL) != 0 )
+				error( "Native thread creation failed!" );
+			
+			pthread_detach( nativeThread );
+			spareWorkerThreadCount++;
+			workerThreadCount++;
+		}
+	}
+}
+
+/* Queues the given runnable thread and makes sure that a worker thread will run it. */
+void makeRunnable( JavaThread* thread )
+{
+	enqueueThread( currentWorker != NULL ? currentWorker : &workers[0], thread );
+	
+	pthread_mutex_lock( &schedulerLock );
+	wakeWorkerThread();
+	pthread_mutex_unlock( &schedulerLock );
+}
+
+/* Adds the given worker to the free workers. The scheduler lock must be held. */
+void freeWorker( Worker* worker )
+{
+	worker->nextFree= freeWorkers;
+	freeWorkers= worker;
+	pthread_cond_broadcast( &workerFreed );
+}
+
+/* Waits until there's a free worker and makes it the worker of the current worker thread. Threads returning from a blocking region take free workers first.
+	Returns false, if all green threads have finished. The scheduler lock must be held. */
+boolean takeFreeWorker( boolean isReturningFromBlockingRegion )
+{
+	if( isReturningFromBlockingRegion )
+	{
+		blockedThreadCount++;
+		
+		/* Idle worker threads give their worker away (see runWorker()). */
+		pthread_cond_broadcast( &workAvailable );
+		
+		while( freeWorkers == NULL )
+			pthread_cond_wait( &workerFreed, &schedulerLock );
+		
+		blockedThreadCount--;
+	}
+	else
+	{
+		while( !isFinished && (freeWorkers == NULL || blockedThreadCount > 0) )
+			pthread_cond_wait( &workerFreed, &schedulerLock );
+		
+		if( isFinished )
+			return false;
+	}
+	
+	currentWorker= freeWorkers;
+	freeWorkers= freeWorkers->nextFree;
+	return true;
+}
+
+/* Runs the given thread on the current worker, until it finishes, gives up the worker or is parked. */
+void runGreenThread( JavaThread* thread )
+{
+	currentThread= thread;
+	thread_switchIn();
+	timeSliceCountdown= TIME_SLICE;
+	
+	if( !thread->hasStarted )
+		thread_pushRunFrame( thread );
+	
+	interpreter_runThread( thread->stack );
+	
+	if( thread->stack->currentFrame->methodInfo == NULL )
+	{
+		/* Back at the initial stack frame, the thread has finished. */
+		thread_finish( thread );
+		currentThread= NULL;
+		
+		pthread_mutex_lock( &schedulerLock );
+		greenThreadCount--;
+		
+		if( greenThreadCount == 0 )
+		{
+			isFinished= true;
+			pthread_cond_broadcast( &workAvailable );
+			pthread_cond_broadcast( &workerFreed );
+		}
+		
+		pthread_mutex_unlock( &schedulerLock );
+		return;
+	}
+	
+	thread_switchOut();
+	currentThread= NULL;
+	
+	/* A parked thread may have been woken up already, while it was still running. */
+	pthread_mutex_lock( &schedulerLock );
+	boolean isParked= thread->schedulingState == THREAD_PARKING;
+	thread->schedulingState= isParked ? THREAD_PARKED : THREAD_RUNNABLE;
+	pthread_mutex_unlock( &schedulerLock );
+	
+	if( !isParked )
+		makeRunnable( thread );
+}
+
+/* Runs green threads on the worker of the current worker thread. Returns when all threads have finished, or when the worker has been given away to a thread
+	which returns from a blocking region. */
+void runWorker()
+{
+	while( true )
+	{
+		JavaThread* thread= takeThread( currentWorker );
+		
+		if( thread != NULL )
+		{
+			runGreenThread( thread );
+			continue;
+		}
+		
+		pthread_mutex_lock( &schedulerLock );
+		
+		if( isFinished || blockedThreadCount > 0 )
+		{
+			freeWorker( currentWorker );
+			currentWorker= NULL;
+			pthread_mutex_unlock( &schedulerLock );
+			return;
+		}
+		
+		if( queuedThreadCount == 0 )
+		{
+			idleWorkerThreadCount++;
+			pthread_cond_wait( &workAvailable, &schedulerLock );
+			idleWorkerThreadCount--;
+		}
+		
+		pthread_mutex_unlock( &schedulerLock );
+	}
+}
+
+/* Entry function of the native worker threads, which are started as spare worker threads. */
+void* runWorkerThread( void* argument )
+{
+	heap_attachThread();
+	pthread_mutex_lock( &schedulerLock );
+	
+	while( takeFreeWorker(false) )
+	{
+		spareWorkerThreadCount--;
+		pthread_mutex_unlock( &schedulerLock );
+		
+		runWorker();
+		
+		pthread_mutex_lock( &schedulerLock );
+		spareWorkerThreadCount++;
+	}
+	
+	pthread_mutex_unlock( &schedulerLock );
+	
+	interpreter_addThreadStatistics();
+	heap_detachThread();
+	
+	pthread_mutex_lock( &schedulerLock );
+	spareWorkerThreadCount--;
+	workerThreadCount--;
+	pthread_cond_broadcast( &workerFreed );
+	pthread_mutex_unlock( &schedulerLock );
+	return NULL;
+}
+
+/* Runs the main thread, with the main method on the given stack, and all threads started by it as green threads. The current native thread becomes the first
+	worker thread. Returns when all threads have finished. */
+void sched_run( Stack* mainStack )
+{
+	logVerbose( "Running green threads on %i workers.\n", workerCount );
+	workers= mm_staticMalloc( workerCount * sizeof(Worker) );
+	
+	uint32 i;
+	for( i= 0; i < workerCount; i++ )
+	{
+		Worker* worker= &workers[i];
+		worker->id= i;
+		pthread_mutex_init( &worker->queueLock, NULL );
+		worker->runQueue= mm_staticMalloc( INITIAL_RUN_QUEUE_SIZE * sizeof(JavaThread*) );
+		worker->queueStart= 0;
+		worker->queueLength= 0;
+		worker->queueSize= INITIAL_RUN_QUEUE_SIZE;
+		
+		if( i > 0 )
+			freeWorker( worker );
+	}
+	
+	/* The main thread continues as a green thread on the first worker. */
+	JavaThread* mainThread= currentThread;
+	mainThread->hasStarted= true;
+	mainThread->schedulingState= THREAD_RUNNABLE;
+	greenThreadCount= 1;
+	thread_switchOut();
+	currentThread= NULL;
+	
+	currentWorker= &workers[0];
+	enqueueThread( currentWorker, mainThread );
+	
+	pthread_mutex_lock( &schedulerLock );
+	
+	do
+	{
+		pthread_mutex_unlock( &schedulerLock );
+		runWorker();
+		pthread_mutex_lock( &schedulerLock );
+	}
+	while( takeFreeWorker(false) );
+	
+	/* Let the other worker threads add their statistics. */
+	while( workerThreadCount > 0 )
+		pthread_cond_wait( &workerFreed, &schedulerLock );
+	
+	pthread_mutex_unlock( &schedulerLock );
+}
+
+/* Makes the given new thread runnable. It's started by the worker thread which takes it first. */
+void sched_startThread( JavaThread* thread )
+{
+	thread->hasStarted= false;
+	thread->schedulingState= THREAD_RUNNABLE;
+	
+	pthread_mutex_lock( &schedulerLock );
+	greenThreadCount++;
+	pthread_mutex_unlock( &schedulerLock );
+	
+	makeRunnable( thread );
+}
+
+/* Called when the time slice of the current thread is over. Returns true, if it should give up its worker now (i.e. if there's another runnable thread). */
+boolean sched_checkTimeSlice()
+{
+	timeSliceCountdown= TIME_SLICE;
+	return queuedThreadCount > 0;
+}
+
+/* Hands the worker of the current thread, which is about to block in a blocking region, over to a spare worker thread. */
+void sched_releaseWorker()
+{
+	/* The main thread may block before the scheduler has been started, e.g. while initializing the system classes. */
+	if( currentWorker == NULL )
+		return;
+	
+	isWorkerReleased= true;
+	pthread_mutex_lock( &schedulerLock );
+	freeWorker( currentWorker );
+	currentWorker= NULL;
+	
+	if( queuedThreadCount > 0 )
+		wakeWorkerThread();
+	
+	pthread_mutex_unlock( &schedulerLock );
+}
+
+/* Takes a free worker again after a blocking region. */
+void sched_acquireWorker()
+{
+	if( !isWorkerReleased )
+		return;
+	
+	isWorkerReleased= false;
+	pthread_mutex_lock( &schedulerLock );
+	takeFreeWorker( true );
+	pthread_mutex_unlock( &schedulerLock );
+}
+
+/* Marks the current thread to be parked as soon as it leaves the interpreter loop. Must be called while holding the lock of the monitor which will call
+	sched_wakeUp() for the thread. */
+void sched_prepareParking()
+{
+	currentThread->schedulingState= THREAD_PARKING;
+}
+
+/* Makes the given parked thread runnable again. */
+void sched_wakeUp( JavaThread* thread )
+{
+	pthread_mutex_lock( &schedulerLock );
+	
+	/* Still running? -> Just don't park it. */
+	if( thread->schedulingState == THREAD_PARKING )
+	{
+		thread->schedulingState= THREAD_RUNNABLE;
+		pthread_mutex_unlock( &schedulerLock );
+		return;
+	}
+	
+	thread->schedulingState= THREAD_RUNNABLE;
+	pthread_mutex_unlock( &schedulerLock );
+	
+	makeRunnable( thread );
+}
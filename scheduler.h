@@ -0,0 +1,44 @@
+/*
+ *  scheduler.h
+ *  Green threads: many Java threads multiplexed over a small pool of worker threads with work-stealing run queues.
+ *
+ *  Copyright (c) 2006, 2007 Daniel Klein. All rights reserved.
+ *
+ *  Licensed under GPL version 2.
+ *  See here for the full license: http://www.gnu.org/licenses/gpl.html
+ */
+
+#ifndef _scheduler_h_
+#define _scheduler_h_
+
+#include "puraGlobals.h"
+#include "types.h"
+#include "stack.h"
+#include "thread.h"
+
+/* number of switch points a green thread passes before the scheduler checks if another thread should run */
+#define TIME_SLICE 10000
+
+/* scheduling states of a green thread */
+#define THREAD_RUNNABLE 0 /* running or in a run queue */
+#define THREAD_PARKING 1 /* running, but about to be parked */
+#define THREAD_PARKED 2 /* waiting for sched_wakeUp() */
+
+/* Number of worker threads, 0 if every Java thread runs on its own native thread. Set by the command line parameter -workers. */
+extern uint32 workerCount;
+extern THREAD_LOCAL int32 timeSliceCountdown;
+
+#define sched_isEnabled() (workerCount > 0)
+
+/* Checks if the current green thread should leave its worker to another thread. Used at the switch points of the interpreter. */
+#define sched_isSwitchDue() (--timeSliceCountdown < 0 && sched_checkTimeSlice())
+
+void sched_run( Stack* mainStack );
+void sched_startThread( JavaThread* thread );
+boolean sched_checkTimeSlice();
+void sched_releaseWorker();
+void sched_acquireWorker();
+void sched_prepareParking();
+void sched_wakeUp( JavaThread* thread );
+
+#endif /*_scheduler_h_*/
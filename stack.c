@@ -11,10 +11,22 @@
 #include "puraGlobals.h"
 #include "class.h"
 #include "memoryManager.h"
+#include "heap.h"
+#include "monitor.h"
 #include "stack.h"
 
 uint32 initialStackSize= DEFAULT_STACK_SIZE;
 
+/* Returns the lock word of the monitor of the synchronized method of the given frame: the one of the instance entered by stack_pushFrame() for instance
+	methods (local variable 0 may be overwritten by the bytecode since), the one of the class for static methods. */
+volatile uint32* getLockWordOfFrame( StackFrame* sf )
+{
+	if( isFlagSet(sf->methodInfo->access_flags, ACC_STATIC) )
+		return &sf->methodInfo->declaringClass->lockWord;
+	
+	return heap_getLockWord( sf->lockedObject );
+}
+
 Stack* stack_create( uint32 stackSize )
 {
 	logVerbose( "Creating stack with a size of %i bytes.\n", stackSize );
@@ -54,6 +66,7 @@ StackFrame* stack_createInitialStackFrame( Stack* stack )
 	sf->prevStackFrame= NULL;
 	sf->methodInfo= NULL;
 	sf->pc= (byte*)0xFFFFFFFF; /* This is only used for storing the pc if another method is called. The initial value is for easier debugging. */
+	sf->lockedObject= NULL_REFERENCE;
 	
 	/* adjust stack info */
 	stack->stackPointer= (slot*)(sf+1);
@@ -97,12 +110,22 @@ StackFrame* stack_pushFrame( Stack* stack, Class* cls, method_info* methodInfo )
 	sf->currentClass= cls;
 	sf->methodInfo= methodInfo;
 	sf->pc= (byte*)0xFFFFFFFF; /* This value is only for debugging purposes. Otherwise pc is unused until the next method call. */
+	sf->lockedObject= NULL_REFERENCE;
 	
 	/* adjust stack info */
 	stack->stackPointer= ((slot*)(sf+1))+methodInfo->code->max_locals;
 	stack->currentFrame= sf;
 	stack->frameCount++;
 	
+	/* The frame may wait for the monitor of a synchronized method before its first instruction, which is a safe point (see isSafePoint()). */
+	if( methodInfo->access_flags & ACC_SYNCHRONIZED )
+	{
+		sf->pc= methodInfo->code->code;
+		if( !isFlagSet(methodInfo->access_flags, ACC_STATIC) )
+			sf->lockedObject= *(slot*)(sf+1);
+		monitor_enter( getLockWordOfFrame(sf) );
+	}
+	
 	logVerbose( "\tPushing new stack frame.\n\tFrame number %i, size %i bytes, %i parameter slots, stack is now %i bytes high.\n", stack->frameCount, expectedSize, methodInfo->parameterSlotCount, stack_getSize(stack) );
 	return sf;
 }
@@ -111,6 +134,11 @@ StackFrame* stack_popFrame( Stack* stack )
 {
 	/* remove stack frame and re-establish the previous one */
 	StackFrame* sf= stack->currentFrame;
+	
+	/* Synchronized methods exit their monitor on return and when an exception is thrown out of them. */
+	if( sf->methodInfo != NULL && (sf->methodInfo->access_flags & ACC_SYNCHRONIZED) )
+		monitor_exit( getLockWordOfFrame(sf) );
+	
 	stack->frameCount--;
 	stack->currentFrame= sf->prevStackFrame;
 	stack->stackPointer= (slot*)sf;
@@ -23,6 +23,7 @@ typedef struct sStack_frame
 	Class* currentClass;
 	method_info* methodInfo;
 	byte* pc; /* program counter storage (Only used to store the pc if another method is invoked on top of this one.) */
+	reference lockedObject; /* the instance whose monitor a synchronized instance method has entered, NULL_REFERENCE otherwise */
 } StackFrame;
 
 typedef struct sStack
@@ -0,0 +1,103 @@
+/*
+ *  symbolTable.c
+ *  VM wide table of interned strings (symbols). Every string is stored only once, so interned strings can be compared by their pointers instead of 
+ *  comparing them char by char. All CONSTANT_Utf8 entries of the constant pools are interned while loading a class, which includes all class, method and 
+ *  field names and descriptors. Interned strings must never be modified or freed.
+ *
+ *  Copyright (c) 2006, 2007 Daniel Klein. All rights reserved.
+ *  
+ *  Licensed under GPL version 2.
+ *  See here for the full license: http://www.gnu.org/licenses/gpl.html
+ */
+
+#include <string.h>
+#include "puraGlobals.h"
+#include "memoryManager.h"
+#include "thread.h"
+#include "symbolTable.h"
+
+/* The symbols are stored in a hash table using open addressing. The table is doubled in size whenever it gets filled more than 3/4. */
+char** symbolTable;
+uint32 symbolTableSize= INITIAL_NUMBER_OF_POSSIBLE_SYMBOLS;
+uint32 numberOfSymbols= 0;
+
+/* Calculates the hash value of a string (same algorithm as java.lang.String.hashCode()). */
+uint32 sym_hash( const char* string )
+{
+	uint32 hash= 0;
+	
+	while( *string != '\0' )
+	{
+		hash= 31*hash + (uint8)*string;
+		string++;
+	}
+	
+	return hash;
+}
+
+/* Returns the entry of the symbol table where the given string is stored, or the empty entry where it would have to be inserted. */
+char** findSymbolTableEntry( char** table, uint32 tableSize, const char* string )
+{
+	uint32 i= sym_hash( string ) & (tableSize - 1);
+	
+	while( table[i] != NULL && strcmp(table[i], string) != 0 )
+		i= (i + 1) & (tableSize - 1);
+	
+	return &table[i];
+}
+
+/* Double the size of the symbol table and re-insert all symbols. */
+void increaseSymbolTable()
+{
+	uint32 newSize= symbolTableSize * 2;
+	char** newTable= (char**)mm_staticMalloc( sizeof(char*) * newSize );
+	
+	uint32 i;
+	for( i= 0; i < newSize; i++ )
+		newTable[i]= NULL;
+	
+	for( i= 0; i < symbolTableSize; i++ )
+		if( symbolTable[i] != NULL )
+			*findSymbolTableEntry( newTable, newSize, symbolTable[i] )= symbolTable[i];
+	
+	logVerbose( "Increasing symbol table size. Size was %i and is %i now.\n", symbolTableSize, newSize );
+	
+	mm_staticFree( symbolTable );
+	symbolTable= newTable;
+	symbolTableSize= newSize;
+}
+
+void sym_init()
+{
+	logVerbose( "Initializing symbol table...\n" );
+	symbolTable= (char**)mm_staticMalloc( sizeof(char*) * symbolTableSize );
+	
+	uint32 i;
+	for( i= 0; i < symbolTableSize; i++ )
+		symbolTable[i]= NULL;
+}
+
+/* Returns the interned version of the given string. If the string is not present in the symbol table yet, a copy of it is added. The symbol table is shared by
+	all threads, so it is only accessed while holding the method area lock. */
+char* sym_intern( const char* string )
+{
+	thread_lockMethodArea();
+	char** entry= findSymbolTableEntry( symbolTable, symbolTableSize, string );
+	
+	if( *entry == NULL )
+	{
+		if( (numberOfSymbols+1)*4 > symbolTableSize*3 )
+		{
+			increaseSymbolTable();
+			entry= findSymbolTableEntry( symbolTable, symbolTableSize, string );
+		}
+		
+		*entry= mm_staticMalloc( strlen(string)+1 );
+		strcpy( *entry, string );
+		numberOfSymbols++;
+	}
+	
+	char* symbol= *entry;
+	thread_unlockMethodArea();
+	return symbol;
+}
@@ -0,0 +1,23 @@
+/*
+ *  symbolTable.h
+ *  VM wide table of interned strings (symbols).
+ *
+ *  Copyright (c) 2006, 2007 Daniel Klein. All rights reserved.
+ *  
+ *  Licensed under GPL version 2.
+ *  See here for the full license: http://www.gnu.org/licenses/gpl.html
+ */
+
+#ifndef _symbolTable_h_
+#define _symbolTable_h_
+
+#include "types.h"
+
+/* initial size of the symbol table, must be a power of two */
+#define INITIAL_NUMBER_OF_POSSIBLE_SYMBOLS 1024
+
+void sym_init();
+uint32 sym_hash( const char* string );
+char* sym_intern( const char* string );
+
+#endif /*_symbolTable_h_*/
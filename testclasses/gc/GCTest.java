@@ -0,0 +1,33 @@
+/**
+ * GCTest.java: Allocates much more memory than the nursery holds, so that the garbage collector runs many times. A table of long-lived
+ * nodes is promoted to the old generation, and new nodes are linked into it all the time (references from old to young instances,
+ * which need the write barrier). Every eighth round the lists are dropped, which leaves garbage in the old generation to be compacted.
+ * Prints a checksum of the live nodes, which is only right if no node has been lost or corrupted.
+ */
+public class GCTest
+{
+	public static void main( String[] args )
+	{
+		Node[] table= new Node[1000];
+		
+		for( int i= 0; i < 2000000; i++ )
+		{
+			// garbage, which dies young
+			int[] temp= new int[16];
+			temp[i & 15]= i;
+			
+			int index= i % 1000;
+			Node node= new Node( temp[i & 15] );
+			if( (i / 1000) % 8 != 0 )
+				node.next= table[index];
+			table[index]= node;
+		}
+		
+		int checksum= 0;
+		for( int i= 0; i < 1000; i++ )
+			for( Node node= table[i]; node != null; node= node.next )
+				checksum= checksum * 31 + node.value + node.data[0];
+		
+		System.out.println( checksum );
+	}
+}
@@ -0,0 +1,13 @@
+public class Node
+{
+	public int value;
+	public int[] data;
+	public Node next;
+	
+	public Node( int value )
+	{
+		this.value= value;
+		data= new int[4];
+		data[0]= value * 3;
+	}
+}
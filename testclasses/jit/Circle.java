@@ -0,0 +1,14 @@
+public class Circle extends Shape
+{
+	private int radius;
+	
+	public Circle( int radius )
+	{
+		this.radius= radius;
+	}
+	
+	public int area()
+	{
+		return 3 * radius * radius;
+	}
+}
@@ -0,0 +1,55 @@
+/**
+ * JitTest.java: Runs arithmetic methods often enough to be compiled by the JIT compilers, and prints checksums, which must be the same
+ * as with -Xint. The call of area() only sees one receiver class until late in the loop, when a second one turns up, which the optimized
+ * code has to fall back to the interpreter for (deoptimization). The loop of main runs long enough to be entered in optimized code
+ * (on-stack replacement).
+ */
+public class JitTest
+{
+	public static int mix( int a, int b )
+	{
+		int x= a * 31 + b;
+		x^= x >>> 7;
+		x+= (x << 3) - b;
+		return x % 1000003 + a / (b | 1);
+	}
+	
+	public static long sumLongs( int n )
+	{
+		long sum= 1;
+		for( int i= 0; i < n; i++ )
+			sum= sum * 31 + i;
+		
+		return sum;
+	}
+	
+	public static int sumArray( int[] values )
+	{
+		int sum= 0;
+		for( int i= 0; i < values.length; i++ )
+			sum+= values[i];
+		
+		return sum;
+	}
+	
+	public static void main( String[] args )
+	{
+		int[] values= new int[100];
+		Shape shape= new Square( 3 );
+		int checksum= 0;
+		long longSum= 0;
+		
+		for( int i= 0; i < 200000; i++ )
+		{
+			if( i == 150000 )
+				shape= new Circle( 2 );
+			
+			values[i % 100]= mix( i, checksum );
+			checksum+= sumArray( values ) + shape.area();
+			longSum+= sumLongs( i % 50 );
+		}
+		
+		System.out.println( checksum );
+		System.out.println( longSum );
+	}
+}
@@ -0,0 +1,4 @@
+public abstract class Shape
+{
+	public abstract int area();
+}
@@ -0,0 +1,25 @@
+public class Buffer
+{
+	private int value;
+	private boolean isFull;
+	
+	public synchronized void put( int value )
+	{
+		while( isFull )
+			wait();
+		
+		this.value= value;
+		isFull= true;
+		notifyAll();
+	}
+	
+	public synchronized int take()
+	{
+		while( !isFull )
+			wait();
+		
+		isFull= false;
+		notifyAll();
+		return value;
+	}
+}
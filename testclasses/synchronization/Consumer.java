@@ -0,0 +1,23 @@
+public class Consumer implements Runnable
+{
+	private Buffer buffer;
+	private int count;
+	private int sum;
+	
+	public Consumer( Buffer buffer, int count )
+	{
+		this.buffer= buffer;
+		this.count= count;
+	}
+	
+	public void run()
+	{
+		for( int i= 0; i < count; i++ )
+			sum+= buffer.take();
+	}
+	
+	public int getSum()
+	{
+		return sum;
+	}
+}
@@ -0,0 +1,26 @@
+public class Counter
+{
+	private int count;
+	private static int total;
+	public int blockCount;
+	
+	public synchronized void increment()
+	{
+		count++;
+	}
+	
+	public synchronized int getCount()
+	{
+		return count;
+	}
+	
+	public static synchronized void incrementTotal()
+	{
+		total++;
+	}
+	
+	public static synchronized int getTotal()
+	{
+		return total;
+	}
+}
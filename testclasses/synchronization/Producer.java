@@ -0,0 +1,19 @@
+public class Producer implements Runnable
+{
+	private Buffer buffer;
+	private int first;
+	private int count;
+	
+	public Producer( Buffer buffer, int first, int count )
+	{
+		this.buffer= buffer;
+		this.first= first;
+		this.count= count;
+	}
+	
+	public void run()
+	{
+		for( int i= 0; i < count; i++ )
+			buffer.put( first + i );
+	}
+}
@@ -0,0 +1,27 @@
+/**
+ * ProducerConsumer.java: Two producers hand the numbers from 1 to 20000 over to two consumers through a buffer for a single value,
+ * waiting for each other with wait() and notifyAll(). Prints the sum of all numbers taken by the consumers.
+ */
+public class ProducerConsumer
+{
+	public static void main( String[] args )
+	{
+		Buffer buffer= new Buffer();
+		Consumer first= new Consumer( buffer, 10000 );
+		Consumer second= new Consumer( buffer, 10000 );
+		
+		Thread[] threads= new Thread[4];
+		threads[0]= new Thread( new Producer(buffer, 1, 10000) );
+		threads[1]= new Thread( new Producer(buffer, 10001, 10000) );
+		threads[2]= new Thread( first );
+		threads[3]= new Thread( second );
+		
+		for( int i= 0; i < 4; i++ )
+			threads[i].start();
+		
+		for( int i= 0; i < 4; i++ )
+			threads[i].join();
+		
+		System.out.println( first.getSum() + second.getSum() );
+	}
+}
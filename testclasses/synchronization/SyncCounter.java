@@ -0,0 +1,46 @@
+/**
+ * SyncCounter.java: Four threads increment the same counters at the same time, using a synchronized method, a static synchronized
+ * method and a synchronized block. No increment may get lost.
+ */
+public class SyncCounter implements Runnable
+{
+	private Counter counter;
+	
+	public SyncCounter( Counter counter )
+	{
+		this.counter= counter;
+	}
+	
+	public void run()
+	{
+		for( int i= 0; i < 100000; i++ )
+		{
+			counter.increment();
+			Counter.incrementTotal();
+			
+			synchronized( counter )
+			{
+				counter.blockCount++;
+			}
+		}
+	}
+	
+	public static void main( String[] args )
+	{
+		Counter counter= new Counter();
+		Thread[] threads= new Thread[4];
+		
+		for( int i= 0; i < 4; i++ )
+		{
+			threads[i]= new Thread( new SyncCounter(counter) );
+			threads[i].start();
+		}
+		
+		for( int i= 0; i < 4; i++ )
+			threads[i].join();
+		
+		System.out.println( counter.getCount() );
+		System.out.println( Counter.getTotal() );
+		System.out.println( counter.blockCount );
+	}
+}
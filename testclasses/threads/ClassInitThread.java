@@ -0,0 +1,10 @@
+/**
+ * ClassInitThread.java: The static initializer of Config starts a thread and waits for it, while the thread initializes other classes.
+ */
+public class ClassInitThread
+{
+	public static void main( String[] args )
+	{
+		System.out.println( Config.value );
+	}
+}
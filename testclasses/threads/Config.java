@@ -0,0 +1,12 @@
+public class Config
+{
+	public static int value;
+	
+	static
+	{
+		Thread loader= new Thread( new ConfigLoader() );
+		loader.start();
+		loader.join();
+		value= ConfigLoader.loaded + 1;
+	}
+}
@@ -0,0 +1,9 @@
+public class ConfigLoader implements Runnable
+{
+	public static int loaded;
+	
+	public void run()
+	{
+		loaded= Defaults.getAnswer();
+	}
+}
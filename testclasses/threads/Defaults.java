@@ -0,0 +1,9 @@
+public class Defaults
+{
+	private static int answer= 41;
+	
+	public static int getAnswer()
+	{
+		return answer;
+	}
+}
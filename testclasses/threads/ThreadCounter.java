@@ -0,0 +1,46 @@
+/**
+ * ThreadCounter.java: Several threads count at the same time, each one with its own counter. The main thread waits for all of them
+ * and prints their results and the total.
+ */
+public class ThreadCounter implements Runnable
+{
+	private int count;
+	private int result;
+	
+	public ThreadCounter( int count )
+	{
+		this.count= count;
+	}
+	
+	public void run()
+	{
+		int sum= 0;
+		for( int i= 0; i < count; i++ )
+			sum+= i % 7;
+		
+		result= sum;
+	}
+	
+	public static void main( String[] args )
+	{
+		ThreadCounter[] counters= new ThreadCounter[4];
+		Thread[] threads= new Thread[4];
+		
+		for( int i= 0; i < 4; i++ )
+		{
+			counters[i]= new ThreadCounter( 100000 * (i+1) );
+			threads[i]= new Thread( counters[i] );
+			threads[i].start();
+		}
+		
+		int total= 0;
+		for( int i= 0; i < 4; i++ )
+		{
+			threads[i].join();
+			System.out.println( counters[i].result );
+			total+= counters[i].result;
+		}
+		
+		System.out.println( total );
+	}
+}
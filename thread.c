@@ -0,0 +1,385 @@
+/*
+ *  thread.c
+ *  Java threads. Every Java thread runs its own interpreter loop on its own stack in a native thread (pthread), so Java threads really run in parallel. With
+ *  -workers, Java threads are green threads instead, which share a few native worker threads (see scheduler.c).
+ *  Shared VM data is protected as follows: The heap uses thread-local allocation buffers (see heap.c). Class loading, the symbol table and the inline caches are
+ *  protected by the method area lock, and class initialization by the class initialization lock, so that no thread can see a class whose initializer is still
+ *  running in another thread.
+ *  The garbage collector stops the world: the collecting thread waits until all other threads have reached a safe point (where the stack of the thread is
+ *  consistent and the pc of the current frame is stored) or are blocked in a blocking region. Threads check for a stop request at every allocating instruction,
+ *  backward branch, method entry and return, so the time to safe point (which thread_stopTheWorld() returns) stays short even for loops without allocations.
+ *  Green threads which aren't on a worker are always at a safe point.
+ *
+ *  Copyright (c) 2006, 2007 Daniel Klein. All rights reserved.
+ *
+ *  Licensed under GPL version 2.
+ *  See here for the full license: http://www.gnu.org/licenses/gpl.html
+ */
+
+#include <pthread.h>
+#include <sys/time.h>
+#include "puraGlobals.h"
+#include "memoryManager.h"
+#include "symbolTable.h"
+#include "class.h"
+#include "heap.h"
+#include "stack.h"
+#include "interpreter.h"
+#include "scheduler.h"
+#include "thread.h"
+
+/* All running threads, including the main thread. Changed while holding the thread lock only. */
+JavaThread* threads= NULL;
+THREAD_LOCAL JavaThread* currentThread;
+uint32 nextThreadId= 0;
+
+/* Protects the thread list and the stop the world state. Waiting threads are notified whenever a thread changes its state. */
+pthread_mutex_t threadLock= PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t threadStateChanged= PTHREAD_COND_INITIALIZER;
+
+/* Number of threads which may currently access the heap, i.e. which are neither at a safe point nor in a blocking region. */
+uint32 runningThreadCount= 0;
+volatile boolean isStopTheWorldRequested= false;
+
+/* The method area lock is recursive, because class loading may recursively load other classes. */
+pthread_mutex_t methodAreaLock;
+
+/* Protects the initialization state of all classes. */
+pthread_mutex_t classInitializationLock= PTHREAD_MUTEX_INITIALIZER;
+
+/* Initializes a recursive mutex. */
+void initRecursiveLock( pthread_mutex_t* lock )
+{
+	pthread_mutexattr_t attributes;
+	pthread_mutexattr_init( &attributes );
+	pthread_mutexattr_settype( &attributes, PTHREAD_MUTEX_RECURSIVE );
+	pthread_mutex_init( lock, &attributes );
+	pthread_mutexattr_destroy( &attributes );
+}
+
+void thread_init()
+{
+	initRecursiveLock( &methodAreaLock );
+}
+
+/* Registers the main thread, which executes the main method on the given stack. */
+void thread_attachMainThread( Stack* mainStack )
+{
+	JavaThread* thread= mm_staticMalloc( sizeof(JavaThread) );
+	thread->id= nextThreadId++;
+	thread->stack= mainStack;
+	thread->threadObject= NULL_REFERENCE;
+	thread->nativeThread= pthread_self();
+	thread->next= NULL;
+	thread->nextParked= NULL;
+	
+	threads= thread;
+	runningThreadCount= 1;
+	currentThread= thread;
+}
+
+/* Returns the running thread of the given java.lang.Thread instance, or NULL if there is none. The thread lock must be held. */
+JavaThread* findThread( reference threadObject )
+{
+	JavaThread* thread;
+	for( thread= threads; thread != NULL; thread= thread->next )
+		if( thread->threadObject == threadObject )
+			return thread;
+	
+	return NULL;
+}
+
+/* Returns true, if the thread with the given id is still running. The thread lock must be held. */
+boolean isThreadRunning( uint32 id )
+{
+	JavaThread* thread;
+	for( thread= threads; thread != NULL; thread= thread->next )
+		if( thread->id == id )
+			return true;
+	
+	return false;
+}
+
+/* Entry function of the native threads. */
+void* runThread( void* argument )
+{
+	JavaThread* thread= (JavaThread*)argument;
+	thread->nativeThread= pthread_self();
+	currentThread= thread;
+	heap_attachThread();
+	
+	thread_pushRunFrame( thread );
+	interpreter_runThread( thread->stack );
+	interpreter_addThreadStatistics();
+	
+	heap_detachThread();
+	thread_finish( thread );
+	return NULL;
+}
+
+/* Pushes the frame of the run() method of the given thread. The frame is pushed by the thread itself when it starts running, as it enters the monitor of the
+	instance if run() is synchronized. */
+void thread_pushRunFrame( JavaThread* thread )
+{
+	Class* cls= heap_getClassOfInstance( thread->threadObject );
+	StackFrame* sf= stack_pushFrame( thread->stack, cls, cls_resolveMethod(&cls, sym_intern("run"), sym_intern("()V")) );
+	sf->pc= sf->methodInfo->code->code;
+	thread->hasStarted= true;
+	
+	logVerbose( "Thread %i started.\n", thread->id );
+}
+
+/* Removes the given thread, which has returned from its run() method, from the list and frees it. It doesn't access the heap anymore from now on. */
+void thread_finish( JavaThread* thread )
+{
+	logVerbose( "Thread %i finished.\n", thread->id );
+	pthread_mutex_lock( &threadLock );
+	
+	JavaThread** entry= &threads;
+	while( *entry != thread )
+		entry= &(*entry)->next;
+	
+	*entry= thread->next;
+	runningThreadCount--;
+	pthread_cond_broadcast( &threadStateChanged );
+	pthread_mutex_unlock( &threadLock );
+	
+	stack_free( thread->stack );
+	mm_staticFree( thread );
+}
+
+/* Starts a new thread, which calls the run() method of the given java.lang.Thread instance. */
+void thread_start( reference threadObject )
+{
+	Class* cls= heap_getClassOfInstance( threadObject );
+	method_info* runMethod= cls_resolveMethod( &cls, sym_intern("run"), sym_intern("()V") );
+	
+	if( runMethod == NULL )
+		error( "Thread start failed, no run() method found!" );
+	
+	JavaThread* thread= mm_staticMalloc( sizeof(JavaThread) );
+	thread->threadObject= threadObject;
+	thread->nextParked= NULL;
+	
+	/* Set up the stack the same way as for the main method, i.e. with the instance as parameter in the initial stack frame. */
+	thread->stack= stack_create( initialStackSize );
+	stack_createInitialStackFrame( thread->stack );
+	stack_pushSlot( thread->stack, threadObject );
+	
+	/* The new thread counts as running from now on, so that the world can't be stopped before it has reached its first safe point. A new green thread is at a
+		safe point until a worker thread switches to it. */
+	pthread_mutex_lock( &threadLock );
+	
+	if( findThread(threadObject) != NULL )
+		error( "IllegalThreadStateException: The thread has been started already." );
+	
+	if( nextThreadId > MAX_THREAD_ID )
+		error( "Too many threads have been started!" );
+	
+	thread->id= nextThreadId++;
+	thread->next= threads;
+	threads= thread;
+	
+	if( !sched_isEnabled() )
+		runningThreadCount++;
+	
+	pthread_mutex_unlock( &threadLock );
+	
+	if( sched_isEnabled() )
+	{
+		sched_startThread( thread );
+		return;
+	}
+	
+	/* The new thread may finish and free its JavaThread before pthread_create() returns, so the handle isn't stored there. */
+	pthread_t nativeThread;
+	
+	if( pthread_create(&nativeThread, NULL, runThread, thread) != 0 )
+		error( "Native thread creation failed!" );
+	
+	pthread_detach( nativeThread );
+}
+
+/* Waits until the thread of the given java.lang.Thread instance has finished. Returns immediately, if the thread isn't running. */
+void thread_join( reference threadObject )
+{
+	thread_enterBlockingRegion();
+	pthread_mutex_lock( &threadLock );
+	
+	/* The instance may be collected and its reference reused while we're waiting, so wait for the id of the thread. */
+	JavaThread* thread= findThread( threadObject );
+	
+	if( thread != NULL )
+	{
+		uint32 id= thread->id;
+		
+		while( isThreadRunning(id) )
+			pthread_cond_wait( &threadStateChanged, &threadLock );
+	}
+	
+	pthread_mutex_unlock( &threadLock );
+	thread_leaveBlockingRegion();
+}
+
+/* Waits until all threads except the current one have finished. */
+void thread_waitForAllThreads()
+{
+	thread_enterBlockingRegion();
+	pthread_mutex_lock( &threadLock );
+	
+	while( threads != currentThread || currentThread->next != NULL )
+		pthread_cond_wait( &threadStateChanged, &threadLock );
+	
+	pthread_mutex_unlock( &threadLock );
+	thread_leaveBlockingRegion();
+}
+
+/* Stops all other threads at a safe point or in a blocking region. If another thread is stopping the world already, the current thread waits at a safe point
+	until the other thread has resumed the world. Returns the time to safe point in microseconds, i.e. how long it took the other threads to stop. */
+uint32 thread_stopTheWorld()
+{
+	pthread_mutex_lock( &threadLock );
+	
+	while( isStopTheWorldRequested )
+	{
+		runningThreadCount--;
+		pthread_cond_broadcast( &threadStateChanged );
+		
+		while( isStopTheWorldRequested )
+			pthread_cond_wait( &threadStateChanged, &threadLock );
+		
+		runningThreadCount++;
+	}
+	
+	isStopTheWorldRequested= true;
+	
+	struct timeval startTime;
+	gettimeofday( &startTime, NULL );
+	
+	while( runningThreadCount > 1 )
+		pthread_cond_wait( &threadStateChanged, &threadLock );
+	
+	pthread_mutex_unlock( &threadLock );
+	
+	struct timeval endTime;
+	gettimeofday( &endTime, NULL );
+	return (endTime.tv_sec - startTime.tv_sec)*1000000 + (endTime.tv_usec - startTime.tv_usec);
+}
+
+/* Lets all threads, that have been stopped by thread_stopTheWorld(), continue. */
+void thread_resumeTheWorld()
+{
+	pthread_mutex_lock( &threadLock );
+	isStopTheWorldRequested= false;
+	pthread_cond_broadcast( &threadStateChanged );
+	pthread_mutex_unlock( &threadLock );
+}
+
+/* Waits until the world is resumed, see thread_pollSafePoint(). */
+void thread_enterSafePoint()
+{
+	thread_switchOut();
+	thread_switchIn();
+}
+
+/* Must be called before the current thread blocks (i.e. waits for other threads), so that the world can be stopped in the meantime. The stack of the thread
+	must be consistent, and the thread must not access the heap before it calls thread_leaveBlockingRegion(). A green thread hands its worker over to another
+	worker thread meanwhile. */
+void thread_enterBlockingRegion()
+{
+	thread_switchOut();
+	
+	if( sched_isEnabled() )
+		sched_releaseWorker();
+}
+
+/* Ends a blocking region. Waits until the world is resumed, if it is stopped. */
+void thread_leaveBlockingRegion()
+{
+	if( sched_isEnabled() )
+		sched_acquireWorker();
+	
+	thread_switchIn();
+}
+
+/* Marks the current thread as not running anymore, i.e. it's at a safe point or in a blocking region, or it's a green thread which has left its worker. */
+void thread_switchOut()
+{
+	pthread_mutex_lock( &threadLock );
+	runningThreadCount--;
+	pthread_cond_broadcast( &threadStateChanged );
+	pthread_mutex_unlock( &threadLock );
+}
+
+/* Marks the current thread as running again. Waits until the world is resumed, if it is stopped. */
+void thread_switchIn()
+{
+	pthread_mutex_lock( &threadLock );
+	
+	while( isStopTheWorldRequested )
+		pthread_cond_wait( &threadStateChanged, &threadLock );
+	
+	runningThreadCount++;
+	pthread_mutex_unlock( &threadLock );
+}
+
+/* The method area lock protects the class table, the symbol table and the inline caches. It is only held for a short time and never while waiting for other
+	threads or running Java code. */
+void thread_lockMethodArea()
+{
+	pthread_mutex_lock( &methodAreaLock );
+}
+
+void thread_unlockMethodArea()
+{
+	pthread_mutex_unlock( &methodAreaLock );
+}
+
+/* Starts the initialization of the given class by the current thread (see JVMS 5.5). Returns true if the current thread has to run the initializer and call
+	thread_endClassInitialization() afterwards, false if the class is initialized already or being initialized by the current thread (i.e. we're called from
+	the initializer). If another thread is initializing the class, waits in a blocking region until it's done. No lock is held while the initializer runs, so it
+	may start and wait for other threads, which initialize other classes in the meantime. */
+boolean thread_beginClassInitialization( Class* cls )
+{
+	pthread_mutex_lock( &classInitializationLock );
+	
+	if( cls->isBeingInitialized && cls->initializingThread != currentThread )
+	{
+		/* The lock must not be held while entering or leaving the blocking region, which may wait for the world to be resumed. */
+		pthread_mutex_unlock( &classInitializationLock );
+		thread_enterBlockingRegion();
+		pthread_mutex_lock( &classInitializationLock );
+		
+		while( cls->isBeingInitialized )
+			pthread_cond_wait( &cls->initializationFinished, &classInitializationLock );
+		
+		pthread_mutex_unlock( &classInitializationLock );
+		thread_leaveBlockingRegion();
+		return false;
+	}
+	
+	boolean isStarted= !cls->isInitialized && !cls->isBeingInitialized;
+	if( isStarted )
+	{
+		cls->isBeingInitialized= true;
+		cls->initializingThread= currentThread;
+	}
+	
+	pthread_mutex_unlock( &classInitializationLock );
+	return isStarted;
+}
+
+/* Marks the given class as initialized and wakes up the threads which wait for it. */
+void thread_endClassInitialization( Class* cls )
+{
+	pthread_mutex_lock( &classInitializationLock );
+	
+	/* Other threads may use the class without locking as soon as they see the flag, so all changes of the initializer have to be visible before. */
+	__sync_synchronize();
+	cls->isInitialized= true;
+	cls->isBeingInitialized= false;
+	cls->initializingThread= NULL;
+	pthread_cond_broadcast( &cls->initializationFinished );
+	
+	pthread_mutex_unlock( &classInitializationLock );
+}
@@ -0,0 +1,69 @@
+/*
+ *  thread.h
+ *  Java threads. Every Java thread runs its own interpreter loop on its own stack, either in its own native thread (pthread) or as a green thread (see scheduler.c).
+ *
+ *  Copyright (c) 2006, 2007 Daniel Klein. All rights reserved.
+ *  
+ *  Licensed under GPL version 2.
+ *  See here for the full license: http://www.gnu.org/licenses/gpl.html
+ */
+
+#ifndef _thread_h_
+#define _thread_h_
+
+#include <pthread.h>
+#include "puraGlobals.h"
+#include "types.h"
+#include "stack.h"
+
+/* Thread ids must fit into the lock word of an instance, see monitor.c. */
+#define MAX_THREAD_ID ((1 << 24) - 2)
+
+typedef struct sJavaThread
+{
+	uint32 id;
+	Stack* stack;
+	reference threadObject; /* the java.lang.Thread instance, NULL_REFERENCE for the main thread */
+	pthread_t nativeThread;
+	struct sJavaThread* next; /* list of all running threads */
+	
+	/* green threads only, see scheduler.c */
+	boolean hasStarted; /* false until the frame of run() has been pushed */
+	uint32 schedulingState;
+	struct sJavaThread* nextParked; /* list of the threads parked on a monitor, see monitor.c */
+} JavaThread;
+
+extern JavaThread* threads;
+extern THREAD_LOCAL JavaThread* currentThread;
+extern volatile boolean isStopTheWorldRequested;
+
+/* Stops the current thread while another thread has stopped the world (i.e. for a garbage collection). May only be used where the stack of the current thread 
+	is consistent, i.e. where the garbage collector may run. */
+#define thread_pollSafePoint() \
+	do { \
+		if( isStopTheWorldRequested ) \
+			thread_enterSafePoint(); \
+	} while( false )
+
+void thread_init();
+void thread_attachMainThread( Stack* mainStack );
+void thread_start( reference threadObject );
+void thread_join( reference threadObject );
+void thread_waitForAllThreads();
+void thread_pushRunFrame( JavaThread* thread );
+void thread_finish( JavaThread* thread );
+void thread_switchIn();
+void thread_switchOut();
+
+uint32 thread_stopTheWorld();
+void thread_resumeTheWorld();
+void thread_enterSafePoint();
+void thread_enterBlockingRegion();
+void thread_leaveBlockingRegion();
+
+void thread_lockMethodArea();
+void thread_unlockMethodArea();
+boolean thread_beginClassInitialization( Class* cls );
+void thread_endClassInitialization( Class* cls );
+
+#endif /*_thread_h_*/